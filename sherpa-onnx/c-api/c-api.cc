@@ -22,6 +22,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/keyword-spotter.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/offline-punctuation.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/offline-speech-denoiser.h"
@@ -31,6 +32,7 @@
 #include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
 #include "sherpa-onnx/csrc/speaker-embedding-manager.h"
 #include "sherpa-onnx/csrc/spoken-language-identification.h"
+#include "sherpa-onnx/csrc/vad-asr-pipeline.h"
 #include "sherpa-onnx/csrc/voice-activity-detector.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 #include "sherpa-onnx/csrc/wave-writer.h"
@@ -337,6 +339,27 @@ int32_t SherpaOnnxOnlineStreamIsEndpoint(
   return recognizer->impl->IsEndpoint(stream->impl.get());
 }
 
+const char *SherpaOnnxOnlineStreamSerialize(
+    const SherpaOnnxOnlineStream *stream, int32_t *n) {
+  std::string snapshot = stream->impl->Serialize();
+  if (snapshot.empty()) {
+    *n = 0;
+    return nullptr;
+  }
+
+  char *p = new char[snapshot.size()];
+  std::copy(snapshot.begin(), snapshot.end(), p);
+  *n = static_cast<int32_t>(snapshot.size());
+  return p;
+}
+
+void SherpaOnnxDestroyOnlineStreamSnapshot(const char *s) { delete[] s; }
+
+int32_t SherpaOnnxOnlineStreamDeserialize(const SherpaOnnxOnlineStream *stream,
+                                          const char *data, int32_t n) {
+  return stream->impl->Deserialize(data, n);
+}
+
 const SherpaOnnxDisplay *SherpaOnnxCreateDisplay(int32_t max_word_per_line) {
   SherpaOnnxDisplay *ans = new SherpaOnnxDisplay;
   ans->impl = std::make_unique<sherpa_onnx::Display>(max_word_per_line);
@@ -1058,13 +1081,16 @@ void SherpaOnnxVoiceActivityDetectorClear(
 
 const SherpaOnnxSpeechSegment *SherpaOnnxVoiceActivityDetectorFront(
     const SherpaOnnxVoiceActivityDetector *p) {
-  const sherpa_onnx::SpeechSegment &segment = p->impl->Front();
+  // Copy directly from the buffer of the detector
+  const sherpa_onnx::SpeechSegmentView &segment = p->impl->FrontView();
+  const sherpa_onnx::CircularBufferView &v = segment.samples;
 
   SherpaOnnxSpeechSegment *ans = new SherpaOnnxSpeechSegment;
   ans->start = segment.start;
-  ans->samples = new float[segment.samples.size()];
-  std::copy(segment.samples.begin(), segment.samples.end(), ans->samples);
-  ans->n = segment.samples.size();
+  ans->samples = new float[v.Size()];
+  std::copy(v.data1, v.data1 + v.size1, ans->samples);
+  std::copy(v.data2, v.data2 + v.size2, ans->samples + v.size1);
+  ans->n = v.Size();
 
   return ans;
 }
@@ -1076,6 +1102,46 @@ void SherpaOnnxDestroySpeechSegment(const SherpaOnnxSpeechSegment *p) {
   }
 }
 
+// It keeps the buffer of the detector alive
+struct SpeechSegmentViewWithStorage : public SherpaOnnxSpeechSegmentView {
+  sherpa_onnx::CircularBufferView view;
+};
+
+const SherpaOnnxSpeechSegmentView *SherpaOnnxVoiceActivityDetectorFrontView(
+    const SherpaOnnxVoiceActivityDetector *p) {
+  const sherpa_onnx::SpeechSegmentView &segment = p->impl->FrontView();
+
+  auto ans = new SpeechSegmentViewWithStorage;
+  ans->view = segment.samples;
+  ans->start = segment.start;
+  ans->samples1 = ans->view.data1;
+  ans->n1 = ans->view.size1;
+  ans->samples2 = ans->view.data2;
+  ans->n2 = ans->view.size2;
+
+  return ans;
+}
+
+void SherpaOnnxDestroySpeechSegmentView(const SherpaOnnxSpeechSegmentView *p) {
+  delete static_cast<const SpeechSegmentViewWithStorage *>(p);
+}
+
+void SherpaOnnxAcceptWaveformOfflineFromSegmentView(
+    const SherpaOnnxOfflineStream *stream, int32_t sample_rate,
+    const SherpaOnnxSpeechSegmentView *segment) {
+  if (segment->n1) {
+    stream->impl->AcceptPartialWaveform(sample_rate, segment->samples1,
+                                        segment->n1);
+  }
+
+  if (segment->n2) {
+    stream->impl->AcceptPartialWaveform(sample_rate, segment->samples2,
+                                        segment->n2);
+  }
+
+  stream->impl->InputFinished();
+}
+
 void SherpaOnnxVoiceActivityDetectorReset(
     const SherpaOnnxVoiceActivityDetector *p) {
   p->impl->Reset();
@@ -1086,6 +1152,92 @@ void SherpaOnnxVoiceActivityDetectorFlush(
   p->impl->Flush();
 }
 
+struct SherpaOnnxVadAsrPipeline {
+  std::unique_ptr<sherpa_onnx::VadAsrPipeline> impl;
+};
+
+const SherpaOnnxVadAsrPipeline *SherpaOnnxCreateVadAsrPipeline(
+    const SherpaOnnxVadAsrPipelineConfig *config, int32_t num_channels,
+    SherpaOnnxVadAsrPipelineCallback callback, void *arg) {
+  sherpa_onnx::VadAsrPipelineConfig pipeline_config;
+  pipeline_config.vad = GetVadModelConfig(&config->vad);
+  pipeline_config.asr = GetOfflineRecognizerConfig(&config->asr);
+
+  auto &batching = pipeline_config.batching;
+  batching.max_batch_size =
+      SHERPA_ONNX_OR(config->max_batch_size, batching.max_batch_size);
+  batching.max_batch_frames =
+      SHERPA_ONNX_OR(config->max_batch_frames, batching.max_batch_frames);
+  batching.bucket_width =
+      SHERPA_ONNX_OR(config->batch_bucket_width, batching.bucket_width);
+  batching.max_wait_ms =
+      SHERPA_ONNX_OR(config->max_batch_wait_ms, batching.max_wait_ms);
+
+  pipeline_config.num_vad_threads = SHERPA_ONNX_OR(config->num_vad_threads, 1);
+  pipeline_config.num_asr_threads = SHERPA_ONNX_OR(config->num_asr_threads, 2);
+  pipeline_config.min_segment_duration =
+      SHERPA_ONNX_OR(config->min_segment_duration, 0.1);
+  pipeline_config.vad_buffer_size_in_seconds =
+      SHERPA_ONNX_OR(config->vad_buffer_size_in_seconds, 60);
+
+  if (pipeline_config.vad.debug) {
+#if __OHOS__
+    SHERPA_ONNX_LOGE("%{public}s", pipeline_config.ToString().c_str());
+#else
+    SHERPA_ONNX_LOGE("%s", pipeline_config.ToString().c_str());
+#endif
+  }
+
+  if (!pipeline_config.Validate()) {
+    SHERPA_ONNX_LOGE("Errors in config");
+    return nullptr;
+  }
+
+  auto cb = [callback, arg](const sherpa_onnx::VadAsrPipelineResult &r) {
+    if (!callback) {
+      return;
+    }
+
+    std::string json = r.result.AsJsonString();
+
+    SherpaOnnxVadAsrPipelineResult c;
+    c.channel = r.channel;
+    c.segment_index = r.segment_index;
+    c.start_time = r.start_time;
+    c.end_time = r.end_time;
+    c.text = r.result.text.c_str();
+    c.json = json.c_str();
+
+    callback(&c, arg);
+  };
+
+  SherpaOnnxVadAsrPipeline *p = new SherpaOnnxVadAsrPipeline;
+  p->impl = std::make_unique<sherpa_onnx::VadAsrPipeline>(
+      pipeline_config, num_channels, std::move(cb));
+
+  return p;
+}
+
+void SherpaOnnxDestroyVadAsrPipeline(const SherpaOnnxVadAsrPipeline *p) {
+  delete p;
+}
+
+void SherpaOnnxVadAsrPipelineAcceptWaveform(const SherpaOnnxVadAsrPipeline *p,
+                                            int32_t channel,
+                                            const float *samples, int32_t n) {
+  p->impl->AcceptWaveform(channel, samples, n);
+}
+
+void SherpaOnnxVadAsrPipelineInputFinished(const SherpaOnnxVadAsrPipeline *p,
+                                           int32_t channel) {
+  p->impl->InputFinished(channel);
+}
+
+void SherpaOnnxVadAsrPipelineWaitForCompletion(
+    const SherpaOnnxVadAsrPipeline *p) {
+  p->impl->WaitForCompletion();
+}
+
 #if SHERPA_ONNX_ENABLE_TTS == 1
 struct SherpaOnnxOfflineTts {
   std::unique_ptr<sherpa_onnx::OfflineTts> impl;
@@ -1974,6 +2126,24 @@ int32_t SherpaOnnxFileExists(const char *filename) {
   return sherpa_onnx::FileExists(filename);
 }
 
+void SherpaOnnxEnableMetrics(int32_t enabled) {
+  sherpa_onnx::MetricsRegistry::SetEnabled(enabled != 0);
+}
+
+const char *SherpaOnnxGetMetricsText() {
+  std::string text = sherpa_onnx::MetricsRegistry::Global().ToText();
+  char *p = new char[text.size() + 1];
+  std::copy(text.begin(), text.end(), p);
+  p[text.size()] = 0;
+  return p;
+}
+
+void SherpaOnnxFreeMetricsText(const char *s) { delete[] s; }
+
+void SherpaOnnxResetMetrics() {
+  sherpa_onnx::MetricsRegistry::Global().Reset();
+}
+
 struct SherpaOnnxOfflineSpeechDenoiser {
   std::unique_ptr<sherpa_onnx::OfflineSpeechDenoiser> impl;
 };
@@ -345,6 +345,32 @@ SHERPA_ONNX_API int32_t
 SherpaOnnxOnlineStreamIsEndpoint(const SherpaOnnxOnlineRecognizer *recognizer,
                                  const SherpaOnnxOnlineStream *stream);
 
+/// Save the decoding state of a stream, e.g., to move it to another
+/// process. See also SherpaOnnxOnlineStreamDeserialize().
+///
+/// @param stream A pointer returned by SherpaOnnxCreateOnlineStream()
+/// @param n  On return, it contains the number of bytes of the snapshot.
+/// @return Return a pointer to the snapshot, or NULL on error. The user has
+///         to invoke SherpaOnnxDestroyOnlineStreamSnapshot() to free it to
+///         avoid memory leak.
+SHERPA_ONNX_API const char *SherpaOnnxOnlineStreamSerialize(
+    const SherpaOnnxOnlineStream *stream, int32_t *n);
+
+SHERPA_ONNX_API void SherpaOnnxDestroyOnlineStreamSnapshot(const char *s);
+
+/// Restore a snapshot from SherpaOnnxOnlineStreamSerialize().
+///
+/// @param stream A pointer returned by SherpaOnnxCreateOnlineStream() or
+///               SherpaOnnxCreateOnlineStreamWithHotwords() of a recognizer
+///               with the same config. It must not have accepted any
+///               waveform.
+/// @param data  The snapshot.
+/// @param n  Number of bytes of the snapshot.
+/// @return Return 1 on success. Return 0 if the snapshot is invalid, in
+///         which case the stream should be destroyed.
+SHERPA_ONNX_API int32_t SherpaOnnxOnlineStreamDeserialize(
+    const SherpaOnnxOnlineStream *stream, const char *data, int32_t n);
+
 // for displaying results on Linux/macOS.
 SHERPA_ONNX_API typedef struct SherpaOnnxDisplay SherpaOnnxDisplay;
 
@@ -901,6 +927,43 @@ SherpaOnnxVoiceActivityDetectorFront(const SherpaOnnxVoiceActivityDetector *p);
 SHERPA_ONNX_API void SherpaOnnxDestroySpeechSegment(
     const SherpaOnnxSpeechSegment *p);
 
+// A speech segment that refers to the buffer of the voice activity
+// detector, so its samples are not copied. The samples may wrap around
+// the end of the buffer, so they are given in two parts: n1 samples in
+// samples1 followed by n2 samples in samples2. n2 is 0 if there is only
+// one part.
+SHERPA_ONNX_API typedef struct SherpaOnnxSpeechSegmentView {
+  // The start index in samples of this segment
+  int32_t start;
+
+  const float *samples1;
+  int32_t n1;
+
+  const float *samples2;
+  int32_t n2;
+} SherpaOnnxSpeechSegmentView;
+
+// Return the first speech segment without copying its samples.
+// The samples stay valid after SherpaOnnxVoiceActivityDetectorPop() and
+// even after the detector is destroyed, until the returned pointer is
+// freed with SherpaOnnxDestroySpeechSegmentView().
+SHERPA_ONNX_API const SherpaOnnxSpeechSegmentView *
+SherpaOnnxVoiceActivityDetectorFrontView(
+    const SherpaOnnxVoiceActivityDetector *p);
+
+// Free the pointer returned SherpaOnnxVoiceActivityDetectorFrontView().
+SHERPA_ONNX_API void SherpaOnnxDestroySpeechSegmentView(
+    const SherpaOnnxSpeechSegmentView *p);
+
+// Like SherpaOnnxAcceptWaveformOffline(), but it takes the samples of
+// a speech segment view, so they don't need to be copied into a
+// contiguous array first.
+//
+// @caution: For each offline stream, please invoke this function only once!
+SHERPA_ONNX_API void SherpaOnnxAcceptWaveformOfflineFromSegmentView(
+    const SherpaOnnxOfflineStream *stream, int32_t sample_rate,
+    const SherpaOnnxSpeechSegmentView *segment);
+
 // Re-initialize the voice activity detector.
 SHERPA_ONNX_API void SherpaOnnxVoiceActivityDetectorReset(
     const SherpaOnnxVoiceActivityDetector *p);
@@ -908,6 +971,81 @@ SHERPA_ONNX_API void SherpaOnnxVoiceActivityDetectorReset(
 SHERPA_ONNX_API void SherpaOnnxVoiceActivityDetectorFlush(
     const SherpaOnnxVoiceActivityDetector *p);
 
+// ============================================================
+// For VAD + non-streaming ASR of many channels
+// ============================================================
+SHERPA_ONNX_API typedef struct SherpaOnnxVadAsrPipelineConfig {
+  SherpaOnnxVadModelConfig vad;
+  SherpaOnnxOfflineRecognizerConfig asr;
+
+  // Batching of speech segments from all channels.
+  // 0 means to use the default value.
+  int32_t max_batch_size;
+  int32_t max_batch_frames;
+  float batch_bucket_width;  // in seconds
+  int32_t max_batch_wait_ms;
+
+  int32_t num_vad_threads;  // 0 means 1
+  int32_t num_asr_threads;  // 0 means 2
+
+  // Speech segments shorter than this value in seconds are discarded.
+  // 0 means 0.1
+  float min_segment_duration;
+
+  // 0 means 60
+  float vad_buffer_size_in_seconds;
+} SherpaOnnxVadAsrPipelineConfig;
+
+SHERPA_ONNX_API typedef struct SherpaOnnxVadAsrPipelineResult {
+  int32_t channel;
+
+  // For each channel, results are delivered in increasing order of it
+  int32_t segment_index;
+
+  // In seconds, relative to the start of the input of the channel
+  float start_time;
+  float end_time;
+
+  // Valid only during the callback
+  const char *text;
+  const char *json;
+} SherpaOnnxVadAsrPipelineResult;
+
+// It is called from the ASR threads. For a given channel, it is never
+// called concurrently.
+typedef void (*SherpaOnnxVadAsrPipelineCallback)(
+    const SherpaOnnxVadAsrPipelineResult *r, void *arg);
+
+SHERPA_ONNX_API typedef struct SherpaOnnxVadAsrPipeline
+    SherpaOnnxVadAsrPipeline;
+
+// The user has to use SherpaOnnxDestroyVadAsrPipeline() to free
+// the returned pointer to avoid memory leak.
+//
+// @param arg  Passed to callback unchanged
+SHERPA_ONNX_API const SherpaOnnxVadAsrPipeline *SherpaOnnxCreateVadAsrPipeline(
+    const SherpaOnnxVadAsrPipelineConfig *config, int32_t num_channels,
+    SherpaOnnxVadAsrPipelineCallback callback, void *arg);
+
+// It waits until all accepted samples are processed
+SHERPA_ONNX_API void SherpaOnnxDestroyVadAsrPipeline(
+    const SherpaOnnxVadAsrPipeline *p);
+
+// The sample rate of samples must be config->vad.sample_rate.
+// It returns without waiting for the samples to be processed.
+SHERPA_ONNX_API void SherpaOnnxVadAsrPipelineAcceptWaveform(
+    const SherpaOnnxVadAsrPipeline *p, int32_t channel, const float *samples,
+    int32_t n);
+
+// Decode the last speech segment of a channel. The channel can then be
+// used for a new input, whose timestamps start from 0 again.
+SHERPA_ONNX_API void SherpaOnnxVadAsrPipelineInputFinished(
+    const SherpaOnnxVadAsrPipeline *p, int32_t channel);
+
+// Block until all samples accepted so far are processed
+SHERPA_ONNX_API void SherpaOnnxVadAsrPipelineWaitForCompletion(
+    const SherpaOnnxVadAsrPipeline *p);
+
 // ============================================================
 // For offline Text-to-Speech (i.e., non-streaming TTS)
 // ============================================================
@@ -1517,6 +1655,25 @@ SHERPA_ONNX_API int32_t SherpaOnnxLinearResamplerResampleGetOutputSampleRate(
 // Return 1 if the file exists; return 0 if the file does not exist.
 SHERPA_ONNX_API int32_t SherpaOnnxFileExists(const char *filename);
 
+// =========================================================================
+// For metrics
+// =========================================================================
+
+/// Enable (enabled != 0) or disable (enabled == 0) the collection of
+/// latency, throughput and batch size metrics. They are disabled by default
+/// unless the environment variable SHERPA_ONNX_ENABLE_METRICS is set to 1.
+SHERPA_ONNX_API void SherpaOnnxEnableMetrics(int32_t enabled);
+
+/// Return all metrics collected so far in the Prometheus text format.
+/// The user has to use SherpaOnnxFreeMetricsText() to free the returned
+/// pointer to avoid memory leak.
+SHERPA_ONNX_API const char *SherpaOnnxGetMetricsText();
+
+SHERPA_ONNX_API void SherpaOnnxFreeMetricsText(const char *s);
+
+/// Reset all counters and histograms to 0.
+SHERPA_ONNX_API void SherpaOnnxResetMetrics();
+
 // =========================================================================
 // For offline speaker diarization (i.e., non-streaming speaker diarization)
 // =========================================================================
@@ -0,0 +1,100 @@
+// sherpa-onnx/csrc/audio-sample-format-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/audio-sample-format.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::vector<float> RoundTrip(AudioSampleFormat format,
+                                    const std::vector<float> &in) {
+  int32_t n = in.size();
+  std::vector<uint8_t> bytes(n * BytesPerSample(format));
+  EncodeAudioSamples(format, in.data(), n, bytes.data());
+
+  std::vector<float> out(n);
+  DecodeAudioSamples(format, bytes.data(), n, out.data());
+  return out;
+}
+
+static std::vector<float> TestSignal() {
+  std::vector<float> ans;
+  for (int32_t i = 0; i != 101; ++i) {
+    ans.push_back(0.9f * std::sin(i * 0.1f));
+  }
+  ans.push_back(0);
+  ans.push_back(1);
+  ans.push_back(-1);
+  return ans;
+}
+
+TEST(AudioSampleFormat, Float32) {
+  auto in = TestSignal();
+  auto out = RoundTrip(AudioSampleFormat::kFloat32, in);
+  EXPECT_EQ(in, out);
+}
+
+TEST(AudioSampleFormat, Int16) {
+  auto in = TestSignal();
+  auto out = RoundTrip(AudioSampleFormat::kInt16, in);
+  for (int32_t i = 0; i != in.size(); ++i) {
+    EXPECT_NEAR(in[i], out[i], 2.0f / 32768) << i;
+  }
+
+  // 0x8000 is -32768, 0x7fff is 32767
+  std::vector<uint8_t> bytes = {0x00, 0x80, 0xff, 0x7f, 0x01, 0x00};
+  std::vector<float> samples(3);
+  DecodeAudioSamples(AudioSampleFormat::kInt16, bytes.data(), 3,
+                     samples.data());
+  EXPECT_EQ(samples[0], -1.0f);
+  EXPECT_EQ(samples[1], 32767.0f / 32768);
+  EXPECT_EQ(samples[2], 1.0f / 32768);
+}
+
+TEST(AudioSampleFormat, G711) {
+  auto in = TestSignal();
+  for (auto format : {AudioSampleFormat::kMulaw, AudioSampleFormat::kAlaw}) {
+    auto out = RoundTrip(format, in);
+    for (int32_t i = 0; i != in.size(); ++i) {
+      // 8-bit companding has a relative error of about 1/16
+      EXPECT_NEAR(in[i], out[i], std::abs(in[i]) / 16 + 2e-3f) << i;
+    }
+  }
+
+  // silence
+  uint8_t mulaw_zero = 0xff;
+  uint8_t alaw_zero = 0xd5;
+  float f = 1;
+  DecodeAudioSamples(AudioSampleFormat::kMulaw, &mulaw_zero, 1, &f);
+  EXPECT_EQ(f, 0);
+
+  DecodeAudioSamples(AudioSampleFormat::kAlaw, &alaw_zero, 1, &f);
+  EXPECT_EQ(f, 8.0f / 32768);
+}
+
+TEST(AudioSampleFormat, Message) {
+  auto msg = BuildAudioFormatMessage(AudioSampleFormat::kMulaw, 8000);
+  EXPECT_EQ(msg, "AUDIO_FORMAT mulaw 8000");
+
+  AudioSampleFormat format;
+  int32_t sample_rate = 0;
+  ASSERT_TRUE(ParseAudioFormatMessage(msg, &format, &sample_rate));
+  EXPECT_EQ(format, AudioSampleFormat::kMulaw);
+  EXPECT_EQ(sample_rate, 8000);
+
+  EXPECT_FALSE(ParseAudioFormatMessage("Done", &format, &sample_rate));
+  EXPECT_FALSE(
+      ParseAudioFormatMessage("AUDIO_FORMAT pcm 8000", &format, &sample_rate));
+  EXPECT_FALSE(
+      ParseAudioFormatMessage("AUDIO_FORMAT int16 0", &format, &sample_rate));
+  EXPECT_FALSE(ParseAudioFormatMessage("AUDIO_FORMAT int16 16000 x", &format,
+                                       &sample_rate));
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,303 @@
+// sherpa-onnx/csrc/audio-sample-format.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/audio-sample-format.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SHERPA_ONNX_AUDIO_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SHERPA_ONNX_AUDIO_NEON 1
+#endif
+
+namespace sherpa_onnx {
+
+// The G.711 conversions below follow the reference implementation
+// g711.c from Sun Microsystems, which is in the public domain.
+static int16_t MulawToLinear(uint8_t u) {
+  u = ~u;
+  int32_t t = ((u & 0x0f) << 3) + 0x84;
+  t <<= (u & 0x70) >> 4;
+  return static_cast<int16_t>((u & 0x80) ? (0x84 - t) : (t - 0x84));
+}
+
+static int16_t AlawToLinear(uint8_t a) {
+  a ^= 0x55;
+  int32_t t = (a & 0x0f) << 4;
+  int32_t seg = (a & 0x70) >> 4;
+  switch (seg) {
+    case 0:
+      t += 8;
+      break;
+    case 1:
+      t += 0x108;
+      break;
+    default:
+      t += 0x108;
+      t <<= seg - 1;
+  }
+  return static_cast<int16_t>((a & 0x80) ? t : -t);
+}
+
+// Return the index of the first entry in table that is >= v,
+// or 8 if there is no such entry
+static int32_t Segment(int32_t v, const int16_t *table) {
+  for (int32_t i = 0; i != 8; ++i) {
+    if (v <= table[i]) {
+      return i;
+    }
+  }
+  return 8;
+}
+
+static uint8_t LinearToMulaw(int32_t pcm) {
+  static const int16_t kSegEnd[8] = {0x3f,  0x7f,  0xff,  0x1ff,
+                                     0x3ff, 0x7ff, 0xfff, 0x1fff};
+  int32_t mask;
+
+  pcm >>= 2;
+  if (pcm < 0) {
+    pcm = -pcm;
+    mask = 0x7f;
+  } else {
+    mask = 0xff;
+  }
+
+  pcm = std::min(pcm, 8159);
+  pcm += 0x84 >> 2;
+
+  int32_t seg = Segment(pcm, kSegEnd);
+  if (seg >= 8) {
+    return static_cast<uint8_t>(0x7f ^ mask);
+  }
+
+  int32_t u = (seg << 4) | ((pcm >> (seg + 1)) & 0x0f);
+  return static_cast<uint8_t>(u ^ mask);
+}
+
+static uint8_t LinearToAlaw(int32_t pcm) {
+  static const int16_t kSegEnd[8] = {0x1f,  0x3f,  0x7f,  0xff,
+                                     0x1ff, 0x3ff, 0x7ff, 0xfff};
+  int32_t mask;
+
+  pcm >>= 3;
+  if (pcm >= 0) {
+    mask = 0xd5;
+  } else {
+    mask = 0x55;
+    pcm = -pcm - 1;
+  }
+
+  int32_t seg = Segment(pcm, kSegEnd);
+  if (seg >= 8) {
+    return static_cast<uint8_t>(0x7f ^ mask);
+  }
+
+  int32_t a = seg << 4;
+  if (seg < 2) {
+    a |= (pcm >> 1) & 0x0f;
+  } else {
+    a |= (pcm >> seg) & 0x0f;
+  }
+
+  return static_cast<uint8_t>(a ^ mask);
+}
+
+// Lookup tables from an 8-bit code to a normalized float sample
+static const std::array<float, 256> &MulawTable() {
+  static const std::array<float, 256> table = []() {
+    std::array<float, 256> t;
+    for (int32_t i = 0; i != 256; ++i) {
+      t[i] = MulawToLinear(static_cast<uint8_t>(i)) / 32768.0f;
+    }
+    return t;
+  }();
+  return table;
+}
+
+static const std::array<float, 256> &AlawTable() {
+  static const std::array<float, 256> table = []() {
+    std::array<float, 256> t;
+    for (int32_t i = 0; i != 256; ++i) {
+      t[i] = AlawToLinear(static_cast<uint8_t>(i)) / 32768.0f;
+    }
+    return t;
+  }();
+  return table;
+}
+
+static void DecodeInt16(const uint8_t *p, int32_t n, float *out) {
+  constexpr float kScale = 1.0f / 32768;
+  int32_t i = 0;
+
+#if SHERPA_ONNX_AUDIO_SSE2
+  const __m128 scale = _mm_set1_ps(kScale);
+  for (; i + 8 <= n; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2 * i));
+    // sign-extend int16 to int32
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+#elif SHERPA_ONNX_AUDIO_NEON
+  const float32x4_t scale = vdupq_n_f32(kScale);
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(p + 2 * i));
+    int32x4_t lo = vmovl_s16(vget_low_s16(v));
+    int32x4_t hi = vmovl_s16(vget_high_s16(v));
+    vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(lo), scale));
+    vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(hi), scale));
+  }
+#endif
+
+  for (; i < n; ++i) {
+    int16_t s = static_cast<int16_t>(p[2 * i] | (p[2 * i + 1] << 8));
+    out[i] = s * kScale;
+  }
+}
+
+static void DecodeWithTable(const std::array<float, 256> &table,
+                            const uint8_t *p, int32_t n, float *out) {
+  const float *t = table.data();
+  for (int32_t i = 0; i != n; ++i) {
+    out[i] = t[p[i]];
+  }
+}
+
+static int32_t FloatToInt16(float f) {
+  f = std::max(-1.0f, std::min(1.0f, f));
+  return static_cast<int32_t>(std::lround(f * 32767));
+}
+
+int32_t BytesPerSample(AudioSampleFormat format) {
+  switch (format) {
+    case AudioSampleFormat::kFloat32:
+      return 4;
+    case AudioSampleFormat::kInt16:
+      return 2;
+    case AudioSampleFormat::kMulaw:
+    case AudioSampleFormat::kAlaw:
+      return 1;
+  }
+  return 4;
+}
+
+const char *AudioSampleFormatToString(AudioSampleFormat format) {
+  switch (format) {
+    case AudioSampleFormat::kFloat32:
+      return "float32";
+    case AudioSampleFormat::kInt16:
+      return "int16";
+    case AudioSampleFormat::kMulaw:
+      return "mulaw";
+    case AudioSampleFormat::kAlaw:
+      return "alaw";
+  }
+  return "unknown";
+}
+
+bool ParseAudioSampleFormat(const std::string &s, AudioSampleFormat *format) {
+  if (s == "float32") {
+    *format = AudioSampleFormat::kFloat32;
+  } else if (s == "int16") {
+    *format = AudioSampleFormat::kInt16;
+  } else if (s == "mulaw") {
+    *format = AudioSampleFormat::kMulaw;
+  } else if (s == "alaw") {
+    *format = AudioSampleFormat::kAlaw;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+void DecodeAudioSamples(AudioSampleFormat format, const uint8_t *p, int32_t n,
+                        float *out) {
+  switch (format) {
+    case AudioSampleFormat::kFloat32:
+      std::memcpy(out, p, n * sizeof(float));
+      break;
+    case AudioSampleFormat::kInt16:
+      DecodeInt16(p, n, out);
+      break;
+    case AudioSampleFormat::kMulaw:
+      DecodeWithTable(MulawTable(), p, n, out);
+      break;
+    case AudioSampleFormat::kAlaw:
+      DecodeWithTable(AlawTable(), p, n, out);
+      break;
+  }
+}
+
+void EncodeAudioSamples(AudioSampleFormat format, const float *in, int32_t n,
+                        uint8_t *out) {
+  switch (format) {
+    case AudioSampleFormat::kFloat32:
+      std::memcpy(out, in, n * sizeof(float));
+      break;
+    case AudioSampleFormat::kInt16:
+      for (int32_t i = 0; i != n; ++i) {
+        int32_t s = FloatToInt16(in[i]);
+        out[2 * i] = static_cast<uint8_t>(s & 0xff);
+        out[2 * i + 1] = static_cast<uint8_t>((s >> 8) & 0xff);
+      }
+      break;
+    case AudioSampleFormat::kMulaw:
+      for (int32_t i = 0; i != n; ++i) {
+        out[i] = LinearToMulaw(FloatToInt16(in[i]));
+      }
+      break;
+    case AudioSampleFormat::kAlaw:
+      for (int32_t i = 0; i != n; ++i) {
+        out[i] = LinearToAlaw(FloatToInt16(in[i]));
+      }
+      break;
+  }
+}
+
+std::string BuildAudioFormatMessage(AudioSampleFormat format,
+                                    int32_t sample_rate) {
+  std::ostringstream os;
+  os << "AUDIO_FORMAT " << AudioSampleFormatToString(format) << " "
+     << sample_rate;
+  return os.str();
+}
+
+bool ParseAudioFormatMessage(const std::string &msg, AudioSampleFormat *format,
+                             int32_t *sample_rate) {
+  std::istringstream is(msg);
+
+  std::string tag;
+  std::string name;
+  int32_t rate = 0;
+
+  if (!(is >> tag >> name >> rate) || tag != "AUDIO_FORMAT") {
+    return false;
+  }
+
+  std::string extra;
+  if (is >> extra) {
+    return false;
+  }
+
+  if (rate <= 0 || !ParseAudioSampleFormat(name, format)) {
+    return false;
+  }
+
+  *sample_rate = rate;
+
+  return true;
+}
+
+}  // namespace sherpa_onnx
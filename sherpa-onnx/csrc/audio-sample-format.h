@@ -0,0 +1,78 @@
+// sherpa-onnx/csrc/audio-sample-format.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_AUDIO_SAMPLE_FORMAT_H_
+#define SHERPA_ONNX_CSRC_AUDIO_SAMPLE_FORMAT_H_
+
+#include <cstdint>
+#include <string>
+
+namespace sherpa_onnx {
+
+// Encoding of audio samples sent over the network.
+// All multi-byte formats are little endian.
+enum class AudioSampleFormat : int32_t {
+  kFloat32 = 0,  // float32, normalized to [-1, 1]
+  kInt16 = 1,    // 16-bit linear PCM
+  kMulaw = 2,    // 8-bit G.711 mu-law
+  kAlaw = 3,     // 8-bit G.711 A-law
+};
+
+// Number of bytes of a single sample in the given format
+int32_t BytesPerSample(AudioSampleFormat format);
+
+// Return one of "float32", "int16", "mulaw", "alaw"
+const char *AudioSampleFormatToString(AudioSampleFormat format);
+
+/** Parse the name of a format.
+ *
+ * @param s  One of "float32", "int16", "mulaw", "alaw".
+ * @param format On return, it contains the parsed format.
+ * @return Return true on success; false if s is not a valid name.
+ */
+bool ParseAudioSampleFormat(const std::string &s, AudioSampleFormat *format);
+
+/** Convert encoded samples to float samples normalized to [-1, 1].
+ *
+ * @param format  Format of the input.
+ * @param p  Pointer to n * BytesPerSample(format) bytes. It does not need
+ *           to be aligned.
+ * @param n  Number of samples.
+ * @param out  Pointer to an array of n floats.
+ */
+void DecodeAudioSamples(AudioSampleFormat format, const uint8_t *p, int32_t n,
+                        float *out);
+
+/** Convert float samples in the range [-1, 1] to the given format.
+ *
+ * @param format  Format of the output.
+ * @param in  Pointer to n floats.
+ * @param n  Number of samples.
+ * @param out  Pointer to n * BytesPerSample(format) bytes.
+ */
+void EncodeAudioSamples(AudioSampleFormat format, const float *in, int32_t n,
+                        uint8_t *out);
+
+/** The websocket servers accept a text message of the following form
+ * to negotiate the format of the audio samples of a connection:
+ *
+ *   AUDIO_FORMAT <format> <sample_rate>
+ *
+ * For instance, "AUDIO_FORMAT mulaw 8000". If it is not sent, samples are
+ * float32 at the sample rate expected by the server.
+ */
+std::string BuildAudioFormatMessage(AudioSampleFormat format,
+                                    int32_t sample_rate);
+
+/** Parse a message built with BuildAudioFormatMessage().
+ *
+ * @return Return false if msg is not an AUDIO_FORMAT message or if it
+ *         contains invalid values.
+ */
+bool ParseAudioFormatMessage(const std::string &msg, AudioSampleFormat *format,
+                             int32_t *sample_rate);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_AUDIO_SAMPLE_FORMAT_H_
@@ -24,6 +24,10 @@ void AudioTaggingModelConfig::Register(ParseOptions *po) {
 
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
+
+  po->Register("use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
 }
 
 bool AudioTaggingModelConfig::Validate() const {
@@ -52,7 +56,9 @@ std::string AudioTaggingModelConfig::ToString() const {
   os << "ced=\"" << ced << "\", ";
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
-  os << "provider=\"" << provider << "\")";
+  os << "provider=\"" << provider << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ")";
 
   return os.str();
 }
@@ -0,0 +1,142 @@
+// sherpa-onnx/csrc/binary-io-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/binary-io.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(BinaryIO, RoundTrip) {
+  BinaryWriter w;
+  w.Write(int32_t{-3});
+  w.Write(2.5f);
+  w.Write(true);
+  w.Write(std::vector<int64_t>{1, 2, 1LL << 40});
+  w.Write(std::vector<float>{});
+  w.Write(std::string("hello"));
+
+  const std::string &buf = w.Data();
+  BinaryReader r(buf.data(), buf.size());
+
+  int32_t i = 0;
+  float f = 0;
+  bool b = false;
+  std::vector<int64_t> v;
+  std::vector<float> e = {1};
+  std::string s;
+
+  EXPECT_TRUE(r.Read(&i));
+  EXPECT_TRUE(r.Read(&f));
+  EXPECT_TRUE(r.Read(&b));
+  EXPECT_TRUE(r.Read(&v));
+  EXPECT_TRUE(r.Read(&e));
+  EXPECT_TRUE(r.Read(&s));
+  EXPECT_TRUE(r.Ok());
+  EXPECT_EQ(r.Remaining(), 0);
+
+  EXPECT_EQ(i, -3);
+  EXPECT_EQ(f, 2.5f);
+  EXPECT_TRUE(b);
+  EXPECT_EQ(v, (std::vector<int64_t>{1, 2, 1LL << 40}));
+  EXPECT_TRUE(e.empty());
+  EXPECT_EQ(s, "hello");
+
+  // Nothing is left
+  EXPECT_FALSE(r.Read(&i));
+  EXPECT_FALSE(r.Ok());
+}
+
+TEST(BinaryIO, Truncated) {
+  BinaryWriter w;
+  w.Write(std::vector<int32_t>{1, 2, 3});
+
+  std::string buf = w.Data();
+  buf.pop_back();
+
+  BinaryReader r(buf.data(), buf.size());
+  std::vector<int32_t> v;
+  EXPECT_FALSE(r.Read(&v));
+  EXPECT_FALSE(r.Ok());
+
+  // Subsequent reads fail as well
+  int8_t c;
+  EXPECT_FALSE(r.Read(&c));
+}
+
+// Sizes that overflow when multiplied by the element size
+TEST(BinaryIO, HugeSize) {
+  BinaryWriter w;
+  w.Write(int64_t{1} << 62);
+  w.Write(int64_t{0});
+
+  const std::string &buf = w.Data();
+  BinaryReader r(buf.data(), buf.size());
+  std::vector<int32_t> v;
+  EXPECT_FALSE(r.Read(&v));
+  EXPECT_FALSE(r.Ok());
+}
+
+TEST(BinaryIO, HugeTensorShape) {
+  for (const auto &shape : std::vector<std::vector<int64_t>>{
+           {int64_t{1} << 32, int64_t{1} << 32},
+           {int64_t{1} << 62, 4},
+           {2, -3}}) {
+    BinaryWriter w;
+    w.Write(true);
+    w.Write(int32_t{ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT});
+    w.Write(shape);
+    w.Write(std::vector<float>(16));
+
+    const std::string &buf = w.Data();
+    BinaryReader r(buf.data(), buf.size());
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    Ort::Value v{nullptr};
+    EXPECT_FALSE(r.Read(&v, allocator));
+    EXPECT_FALSE(r.Ok());
+  }
+}
+
+TEST(BinaryIO, Tensor) {
+  std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  std::array<int64_t, 2> shape = {2, 3};
+
+  auto memory_info =
+      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+  Ort::Value x = Ort::Value::CreateTensor(memory_info, data.data(),
+                                          data.size(), shape.data(),
+                                          shape.size());
+
+  BinaryWriter w;
+  w.Write(x);
+  w.Write(Ort::Value{nullptr});
+
+  const std::string &buf = w.Data();
+  BinaryReader r(buf.data(), buf.size());
+
+  Ort::AllocatorWithDefaultOptions allocator;
+  Ort::Value y{nullptr};
+  Ort::Value z{nullptr};
+  EXPECT_TRUE(r.Read(&y, allocator));
+  EXPECT_TRUE(r.Read(&z, allocator));
+  EXPECT_EQ(r.Remaining(), 0);
+
+  ASSERT_TRUE(static_cast<bool>(y));
+  EXPECT_FALSE(static_cast<bool>(z));
+
+  auto y_shape = y.GetTensorTypeAndShapeInfo().GetShape();
+  EXPECT_EQ(y_shape, (std::vector<int64_t>{2, 3}));
+
+  const float *p = y.GetTensorData<float>();
+  for (size_t i = 0; i != data.size(); ++i) {
+    EXPECT_EQ(p[i], data[i]);
+  }
+}
+
+}  // namespace sherpa_onnx
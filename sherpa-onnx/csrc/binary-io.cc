@@ -0,0 +1,149 @@
+// sherpa-onnx/csrc/binary-io.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/binary-io.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+template <typename T>
+void WriteTensorData(const Ort::Value &v, int64_t n, std::string *buf) {
+  buf->append(reinterpret_cast<const char *>(v.GetTensorData<T>()),
+              n * sizeof(T));
+}
+
+template <typename T>
+Ort::Value CreateTensor(const char *p, const std::vector<int64_t> &shape,
+                        int64_t n, OrtAllocator *allocator) {
+  Ort::Value ans =
+      Ort::Value::CreateTensor<T>(allocator, shape.data(), shape.size());
+  if (n > 0) {
+    std::memcpy(ans.GetTensorMutableData<T>(), p, n * sizeof(T));
+  }
+  return ans;
+}
+
+size_t ElementSize(int32_t type) {
+  switch (type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+      return sizeof(float);
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+      return sizeof(int32_t);
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+      return sizeof(int64_t);
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+void BinaryWriter::Write(const std::string &s) {
+  Write(static_cast<int64_t>(s.size()));
+  buf_.append(s);
+}
+
+void BinaryWriter::Write(const Ort::Value &v) {
+  bool has_value = static_cast<bool>(v);
+  Write(has_value);
+  if (!has_value) {
+    return;
+  }
+
+  auto type_and_shape = v.GetTensorTypeAndShapeInfo();
+  int32_t type = type_and_shape.GetElementType();
+  int64_t n = type_and_shape.GetElementCount();
+
+  Write(type);
+  Write(type_and_shape.GetShape());
+
+  switch (type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+      WriteTensorData<float>(v, n, &buf_);
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+      WriteTensorData<int32_t>(v, n, &buf_);
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+      WriteTensorData<int64_t>(v, n, &buf_);
+      break;
+    default:
+      SHERPA_ONNX_LOGE("Unsupported type: %d", type);
+      SHERPA_ONNX_EXIT(-1);
+  }
+}
+
+bool BinaryReader::Read(std::string *s) {
+  int64_t n = 0;
+  if (!Read(&n) || n < 0 || !Check(n)) {
+    ok_ = false;
+    return false;
+  }
+  s->assign(p_, n);
+  p_ += n;
+  return true;
+}
+
+bool BinaryReader::Read(Ort::Value *v, OrtAllocator *allocator) {
+  bool has_value = false;
+  if (!Read(&has_value)) {
+    return false;
+  }
+
+  if (!has_value) {
+    *v = Ort::Value{nullptr};
+    return true;
+  }
+
+  int32_t type = 0;
+  std::vector<int64_t> shape;
+  if (!Read(&type) || !Read(&shape)) {
+    return false;
+  }
+
+  size_t element_size = ElementSize(type);
+  if (element_size == 0) {
+    ok_ = false;
+    return false;
+  }
+
+  // A tensor with a dim of 0 is empty. Otherwise each dim is checked
+  // against the remaining bytes before it is multiplied, so that the
+  // number of elements n cannot overflow.
+  uint64_t max_n = Remaining() / element_size;
+  uint64_t n = std::count(shape.begin(), shape.end(), 0) ? 0 : 1;
+  for (auto d : shape) {
+    if (d < 0 || (n != 0 && static_cast<uint64_t>(d) > max_n / n)) {
+      ok_ = false;
+      return false;
+    }
+    n *= d;
+  }
+
+  switch (type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+      *v = CreateTensor<float>(p_, shape, n, allocator);
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+      *v = CreateTensor<int32_t>(p_, shape, n, allocator);
+      break;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+      *v = CreateTensor<int64_t>(p_, shape, n, allocator);
+      break;
+    default:
+      break;
+  }
+
+  p_ += n * element_size;
+  return true;
+}
+
+}  // namespace sherpa_onnx
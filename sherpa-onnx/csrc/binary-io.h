@@ -0,0 +1,117 @@
+// sherpa-onnx/csrc/binary-io.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_BINARY_IO_H_
+#define SHERPA_ONNX_CSRC_BINARY_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+
+namespace sherpa_onnx {
+
+/** Write values into a byte buffer in the native byte order.
+ *
+ * It is used to snapshot the state of a stream so that it can be restored
+ * later, possibly in another process on a machine of the same kind.
+ */
+class BinaryWriter {
+ public:
+  template <typename T, typename = std::enable_if_t<
+                            std::is_trivially_copyable<T>::value>>
+  void Write(const T &v) {
+    buf_.append(reinterpret_cast<const char *>(&v), sizeof(T));
+  }
+
+  template <typename T>
+  void Write(const std::vector<T> &v) {
+    static_assert(std::is_trivially_copyable<T>::value, "");
+    Write(static_cast<int64_t>(v.size()));
+    buf_.append(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+  }
+
+  void Write(const std::string &s);
+
+  // A tensor of type float, int32 or int64. It can be a null value.
+  void Write(const Ort::Value &v);
+
+  const std::string &Data() const { return buf_; }
+  std::string &Data() { return buf_; }
+
+ private:
+  std::string buf_;
+};
+
+/** Read values written by BinaryWriter.
+ *
+ * Once a read fails, e.g., because the buffer is truncated, all
+ * subsequent reads fail and Ok() returns false.
+ */
+class BinaryReader {
+ public:
+  // data is not owned and must outlive this object
+  BinaryReader(const char *data, size_t size) : p_(data), end_(data + size) {}
+
+  template <typename T, typename = std::enable_if_t<
+                            std::is_trivially_copyable<T>::value>>
+  bool Read(T *v) {
+    if (!Check(sizeof(T))) {
+      return false;
+    }
+    std::memcpy(v, p_, sizeof(T));
+    p_ += sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool Read(std::vector<T> *v) {
+    static_assert(std::is_trivially_copyable<T>::value, "");
+    int64_t n = 0;
+    // Compare with Remaining() / sizeof(T) so that n * sizeof(T) cannot
+    // overflow
+    if (!Read(&n) || n < 0 ||
+        static_cast<uint64_t>(n) > Remaining() / sizeof(T)) {
+      ok_ = false;
+      return false;
+    }
+    v->resize(n);
+    if (n > 0) {
+      std::memcpy(v->data(), p_, n * sizeof(T));
+      p_ += n * sizeof(T);
+    }
+    return true;
+  }
+
+  bool Read(std::string *s);
+
+  // On return, v is a tensor allocated by the given allocator or a null
+  // value.
+  bool Read(Ort::Value *v, OrtAllocator *allocator);
+
+  bool Ok() const { return ok_; }
+
+  size_t Remaining() const { return end_ - p_; }
+
+ private:
+  bool Check(size_t n) {
+    if (!ok_ || static_cast<size_t>(end_ - p_) < n) {
+      ok_ = false;
+    }
+    return ok_;
+  }
+
+ private:
+  const char *p_;
+  const char *end_;
+  bool ok_ = true;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_BINARY_IO_H_
@@ -147,4 +147,60 @@ TEST(CircularBuffer, PushAndPop) {
   EXPECT_EQ(c[1], 4000);
 }
 
+TEST(CircularBuffer, GetView) {
+  CircularBuffer buffer(5);
+  std::vector<float> a = {0, 1, 2, 3};
+  buffer.Push(a.data(), a.size());
+
+  auto v = buffer.GetView(1, 3);
+  EXPECT_EQ(v.Size(), 3);
+  EXPECT_EQ(v.size2, 0);
+  EXPECT_EQ(v.ToVector(), (std::vector<float>{1, 2, 3}));
+
+  buffer.Pop(3);
+
+  // It wraps around
+  std::vector<float> b = {4, 5, 6};
+  buffer.Push(b.data(), b.size());
+
+  auto w = buffer.GetView(3, 4);
+  EXPECT_EQ(w.size1, 2);
+  EXPECT_EQ(w.size2, 2);
+  EXPECT_EQ(w.ToVector(), (std::vector<float>{3, 4, 5, 6}));
+}
+
+TEST(CircularBuffer, ViewIsNotOverwritten) {
+  CircularBuffer buffer(4);
+  std::vector<float> a = {0, 1, 2, 3};
+  buffer.Push(a.data(), a.size());
+
+  auto v = buffer.GetView(0, 2);
+  buffer.Pop(4);
+
+  // Positions of 0 and 1 are reused
+  std::vector<float> b = {4, 5, 6};
+  buffer.Push(b.data(), b.size());
+
+  EXPECT_EQ(v.ToVector(), (std::vector<float>{0, 1}));
+  EXPECT_EQ(buffer.Get(4, 3), b);
+
+  // The view is destroyed, so its storage can be reused
+  v = {};
+  auto w = buffer.GetView(4, 3);
+  buffer.Pop(3);
+
+  std::vector<float> c = {7};
+  buffer.Push(c.data(), c.size());
+  EXPECT_EQ(w.ToVector(), b);
+  EXPECT_EQ(buffer.Get(7, 1), c);
+
+  buffer.Reset();
+  buffer.Push(a.data(), a.size());
+  EXPECT_EQ(w.ToVector(), b);
+
+  buffer.Resize(8);
+  EXPECT_EQ(w.ToVector(), b);
+  EXPECT_EQ(buffer.Get(0, 4), a);
+}
+
 }  // namespace sherpa_onnx
@@ -5,22 +5,51 @@
 #include "sherpa-onnx/csrc/circular-buffer.h"
 
 #include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
 
+std::vector<float> CircularBufferView::ToVector() const {
+  std::vector<float> ans(Size());
+  if (size1) {
+    std::copy(data1, data1 + size1, ans.begin());
+  }
+
+  if (size2) {
+    std::copy(data2, data2 + size2, ans.begin() + size1);
+  }
+
+  return ans;
+}
+
 CircularBuffer::CircularBuffer(int32_t capacity) {
   if (capacity <= 0) {
     SHERPA_ONNX_LOGE("Please specify a positive capacity. Given: %d\n",
                      capacity);
     exit(-1);
   }
-  buffer_.resize(capacity);
+  buffer_ = std::make_shared<std::vector<float>>(capacity);
+}
+
+void CircularBuffer::Reset() {
+  head_ = 0;
+  tail_ = 0;
+
+  if (view_start_ != -1 && buffer_.use_count() > 1) {
+    // Indexes start from 0 again, so we cannot tell whether a Push()
+    // overwrites a view. Leave the old storage to the views.
+    buffer_ = std::make_shared<std::vector<float>>(buffer_->size());
+  }
+  view_start_ = -1;
 }
 
 void CircularBuffer::Resize(int32_t new_capacity) {
-  int32_t capacity = static_cast<int32_t>(buffer_.size());
+  const std::vector<float> &buffer = *buffer_;
+  int32_t capacity = static_cast<int32_t>(buffer.size());
   if (new_capacity <= capacity) {
 #if __OHOS__
     SHERPA_ONNX_LOGE(
@@ -34,8 +63,12 @@ void CircularBuffer::Resize(int32_t new_capacity) {
   }
 
   int32_t size = Size();
+  // Views may still refer to the old storage, so we never resize it
+  // in place
+  view_start_ = -1;
+
   if (size == 0) {
-    buffer_.resize(new_capacity);
+    buffer_ = std::make_shared<std::vector<float>>(new_capacity);
     return;
   }
 
@@ -45,18 +78,18 @@ void CircularBuffer::Resize(int32_t new_capacity) {
 
   if (start + size <= capacity) {
     if (dest + size <= new_capacity) {
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + size,
+      std::copy(buffer.begin() + start, buffer.begin() + start + size,
                 new_buffer.begin() + dest);
     } else {
       int32_t part1_size = new_capacity - dest;
 
       // copy [start, start+part1_size] to new_buffer
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + part1_size,
+      std::copy(buffer.begin() + start, buffer.begin() + start + part1_size,
                 new_buffer.begin() + dest);
 
       // copy [start+part1_size, start+size] to new_buffer
-      std::copy(buffer_.begin() + start + part1_size,
-                buffer_.begin() + start + size, new_buffer.begin());
+      std::copy(buffer.begin() + start + part1_size,
+                buffer.begin() + start + size, new_buffer.begin());
     }
   } else {
     int32_t part1_size = capacity - start;
@@ -64,35 +97,35 @@ void CircularBuffer::Resize(int32_t new_capacity) {
 
     // copy [start, start+part1_size] to new_buffer
     if (dest + part1_size <= new_capacity) {
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + part1_size,
+      std::copy(buffer.begin() + start, buffer.begin() + start + part1_size,
                 new_buffer.begin() + dest);
     } else {
       int32_t first_part = new_capacity - dest;
-      std::copy(buffer_.begin() + start, buffer_.begin() + start + first_part,
+      std::copy(buffer.begin() + start, buffer.begin() + start + first_part,
                 new_buffer.begin() + dest);
 
-      std::copy(buffer_.begin() + start + first_part,
-                buffer_.begin() + start + part1_size, new_buffer.begin());
+      std::copy(buffer.begin() + start + first_part,
+                buffer.begin() + start + part1_size, new_buffer.begin());
     }
 
     int32_t new_dest = (dest + part1_size) % new_capacity;
 
     if (new_dest + part2_size <= new_capacity) {
-      std::copy(buffer_.begin(), buffer_.begin() + part2_size,
+      std::copy(buffer.begin(), buffer.begin() + part2_size,
                 new_buffer.begin() + new_dest);
     } else {
       int32_t first_part = new_capacity - new_dest;
-      std::copy(buffer_.begin(), buffer_.begin() + first_part,
+      std::copy(buffer.begin(), buffer.begin() + first_part,
                 new_buffer.begin() + new_dest);
-      std::copy(buffer_.begin() + first_part, buffer_.begin() + part2_size,
+      std::copy(buffer.begin() + first_part, buffer.begin() + part2_size,
                 new_buffer.begin());
     }
   }
-  buffer_.swap(new_buffer);
+  buffer_ = std::make_shared<std::vector<float>>(std::move(new_buffer));
 }
 
 void CircularBuffer::Push(const float *p, int32_t n) {
-  int32_t capacity = static_cast<int32_t>(buffer_.size());
+  int32_t capacity = static_cast<int32_t>(buffer_->size());
   int32_t size = Size();
   if (n + size > capacity) {
     int32_t new_capacity = std::max(capacity * 2, n + size);
@@ -113,61 +146,138 @@ void CircularBuffer::Push(const float *p, int32_t n) {
     capacity = new_capacity;
   }
 
+  DetachIfNeeded(n);
+
+  std::vector<float> &buffer = *buffer_;
+
   int32_t start = tail_ % capacity;
 
   tail_ += n;
 
   if (start + n < capacity) {
-    std::copy(p, p + n, buffer_.begin() + start);
+    std::copy(p, p + n, buffer.begin() + start);
     return;
   }
 
   int32_t part1_size = capacity - start;
 
-  std::copy(p, p + part1_size, buffer_.begin() + start);
+  std::copy(p, p + part1_size, buffer.begin() + start);
 
-  std::copy(p + part1_size, p + n, buffer_.begin());
+  std::copy(p + part1_size, p + n, buffer.begin());
 }
 
-std::vector<float> CircularBuffer::Get(int32_t start_index, int32_t n) const {
+void CircularBuffer::DetachIfNeeded(int32_t n) {
+  if (view_start_ == -1) {
+    return;
+  }
+
+  if (buffer_.use_count() == 1) {
+    // All views have been destroyed
+    view_start_ = -1;
+    return;
+  }
+
+  int32_t capacity = static_cast<int32_t>(buffer_->size());
+
+  // Elements [tail_, tail_ + n) are written to the positions of
+  // [tail_ - capacity, tail_ + n - capacity), which must not reach any view
+  if (tail_ + n <= view_start_ + capacity) {
+    return;
+  }
+
+  const std::vector<float> &old_buffer = *buffer_;
+  auto new_buffer = std::make_shared<std::vector<float>>(capacity);
+
+  // Keep the positions of the live elements unchanged
+  for (int32_t i = head_; i < tail_;) {
+    int32_t pos = i % capacity;
+    int32_t k = std::min(tail_ - i, capacity - pos);
+    std::copy(old_buffer.begin() + pos, old_buffer.begin() + pos + k,
+              new_buffer->begin() + pos);
+    i += k;
+  }
+
+  buffer_ = std::move(new_buffer);
+  view_start_ = -1;
+}
+
+bool CircularBuffer::IsValid(int32_t start_index, int32_t n) const {
   if (start_index < head_ || start_index >= tail_) {
     SHERPA_ONNX_LOGE("Invalid start_index: %d. head_: %d, tail_: %d",
                      start_index, head_, tail_);
-    return {};
+    return false;
   }
 
   int32_t size = Size();
   if (n < 0 || n > size) {
     SHERPA_ONNX_LOGE("Invalid n: %d. size: %d", n, size);
-    return {};
+    return false;
   }
 
-  int32_t capacity = static_cast<int32_t>(buffer_.size());
-
   if (start_index - head_ + n > size) {
     SHERPA_ONNX_LOGE("Invalid start_index: %d and n: %d. head_: %d, size: %d",
                      start_index, n, head_, size);
+    return false;
+  }
+
+  return true;
+}
+
+std::vector<float> CircularBuffer::Get(int32_t start_index, int32_t n) const {
+  if (!IsValid(start_index, n)) {
     return {};
   }
 
+  const std::vector<float> &buffer = *buffer_;
+  int32_t capacity = static_cast<int32_t>(buffer.size());
+
   int32_t start = start_index % capacity;
 
   if (start + n < capacity) {
-    return {buffer_.begin() + start, buffer_.begin() + start + n};
+    return {buffer.begin() + start, buffer.begin() + start + n};
   }
 
   std::vector<float> ans(n);
 
-  std::copy(buffer_.begin() + start, buffer_.end(), ans.begin());
+  std::copy(buffer.begin() + start, buffer.end(), ans.begin());
 
   int32_t part1_size = capacity - start;
   int32_t part2_size = n - part1_size;
-  std::copy(buffer_.begin(), buffer_.begin() + part2_size,
+  std::copy(buffer.begin(), buffer.begin() + part2_size,
             ans.begin() + part1_size);
 
   return ans;
 }
 
+CircularBufferView CircularBuffer::GetView(int32_t start_index, int32_t n) {
+  CircularBufferView ans;
+  if (!IsValid(start_index, n)) {
+    return ans;
+  }
+
+  const std::vector<float> &buffer = *buffer_;
+  int32_t capacity = static_cast<int32_t>(buffer.size());
+  int32_t start = start_index % capacity;
+
+  ans.data1 = buffer.data() + start;
+  ans.size1 = std::min(n, capacity - start);
+
+  if (ans.size1 < n) {
+    ans.data2 = buffer.data();
+    ans.size2 = n - ans.size1;
+  }
+
+  if (view_start_ == -1 || buffer_.use_count() == 1) {
+    view_start_ = start_index;
+  } else {
+    view_start_ = std::min(view_start_, start_index);
+  }
+
+  ans.storage = buffer_;
+
+  return ans;
+}
+
 void CircularBuffer::Pop(int32_t n) {
   int32_t size = Size();
   if (n < 0 || n > size) {
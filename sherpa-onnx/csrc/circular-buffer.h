@@ -5,10 +5,33 @@
 #define SHERPA_ONNX_CSRC_CIRCULAR_BUFFER_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace sherpa_onnx {
 
+// A read-only view of elements of a CircularBuffer without copying them.
+// The elements may wrap around the end of the underlying storage, so they
+// are given as two spans [data1, data1 + size1) and [data2, data2 + size2),
+// where size2 is 0 if they don't wrap around.
+//
+// The view shares the ownership of the storage, so it stays valid after
+// the elements are popped and even after the buffer is destroyed.
+struct CircularBufferView {
+  std::shared_ptr<const std::vector<float>> storage;
+
+  const float *data1 = nullptr;
+  int32_t size1 = 0;
+
+  const float *data2 = nullptr;
+  int32_t size2 = 0;
+
+  int32_t Size() const { return size1 + size2; }
+
+  // Copy the elements into a contiguous vector
+  std::vector<float> ToVector() const;
+};
+
 class CircularBuffer {
  public:
   // Capacity of this buffer. Should be large enough.
@@ -28,6 +51,13 @@ class CircularBuffer {
   // @return Return a vector of size n containing the requested elements
   std::vector<float> Get(int32_t start_index, int32_t n) const;
 
+  // Like Get() but it does not copy the elements.
+  //
+  // The buffer does not overwrite the elements of a view that is still
+  // alive. If a Push() would do so, the live elements are moved to a new
+  // storage first and the view keeps the old one.
+  CircularBufferView GetView(int32_t start_index, int32_t n);
+
   // Remove n elements from the buffer
   //
   // @param n Should be in the range [0, size_]
@@ -42,15 +72,23 @@ class CircularBuffer {
   // Current position of the tail
   int32_t Tail() const { return tail_; }
 
-  void Reset() {
-    head_ = 0;
-    tail_ = 0;
-  }
+  void Reset();
 
   void Resize(int32_t new_capacity);
 
  private:
-  std::vector<float> buffer_;
+  bool IsValid(int32_t start_index, int32_t n) const;
+
+  // Move the live elements to a new storage if pushing n elements would
+  // overwrite the elements of a view that is still alive
+  void DetachIfNeeded(int32_t n);
+
+ private:
+  std::shared_ptr<std::vector<float>> buffer_;
+
+  // Smallest start index of the views returned since the storage was
+  // last replaced. -1 if there are none.
+  int32_t view_start_ = -1;
 
   int32_t head_ = 0;  // linear index; always increasing; never wraps around
   int32_t tail_ = 0;  // linear index, always increasing; never wraps around.
@@ -0,0 +1,102 @@
+// sherpa-onnx/csrc/compact-tensors-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/compact-tensors.h"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(CompactTensors, Half) {
+  for (float f : {0.0f, 1.0f, -2.5f, 0.333251953125f, 65504.0f, 6.1035156e-05f,
+                  5.9604645e-08f}) {
+    EXPECT_EQ(HalfToFloat(FloatToHalf(f)), f) << f;
+  }
+
+  EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+  EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+
+  // round to the nearest even
+  EXPECT_EQ(FloatToHalf(1.0f + 1.0f / 2048), 0x3c00);
+  EXPECT_EQ(FloatToHalf(1.0f + 3.0f / 2048), 0x3c02);
+
+  EXPECT_EQ(FloatToHalf(1e6f), 0x7c00);
+  EXPECT_EQ(FloatToHalf(1e-9f), 0);
+  EXPECT_TRUE(std::isinf(HalfToFloat(FloatToHalf(
+      std::numeric_limits<float>::infinity()))));
+  EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(
+      std::numeric_limits<float>::quiet_NaN()))));
+
+  for (int32_t i = -1000; i != 1000; ++i) {
+    float f = std::sin(i * 0.1f) * 10;
+    EXPECT_NEAR(HalfToFloat(FloatToHalf(f)), f, std::abs(f) / 1024 + 1e-7);
+  }
+}
+
+static std::vector<Ort::Value> CreateTensors(std::vector<float> *f,
+                                             std::vector<int64_t> *i) {
+  auto memory_info =
+      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+  std::array<int64_t, 2> f_shape{2, static_cast<int64_t>(f->size()) / 2};
+  std::array<int64_t, 1> i_shape{static_cast<int64_t>(i->size())};
+
+  std::vector<Ort::Value> ans;
+  ans.push_back(Ort::Value::CreateTensor(memory_info, f->data(), f->size(),
+                                         f_shape.data(), f_shape.size()));
+  ans.push_back(Ort::Value::CreateTensor(memory_info, i->data(), i->size(),
+                                         i_shape.data(), i_shape.size()));
+  return ans;
+}
+
+static void Check(const CompactTensors &c, const std::vector<float> &f,
+                  const std::vector<int64_t> &i, float tol) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  auto tensors = c.GetAll(allocator);
+  ASSERT_EQ(tensors.size(), 2);
+
+  auto shape = tensors[0].GetTensorTypeAndShapeInfo().GetShape();
+  ASSERT_EQ(shape.size(), 2);
+  EXPECT_EQ(shape[0], 2);
+  EXPECT_EQ(shape[1], static_cast<int64_t>(f.size()) / 2);
+
+  const float *pf = tensors[0].GetTensorData<float>();
+  for (size_t k = 0; k != f.size(); ++k) {
+    EXPECT_NEAR(pf[k], f[k], tol);
+  }
+
+  const int64_t *pi = tensors[1].GetTensorData<int64_t>();
+  for (size_t k = 0; k != i.size(); ++k) {
+    EXPECT_EQ(pi[k], i[k]);
+  }
+}
+
+TEST(CompactTensors, RoundTrip) {
+  std::vector<float> f(100);
+  for (size_t k = 0; k != f.size(); ++k) {
+    f[k] = std::cos(k * 0.3f);
+  }
+  std::vector<int64_t> i = {1, -2, 1LL << 40};
+
+  auto tensors = CreateTensors(&f, &i);
+
+  CompactTensors c1(tensors, /*fp16*/ false);
+  EXPECT_EQ(c1.NumSpilledBytes(), 0);
+  Check(c1, f, i, 0);
+
+  CompactTensors c2(tensors, /*fp16*/ true);
+  EXPECT_LT(c2.NumBytes(), c1.NumBytes());
+  Check(c2, f, i, 1e-3);
+
+  CompactTensors c3(tensors, /*fp16*/ true, ".");
+  EXPECT_EQ(c3.NumBytes() + c3.NumSpilledBytes(), c2.NumBytes());
+  Check(c3, f, i, 1e-3);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,283 @@
+// sherpa-onnx/csrc/compact-tensors.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/compact-tensors.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+uint16_t FloatToHalf(float f) {
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t exp = (x >> 23) & 0xff;
+  uint32_t mant = x & 0x7fffff;
+
+  if (exp == 0xff) {
+    // inf or nan
+    return sign | 0x7c00 | (mant ? 0x200 : 0);
+  }
+
+  int32_t e = static_cast<int32_t>(exp) - 127 + 15;
+  if (e >= 0x1f) {
+    // overflow
+    return sign | 0x7c00;
+  }
+
+  if (e <= 0) {
+    // subnormal or zero in half precision
+    if (e < -10) {
+      return sign;
+    }
+
+    mant |= 0x800000;
+    int32_t shift = 14 - e;
+    uint32_t half = mant >> shift;
+    uint32_t rem = mant & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (half & 1))) {
+      ++half;
+    }
+    return sign | half;
+  }
+
+  uint32_t half = (static_cast<uint32_t>(e) << 10) | (mant >> 13);
+  uint32_t rem = mant & 0x1fff;
+
+  // A carry into the exponent is fine. It rounds up to the next power of 2
+  // or to inf.
+  if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) {
+    ++half;
+  }
+
+  return sign | half;
+}
+
+float HalfToFloat(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+
+  uint32_t x;
+  if (exp == 0x1f) {
+    x = sign | 0x7f800000 | (mant << 13);
+  } else if (exp == 0) {
+    float f = std::ldexp(static_cast<float>(mant), -24);
+    return sign ? -f : f;
+  } else {
+    x = sign | ((exp + 112) << 23) | (mant << 13);
+  }
+
+  float f;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+namespace {
+
+template <typename T>
+Ort::Value CopyToTensor(const char *p, const std::vector<int64_t> &shape,
+                        int64_t num_elements, OrtAllocator *allocator) {
+  Ort::Value ans =
+      Ort::Value::CreateTensor<T>(allocator, shape.data(), shape.size());
+  std::memcpy(ans.GetTensorMutableData<T>(), p, num_elements * sizeof(T));
+  return ans;
+}
+
+template <typename T>
+void CopyFromTensor(const Ort::Value &v, int64_t num_elements, char *p) {
+  std::memcpy(p, v.GetTensorData<T>(), num_elements * sizeof(T));
+}
+
+// Return a name that is unique among all processes that spill to the
+// same directory
+std::string SpillFilename(const std::string &dir) {
+  static const uint64_t kProcessTag =
+      (static_cast<uint64_t>(std::random_device{}()) << 32) |
+      std::random_device{}();
+  static std::atomic<uint64_t> counter{0};
+
+  std::ostringstream os;
+  os << dir << "/sherpa-onnx-states-" << std::hex << kProcessTag << "-"
+     << counter.fetch_add(1) << ".bin";
+  return os.str();
+}
+
+}  // namespace
+
+CompactTensors::CompactTensors(const std::vector<Ort::Value> &tensors,
+                               bool fp16,
+                               const std::string &spill_dir /*= ""*/) {
+  entries_.reserve(tensors.size());
+
+  size_t num_bytes = 0;
+  for (const auto &t : tensors) {
+    auto type_and_shape = t.GetTensorTypeAndShapeInfo();
+
+    Entry e;
+    e.type = type_and_shape.GetElementType();
+    e.shape = type_and_shape.GetShape();
+    e.num_elements = type_and_shape.GetElementCount();
+
+    size_t element_size = 0;
+    switch (e.type) {
+      case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+        e.fp16 = fp16;
+        element_size = fp16 ? sizeof(uint16_t) : sizeof(float);
+        break;
+      case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+        element_size = sizeof(int32_t);
+        break;
+      case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+        element_size = sizeof(int64_t);
+        break;
+      default:
+        SHERPA_ONNX_LOGE("Unsupported type: %d", static_cast<int32_t>(e.type));
+        SHERPA_ONNX_EXIT(-1);
+    }
+
+    // Keep each tensor 8-byte aligned
+    e.offset = (num_bytes + 7) / 8 * 8;
+    num_bytes = e.offset + e.num_elements * element_size;
+
+    entries_.push_back(std::move(e));
+  }
+
+  buf_.resize(num_bytes);
+
+  for (size_t i = 0; i != tensors.size(); ++i) {
+    const auto &e = entries_[i];
+    char *p = buf_.data() + e.offset;
+
+    switch (e.type) {
+      case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+        if (e.fp16) {
+          const float *src = tensors[i].GetTensorData<float>();
+          uint16_t *dst = reinterpret_cast<uint16_t *>(p);
+          for (int64_t k = 0; k != e.num_elements; ++k) {
+            dst[k] = FloatToHalf(src[k]);
+          }
+        } else {
+          CopyFromTensor<float>(tensors[i], e.num_elements, p);
+        }
+        break;
+      case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+        CopyFromTensor<int32_t>(tensors[i], e.num_elements, p);
+        break;
+      case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+        CopyFromTensor<int64_t>(tensors[i], e.num_elements, p);
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (spill_dir.empty() || buf_.empty()) {
+    return;
+  }
+
+  std::string filename = SpillFilename(spill_dir);
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os.write(buf_.data(), buf_.size());
+    if (!os) {
+      SHERPA_ONNX_LOGE("Failed to write '%s'. Keep the states in memory",
+                       filename.c_str());
+      os.close();
+      std::remove(filename.c_str());
+      return;
+    }
+  }
+
+  file_ = MappedFile::Open(filename, /*lazy*/ true);
+  if (!file_ || file_->Size() != buf_.size()) {
+    file_.reset();
+    std::remove(filename.c_str());
+    return;
+  }
+
+  std::vector<char>().swap(buf_);
+
+#if defined(_WIN32)
+  // A mapped file cannot be removed on Windows
+  filename_ = filename;
+#else
+  // The mapping keeps the content alive. The disk space is released
+  // once it is unmapped.
+  std::remove(filename.c_str());
+#endif
+}
+
+CompactTensors::~CompactTensors() {
+  file_.reset();
+
+  if (!filename_.empty()) {
+    std::remove(filename_.c_str());
+  }
+}
+
+Ort::Value CompactTensors::Get(int32_t i, OrtAllocator *allocator) const {
+  const auto &e = entries_[i];
+  const char *p = Data() + e.offset;
+
+  switch (e.type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT: {
+      if (!e.fp16) {
+        return CopyToTensor<float>(p, e.shape, e.num_elements, allocator);
+      }
+
+      Ort::Value ans = Ort::Value::CreateTensor<float>(
+          allocator, e.shape.data(), e.shape.size());
+      const uint16_t *src = reinterpret_cast<const uint16_t *>(p);
+      float *dst = ans.GetTensorMutableData<float>();
+      for (int64_t k = 0; k != e.num_elements; ++k) {
+        dst[k] = HalfToFloat(src[k]);
+      }
+      return ans;
+    }
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+      return CopyToTensor<int32_t>(p, e.shape, e.num_elements, allocator);
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+      return CopyToTensor<int64_t>(p, e.shape, e.num_elements, allocator);
+    default:
+      // unreachable code since the constructor checks the type
+      return Ort::Value{nullptr};
+  }
+}
+
+std::vector<Ort::Value> CompactTensors::GetAll(OrtAllocator *allocator) const {
+  std::vector<Ort::Value> ans;
+  ans.reserve(entries_.size());
+  for (int32_t i = 0; i != Size(); ++i) {
+    ans.push_back(Get(i, allocator));
+  }
+  return ans;
+}
+
+int64_t CompactTensors::NumBytes() const {
+  int64_t ans = buf_.size();
+  if (file_ && !file_->IsMapped()) {
+    ans += file_->Size();
+  }
+  return ans;
+}
+
+int64_t CompactTensors::NumSpilledBytes() const {
+  return (file_ && file_->IsMapped()) ? file_->Size() : 0;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,93 @@
+// sherpa-onnx/csrc/compact-tensors.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_COMPACT_TENSORS_H_
+#define SHERPA_ONNX_CSRC_COMPACT_TENSORS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/mapped-file.h"
+
+namespace sherpa_onnx {
+
+// Convert a float to IEEE 754 half precision, rounding to the nearest even
+uint16_t FloatToHalf(float f);
+
+float HalfToFloat(uint16_t h);
+
+/** A compact copy of a list of tensors.
+ *
+ * It is used to shrink the model states of streams that are idle, e.g.,
+ * the encoder caches of a streaming zipformer. Float tensors can be stored
+ * in half precision, which halves their size at the cost of a small loss
+ * of precision. The content can also be spilled to a file that is
+ * memory-mapped, so that it lives in the page cache, which the kernel can
+ * write back and evict, instead of in the heap.
+ *
+ * Supported element types are float, int32 and int64.
+ */
+class CompactTensors {
+ public:
+  /**
+   * @param tensors  Tensors on CPU. They are not modified.
+   * @param fp16  True to store float tensors in half precision.
+   * @param spill_dir  If not empty, the content is written to a file in
+   *                   this directory. If it fails, the content is kept
+   *                   in memory.
+   */
+  CompactTensors(const std::vector<Ort::Value> &tensors, bool fp16,
+                 const std::string &spill_dir = "");
+
+  ~CompactTensors();
+
+  CompactTensors(const CompactTensors &) = delete;
+  CompactTensors &operator=(const CompactTensors &) = delete;
+
+  int32_t Size() const { return static_cast<int32_t>(entries_.size()); }
+
+  // Return a copy of the i-th tensor allocated by the given allocator
+  Ort::Value Get(int32_t i, OrtAllocator *allocator) const;
+
+  // Return copies of all tensors
+  std::vector<Ort::Value> GetAll(OrtAllocator *allocator) const;
+
+  // Number of bytes kept in the heap
+  int64_t NumBytes() const;
+
+  // Number of bytes spilled to a file
+  int64_t NumSpilledBytes() const;
+
+ private:
+  struct Entry {
+    ONNXTensorElementDataType type;
+    std::vector<int64_t> shape;
+    int64_t num_elements = 0;
+
+    // True if a float tensor is stored in half precision
+    bool fp16 = false;
+
+    // Start of the content in Data()
+    size_t offset = 0;
+  };
+
+  const char *Data() const { return file_ ? file_->Data() : buf_.data(); }
+
+ private:
+  std::vector<Entry> entries_;
+  std::vector<char> buf_;
+
+  std::unique_ptr<MappedFile> file_;
+
+  // The spilled file. It is removed in the destructor if it is not empty.
+  std::string filename_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_COMPACT_TENSORS_H_
@@ -7,6 +7,7 @@
 #include <chrono>  // NOLINT
 #include <cmath>
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
@@ -74,6 +75,183 @@ TEST(ContextGraph, TestCustomizeNonStrict) {
   TestHelper(queries, 5, false);
 }
 
+static float ScoreQuery(const ContextGraph &graph, const std::string &query,
+                        bool strict_mode) {
+  float total_scores = 0;
+  auto state = graph.Root();
+  for (auto q : query) {
+    auto res = graph.ForwardOneStep(state, q, strict_mode);
+    total_scores += std::get<0>(res);
+    state = std::get<1>(res);
+  }
+  auto res = graph.Finalize(state);
+  EXPECT_EQ(res.second->token, -1);
+  EXPECT_EQ(res.second, graph.Root());
+  return total_scores + res.first;
+}
+
+TEST(ContextGraph, TestOverlay) {
+  auto to_ids = [](const std::vector<std::string> &contexts_str) {
+    std::vector<std::vector<int32_t>> ans;
+    for (const auto &s : contexts_str) {
+      ans.emplace_back(s.begin(), s.end());
+    }
+    return ans;
+  };
+
+  // Phrases sharing a prefix have different scores in the two graphs
+  auto base_ids = to_ids({"S", "HE", "SHE", "SHELL", "HIS", "AB"});
+  std::vector<float> base_scores = {1.5, 2, 0.5, 1, 3, 2};
+
+  auto overlay_ids = to_ids({"HERS", "HELLO", "THIS", "THEM", "ABC", "SH"});
+  std::vector<float> overlay_scores = {0.5, 2.5, 1, 1.5, 1, 4};
+
+  auto all_ids = base_ids;
+  all_ids.insert(all_ids.end(), overlay_ids.begin(), overlay_ids.end());
+  auto all_scores = base_scores;
+  all_scores.insert(all_scores.end(), overlay_scores.begin(),
+                    overlay_scores.end());
+
+  ContextGraph graph(all_ids, 1, 0.0f, all_scores);
+
+  auto base = std::make_shared<ContextGraph>(base_ids, 1, 0.0f, base_scores);
+  ContextGraph overlay(base, overlay_ids, 1, 0.0f, overlay_scores);
+  EXPECT_EQ(overlay.Root()->token, -1);
+
+  std::vector<std::string> queries = {
+      "HEHERSHE", "HERSHE", "HISHE", "SHED", "SHELF", "HELL",
+      "HELLO",    "DHRHISQ", "THEN", "ABC", "XABCAB", "SHELLS"};
+  for (bool strict_mode : {true, false}) {
+    for (const auto &q : queries) {
+      EXPECT_EQ(ScoreQuery(overlay, q, strict_mode),
+                ScoreQuery(graph, q, strict_mode))
+          << q << " " << strict_mode;
+    }
+  }
+
+  // The prefix AB of ABC gets the larger score of AB from the base graph
+  auto state = overlay.Root();
+  for (auto q : std::string("ABC")) {
+    state = std::get<1>(overlay.ForwardOneStep(state, q));
+  }
+  EXPECT_EQ(state->node_score, 2 + 2 + 1);
+
+  // Phrases from both graphs are matched
+  state = overlay.Root();
+  for (auto q : std::string("THEM")) {
+    state = std::get<1>(overlay.ForwardOneStep(state, q));
+  }
+  auto matched = overlay.IsMatched(state);
+  EXPECT_TRUE(matched.first);
+  EXPECT_EQ(matched.second->level, 4);
+
+  state = overlay.Root();
+  for (auto q : std::string("XSHE")) {
+    state = std::get<1>(overlay.ForwardOneStep(state, q));
+  }
+  matched = overlay.IsMatched(state);
+  EXPECT_TRUE(matched.first);
+  EXPECT_EQ(matched.second->level, 3);
+}
+
+TEST(ContextGraph, TestOverlayStates) {
+  auto to_ids = [](const std::vector<std::string> &phrases) {
+    std::vector<std::vector<int32_t>> ids;
+    for (const auto &p : phrases) {
+      ids.emplace_back(p.begin(), p.end());
+    }
+    return ids;
+  };
+
+  auto base = std::make_shared<ContextGraph>(
+      to_ids({"SHE", "HIS", "HERS", "ABCD"}), 1, 0.0f);
+
+  // Tokens not in the base graph. Only the states of XYZ are created
+  ContextGraph overlay(base, to_ids({"XYZ"}), 1, 0.0f);
+  EXPECT_EQ(overlay.NumUnionStates(), 3);
+  EXPECT_EQ(overlay.Root(), base->Root());
+
+  // States of the base graph are used as they are
+  auto state = overlay.Root();
+  for (auto q : std::string("SH")) {
+    state = std::get<1>(overlay.ForwardOneStep(state, q));
+  }
+  auto base_state = base->Root();
+  for (auto q : std::string("SH")) {
+    base_state = std::get<1>(base->ForwardOneStep(base_state, q));
+  }
+  EXPECT_EQ(state, base_state);
+
+  // ABZ has larger token scores, so the states of the base graph with the
+  // prefix A are changed: A, AB, ABC and ABCD. The other one is ABZ
+  ContextGraph overlay2(base, to_ids({"ABZ"}), 2, 0.0f);
+  EXPECT_EQ(overlay2.NumUnionStates(), 5);
+}
+
+TEST(ContextGraph, TestOverlayRandom) {
+  std::mt19937 mt(20250101);
+  std::uniform_int_distribution<int32_t> char_dist(0, 5);
+  std::uniform_int_distribution<int32_t> len_dist(1, 6);
+  std::uniform_int_distribution<int32_t> score_dist(1, 8);
+  auto random_scores = [&](int32_t n) {
+    std::vector<float> ans(n);
+    for (auto &s : ans) {
+      s = 0.5f * score_dist(mt);
+    }
+    return ans;
+  };
+  auto random_ids = [&](int32_t n) {
+    std::vector<std::vector<int32_t>> ans(n);
+    for (auto &ids : ans) {
+      int32_t len = len_dist(mt);
+      for (int32_t i = 0; i < len; ++i) {
+        ids.push_back(char_dist(mt));
+      }
+    }
+    return ans;
+  };
+
+  auto base_ids = random_ids(200);
+  auto base_scores = random_scores(200);
+  auto overlay_ids = random_ids(20);
+  auto overlay_scores = random_scores(20);
+
+  auto all_ids = base_ids;
+  all_ids.insert(all_ids.end(), overlay_ids.begin(), overlay_ids.end());
+  auto all_scores = base_scores;
+  all_scores.insert(all_scores.end(), overlay_scores.begin(),
+                    overlay_scores.end());
+
+  ContextGraph graph(all_ids, 1, 0.0f, all_scores);
+  auto base = std::make_shared<ContextGraph>(base_ids, 1, 0.0f, base_scores);
+  ContextGraph overlay(base, overlay_ids, 1, 0.0f, overlay_scores);
+
+  for (int32_t n = 0; n < 100; ++n) {
+    auto a = graph.Root();
+    auto b = overlay.Root();
+    for (int32_t i = 0; i < 30; ++i) {
+      int32_t token = char_dist(mt);
+      auto res_a = graph.ForwardOneStep(a, token);
+      auto res_b = overlay.ForwardOneStep(b, token);
+      a = std::get<1>(res_a);
+      b = std::get<1>(res_b);
+
+      EXPECT_EQ(std::get<0>(res_a), std::get<0>(res_b));
+      EXPECT_EQ(a->level, b->level);
+      EXPECT_EQ(a->node_score, b->node_score);
+      EXPECT_EQ(a->output_score, b->output_score);
+
+      auto matched_a = graph.IsMatched(a);
+      auto matched_b = overlay.IsMatched(b);
+      EXPECT_EQ(matched_a.first, matched_b.first);
+      if (matched_a.first) {
+        EXPECT_EQ(matched_a.second->level, matched_b.second->level);
+        EXPECT_EQ(matched_a.second->node_score, matched_b.second->node_score);
+      }
+    }
+  }
+}
+
 TEST(ContextGraph, Benchmark) {
   std::random_device rd;
   std::mt19937 mt(rd());
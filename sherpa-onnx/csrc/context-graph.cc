@@ -6,10 +6,14 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <memory>
 #include <queue>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
 
@@ -17,7 +21,7 @@ namespace sherpa_onnx {
 void ContextGraph::Build(const std::vector<std::vector<int32_t>> &token_ids,
                          const std::vector<float> &scores,
                          const std::vector<std::string> &phrases,
-                         const std::vector<float> &ac_thresholds) const {
+                         const std::vector<float> &ac_thresholds) {
   if (!scores.empty()) {
     SHERPA_ONNX_CHECK_EQ(token_ids.size(), scores.size());
   }
@@ -27,8 +31,25 @@ void ContextGraph::Build(const std::vector<std::vector<int32_t>> &token_ids,
   if (!ac_thresholds.empty()) {
     SHERPA_ONNX_CHECK_EQ(token_ids.size(), ac_thresholds.size());
   }
+
+  size_t num_tokens = 0;
+  for (const auto &ids : token_ids) {
+    num_tokens += ids.size();
+  }
+
+  states_.clear();
+  states_.reserve(num_tokens + 1);
+  states_.emplace_back(-1, 0, 0, 0);  // root
+
+  // (parent state << 32 | token) -> child state. Used only while building
+  std::unordered_map<uint64_t, int32_t> edges;
+  edges.reserve(num_tokens);
+  auto key = [](int32_t state, int32_t token) {
+    return (static_cast<uint64_t>(state) << 32) | static_cast<uint32_t>(token);
+  };
+
   for (int32_t i = 0; i < static_cast<int32_t>(token_ids.size()); ++i) {
-    auto node = root_.get();
+    int32_t node = 0;
     float score = scores.empty() ? 0.0f : scores[i];
     score = score == 0.0f ? context_score_ : score;
     float ac_threshold = ac_thresholds.empty() ? 0.0f : ac_thresholds[i];
@@ -37,50 +58,308 @@ void ContextGraph::Build(const std::vector<std::vector<int32_t>> &token_ids,
 
     for (int32_t j = 0; j < static_cast<int32_t>(token_ids[i].size()); ++j) {
       int32_t token = token_ids[i][j];
-      if (0 == node->next.count(token)) {
-        bool is_end = j == (static_cast<int32_t>(token_ids[i].size()) - 1);
-        node->next[token] = std::make_unique<ContextState>(
-            token, score, node->node_score + score,
-            is_end ? node->node_score + score : 0, j + 1,
-            is_end ? ac_threshold : 0.0f, is_end,
-            is_end ? phrase : std::string());
+      bool is_last = j == (static_cast<int32_t>(token_ids[i].size()) - 1);
+
+      // node_score and output_score are filled in FillFailOutput() once the
+      // token scores of all phrases are known
+      auto it = edges.find(key(node, token));
+      if (it == edges.end()) {
+        int32_t next = static_cast<int32_t>(states_.size());
+        edges.emplace(key(node, token), next);
+        states_.emplace_back(token, score, 0, 0, j + 1,
+                             is_last ? ac_threshold : 0.0f, is_last,
+                             is_last ? phrase : std::string());
+        node = next;
       } else {
-        float token_score = std::max(score, node->next[token]->token_score);
-        node->next[token]->token_score = token_score;
-        float node_score = node->node_score + token_score;
-        node->next[token]->node_score = node_score;
-        bool is_end = (j == static_cast<int32_t>(token_ids[i].size()) - 1) ||
-                      node->next[token]->is_end;
-        node->next[token]->output_score = is_end ? node_score : 0.0f;
-        node->next[token]->is_end = is_end;
-        if (j == static_cast<int32_t>(token_ids[i].size()) - 1) {
-          node->next[token]->phrase = phrase;
-          node->next[token]->ac_threshold = ac_threshold;
+        node = it->second;
+        ContextState &s = states_[node];
+        s.token_score = std::max(score, s.token_score);
+        s.is_end = is_last || s.is_end;
+        if (is_last) {
+          s.phrase = phrase;
+          s.ac_threshold = ac_threshold;
         }
       }
-      node = node->next[token].get();
     }
   }
+
+  // Store the arcs of each state contiguously, sorted by token
+  arcs_.clear();
+  arcs_.reserve(edges.size());
+  std::vector<std::pair<uint64_t, int32_t>> sorted(edges.begin(), edges.end());
+  edges.clear();
+  std::sort(sorted.begin(), sorted.end());
+
+  for (const auto &e : sorted) {
+    int32_t parent = static_cast<int32_t>(e.first >> 32);
+    int32_t token = static_cast<int32_t>(e.first & 0xffffffff);
+    ContextState &s = states_[parent];
+    if (s.arc_begin == s.arc_end) {
+      s.arc_begin = static_cast<int32_t>(arcs_.size());
+    }
+    arcs_.push_back({token, e.second});
+    s.arc_end = static_cast<int32_t>(arcs_.size());
+    states_[e.second].parent = &s;
+  }
+
+  states_[0].fail = states_.data();
   FillFailOutput();
 }
 
+ContextGraph::ContextGraph(ContextGraphPtr base,
+                           const std::vector<std::vector<int32_t>> &token_ids,
+                           float context_score, float ac_threshold,
+                           const std::vector<float> &scores /*= {}*/,
+                           const std::vector<std::string> &phrases /*= {}*/,
+                           const std::vector<float> &ac_thresholds /*= {}*/)
+    : ContextGraph(token_ids, context_score, ac_threshold, scores, phrases,
+                   ac_thresholds) {
+  SHERPA_ONNX_CHECK(base != nullptr);
+  SHERPA_ONNX_CHECK(base->base_ == nullptr);
+
+  base_ = std::move(base);
+
+  // The root is not changed by the overlay
+  union_root_ = base_->Root();
+  BuildUnionStates();
+}
+
+void ContextGraph::BuildUnionStates() {
+  const ContextGraph &base = *base_;
+  const ContextState *base_root = base.states_.data();
+  const ContextState *overlay_root = states_.data();
+
+  // Components of the states of the combined graph, in the order of levels
+  std::vector<StatePair> pairs;
+
+  // Visit the states of base_ in breadth-first order. For state i:
+  //  - suffix[i] is its longest suffix in the trie of this graph
+  //  - prefix[i] is the state of this graph with the same tokens, or nullptr
+  //  - raised[i] is true if a state on the path from the root has a larger
+  //    token score in this graph, which changes node_score of state i
+  //  - changed[i] is true if the overlay changes state i. Its output
+  //    state is shorter, so it is visited before
+  int32_t num_base_states = base.NumStates();
+  std::vector<const ContextState *> suffix(num_base_states, overlay_root);
+  std::vector<const ContextState *> prefix(num_base_states, nullptr);
+  std::vector<char> raised(num_base_states, 0);
+  std::vector<char> changed(num_base_states, 0);
+  prefix[0] = overlay_root;
+
+  std::queue<int32_t> node_queue;
+  node_queue.push(0);
+  while (!node_queue.empty()) {
+    int32_t i = node_queue.front();
+    node_queue.pop();
+
+    const ContextState &current_node = base.states_[i];
+    for (int32_t k = current_node.arc_begin; k != current_node.arc_end; ++k) {
+      int32_t token = base.arcs_[k].token;
+      int32_t c = base.arcs_[k].state;
+      const ContextState &next = base.states_[c];
+
+      suffix[c] = Transit(suffix[i], token);
+      prefix[c] = prefix[i] ? Child(prefix[i], token) : nullptr;
+      raised[c] = raised[i] ||
+                  (prefix[c] && prefix[c]->token_score > next.token_score);
+      changed[c] = suffix[c] != overlay_root || raised[c] ||
+                   (next.output && changed[next.output - base_root]);
+      if (changed[c]) {
+        pairs.emplace_back(&next, suffix[c]);
+      }
+
+      node_queue.push(c);
+    }
+  }
+
+  // States of this graph that are not in base_. The others are visited above
+  std::vector<const ContextState *> base_suffix(states_.size(), base_root);
+  node_queue.push(0);
+  while (!node_queue.empty()) {
+    int32_t i = node_queue.front();
+    node_queue.pop();
+
+    const ContextState &current_node = states_[i];
+    for (int32_t k = current_node.arc_begin; k != current_node.arc_end; ++k) {
+      int32_t c = arcs_[k].state;
+      base_suffix[c] = base.Transit(base_suffix[i], arcs_[k].token);
+      if (base_suffix[c]->level < states_[c].level) {
+        pairs.emplace_back(base_suffix[c], &states_[c]);
+      }
+
+      node_queue.push(c);
+    }
+  }
+
+  // Output states of a state are shorter, so they are created before it
+  auto level = [](const StatePair &p) {
+    return std::max(p.first->level, p.second->level);
+  };
+  std::stable_sort(pairs.begin(), pairs.end(),
+                   [&level](const StatePair &a, const StatePair &b) {
+                     return level(a) < level(b);
+                   });
+
+  union_states_.resize(pairs.size());
+  union_index_.reserve(pairs.size());
+  for (size_t i = 0; i != pairs.size(); ++i) {
+    InitUnionState(pairs[i].first, pairs[i].second, &union_states_[i]);
+    union_index_.emplace(pairs[i], &union_states_[i]);
+  }
+}
+
+const ContextState *ContextGraph::Child(const ContextState *state,
+                                        int32_t token) const {
+  auto begin = arcs_.begin() + state->arc_begin;
+  auto end = arcs_.begin() + state->arc_end;
+  auto it = std::lower_bound(
+      begin, end, token,
+      [](const Arc &arc, int32_t token) { return arc.token < token; });
+
+  if (it == end || it->token != token) {
+    return nullptr;
+  }
+
+  return &states_[it->state];
+}
+
+const ContextState *ContextGraph::Transit(const ContextState *state,
+                                          int32_t token) const {
+  if (const ContextState *child = Child(state, token)) {
+    return child;
+  }
+
+  const ContextState *node = state->fail;
+  while (!Child(node, token)) {
+    node = node->fail;
+    if (-1 == node->token) break;  // root
+  }
+
+  if (const ContextState *child = Child(node, token)) {
+    node = child;
+  }
+
+  return node;
+}
+
+float ContextGraph::UnionNodeScore(const ContextState *state,
+                                   const ContextGraph &other) const {
+  std::vector<const ContextState *> path;
+  for (const ContextState *p = state; p->parent; p = p->parent) {
+    path.push_back(p);
+  }
+
+  // Walk the same tokens in the trie of other as far as it goes
+  float score = 0;
+  const ContextState *node = other.states_.data();
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    float token_score = (*it)->token_score;
+    node = node ? other.Child(node, (*it)->token) : nullptr;
+    if (node) {
+      token_score = std::max(token_score, node->token_score);
+    }
+    score += token_score;
+  }
+
+  return score;
+}
+
+const ContextState *ContextGraph::GetUnionState(
+    const ContextState *base_state, const ContextState *overlay_state) const {
+  auto it = union_index_.find({base_state, overlay_state});
+  if (it != union_index_.end()) {
+    return it->second;
+  }
+
+  // BuildUnionStates() creates all states with a non-root overlay_state
+  assert(overlay_state == states_.data());
+  return base_state;
+}
+
+void ContextGraph::InitUnionState(const ContextState *base_state,
+                                  const ContextState *overlay_state,
+                                  UnionState *s) const {
+  s->base_state = base_state;
+  s->overlay_state = overlay_state;
+
+  // The combined trie contains the longer of the two matched suffixes
+  const ContextState *a = base_state;
+  const ContextState *b = overlay_state;
+  const ContextState *deeper = a->level >= b->level ? a : b;
+
+  s->token = deeper->token;
+  s->token_score = a->level == b->level
+                       ? std::max(a->token_score, b->token_score)
+                       : deeper->token_score;
+  s->level = deeper->level;
+  s->node_score = UnionNodeScore(deeper, deeper == a ? *this : *base_);
+
+  // A phrase of the base graph wins if both graphs contain it
+  const ContextState *end = nullptr;
+  if (b->level == s->level && b->is_end) end = b;
+  if (a->level == s->level && a->is_end) end = a;
+
+  s->is_end = end != nullptr;
+  if (end) {
+    s->phrase = end->phrase;
+    s->ac_threshold = end->ac_threshold;
+  }
+
+  // The output arc points to the longest phrase that is a proper suffix
+  const ContextState *output = nullptr;
+  for (const ContextState *x : {a, b}) {
+    const ContextState *candidate =
+        (x->level < s->level && x->is_end) ? x : x->output;
+    if (candidate && (!output || candidate->level > output->level)) {
+      output = candidate;
+    }
+  }
+
+  if (output) {
+    // Use the state of the combined graph for the phrase so that its
+    // scores include the tokens of both graphs. Its components are the
+    // longest suffixes of the phrase in each trie, found on the fail
+    // chains of a and b
+    auto shrink = [level = output->level](const ContextState *x) {
+      while (x->level > level) {
+        x = x->fail;
+      }
+      return x;
+    };
+    s->output = GetUnionState(shrink(a), shrink(b));
+  }
+
+  s->output_score = (s->is_end ? s->node_score : 0) +
+                    (s->output ? s->output->output_score : 0);
+
+  // Not used. Union states are advanced through their components
+  s->fail = union_root_;
+}
+
 std::tuple<float, const ContextState *, const ContextState *>
 ContextGraph::ForwardOneStep(const ContextState *state, int32_t token,
                              bool strict_mode /*= true*/) const {
   const ContextState *node = nullptr;
   float score = 0;
-  if (1 == state->next.count(token)) {
-    node = state->next.at(token).get();
+  if (base_) {
+    // A state of base_ is a state of the combined graph with the root of
+    // this graph as the overlay component
+    const ContextState *base_state = state;
+    const ContextState *overlay_state = states_.data();
+    if (!base_->Contains(state)) {
+      auto u = static_cast<const UnionState *>(state);
+      base_state = u->base_state;
+      overlay_state = u->overlay_state;
+    }
+
+    node = GetUnionState(base_->Transit(base_state, token),
+                         Transit(overlay_state, token));
+    score = node->node_score - state->node_score;
+  } else if (const ContextState *child = Child(state, token)) {
+    node = child;
     score = node->token_score;
   } else {
-    node = state->fail;
-    while (0 == node->next.count(token)) {
-      node = node->fail;
-      if (-1 == node->token) break;  // root
-    }
-    if (1 == node->next.count(token)) {
-      node = node->next.at(token).get();
-    }
+    node = Transit(state, token);
     score = node->node_score - state->node_score;
   }
 
@@ -98,7 +377,7 @@ ContextGraph::ForwardOneStep(const ContextState *state, int32_t token,
         node->is_end ? node->node_score
                      : (node->output != nullptr ? node->output->node_score
                                                 : node->node_score);
-    return std::make_tuple(score + output_score - node->node_score, root_.get(),
+    return std::make_tuple(score + output_score - node->node_score, Root(),
                            matched_node);
   }
   return std::make_tuple(score + node->output_score, node, matched_node);
@@ -107,7 +386,7 @@ ContextGraph::ForwardOneStep(const ContextState *state, int32_t token,
 std::pair<float, const ContextState *> ContextGraph::Finalize(
     const ContextState *state) const {
   float score = -state->node_score;
-  return std::make_pair(score, root_.get());
+  return std::make_pair(score, Root());
 }
 
 std::pair<bool, const ContextState *> ContextGraph::IsMatched(
@@ -126,29 +405,42 @@ std::pair<bool, const ContextState *> ContextGraph::IsMatched(
   return std::make_pair(status, node);
 }
 
-void ContextGraph::FillFailOutput() const {
-  std::queue<const ContextState *> node_queue;
-  for (auto &kv : root_->next) {
-    kv.second->fail = root_.get();
-    node_queue.push(kv.second.get());
+void ContextGraph::FillFailOutput() {
+  // States are visited in breadth-first order so that the fail and output
+  // arcs of shorter states are ready when they are used
+  std::queue<int32_t> node_queue;
+  const ContextState *root = states_.data();
+  for (int32_t k = root->arc_begin; k != root->arc_end; ++k) {
+    ContextState &s = states_[arcs_[k].state];
+    s.fail = root;
+    s.node_score = s.token_score;
+    s.output_score = s.is_end ? s.node_score : 0;
+    node_queue.push(arcs_[k].state);
   }
   while (!node_queue.empty()) {
-    auto current_node = node_queue.front();
+    const ContextState &current_node = states_[node_queue.front()];
     node_queue.pop();
-    for (auto &kv : current_node->next) {
-      auto fail = current_node->fail;
-      if (1 == fail->next.count(kv.first)) {
-        fail = fail->next.at(kv.first).get();
+    for (int32_t k = current_node.arc_begin; k != current_node.arc_end; ++k) {
+      int32_t token = arcs_[k].token;
+      ContextState &next = states_[arcs_[k].state];
+
+      // The score of a state is the sum of the largest token scores of the
+      // phrases sharing its prefix, independent of the order of the phrases
+      next.node_score = current_node.node_score + next.token_score;
+      next.output_score = next.is_end ? next.node_score : 0;
+
+      const ContextState *fail = current_node.fail;
+      if (const ContextState *child = Child(fail, token)) {
+        fail = child;
       } else {
         fail = fail->fail;
-        while (0 == fail->next.count(kv.first)) {
+        while (!Child(fail, token)) {
           fail = fail->fail;
           if (-1 == fail->token) break;
         }
-        if (1 == fail->next.count(kv.first))
-          fail = fail->next.at(kv.first).get();
+        if (const ContextState *child = Child(fail, token)) fail = child;
       }
-      kv.second->fail = fail;
+      next.fail = fail;
       // fill the output arc
       auto output = fail;
       while (!output->is_end) {
@@ -158,9 +450,9 @@ void ContextGraph::FillFailOutput() const {
           break;
         }
       }
-      kv.second->output = output;
-      kv.second->output_score += output == nullptr ? 0 : output->output_score;
-      node_queue.push(kv.second.get());
+      next.output = output;
+      next.output_score += output == nullptr ? 0 : output->output_score;
+      node_queue.push(arcs_[k].state);
     }
   }
 }
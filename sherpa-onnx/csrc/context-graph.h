@@ -5,6 +5,8 @@
 #ifndef SHERPA_ONNX_CSRC_CONTEXT_GRAPH_H_
 #define SHERPA_ONNX_CSRC_CONTEXT_GRAPH_H_
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -28,7 +30,11 @@ struct ContextState {
   float ac_threshold;
   bool is_end;
   std::string phrase;
-  std::unordered_map<int32_t, std::unique_ptr<ContextState>> next;
+  // Outgoing arcs are [arc_begin, arc_end) in the arc array of the
+  // graph, sorted by token
+  int32_t arc_begin = 0;
+  int32_t arc_end = 0;
+  const ContextState *parent = nullptr;
   const ContextState *fail = nullptr;
   const ContextState *output = nullptr;
 
@@ -55,8 +61,6 @@ class ContextGraph {
                const std::vector<std::string> &phrases = {},
                const std::vector<float> &ac_thresholds = {})
       : context_score_(context_score), ac_threshold_(ac_threshold) {
-    root_ = std::make_unique<ContextState>(-1, 0, 0, 0);
-    root_->fail = root_.get();
     Build(token_ids, scores, phrases, ac_thresholds);
   }
 
@@ -65,6 +69,28 @@ class ContextGraph {
       : ContextGraph(token_ids, context_score, 0.0f, scores,
                      std::vector<std::string>(), std::vector<float>()) {}
 
+  // States point to each other, so a graph cannot be copied
+  ContextGraph(const ContextGraph &) = delete;
+  ContextGraph &operator=(const ContextGraph &) = delete;
+
+  /** Create a graph for token_ids layered on top of base, e.g., the
+   * hotwords or keywords of a stream on top of the default ones shared by
+   * all streams. base is not modified and can be shared by many overlays.
+   *
+   * It behaves like a graph built from the phrases of both, but only the
+   * trie of token_ids is built here. Most states of the combined graph are
+   * the states of base. Only the states that differ, e.g., states ending
+   * with tokens of token_ids, are created here, so memory is proportional
+   * to them. Nothing is created while decoding and the overlay can be
+   * shared by streams without locking.
+   */
+  ContextGraph(ContextGraphPtr base,
+               const std::vector<std::vector<int32_t>> &token_ids,
+               float context_score, float ac_threshold,
+               const std::vector<float> &scores = {},
+               const std::vector<std::string> &phrases = {},
+               const std::vector<float> &ac_thresholds = {});
+
   std::tuple<float, const ContextState *, const ContextState *> ForwardOneStep(
       const ContextState *state, int32_t token_id,
       bool strict_mode = true) const;
@@ -75,17 +101,95 @@ class ContextGraph {
   std::pair<float, const ContextState *> Finalize(
       const ContextState *state) const;
 
-  const ContextState *Root() const { return root_.get(); }
+  const ContextState *Root() const {
+    return base_ ? union_root_ : states_.data();
+  }
+
+  // Number of states of the trie, excluding states of the base graph
+  int32_t NumStates() const { return static_cast<int32_t>(states_.size()); }
+
+  // Number of states of the combined graph that an overlay creates, i.e.,
+  // states that differ from those of the base graph
+  int32_t NumUnionStates() const {
+    return static_cast<int32_t>(union_states_.size());
+  }
 
  private:
+  struct Arc {
+    int32_t token;
+    int32_t state;  // index into states_
+  };
+
+  // A state of an overlay graph. It pairs the current states of the base
+  // graph and of the trie of the overlay
+  struct UnionState : public ContextState {
+    const ContextState *base_state = nullptr;
+    const ContextState *overlay_state = nullptr;
+  };
+
+  using StatePair = std::pair<const ContextState *, const ContextState *>;
+
+  struct StatePairHash {
+    size_t operator()(const StatePair &p) const {
+      return std::hash<const ContextState *>()(p.first) * 31 +
+             std::hash<const ContextState *>()(p.second);
+    }
+  };
+
+  // Return nullptr if state has no outgoing arc with token
+  const ContextState *Child(const ContextState *state, int32_t token) const;
+
+  // Follow the goto and fail arcs of the trie from state with token
+  const ContextState *Transit(const ContextState *state, int32_t token) const;
+
+  // Return true if state is in the trie of this graph
+  bool Contains(const ContextState *state) const {
+    std::less<const ContextState *> less;
+    return !less(state, states_.data()) &&
+           less(state, states_.data() + states_.size());
+  }
+
+  // Return the state of the combined graph with the given components. It is
+  // base_state itself if the overlay does not change it
+  const ContextState *GetUnionState(const ContextState *base_state,
+                                    const ContextState *overlay_state) const;
+
+  // Create the states of the combined graph that differ from the states
+  // of base_
+  void BuildUnionStates();
+
+  // Fill the fields of s from its components. The union states of shorter
+  // suffixes must exist already
+  void InitUnionState(const ContextState *base_state,
+                      const ContextState *overlay_state, UnionState *s) const;
+
+  // node_score of the state of the combined graph for the path from the
+  // root to state. state is in the trie of this graph and other is base_,
+  // or the other way round
+  float UnionNodeScore(const ContextState *state,
+                       const ContextGraph &other) const;
+
   float context_score_;
   float ac_threshold_;
-  std::unique_ptr<ContextState> root_;
+
+  // The trie is stored in flat arrays and not modified after Build().
+  // states_[0] is the root. fail and output of a state point into states_.
+  std::vector<ContextState> states_;
+  std::vector<Arc> arcs_;
+
+  // Used only by overlay graphs. union_states_ is not modified after the
+  // constructor
+  ContextGraphPtr base_;
+  const ContextState *union_root_ = nullptr;
+  std::vector<UnionState> union_states_;
+  std::unordered_map<StatePair, const UnionState *, StatePairHash>
+      union_index_;
+
   void Build(const std::vector<std::vector<int32_t>> &token_ids,
              const std::vector<float> &scores,
              const std::vector<std::string> &phrases,
-             const std::vector<float> &ac_thresholds) const;
-  void FillFailOutput() const;
+             const std::vector<float> &ac_thresholds);
+  void FillFailOutput();
 };
 
 }  // namespace sherpa_onnx
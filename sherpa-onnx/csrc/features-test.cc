@@ -0,0 +1,161 @@
+// sherpa-onnx/csrc/features-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/features.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/binary-io.h"
+
+namespace sherpa_onnx {
+
+static std::vector<float> GenerateSamples(int32_t n) {
+  std::vector<float> samples(n);
+  for (int32_t i = 0; i != n; ++i) {
+    samples[i] = 0.5f * std::sin(i * 0.013f) + 0.1f * std::sin(i * 0.31f);
+  }
+  return samples;
+}
+
+// Get frames as a recognizer does, i.e., chunks of 8 frames with a shift
+// of 6 frames. If final is true, also get the remaining frames.
+static void GetFrames(const FeatureExtractor &extractor, bool final,
+                      int32_t *frame_index, std::vector<float> *frames) {
+  constexpr int32_t kChunkSize = 8;
+  constexpr int32_t kChunkShift = 6;
+
+  while (extractor.NumFramesReady() - *frame_index >= kChunkSize) {
+    std::vector<float> f = extractor.GetFrames(*frame_index, kChunkSize);
+    frames->insert(frames->end(), f.begin(),
+                   f.begin() + kChunkShift * extractor.FeatureDim());
+    *frame_index += kChunkShift;
+  }
+
+  int32_t n = extractor.NumFramesReady() - *frame_index;
+  if (final && n > 0) {
+    std::vector<float> f = extractor.GetFrames(*frame_index, n);
+    frames->insert(frames->end(), f.begin(), f.end());
+    *frame_index += n;
+  }
+}
+
+static void AcceptWaveform(const FeatureExtractor &extractor,
+                           const float *samples, int32_t n) {
+  // Feed the samples in pieces of 10 ms
+  for (int32_t i = 0; i < n; i += 160) {
+    extractor.AcceptWaveform(16000, samples + i, std::min(160, n - i));
+  }
+}
+
+TEST(FeatureExtractor, SerializeRestore) {
+  std::vector<float> samples = GenerateSamples(16000);
+
+  for (bool snip_edges : {false, true}) {
+    FeatureExtractorConfig config;
+    config.snip_edges = snip_edges;
+    config.enable_snapshots = true;
+
+    FeatureExtractor expected_extractor(config);
+    AcceptWaveform(expected_extractor, samples.data(), samples.size());
+    expected_extractor.InputFinished();
+
+    std::vector<float> expected;
+    int32_t expected_frame_index = 0;
+    GetFrames(expected_extractor, true, &expected_frame_index, &expected);
+
+    for (int32_t split : {400, 4321, 8000, 15999}) {
+      FeatureExtractor a(config);
+      AcceptWaveform(a, samples.data(), split);
+
+      std::vector<float> frames;
+      int32_t frame_index = 0;
+      GetFrames(a, false, &frame_index, &frames);
+
+      BinaryWriter w;
+      ASSERT_TRUE(a.Serialize(&w));
+
+      FeatureExtractor b(config);
+      BinaryReader r(w.Data().data(), w.Data().size());
+      ASSERT_TRUE(b.Deserialize(&r));
+      EXPECT_EQ(r.Remaining(), 0);
+      EXPECT_EQ(b.NumFramesReady(), a.NumFramesReady());
+
+      AcceptWaveform(b, samples.data() + split, samples.size() - split);
+      b.InputFinished();
+      GetFrames(b, true, &frame_index, &frames);
+
+      EXPECT_EQ(frame_index, expected_frame_index)
+          << "snip_edges: " << snip_edges << ", split: " << split;
+      EXPECT_TRUE(b.IsLastFrame(frame_index - 1));
+
+      ASSERT_EQ(frames.size(), expected.size());
+      for (size_t i = 0; i != frames.size(); ++i) {
+        ASSERT_NEAR(frames[i], expected[i], 1e-4)
+            << "snip_edges: " << snip_edges << ", split: " << split
+            << ", frame: " << i / b.FeatureDim();
+      }
+    }
+  }
+}
+
+// Build a snapshot with the given frame indexes
+static std::string CreateSnapshot(int32_t feature_dim, int32_t frame_index,
+                                  int32_t num_frames, int32_t frame_offset) {
+  BinaryWriter w;
+  w.Write(feature_dim);
+  w.Write(false);  // input_finished
+  w.Write(frame_index);
+  w.Write(std::vector<float>(num_frames * feature_dim));
+  w.Write(frame_offset);
+  w.Write(std::vector<float>{});  // samples
+  return w.Data();
+}
+
+TEST(FeatureExtractor, InvalidSnapshot) {
+  FeatureExtractorConfig config;
+  config.enable_snapshots = true;
+  int32_t dim = config.feature_dim;
+
+  auto restore = [](const std::string &snapshot,
+                    FeatureExtractor *extractor) {
+    BinaryReader r(snapshot.data(), snapshot.size());
+    return extractor->Deserialize(&r);
+  };
+
+  {
+    // Frames 5 and 6 are saved and the next frames start from frame 7
+    FeatureExtractor extractor(config);
+    ASSERT_TRUE(restore(CreateSnapshot(dim, 5, 2, 7), &extractor));
+    EXPECT_EQ(extractor.FirstAvailableFrame(), 5);
+    EXPECT_EQ(extractor.NumFramesReady(), 7);
+  }
+
+  {
+    // Frame 7 is missing
+    FeatureExtractor extractor(config);
+    EXPECT_FALSE(restore(CreateSnapshot(dim, 5, 2, 8), &extractor));
+  }
+
+  {
+    FeatureExtractor extractor(config);
+    EXPECT_FALSE(restore(CreateSnapshot(dim, -1, 2, 1), &extractor));
+  }
+
+  {
+    FeatureExtractor extractor(config);
+    EXPECT_FALSE(restore(CreateSnapshot(dim, 0, 0, -1), &extractor));
+  }
+
+  {
+    FeatureExtractor extractor(config);
+    EXPECT_FALSE(restore(CreateSnapshot(dim + 1, 0, 0, 0), &extractor));
+  }
+}
+
+}  // namespace sherpa_onnx
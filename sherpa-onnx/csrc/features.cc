@@ -5,13 +5,16 @@
 #include "sherpa-onnx/csrc/features.h"
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <sstream>
 #include <vector>
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
+#include "sherpa-onnx/csrc/binary-io.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/resample.h"
 
 namespace sherpa_onnx {
@@ -50,7 +53,8 @@ std::string FeatureExtractorConfig::ToString() const {
   os << "high_freq=" << high_freq << ", ";
   os << "dither=" << dither << ", ";
   os << "normalize_samples=" << (normalize_samples ? "True" : "False") << ", ";
-  os << "snip_edges=" << (snip_edges ? "True" : "False") << ")";
+  os << "snip_edges=" << (snip_edges ? "True" : "False") << ", ";
+  os << "enable_snapshots=" << (enable_snapshots ? "True" : "False") << ")";
 
   return os.str();
 }
@@ -66,6 +70,8 @@ class FeatureExtractor::Impl {
   }
 
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
+    SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_feature_extraction_seconds",
+                               "Time to compute features in AcceptWaveform()");
     if (config_.normalize_samples) {
       AcceptWaveformImpl(sampling_rate, waveform, n);
     } else {
@@ -92,13 +98,7 @@ class FeatureExtractor::Impl {
 
       std::vector<float> samples;
       resampler_->Resample(waveform, n, false, &samples);
-      if (fbank_) {
-        fbank_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                               samples.size());
-      } else {
-        mfcc_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                              samples.size());
-      }
+      Feed(samples.data(), samples.size());
       return;
     }
 
@@ -119,43 +119,43 @@ class FeatureExtractor::Impl {
 
       std::vector<float> samples;
       resampler_->Resample(waveform, n, false, &samples);
-      if (fbank_) {
-        fbank_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                               samples.size());
-      } else {
-        mfcc_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                              samples.size());
-      }
+      Feed(samples.data(), samples.size());
       return;
     }
 
-    if (fbank_) {
-      fbank_->AcceptWaveform(sampling_rate, waveform, n);
-    } else {
-      mfcc_->AcceptWaveform(sampling_rate, waveform, n);
-    }
+    Feed(waveform, n);
   }
 
-  void InputFinished() const {
+  void InputFinished() {
     std::lock_guard<std::mutex> lock(mutex_);
     fbank_->InputFinished();
+    input_finished_ = true;
   }
 
   int32_t NumFramesReady() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return fbank_->NumFramesReady();
+    return NumFramesReadyImpl();
+  }
+
+  int32_t FirstAvailableFrame() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_frame_index_;
   }
 
   bool IsLastFrame(int32_t frame) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return fbank_->IsLastFrame(frame);
+    if (!restored_) {
+      return fbank_->IsLastFrame(frame);
+    }
+
+    return input_finished_ && frame == NumFramesReadyImpl() - 1;
   }
 
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (frame_index + n > fbank_->NumFramesReady()) {
+    if (frame_index + n > NumFramesReadyImpl()) {
       SHERPA_ONNX_LOGE("%d + %d > %d\n", frame_index, n,
-                       fbank_->NumFramesReady());
+                       NumFramesReadyImpl());
       exit(-1);
     }
 
@@ -165,15 +165,26 @@ class FeatureExtractor::Impl {
                        last_frame_index_, frame_index);
       exit(-1);
     }
-    fbank_->Pop(discard_num);
+
+    // Frames of fbank_ before fbank_index are not needed any more
+    int32_t fbank_index = std::max(frame_index - frame_offset_, 0);
+    if (fbank_index > num_popped_frames_) {
+      fbank_->Pop(fbank_index - num_popped_frames_);
+      num_popped_frames_ = fbank_index;
+    }
 
     int32_t feature_dim = fbank_->Dim();
     std::vector<float> features(feature_dim * n);
 
     float *p = features.data();
 
+    int32_t saved_end = SavedFramesEnd();
     for (int32_t i = 0; i != n; ++i) {
-      const float *f = fbank_->GetFrame(i + frame_index);
+      int32_t k = i + frame_index;
+      const float *f =
+          k < saved_end
+              ? saved_frames_.data() + (k - saved_frame_index_) * feature_dim
+              : fbank_->GetFrame(k - frame_offset_);
       std::copy(f, f + feature_dim, p);
       p += feature_dim;
     }
@@ -183,10 +194,164 @@ class FeatureExtractor::Impl {
     return features;
   }
 
+  bool Serialize(BinaryWriter *w) const {
+    if (!config_.enable_snapshots) {
+      SHERPA_ONNX_LOGE("Please set enable_snapshots to serialize a stream");
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Frames of fbank_ in [first_frame, num_frames) are computed from
+    // samples in [first_frame * shift, num_samples_). If we feed these
+    // samples to a new extractor, its frames starting from
+    // NumReflectedFrames() are the same as our frames starting from
+    // first_frame + NumReflectedFrames().
+    int32_t shift = fbank_opts().WindowShift();
+    int32_t fbank_frames = fbank_->NumFramesReady();
+    int32_t first_frame = std::max(fbank_frames - NumReflectedFrames(), 0);
+    int64_t first_sample = static_cast<int64_t>(first_frame) * shift;
+
+    int64_t tail_start = num_samples_ - static_cast<int64_t>(tail_.size());
+    if (first_sample < tail_start) {
+      SHERPA_ONNX_LOGE("Samples from %d are discarded. Current: %d",
+                       static_cast<int32_t>(first_sample),
+                       static_cast<int32_t>(tail_start));
+      return false;
+    }
+
+    int32_t feature_dim = fbank_->Dim();
+    int32_t num_frames = NumFramesReadyImpl();
+
+    // Frames that are not consumed yet
+    std::vector<float> frames;
+    frames.reserve((num_frames - last_frame_index_) * feature_dim);
+    int32_t saved_end = SavedFramesEnd();
+    for (int32_t k = last_frame_index_; k < num_frames; ++k) {
+      const float *f =
+          k < saved_end
+              ? saved_frames_.data() + (k - saved_frame_index_) * feature_dim
+              : fbank_->GetFrame(k - frame_offset_);
+      frames.insert(frames.end(), f, f + feature_dim);
+    }
+
+    w->Write(feature_dim);
+    w->Write(input_finished_);
+    w->Write(last_frame_index_);
+    w->Write(frames);
+    w->Write(first_frame + frame_offset_);
+    w->Write(std::vector<float>(tail_.begin() + (first_sample - tail_start),
+                                tail_.end()));
+
+    return true;
+  }
+
+  bool Deserialize(BinaryReader *r) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (num_samples_ != 0 || input_finished_) {
+      SHERPA_ONNX_LOGE("Please deserialize into a new feature extractor");
+      return false;
+    }
+
+    int32_t feature_dim = 0;
+    bool input_finished = false;
+    std::vector<float> samples;
+    if (!r->Read(&feature_dim) || !r->Read(&input_finished) ||
+        !r->Read(&saved_frame_index_) || !r->Read(&saved_frames_) ||
+        !r->Read(&frame_offset_) || !r->Read(&samples)) {
+      return false;
+    }
+
+    if (feature_dim != fbank_->Dim() || saved_frames_.size() % feature_dim) {
+      SHERPA_ONNX_LOGE("Feature dim mismatch. Expected: %d. Given: %d",
+                       fbank_->Dim(), feature_dim);
+      return false;
+    }
+
+    // Frames of the new fbank_ start from frame_offset_, which is not
+    // after the saved frames. See Serialize()
+    int64_t saved_end =
+        static_cast<int64_t>(saved_frame_index_) +
+        static_cast<int64_t>(saved_frames_.size() / feature_dim);
+    if (saved_frame_index_ < 0 || frame_offset_ < 0 ||
+        frame_offset_ > saved_end ||
+        saved_end > std::numeric_limits<int32_t>::max()) {
+      SHERPA_ONNX_LOGE("Invalid frame indexes. Saved: %d, offset: %d",
+                       saved_frame_index_, frame_offset_);
+      return false;
+    }
+
+    restored_ = true;
+    last_frame_index_ = saved_frame_index_;
+
+    Feed(samples.data(), samples.size());
+    if (input_finished) {
+      fbank_->InputFinished();
+      input_finished_ = true;
+    }
+
+    return true;
+  }
+
   int32_t FeatureDim() const {
     return mfcc_ ? mfcc_opts_.num_ceps : opts_.mel_opts.num_bins;
   }
 
+ private:
+  // Give samples to the extractor and, if snapshots are enabled, remember
+  // the most recent ones for Serialize()
+  void Feed(const float *samples, int32_t n) {
+    if (fbank_) {
+      fbank_->AcceptWaveform(config_.sampling_rate, samples, n);
+    } else {
+      mfcc_->AcceptWaveform(config_.sampling_rate, samples, n);
+    }
+
+    num_samples_ += n;
+
+    if (!config_.enable_snapshots) {
+      return;
+    }
+
+    // Enough samples to recompute the frames that are not ready yet.
+    // See Serialize()
+    const auto &opts = fbank_opts();
+    size_t max_tail = opts.WindowSize() +
+                      (NumReflectedFrames() + 2) * opts.WindowShift();
+
+    tail_.insert(tail_.end(), samples, samples + n);
+    if (tail_.size() > 2 * max_tail) {
+      tail_.erase(tail_.begin(), tail_.end() - max_tail);
+    }
+  }
+
+  const knf::FrameExtractionOptions &fbank_opts() const {
+    return mfcc_ ? mfcc_opts_.frame_opts : opts_.frame_opts;
+  }
+
+  // Number of frames at the start of the input that contain reflected
+  // samples when snip_edges is false
+  int32_t NumReflectedFrames() const {
+    const auto &opts = fbank_opts();
+    if (opts.snip_edges) {
+      return 0;
+    }
+
+    int32_t shift = opts.WindowShift();
+    int32_t first_sample = shift / 2 - opts.WindowSize() / 2;
+    return first_sample >= 0 ? 0 : (-first_sample + shift - 1) / shift;
+  }
+
+  int32_t SavedFramesEnd() const {
+    return saved_frame_index_ +
+           static_cast<int32_t>(saved_frames_.size()) / fbank_->Dim();
+  }
+
+  int32_t NumFramesReadyImpl() const {
+    return std::max(fbank_->NumFramesReady() + frame_offset_,
+                    SavedFramesEnd());
+  }
+
  private:
   void InitFbank() {
     opts_.frame_opts.dither = config_.dither;
@@ -239,6 +404,21 @@ class FeatureExtractor::Impl {
   mutable std::mutex mutex_;
   std::unique_ptr<LinearResample> resampler_;
   int32_t last_frame_index_ = 0;
+  int32_t num_popped_frames_ = 0;  // of fbank_
+
+  bool input_finished_ = false;
+
+  // Number of samples given to fbank_ so far and the most recent of them
+  int64_t num_samples_ = 0;
+  std::vector<float> tail_;
+
+  // Used only by an extractor restored by Deserialize(). Frame i of this
+  // extractor is frame i - frame_offset_ of fbank_, except that frames
+  // before SavedFramesEnd() are taken from saved_frames_.
+  bool restored_ = false;
+  int32_t frame_offset_ = 0;
+  int32_t saved_frame_index_ = 0;
+  std::vector<float> saved_frames_;
 };
 
 FeatureExtractor::FeatureExtractor(const FeatureExtractorConfig &config /*={}*/)
@@ -257,6 +437,10 @@ int32_t FeatureExtractor::NumFramesReady() const {
   return impl_->NumFramesReady();
 }
 
+int32_t FeatureExtractor::FirstAvailableFrame() const {
+  return impl_->FirstAvailableFrame();
+}
+
 bool FeatureExtractor::IsLastFrame(int32_t frame) const {
   return impl_->IsLastFrame(frame);
 }
@@ -268,4 +452,12 @@ std::vector<float> FeatureExtractor::GetFrames(int32_t frame_index,
 
 int32_t FeatureExtractor::FeatureDim() const { return impl_->FeatureDim(); }
 
+bool FeatureExtractor::Serialize(BinaryWriter *w) const {
+  return impl_->Serialize(w);
+}
+
+bool FeatureExtractor::Deserialize(BinaryReader *r) {
+  return impl_->Deserialize(r);
+}
+
 }  // namespace sherpa_onnx
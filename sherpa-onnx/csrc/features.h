@@ -79,11 +79,19 @@ struct FeatureExtractorConfig {
 
   bool is_mfcc = false;
 
+  // true to keep the most recent samples of the input so that
+  // FeatureExtractor::Serialize() can be used. Otherwise, Serialize()
+  // fails.
+  bool enable_snapshots = false;
+
   std::string ToString() const;
 
   void Register(ParseOptions *po);
 };
 
+class BinaryReader;
+class BinaryWriter;
+
 class FeatureExtractor {
  public:
   explicit FeatureExtractor(const FeatureExtractorConfig &config = {});
@@ -110,6 +118,11 @@ class FeatureExtractor {
 
   int32_t NumFramesReady() const;
 
+  /** Return the smallest frame index that can be passed to GetFrames().
+   * Earlier frames may have been discarded.
+   */
+  int32_t FirstAvailableFrame() const;
+
   /** Note: IsLastFrame() will only ever return true if you have called
    * InputFinished() (and this frame is the last frame).
    */
@@ -127,6 +140,26 @@ class FeatureExtractor {
   /// Return feature dim of this extractor
   int32_t FeatureDim() const;
 
+  /** Save what is needed to continue feature extraction in another
+   * extractor, i.e., the frames that have not been consumed by GetFrames()
+   * and the samples that have not been turned into frames.
+   *
+   * It requires config.enable_snapshots.
+   *
+   * @return Return false if it fails.
+   */
+  bool Serialize(BinaryWriter *w) const;
+
+  /** Restore the state saved by Serialize().
+   *
+   * It must be called on a newly created extractor with the same config.
+   * Frame indexes continue from the saved extractor. If the input is
+   * resampled, the state of the resampler is not restored.
+   *
+   * @return Return false if it fails.
+   */
+  bool Deserialize(BinaryReader *r);
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
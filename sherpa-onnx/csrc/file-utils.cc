@@ -9,6 +9,16 @@
 #include <sstream>
 #include <string>
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
@@ -30,6 +40,44 @@ std::vector<char> ReadFile(const std::string &filename) {
   return buffer;
 }
 
+std::vector<std::string> ListFiles(const std::string &dir) {
+  std::vector<std::string> ans;
+
+#if defined(_WIN32)
+  WIN32_FIND_DATAA data;
+  HANDLE h = FindFirstFileA((dir + "\\*").c_str(), &data);
+  if (h == INVALID_HANDLE_VALUE) {
+    return ans;
+  }
+
+  do {
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      ans.emplace_back(data.cFileName);
+    }
+  } while (FindNextFileA(h, &data));
+
+  FindClose(h);
+#else
+  DIR *d = opendir(dir.c_str());
+  if (!d) {
+    return ans;
+  }
+
+  while (struct dirent *e = readdir(d)) {
+    // d_type is not set by all file systems
+    struct stat st;
+    std::string path = dir + "/" + e->d_name;
+    if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+      ans.emplace_back(e->d_name);
+    }
+  }
+
+  closedir(d);
+#endif
+
+  return ans;
+}
+
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename) {
   AAsset *asset = AAssetManager_open(mgr, filename.c_str(), AASSET_MODE_BUFFER);
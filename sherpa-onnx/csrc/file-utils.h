@@ -35,6 +35,14 @@ void AssertFileExists(const std::string &filename);
 
 std::vector<char> ReadFile(const std::string &filename);
 
+/** Return the names of the regular files in a directory, without the
+ * directory. The order is unspecified.
+ *
+ * @param dir The directory to list.
+ * @return Return an empty vector if the directory cannot be opened.
+ */
+std::vector<std::string> ListFiles(const std::string &dir);
+
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename);
 #endif
@@ -4,6 +4,12 @@
 
 #include "sherpa-onnx/csrc/fst-utils.h"
 
+#include <fstream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
@@ -50,4 +56,75 @@ fst::Fst<fst::StdArc> *ReadGraph(const std::string &filename) {
   }
 }
 
+// Like ReadGraph(), but always return a ConstFst. A ConstFst file is
+// memory-mapped instead of being copied into memory.
+static fst::ConstFst<fst::StdArc> *ReadConstGraph(
+    const std::string &filename) {
+  std::ifstream is(filename, std::ios::binary);
+  if (!is.good()) {
+    SHERPA_ONNX_LOGE("Could not open decoding-graph FST %s", filename.c_str());
+    return nullptr;
+  }
+
+  fst::FstHeader hdr;
+  if (!hdr.Read(is, filename)) {
+    SHERPA_ONNX_LOGE("Reading FST: error reading FST header.");
+    return nullptr;
+  }
+
+  if (hdr.ArcType() != fst::StdArc::Type()) {
+    SHERPA_ONNX_LOGE("FST with arc type %s not supported",
+                     hdr.ArcType().c_str());
+    return nullptr;
+  }
+
+  // The source has to be the real filename for mapping to work
+  fst::FstReadOptions ropts(filename, &hdr);
+
+  if (hdr.FstType() == "const") {
+    ropts.mode = fst::FstReadOptions::MAP;
+    return fst::ConstFst<fst::StdArc>::Read(is, ropts);
+  }
+
+  if (hdr.FstType() == "vector") {
+    std::unique_ptr<fst::VectorFst<fst::StdArc>> vector_fst(
+        fst::VectorFst<fst::StdArc>::Read(is, ropts));
+    if (!vector_fst) {
+      return nullptr;
+    }
+
+    return new fst::ConstFst<fst::StdArc>(*vector_fst);
+  }
+
+  SHERPA_ONNX_LOGE("Reading FST: unsupported FST type: %s",
+                   hdr.FstType().c_str());
+  return nullptr;
+}
+
+std::shared_ptr<const fst::Fst<fst::StdArc>> GetSharedGraph(
+    const std::string &filename) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string,
+                            std::weak_ptr<const fst::Fst<fst::StdArc>>>
+      cache;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto &entry = cache[filename];
+  if (auto graph = entry.lock()) {
+    return graph;
+  }
+
+  std::shared_ptr<const fst::Fst<fst::StdArc>> graph(ReadConstGraph(filename));
+  if (!graph) {
+    SHERPA_ONNX_LOGE("Error reading FST %s", filename.c_str());
+    cache.erase(filename);
+    return nullptr;
+  }
+
+  entry = graph;
+
+  return graph;
+}
+
 }  // namespace sherpa_onnx
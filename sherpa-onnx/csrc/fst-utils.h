@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_FST_UTILS_H_
 #define SHERPA_ONNX_CSRC_FST_UTILS_H_
 
+#include <memory>
 #include <string>
 
 #include "fst/fstlib.h"
@@ -13,6 +14,19 @@ namespace sherpa_onnx {
 
 fst::Fst<fst::StdArc> *ReadGraph(const std::string &filename);
 
+/** Return the decoding graph in filename, shared by all callers in the
+ * process.
+ *
+ * The file is read only once while any caller holds the returned graph.
+ * A ConstFst file is memory-mapped, so its pages are also shared with
+ * other processes. A VectorFst file is converted to a ConstFst once.
+ *
+ * The returned graph is immutable and can be used from several
+ * threads at the same time. Return nullptr on error.
+ */
+std::shared_ptr<const fst::Fst<fst::StdArc>> GetSharedGraph(
+    const std::string &filename);
+
 }
 
 #endif  // SHERPA_ONNX_CSRC_FST_UTILS_H_
@@ -10,14 +10,15 @@
 
 namespace sherpa_onnx {
 
-void Hypotheses::Add(Hypothesis hyp) {
+Hypothesis *Hypotheses::Add(Hypothesis hyp) {
   auto key = hyp.Key();
   auto it = hyps_dict_.find(key);
   if (it == hyps_dict_.end()) {
-    hyps_dict_[key] = std::move(hyp);
-  } else {
-    it->second.log_prob = LogAdd<double>()(it->second.log_prob, hyp.log_prob);
+    return &(hyps_dict_[key] = std::move(hyp));
   }
+
+  it->second.log_prob = LogAdd<double>()(it->second.log_prob, hyp.log_prob);
+  return nullptr;
 }
 
 Hypothesis Hypotheses::GetMostProbable(bool length_norm) const {
@@ -16,6 +16,7 @@
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/math.h"
+#include "sherpa-onnx/csrc/ngram-lm.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 
 namespace sherpa_onnx {
@@ -61,6 +62,9 @@ struct Hypothesis {
   // the nn lm states
   std::vector<CopyableOrtValue> nn_lm_states;
 
+  // the history of ys seen by an n-gram LM
+  NGramLMState ngram_lm_state;
+
   const ContextState *context_state;
 
   // TODO(fangjun): Make it configurable
@@ -112,7 +116,10 @@ class Hypotheses {
 
   // Add hyp to this object. If it already exists, its log_prob
   // is updated with the given hyp using log-sum-exp.
-  void Add(Hypothesis hyp);
+  //
+  // Return the added hyp, or nullptr if hyp is merged into an existing one.
+  // The returned pointer stays valid until the hyp is removed.
+  Hypothesis *Add(Hypothesis hyp);
 
   // Get the hyp that has the largest log_prob.
   // If length_norm is true, hyp's log_prob is divided by
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/keyword-spotter-impl.h"
 
 #include "sherpa-onnx/csrc/keyword-spotter-transducer-impl.h"
+#include "sherpa-onnx/csrc/warm-up.h"
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -17,6 +18,13 @@
 
 namespace sherpa_onnx {
 
+void KeywordSpotterImpl::WarmUp(int32_t num_runs,
+                                int32_t max_batch_size) const {
+  // Keyword spotting models use 16 kHz audio. The streams resample audio
+  // of other sample rates.
+  WarmUpStreams(*this, 16000, num_runs, max_batch_size);
+}
+
 std::unique_ptr<KeywordSpotterImpl> KeywordSpotterImpl::Create(
     const KeywordSpotterConfig &config) {
   if (!config.model_config.transducer.encoder.empty()) {
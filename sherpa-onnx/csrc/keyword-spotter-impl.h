@@ -37,6 +37,10 @@ class KeywordSpotterImpl {
   virtual void DecodeStreams(OnlineStream **ss, int32_t n) const = 0;
 
   virtual KeywordResult GetResult(OnlineStream *s) const = 0;
+
+  // Decode synthetic audio num_runs times with 1, 2, 4, ...,
+  // max_batch_size streams at a time. See WarmUpStreams() in warm-up.h
+  void WarmUp(int32_t num_runs, int32_t max_batch_size) const;
 };
 
 }  // namespace sherpa_onnx
@@ -6,10 +6,13 @@
 #define SHERPA_ONNX_CSRC_KEYWORD_SPOTTER_TRANSDUCER_IMPL_H_
 
 #include <algorithm>
+#include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <regex>  // NOLINT
 #include <string>
 #include <strstream>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -112,6 +115,20 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
   std::unique_ptr<OnlineStream> CreateStream(
       const std::string &keywords) const override {
+    {
+      // Streams with the same custom keywords share a graph
+      std::lock_guard<std::mutex> lock(overlays_mutex_);
+      auto it = overlays_.find(keywords);
+      if (it != overlays_.end()) {
+        if (auto keywords_graph = it->second.lock()) {
+          auto stream = std::make_unique<OnlineStream>(config_.feat_config,
+                                                       keywords_graph);
+          InitOnlineStream(stream.get());
+          return stream;
+        }
+      }
+    }
+
     auto kws = std::regex_replace(keywords, std::regex("/"), "\n");
     std::istringstream is(kws);
 
@@ -130,57 +147,35 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
       return nullptr;
     }
 
-    int32_t num_kws = current_ids.size();
-    int32_t num_default_kws = keywords_id_.size();
-
-    current_ids.insert(current_ids.end(), keywords_id_.begin(),
-                       keywords_id_.end());
-
-    if (!current_kws.empty() && !keywords_.empty()) {
-      current_kws.insert(current_kws.end(), keywords_.begin(), keywords_.end());
-    } else if (!current_kws.empty() && keywords_.empty()) {
-      current_kws.insert(current_kws.end(), num_default_kws, std::string());
-    } else if (current_kws.empty() && !keywords_.empty()) {
-      current_kws.insert(current_kws.end(), num_kws, std::string());
-      current_kws.insert(current_kws.end(), keywords_.begin(), keywords_.end());
-    } else {
-      // Do nothing.
+    if (current_ids.empty()) {
+      return CreateStream();
     }
 
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_kws,
-                            config_.keywords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_kws,
-                            config_.keywords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else {
-      // Do nothing.
-    }
+    // Only the custom keywords are compiled for this stream. They are
+    // layered on top of the default keywords, which are shared by all
+    // streams.
+    auto keywords_graph = std::make_shared<ContextGraph>(
+        keywords_graph_, current_ids, config_.keywords_score,
+        config_.keywords_threshold, current_scores, current_kws,
+        current_thresholds);
+
+    {
+      std::lock_guard<std::mutex> lock(overlays_mutex_);
+      if (overlays_.size() >= kMaxCachedOverlays) {
+        for (auto it = overlays_.begin(); it != overlays_.end();) {
+          it = it->second.expired() ? overlays_.erase(it) : std::next(it);
+        }
+      }
 
-    if (!current_thresholds.empty() && !thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), thresholds_.begin(),
-                                thresholds_.end());
-    } else if (!current_thresholds.empty() && thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), num_default_kws,
-                                config_.keywords_threshold);
-    } else if (current_thresholds.empty() && !thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), num_kws,
-                                config_.keywords_threshold);
-      current_thresholds.insert(current_thresholds.end(), thresholds_.begin(),
-                                thresholds_.end());
-    } else {
-      // Do nothing.
+      // Another thread may have built it in the meantime
+      auto &cached = overlays_[keywords];
+      if (auto p = cached.lock()) {
+        keywords_graph = std::move(p);
+      } else {
+        cached = keywords_graph;
+      }
     }
 
-    auto keywords_graph = std::make_shared<ContextGraph>(
-        current_ids, config_.keywords_score, config_.keywords_threshold,
-        current_scores, current_kws, current_thresholds);
-
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, keywords_graph);
     InitOnlineStream(stream.get());
@@ -360,6 +355,13 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
   std::vector<float> thresholds_;
   std::vector<std::string> keywords_;
   ContextGraphPtr keywords_graph_;
+
+  // Graphs of the custom keywords of streams, keyed by the argument of
+  // CreateStream(). Expired entries are removed when the cache is full.
+  static constexpr size_t kMaxCachedOverlays = 1024;
+  mutable std::mutex overlays_mutex_;
+  mutable std::unordered_map<std::string, std::weak_ptr<ContextGraph>>
+      overlays_;
   std::unique_ptr<OnlineTransducerModel> model_;
   std::unique_ptr<TransducerKeywordDecoder> decoder_;
   SymbolTable sym_;
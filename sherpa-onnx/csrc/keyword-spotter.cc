@@ -174,6 +174,11 @@ KeywordResult KeywordSpotter::GetResult(OnlineStream *s) const {
   return impl_->GetResult(s);
 }
 
+void KeywordSpotter::WarmUp(int32_t num_runs,
+                            int32_t max_batch_size /*= 1*/) const {
+  impl_->WarmUp(num_runs, std::max(max_batch_size, 1));
+}
+
 #if __ANDROID_API__ >= 9
 template KeywordSpotter::KeywordSpotter(AAssetManager *mgr,
                                         const KeywordSpotterConfig &config);
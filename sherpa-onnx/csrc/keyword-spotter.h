@@ -141,6 +141,16 @@ class KeywordSpotter {
 
   KeywordResult GetResult(OnlineStream *s) const;
 
+  /** Decode synthetic audio so that onnxruntime allocates memory and
+   * selects kernels before the first real stream.
+   *
+   * @param num_runs Number of runs of each batch size. Nothing is run if
+   *                 it is not positive.
+   * @param max_batch_size Batch sizes 1, 2, 4, ..., max_batch_size are run.
+   *                       It is at least 1.
+   */
+  void WarmUp(int32_t num_runs, int32_t max_batch_size = 1) const;
+
  private:
   std::unique_ptr<KeywordSpotterImpl> impl_;
 };
@@ -0,0 +1,93 @@
+// sherpa-onnx/csrc/length-bucketed-batcher-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/length-bucketed-batcher.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(LengthBucketedBatcher, Fifo) {
+  BatchingConfig config;
+  config.max_batch_size = 2;
+
+  LengthBucketedBatcher<int32_t> batcher(config);
+  batcher.Push(0, 100);
+  batcher.Push(1, 3000);
+  batcher.Push(2, 200);
+
+  std::vector<int32_t> batch;
+  ASSERT_TRUE(batcher.Pop(&batch));
+  EXPECT_EQ(batch, (std::vector<int32_t>{0, 1}));
+
+  ASSERT_TRUE(batcher.Pop(&batch));
+  EXPECT_EQ(batch, (std::vector<int32_t>{2}));
+
+  int32_t wait_ms = 0;
+  EXPECT_FALSE(batcher.Pop(&batch, &wait_ms));
+  EXPECT_EQ(wait_ms, -1);
+
+  const auto &stats = batcher.GetStats();
+  EXPECT_EQ(stats.num_batches, 2);
+  EXPECT_EQ(stats.num_utterances, 3);
+  EXPECT_EQ(stats.num_frames, 3300);
+  EXPECT_EQ(stats.num_padded_frames, 2 * 3000 + 200);
+}
+
+TEST(LengthBucketedBatcher, Buckets) {
+  BatchingConfig config;
+  config.max_batch_size = 2;
+  config.bucket_width = 5;  // seconds, i.e., 500 frames
+  config.max_wait_ms = 60 * 1000;
+
+  LengthBucketedBatcher<int32_t> batcher(config);
+  batcher.Push(0, 200);
+  batcher.Push(1, 3000);
+
+  std::vector<int32_t> batch;
+  int32_t wait_ms = 0;
+
+  // No bucket is full and nothing has timed out
+  EXPECT_FALSE(batcher.Pop(&batch, &wait_ms));
+  EXPECT_GT(wait_ms, 0);
+
+  batcher.Push(2, 3100);
+  ASSERT_TRUE(batcher.Pop(&batch));
+  EXPECT_EQ(batch, (std::vector<int32_t>{1, 2}));
+
+  EXPECT_FALSE(batcher.Pop(&batch));
+
+  ASSERT_TRUE(batcher.Pop(&batch, nullptr, /*flush*/ true));
+  EXPECT_EQ(batch, (std::vector<int32_t>{0}));
+
+  EXPECT_TRUE(batcher.Empty());
+  EXPECT_EQ(batcher.GetStats().PaddingRatio(), 100.0f / (2 * 3100 + 200));
+}
+
+TEST(LengthBucketedBatcher, MaxBatchFrames) {
+  BatchingConfig config;
+  config.max_batch_size = 10;
+  config.max_batch_frames = 1000;
+
+  LengthBucketedBatcher<int32_t> batcher(config);
+  batcher.Push(0, 300);
+  batcher.Push(1, 300);
+  batcher.Push(2, 400);
+  batcher.Push(3, 2000);
+
+  std::vector<int32_t> batch;
+  ASSERT_TRUE(batcher.Pop(&batch));
+  EXPECT_EQ(batch, (std::vector<int32_t>{0, 1}));
+
+  ASSERT_TRUE(batcher.Pop(&batch));
+  EXPECT_EQ(batch, (std::vector<int32_t>{2}));
+
+  // An utterance longer than max_batch_frames is decoded on its own
+  ASSERT_TRUE(batcher.Pop(&batch));
+  EXPECT_EQ(batch, (std::vector<int32_t>{3}));
+}
+
+}  // namespace sherpa_onnx
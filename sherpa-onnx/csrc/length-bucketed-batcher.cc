@@ -0,0 +1,88 @@
+// sherpa-onnx/csrc/length-bucketed-batcher.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/length-bucketed-batcher.h"
+
+#include <sstream>
+#include <string>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+void BatchingConfig::Register(ParseOptions *po) {
+  po->Register("max-batch-size", &max_batch_size,
+               "Max number of utterances in a batch for decoding.");
+
+  po->Register("max-batch-frames", &max_batch_frames,
+               "Max number of padded feature frames in a batch, i.e., "
+               "batch_size * num_frames_of_the_longest_utterance_in_batch. "
+               "There are 100 frames per second. 0 means no limit.");
+
+  po->Register("batch-bucket-width", &bucket_width,
+               "Utterances are grouped by length into buckets of this "
+               "width in seconds and a batch contains utterances from a "
+               "single bucket. 0 means a single bucket, i.e., FIFO order.");
+
+  po->Register("max-batch-wait-ms", &max_wait_ms,
+               "Max time in milliseconds an utterance waits for its bucket "
+               "to fill up before it is decoded in a partial batch. "
+               "0 means never wait.");
+}
+
+bool BatchingConfig::Validate() const {
+  if (max_batch_size <= 0) {
+    SHERPA_ONNX_LOGE("Expect --max-batch-size > 0. Given: %d", max_batch_size);
+    return false;
+  }
+
+  if (max_batch_frames < 0) {
+    SHERPA_ONNX_LOGE("Expect --max-batch-frames >= 0. Given: %d",
+                     max_batch_frames);
+    return false;
+  }
+
+  if (bucket_width < 0) {
+    SHERPA_ONNX_LOGE("Expect --batch-bucket-width >= 0. Given: %.3f",
+                     bucket_width);
+    return false;
+  }
+
+  if (max_wait_ms < 0) {
+    SHERPA_ONNX_LOGE("Expect --max-batch-wait-ms >= 0. Given: %d",
+                     max_wait_ms);
+    return false;
+  }
+
+  return true;
+}
+
+std::string BatchingConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "BatchingConfig(";
+  os << "max_batch_size=" << max_batch_size << ", ";
+  os << "max_batch_frames=" << max_batch_frames << ", ";
+  os << "bucket_width=" << bucket_width << ", ";
+  os << "max_wait_ms=" << max_wait_ms << ")";
+
+  return os.str();
+}
+
+std::string BatchingStats::ToString() const {
+  std::ostringstream os;
+
+  os << "BatchingStats(";
+  os << "num_batches=" << num_batches << ", ";
+  os << "num_utterances=" << num_utterances << ", ";
+  os << "average_batch_size=" << AverageBatchSize() << ", ";
+  os << "padding_ratio=" << PaddingRatio() << ", ";
+  os << "audio_seconds=" << audio_seconds << ", ";
+  os << "processing_seconds=" << processing_seconds << ", ";
+  os << "throughput=" << Throughput() << ")";
+
+  return os.str();
+}
+
+}  // namespace sherpa_onnx
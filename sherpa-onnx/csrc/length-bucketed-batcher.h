@@ -0,0 +1,284 @@
+// sherpa-onnx/csrc/length-bucketed-batcher.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_LENGTH_BUCKETED_BATCHER_H_
+#define SHERPA_ONNX_CSRC_LENGTH_BUCKETED_BATCHER_H_
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/parse-options.h"
+
+namespace sherpa_onnx {
+
+struct BatchingConfig {
+  // Max number of utterances in a batch
+  int32_t max_batch_size = 5;
+
+  // Max number of padded feature frames in a batch, i.e.,
+  // batch_size * (number of frames of the longest utterance in the batch).
+  // 0 means no limit. A single utterance longer than this value is still
+  // decoded in a batch of its own.
+  int32_t max_batch_frames = 0;
+
+  // Utterances are grouped into buckets of this width in seconds. Only
+  // utterances from the same bucket are put into a batch so that
+  // little computation is wasted on padding.
+  // 0 means there is only one bucket, i.e., batches are formed
+  // in FIFO order.
+  float bucket_width = 0;
+
+  // Max time in milliseconds an utterance waits for its bucket to fill up.
+  // After that, a batch is formed with whatever is in the bucket.
+  // 0 means never wait.
+  int32_t max_wait_ms = 0;
+
+  BatchingConfig() = default;
+
+  BatchingConfig(int32_t max_batch_size, int32_t max_batch_frames,
+                 float bucket_width, int32_t max_wait_ms)
+      : max_batch_size(max_batch_size),
+        max_batch_frames(max_batch_frames),
+        bucket_width(bucket_width),
+        max_wait_ms(max_wait_ms) {}
+
+  void Register(ParseOptions *po);
+  bool Validate() const;
+
+  std::string ToString() const;
+};
+
+struct BatchingStats {
+  int64_t num_batches = 0;
+  int64_t num_utterances = 0;
+
+  // Sum of the number of frames of all utterances
+  int64_t num_frames = 0;
+
+  // Sum of batch_size * max_num_frames over all batches
+  int64_t num_padded_frames = 0;
+
+  // Duration in seconds of all utterances
+  double audio_seconds = 0;
+
+  // Time in seconds spent on decoding, reported by the user
+  // of the batcher.
+  double processing_seconds = 0;
+
+  // Fraction of frames in batches that are padding
+  float PaddingRatio() const {
+    return num_padded_frames == 0
+               ? 0
+               : 1 - static_cast<float>(num_frames) / num_padded_frames;
+  }
+
+  float AverageBatchSize() const {
+    return num_batches == 0 ? 0
+                            : static_cast<float>(num_utterances) / num_batches;
+  }
+
+  // Seconds of audio decoded per second of processing time
+  float Throughput() const {
+    return processing_seconds == 0 ? 0 : audio_seconds / processing_seconds;
+  }
+
+  std::string ToString() const;
+};
+
+/** Form batches from utterances of different lengths.
+ *
+ * Utterances are put into buckets by their length. A batch is taken from
+ * a single bucket once the bucket is full, i.e., adding one more utterance
+ * would exceed max_batch_size or max_batch_frames, or once the oldest
+ * utterance in the bucket has waited for max_wait_ms. If several buckets
+ * are ready, the one with the oldest utterance is selected.
+ *
+ * Inside a bucket utterances are kept in FIFO order.
+ *
+ * Caution: It is not thread-safe. Callers have to synchronize access to it.
+ */
+template <typename T>
+class LengthBucketedBatcher {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param config  Configuration of the batching policy.
+   * @param frames_per_second  Number of feature frames per second. It is
+   *                           used to convert config.bucket_width to frames.
+   */
+  explicit LengthBucketedBatcher(const BatchingConfig &config,
+                                 int32_t frames_per_second = 100)
+      : config_(config),
+        frames_per_second_(frames_per_second),
+        bucket_frames_(static_cast<int32_t>(config.bucket_width *
+                                            frames_per_second)) {}
+
+  /** Add an utterance.
+   *
+   * @param item  The utterance.
+   * @param num_frames  Number of feature frames of the utterance.
+   */
+  void Push(T item, int32_t num_frames) {
+    int32_t bucket = bucket_frames_ > 0 ? num_frames / bucket_frames_ : 0;
+    buckets_[bucket].push_back({std::move(item), num_frames, Clock::now()});
+    ++size_;
+  }
+
+  /** Take a batch if there is one ready.
+   *
+   * @param batch On return, it contains the utterances of the batch.
+   * @param wait_ms If not nullptr and no batch is ready, on return it
+   *                contains the number of milliseconds until the next batch
+   *                will become ready; it is -1 if there are no utterances.
+   * @param flush  If true, ignore max_wait_ms and take a batch from the
+   *               bucket with the oldest utterance even if it is not full.
+   *
+   * @return Return true if a batch is returned; false otherwise.
+   */
+  bool Pop(std::vector<T> *batch, int32_t *wait_ms = nullptr,
+           bool flush = false) {
+    batch->clear();
+
+    if (size_ == 0) {
+      if (wait_ms) {
+        *wait_ms = -1;
+      }
+      return false;
+    }
+
+    auto now = Clock::now();
+    auto max_wait = std::chrono::milliseconds(config_.max_wait_ms);
+
+    auto best = buckets_.end();
+    auto min_remaining = max_wait;
+
+    for (auto it = buckets_.begin(); it != buckets_.end(); ++it) {
+      const auto &q = it->second;
+      auto waited = now - q.front().enqueue_time;
+
+      bool ready = flush || waited >= max_wait || IsFull(q);
+      if (ready) {
+        if (best == buckets_.end() ||
+            q.front().enqueue_time < best->second.front().enqueue_time) {
+          best = it;
+        }
+      } else {
+        auto remaining =
+            std::chrono::duration_cast<std::chrono::milliseconds>(max_wait -
+                                                                  waited);
+        min_remaining = std::min(min_remaining, remaining);
+      }
+    }
+
+    if (best == buckets_.end()) {
+      if (wait_ms) {
+        *wait_ms = std::max<int32_t>(1, min_remaining.count());
+      }
+      return false;
+    }
+
+    auto &q = best->second;
+    int32_t n = NumToTake(q);
+    int32_t max_frames = 0;
+
+    batch->reserve(n);
+    for (int32_t i = 0; i != n; ++i) {
+      auto &u = q.front();
+      max_frames = std::max(max_frames, u.num_frames);
+
+      stats_.num_frames += u.num_frames;
+      stats_.audio_seconds += static_cast<double>(u.num_frames) /
+                              frames_per_second_;
+
+      batch->push_back(std::move(u.item));
+      q.pop_front();
+    }
+
+    if (q.empty()) {
+      buckets_.erase(best);
+    }
+
+    size_ -= n;
+
+    stats_.num_batches += 1;
+    stats_.num_utterances += n;
+    stats_.num_padded_frames += static_cast<int64_t>(max_frames) * n;
+
+    return true;
+  }
+
+  // Number of utterances waiting to be batched
+  int32_t Size() const { return size_; }
+
+  bool Empty() const { return size_ == 0; }
+
+  // Report the time spent on decoding a batch. Used only for statistics.
+  void AddProcessingTime(double seconds) {
+    stats_.processing_seconds += seconds;
+  }
+
+  const BatchingStats &GetStats() const { return stats_; }
+
+  const BatchingConfig &GetConfig() const { return config_; }
+
+ private:
+  struct Utterance {
+    T item;
+    int32_t num_frames;
+    Clock::time_point enqueue_time;
+  };
+
+  // Return the number of utterances from the front of q that fit into
+  // a single batch. It is at least 1 for a non-empty q.
+  int32_t NumToTake(const std::deque<Utterance> &q) const {
+    int32_t n = 0;
+    int32_t max_frames = 0;
+    for (const auto &u : q) {
+      if (n == config_.max_batch_size) {
+        break;
+      }
+
+      int32_t new_max_frames = std::max(max_frames, u.num_frames);
+      if (n > 0 && config_.max_batch_frames > 0 &&
+          static_cast<int64_t>(new_max_frames) * (n + 1) >
+              config_.max_batch_frames) {
+        break;
+      }
+
+      max_frames = new_max_frames;
+      ++n;
+    }
+
+    return n;
+  }
+
+  // A bucket is full if we cannot add more utterances to the batch
+  // formed from its front.
+  bool IsFull(const std::deque<Utterance> &q) const {
+    int32_t n = NumToTake(q);
+    return n == config_.max_batch_size || n < static_cast<int32_t>(q.size());
+  }
+
+ private:
+  BatchingConfig config_;
+  int32_t frames_per_second_;
+  int32_t bucket_frames_;
+
+  // bucket index -> utterances in that bucket
+  std::map<int32_t, std::deque<Utterance>> buckets_;
+  int32_t size_ = 0;
+
+  BatchingStats stats_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_LENGTH_BUCKETED_BATCHER_H_
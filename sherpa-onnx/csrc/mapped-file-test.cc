@@ -0,0 +1,72 @@
+// sherpa-onnx/csrc/mapped-file-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/mapped-file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::string WriteTestFile(const std::string &filename,
+                                 const std::vector<float> &data) {
+  std::ofstream os(filename, std::ios::binary);
+  os.write(reinterpret_cast<const char *>(data.data()),
+           data.size() * sizeof(float));
+  return filename;
+}
+
+TEST(MappedFile, Open) {
+  std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  auto filename = WriteTestFile("mapped-file-test-open.bin", data);
+
+  auto f = MappedFile::Open(filename, /*lazy*/ true);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(f->Size(), data.size() * sizeof(float));
+
+  const float *p = reinterpret_cast<const float *>(f->Data());
+  for (int32_t i = 0; i != data.size(); ++i) {
+    EXPECT_EQ(p[i], data[i]);
+  }
+
+  // should not crash for ranges outside of the file
+  f->Prefetch(0, f->Size());
+  f->Prefetch(f->Size() - 1, 100);
+  f->Prefetch(f->Size() + 1, 100);
+
+  f.reset();
+  std::remove(filename.c_str());
+}
+
+TEST(MappedFile, FromBuffer) {
+  MappedFile f(std::vector<char>{'a', 'b', 'c'});
+  EXPECT_FALSE(f.IsMapped());
+  EXPECT_EQ(f.Size(), 3);
+  EXPECT_EQ(f.Data()[0], 'a');
+  EXPECT_EQ(f.Data()[2], 'c');
+}
+
+TEST(MappedFile, Shared) {
+  std::vector<float> data = {10, 20, 30};
+  auto filename = WriteTestFile("mapped-file-test-shared.bin", data);
+
+  auto a = GetSharedMappedFile(filename);
+  auto b = GetSharedMappedFile(filename);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_EQ(a->Data(), b->Data());
+
+  a.reset();
+  b.reset();
+
+  std::remove(filename.c_str());
+
+  EXPECT_EQ(GetSharedMappedFile(filename), nullptr);
+}
+
+}  // namespace sherpa_onnx
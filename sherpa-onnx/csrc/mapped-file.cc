@@ -0,0 +1,199 @@
+// sherpa-onnx/csrc/mapped-file.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/mapped-file.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+MappedFile::MappedFile(std::vector<char> buf) : buf_(std::move(buf)) {
+  data_ = buf_.data();
+  size_ = buf_.size();
+}
+
+#if defined(_WIN32)
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string &filename,
+                                             bool /*lazy = false*/) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    SHERPA_ONNX_LOGE("Failed to open '%s'", filename.c_str());
+    return nullptr;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    SHERPA_ONNX_LOGE("Failed to get the size of '%s'", filename.c_str());
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  if (size.QuadPart == 0) {
+    CloseHandle(file);
+    return std::unique_ptr<MappedFile>(new MappedFile(std::vector<char>{}));
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+
+  if (!mapping) {
+    SHERPA_ONNX_LOGE("Failed to create a file mapping for '%s'",
+                     filename.c_str());
+    return nullptr;
+  }
+
+  void *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!p) {
+    SHERPA_ONNX_LOGE("Failed to map '%s'", filename.c_str());
+    CloseHandle(mapping);
+    return nullptr;
+  }
+
+  std::unique_ptr<MappedFile> ans(new MappedFile);
+  ans->mapping_ = p;
+  ans->file_mapping_handle_ = mapping;
+  ans->data_ = reinterpret_cast<const char *>(p);
+  ans->size_ = static_cast<size_t>(size.QuadPart);
+
+  return ans;
+}
+
+MappedFile::~MappedFile() {
+  if (mapping_) {
+    UnmapViewOfFile(mapping_);
+  }
+
+  if (file_mapping_handle_) {
+    CloseHandle(file_mapping_handle_);
+  }
+}
+
+void MappedFile::Prefetch(size_t /*offset*/, size_t /*n*/) const {}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string &filename,
+                                             bool lazy /*= false*/) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    SHERPA_ONNX_LOGE("Failed to open '%s'", filename.c_str());
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    SHERPA_ONNX_LOGE("Failed to get the size of '%s'", filename.c_str());
+    close(fd);
+    return nullptr;
+  }
+
+  if (st.st_size == 0) {
+    close(fd);
+    return std::unique_ptr<MappedFile>(new MappedFile(std::vector<char>{}));
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+
+  void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+  // The mapping keeps a reference to the file, so we can close fd here
+  close(fd);
+
+  if (p == MAP_FAILED) {
+    SHERPA_ONNX_LOGE("Failed to mmap '%s'. Fallback to read it into memory",
+                     filename.c_str());
+
+    auto buf = ReadFile(filename);
+    if (buf.size() != size) {
+      return nullptr;
+    }
+
+    return std::unique_ptr<MappedFile>(new MappedFile(std::move(buf)));
+  }
+
+  madvise(p, size, lazy ? MADV_RANDOM : MADV_WILLNEED);
+
+  std::unique_ptr<MappedFile> ans(new MappedFile);
+  ans->mapping_ = p;
+  ans->data_ = reinterpret_cast<const char *>(p);
+  ans->size_ = size;
+
+  return ans;
+}
+
+MappedFile::~MappedFile() {
+  if (mapping_) {
+    munmap(mapping_, size_);
+  }
+}
+
+void MappedFile::Prefetch(size_t offset, size_t n) const {
+  if (!mapping_ || offset >= size_ || n == 0) {
+    return;
+  }
+
+  if (offset + n > size_) {
+    n = size_ - offset;
+  }
+
+  // madvise() requires a page-aligned start address
+  static const size_t kPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin = offset / kPageSize * kPageSize;
+
+  madvise(reinterpret_cast<char *>(mapping_) + begin, offset + n - begin,
+          MADV_WILLNEED);
+}
+
+#endif
+
+std::shared_ptr<const MappedFile> GetSharedMappedFile(
+    const std::string &filename, bool lazy /*= false*/) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<const MappedFile>>
+      files;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto &entry = files[filename];
+  std::shared_ptr<const MappedFile> ans = entry.lock();
+  if (ans) {
+    return ans;
+  }
+
+  ans = MappedFile::Open(filename, lazy);
+  if (!ans) {
+    files.erase(filename);
+    return nullptr;
+  }
+
+  entry = ans;
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,90 @@
+// sherpa-onnx/csrc/mapped-file.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_MAPPED_FILE_H_
+#define SHERPA_ONNX_CSRC_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** A read-only view of a file.
+ *
+ * On platforms that support it, the file is memory-mapped so that its
+ * pages are backed by the page cache and shared among all processes and
+ * all instances that map the same file. Otherwise, e.g., for files read
+ * from an Android asset manager, the content is kept in a buffer owned
+ * by this object.
+ */
+class MappedFile {
+ public:
+  /** Map the given file.
+   *
+   * @param filename Path to the file.
+   * @param lazy  If true, pages are faulted in only when they are accessed
+   *              and the kernel is told that the access pattern is random.
+   *              If false, the kernel is asked to read the whole file ahead.
+   *
+   * It returns nullptr if the file cannot be opened or mapped.
+   */
+  static std::unique_ptr<MappedFile> Open(const std::string &filename,
+                                          bool lazy = false);
+
+  /** Take the ownership of a buffer. Used when mmap is not available. */
+  explicit MappedFile(std::vector<char> buf);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+  // True if the content is memory-mapped, false if it is held in a buffer.
+  bool IsMapped() const { return mapping_ != nullptr; }
+
+  /** Hint that the bytes in [offset, offset + n) will be accessed soon.
+   *
+   * It is a no-op if the file is not memory-mapped.
+   */
+  void Prefetch(size_t offset, size_t n) const;
+
+ private:
+  MappedFile() = default;
+
+ private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+
+  // Start address of the mapping. nullptr if the file is not mapped
+  void *mapping_ = nullptr;
+
+#if defined(_WIN32)
+  void *file_mapping_handle_ = nullptr;
+#endif
+
+  std::vector<char> buf_;
+};
+
+/** Return a mapping of the given file that is shared by all callers in
+ * this process.
+ *
+ * The mapping is released once the last returned pointer is destroyed.
+ * It returns nullptr if the file cannot be mapped.
+ *
+ * @param filename Path to the file.
+ * @param lazy  See MappedFile::Open(). It is used only by the caller
+ *              that creates the mapping.
+ */
+std::shared_ptr<const MappedFile> GetSharedMappedFile(
+    const std::string &filename, bool lazy = false);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_MAPPED_FILE_H_
@@ -0,0 +1,101 @@
+// sherpa-onnx/csrc/metrics-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/metrics.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(Metrics, Counter) {
+  MetricsRegistry registry;
+  Counter *c = registry.GetCounter("test_total", "A test counter");
+  EXPECT_EQ(c, registry.GetCounter("test_total", "A test counter"));
+
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i != 4; ++i) {
+    threads.emplace_back([c]() {
+      for (int32_t k = 0; k != 1000; ++k) {
+        c->Inc(0.5);
+      }
+    });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(c->Value(), 2000);
+}
+
+TEST(Metrics, HistogramQuantile) {
+  Histogram h({1, 2, 3, 4});
+  EXPECT_EQ(h.Quantile(0.5), 0);
+
+  for (int32_t i = 0; i != 100; ++i) {
+    h.Observe(0.5 + (i % 4));
+  }
+
+  EXPECT_EQ(h.Count(), 100);
+  EXPECT_DOUBLE_EQ(h.Sum(), 200);
+
+  auto counts = h.BucketCounts();
+  ASSERT_EQ(counts.size(), 5);
+  EXPECT_EQ(counts[0], 25);
+  EXPECT_EQ(counts[3], 25);
+  EXPECT_EQ(counts[4], 0);
+
+  EXPECT_DOUBLE_EQ(h.Quantile(0.5), 2);
+  EXPECT_DOUBLE_EQ(h.Quantile(0.25), 1);
+  EXPECT_NEAR(h.Quantile(0.99), 3.96, 1e-6);
+
+  h.Observe(100);
+  EXPECT_EQ(h.Quantile(1), 4);
+}
+
+TEST(Metrics, Text) {
+  MetricsRegistry registry;
+  Histogram *h = registry.GetHistogram("decode_seconds", "Decode time");
+  Counter *c = registry.GetCounter("audio_seconds_total", "Audio duration");
+  registry.GetGauge("queue_depth", "Queue depth")->Set(3);
+  registry.AddRatio("rtf", "Real-time factor", "decode_seconds",
+                    "audio_seconds_total");
+
+  h->Observe(0.5);
+  c->Inc(2);
+
+  std::string text = registry.ToText();
+  EXPECT_NE(text.find("# TYPE decode_seconds histogram\n"), std::string::npos);
+  EXPECT_NE(text.find("decode_seconds_count 1\n"), std::string::npos);
+  EXPECT_NE(text.find("decode_seconds_bucket{le=\"+Inf\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("decode_seconds_p50 "), std::string::npos);
+  EXPECT_NE(text.find("audio_seconds_total 2\n"), std::string::npos);
+  EXPECT_NE(text.find("queue_depth 3\n"), std::string::npos);
+  EXPECT_NE(text.find("rtf 0.25\n"), std::string::npos);
+
+  registry.Reset();
+  EXPECT_EQ(h->Count(), 0);
+  EXPECT_EQ(c->Value(), 0);
+}
+
+TEST(Metrics, ScopedLatency) {
+  Histogram h(Histogram::LatencyBounds());
+
+  MetricsRegistry::SetEnabled(false);
+  { ScopedLatency t(&h); }
+  EXPECT_EQ(h.Count(), 0);
+
+  MetricsRegistry::SetEnabled(true);
+  { ScopedLatency t(&h); }
+  EXPECT_EQ(h.Count(), 1);
+
+  MetricsRegistry::SetEnabled(false);
+}
+
+}  // namespace sherpa_onnx
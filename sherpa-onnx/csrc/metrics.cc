@@ -0,0 +1,265 @@
+// sherpa-onnx/csrc/metrics.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/metrics.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+namespace internal {
+
+static bool MetricsEnabledFromEnv() {
+  const char *s = std::getenv("SHERPA_ONNX_ENABLE_METRICS");
+  return s && std::strcmp(s, "") != 0 && std::strcmp(s, "0") != 0;
+}
+
+std::atomic<bool> g_metrics_enabled{MetricsEnabledFromEnv()};
+
+}  // namespace internal
+
+static void AtomicAdd(std::atomic<double> *a, double v) {
+  double old = a->load(std::memory_order_relaxed);
+  while (!a->compare_exchange_weak(old, old + v, std::memory_order_relaxed)) {
+  }
+}
+
+void Counter::Inc(double v /*= 1*/) { AtomicAdd(&value_, v); }
+
+void Gauge::Add(double v) { AtomicAdd(&value_, v); }
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      counts_(new std::atomic<int64_t>[bounds_.size() + 1]) {
+  for (size_t i = 0; i != bounds_.size() + 1; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::Observe(double v) {
+  auto i =
+      std::lower_bound(bounds_.begin(), bounds_.end(), v) - bounds_.begin();
+  counts_[i].fetch_add(1, std::memory_order_relaxed);
+  AtomicAdd(&sum_, v);
+}
+
+int64_t Histogram::Count() const {
+  int64_t ans = 0;
+  for (size_t i = 0; i != bounds_.size() + 1; ++i) {
+    ans += counts_[i].load(std::memory_order_relaxed);
+  }
+  return ans;
+}
+
+std::vector<int64_t> Histogram::BucketCounts() const {
+  std::vector<int64_t> ans(bounds_.size() + 1);
+  for (size_t i = 0; i != ans.size(); ++i) {
+    ans[i] = counts_[i].load(std::memory_order_relaxed);
+  }
+  return ans;
+}
+
+double Histogram::Quantile(double q) const {
+  std::vector<int64_t> counts = BucketCounts();
+  int64_t total = 0;
+  for (auto c : counts) {
+    total += c;
+  }
+
+  if (total == 0) {
+    return 0;
+  }
+
+  q = std::min(1.0, std::max(0.0, q));
+  double rank = q * total;
+
+  int64_t cumulative = 0;
+  for (size_t i = 0; i != counts.size(); ++i) {
+    if (counts[i] == 0 || cumulative + counts[i] < rank) {
+      cumulative += counts[i];
+      continue;
+    }
+
+    if (i == bounds_.size()) {
+      // The +inf bucket. The best we can do is the largest finite bound
+      return bounds_.empty() ? 0 : bounds_.back();
+    }
+
+    double lower = i == 0 ? std::min(0.0, bounds_[0]) : bounds_[i - 1];
+    double upper = bounds_[i];
+    double fraction = (rank - cumulative) / counts[i];
+    return lower + (upper - lower) * fraction;
+  }
+
+  return bounds_.empty() ? 0 : bounds_.back();
+}
+
+void Histogram::Reset() {
+  for (size_t i = 0; i != bounds_.size() + 1; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+  sum_.store(0, std::memory_order_relaxed);
+}
+
+std::vector<double> Histogram::LatencyBounds() {
+  std::vector<double> ans;
+  double b = 1e-4;
+  for (int32_t i = 0; i != 19; ++i, b *= 2) {
+    ans.push_back(b);
+  }
+  return ans;
+}
+
+std::vector<double> Histogram::SizeBounds() {
+  return {1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 256};
+}
+
+MetricsRegistry &MetricsRegistry::Global() {
+  // Never destroyed so that it can be used during static destruction
+  static MetricsRegistry *registry = new MetricsRegistry;
+  return *registry;
+}
+
+void MetricsRegistry::SetEnabled(bool enabled) {
+  internal::g_metrics_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Counter *MetricsRegistry::GetCounter(const std::string &name,
+                                     const std::string &help) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &e = entries_[name];
+  if (!e.counter && !e.gauge && !e.histogram) {
+    e.help = help;
+    e.counter = std::make_unique<Counter>();
+  }
+  return e.counter.get();
+}
+
+Gauge *MetricsRegistry::GetGauge(const std::string &name,
+                                 const std::string &help) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &e = entries_[name];
+  if (!e.counter && !e.gauge && !e.histogram) {
+    e.help = help;
+    e.gauge = std::make_unique<Gauge>();
+  }
+  return e.gauge.get();
+}
+
+Histogram *MetricsRegistry::GetHistogram(
+    const std::string &name, const std::string &help,
+    const std::vector<double> &bounds /*= {}*/) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &e = entries_[name];
+  if (!e.counter && !e.gauge && !e.histogram) {
+    e.help = help;
+    e.histogram = std::make_unique<Histogram>(
+        bounds.empty() ? Histogram::LatencyBounds() : bounds);
+  }
+  return e.histogram.get();
+}
+
+void MetricsRegistry::AddRatio(const std::string &name,
+                               const std::string &help,
+                               const std::string &numerator,
+                               const std::string &denominator) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ratios_[name] = {help, numerator, denominator};
+}
+
+double MetricsRegistry::ValueOf(const std::string &name) const {
+  auto it = entries_.find(name);
+  if (it == entries_.end()) {
+    return 0;
+  }
+
+  const auto &e = it->second;
+  if (e.counter) {
+    return e.counter->Value();
+  } else if (e.gauge) {
+    return e.gauge->Value();
+  } else if (e.histogram) {
+    return e.histogram->Sum();
+  }
+
+  return 0;
+}
+
+static void WriteHeader(const std::string &name, const std::string &help,
+                        const char *type, std::ostringstream *os) {
+  *os << "# HELP " << name << " " << help << "\n";
+  *os << "# TYPE " << name << " " << type << "\n";
+}
+
+std::string MetricsRegistry::ToText() const {
+  std::ostringstream os;
+  os << std::setprecision(9);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto &p : entries_) {
+    const std::string &name = p.first;
+    const Entry &e = p.second;
+
+    if (e.counter) {
+      WriteHeader(name, e.help, "counter", &os);
+      os << name << " " << e.counter->Value() << "\n";
+    } else if (e.gauge) {
+      WriteHeader(name, e.help, "gauge", &os);
+      os << name << " " << e.gauge->Value() << "\n";
+    } else if (e.histogram) {
+      const Histogram &h = *e.histogram;
+      std::vector<int64_t> counts = h.BucketCounts();
+      const auto &bounds = h.Bounds();
+
+      WriteHeader(name, e.help, "histogram", &os);
+      int64_t cumulative = 0;
+      for (size_t i = 0; i != bounds.size(); ++i) {
+        cumulative += counts[i];
+        os << name << "_bucket{le=\"" << bounds[i] << "\"} " << cumulative
+           << "\n";
+      }
+      cumulative += counts.back();
+      os << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+      os << name << "_sum " << h.Sum() << "\n";
+      os << name << "_count " << cumulative << "\n";
+
+      WriteHeader(name + "_p50", "Median of " + name, "gauge", &os);
+      os << name << "_p50 " << h.Quantile(0.5) << "\n";
+
+      WriteHeader(name + "_p99", "99th percentile of " + name, "gauge", &os);
+      os << name << "_p99 " << h.Quantile(0.99) << "\n";
+    }
+  }
+
+  for (const auto &p : ratios_) {
+    const Ratio &r = p.second;
+    double d = ValueOf(r.denominator);
+    double v = d > 0 ? ValueOf(r.numerator) / d : 0;
+
+    WriteHeader(p.first, r.help, "gauge", &os);
+    os << p.first << " " << v << "\n";
+  }
+
+  return os.str();
+}
+
+void MetricsRegistry::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &p : entries_) {
+    if (p.second.counter) {
+      p.second.counter->Reset();
+    } else if (p.second.histogram) {
+      p.second.histogram->Reset();
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,208 @@
+// sherpa-onnx/csrc/metrics.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_METRICS_H_
+#define SHERPA_ONNX_CSRC_METRICS_H_
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+// A monotonically increasing value, e.g., the number of seconds of
+// audio decoded so far. It is safe to call from multiple threads.
+class Counter {
+ public:
+  void Inc(double v = 1);
+
+  double Value() const { return value_.load(std::memory_order_relaxed); }
+
+  void Reset() { value_.store(0, std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_{0};
+};
+
+// A value that can go up and down, e.g., the length of a queue.
+class Gauge {
+ public:
+  void Set(double v) { value_.store(v, std::memory_order_relaxed); }
+
+  void Add(double v);
+
+  double Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_{0};
+};
+
+// A histogram with fixed bucket upper bounds. Observe() is lock-free
+// and wait-free except for the update of the sum.
+class Histogram {
+ public:
+  // bounds must be sorted in increasing order. An implicit bucket with
+  // upper bound +inf is appended.
+  explicit Histogram(std::vector<double> bounds);
+
+  void Observe(double v);
+
+  int64_t Count() const;
+  double Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+  // Estimate the q-quantile, 0 <= q <= 1, by linear interpolation inside
+  // the bucket that contains it. Return 0 if nothing has been observed.
+  double Quantile(double q) const;
+
+  const std::vector<double> &Bounds() const { return bounds_; }
+
+  // Number of observations in each bucket, not cumulative.
+  // Its size is Bounds().size() + 1.
+  std::vector<int64_t> BucketCounts() const;
+
+  void Reset();
+
+  // Exponential buckets from 0.1 ms to about 26 s, for latencies in seconds
+  static std::vector<double> LatencyBounds();
+
+  // For batch sizes
+  static std::vector<double> SizeBounds();
+
+ private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<int64_t>[]> counts_;
+  std::atomic<double> sum_{0};
+};
+
+namespace internal {
+extern std::atomic<bool> g_metrics_enabled;
+}  // namespace internal
+
+// Metrics are disabled by default so that the instrumented code pays only
+// for a relaxed atomic load. Set the environment variable
+// SHERPA_ONNX_ENABLE_METRICS=1 or call MetricsRegistry::SetEnabled(true)
+// to enable them.
+inline bool MetricsEnabled() {
+  return internal::g_metrics_enabled.load(std::memory_order_relaxed);
+}
+
+class MetricsRegistry {
+ public:
+  // The process-wide registry used by the instrumented code
+  static MetricsRegistry &Global();
+
+  static void SetEnabled(bool enabled);
+  static bool Enabled() { return MetricsEnabled(); }
+
+  // The returned pointers are owned by the registry and stay valid
+  // as long as the registry is alive. Calling it twice with the same
+  // name returns the same object.
+  Counter *GetCounter(const std::string &name, const std::string &help);
+
+  Gauge *GetGauge(const std::string &name, const std::string &help);
+
+  // bounds is used only when the histogram is created. If it is empty,
+  // Histogram::LatencyBounds() is used.
+  Histogram *GetHistogram(const std::string &name, const std::string &help,
+                          const std::vector<double> &bounds = {});
+
+  // Export the ratio numerator/denominator, where each of them is
+  // the name of a counter or a histogram (whose sum is used).
+  // For instance, the real-time factor is
+  // decode seconds / audio seconds.
+  void AddRatio(const std::string &name, const std::string &help,
+                const std::string &numerator, const std::string &denominator);
+
+  // Return all metrics in the Prometheus text exposition format.
+  // For each histogram, we also export <name>_p50 and <name>_p99.
+  std::string ToText() const;
+
+  // Reset all counters and histograms to 0. Gauges are kept.
+  void Reset();
+
+ private:
+  struct Entry {
+    std::string help;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  struct Ratio {
+    std::string help;
+    std::string numerator;
+    std::string denominator;
+  };
+
+  double ValueOf(const std::string &name) const;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Entry> entries_;
+  std::map<std::string, Ratio> ratios_;
+};
+
+// Record the time spent in a scope into a histogram.
+// It does not even read the clock if metrics are disabled.
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(Histogram *h) {
+    if (MetricsEnabled()) {
+      h_ = h;
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedLatency() {
+    if (h_) {
+      auto end = std::chrono::steady_clock::now();
+      h_->Observe(std::chrono::duration<double>(end - start_).count());
+    }
+  }
+
+  ScopedLatency(const ScopedLatency &) = delete;
+  ScopedLatency &operator=(const ScopedLatency &) = delete;
+
+ private:
+  Histogram *h_ = nullptr;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#define SHERPA_ONNX_METRICS_CONCAT_IMPL(a, b) a##b
+#define SHERPA_ONNX_METRICS_CONCAT(a, b) SHERPA_ONNX_METRICS_CONCAT_IMPL(a, b)
+
+// Time the rest of the enclosing scope and record it in the latency
+// histogram with the given name. The histogram is looked up only once.
+//
+//   SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_encoder_seconds",
+//                              "Time to run the encoder");
+#define SHERPA_ONNX_SCOPED_LATENCY(name, help)                          \
+  static ::sherpa_onnx::Histogram *SHERPA_ONNX_METRICS_CONCAT(          \
+      sherpa_onnx_histogram_, __LINE__) =                               \
+      ::sherpa_onnx::MetricsRegistry::Global().GetHistogram(name, help); \
+  ::sherpa_onnx::ScopedLatency SHERPA_ONNX_METRICS_CONCAT(              \
+      sherpa_onnx_scoped_latency_,                                      \
+      __LINE__)(SHERPA_ONNX_METRICS_CONCAT(sherpa_onnx_histogram_, __LINE__))
+
+// Add v to the counter with the given name. The counter is looked up only
+// once, and v is not even evaluated if metrics are disabled.
+//
+//   SHERPA_ONNX_COUNTER_INC("sherpa_onnx_online_decoder_rows_total",
+//                           "Rows the decoder has run on", batch_size);
+#define SHERPA_ONNX_COUNTER_INC(name, help, v)                             \
+  do {                                                                     \
+    if (::sherpa_onnx::MetricsEnabled()) {                                 \
+      static ::sherpa_onnx::Counter *sherpa_onnx_counter =                 \
+          ::sherpa_onnx::MetricsRegistry::Global().GetCounter(name, help); \
+      sherpa_onnx_counter->Inc(v);                                         \
+    }                                                                      \
+  } while (0)
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_METRICS_H_
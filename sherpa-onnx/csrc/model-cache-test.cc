@@ -0,0 +1,95 @@
+// sherpa-onnx/csrc/model-cache-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/model-cache.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(ModelCache, HashModel) {
+  std::vector<char> a(1001);
+  for (int32_t i = 0; i != static_cast<int32_t>(a.size()); ++i) {
+    a[i] = static_cast<char>(i * 7);
+  }
+
+  std::vector<char> b = a;
+  EXPECT_EQ(HashModel(a.data(), a.size()), HashModel(b.data(), b.size()));
+
+  // A change in the tail that is not a multiple of 8 bytes
+  b.back() += 1;
+  EXPECT_NE(HashModel(a.data(), a.size()), HashModel(b.data(), b.size()));
+
+  b = a;
+  b[3] += 1;
+  EXPECT_NE(HashModel(a.data(), a.size()), HashModel(b.data(), b.size()));
+
+  // Trailing zeros change the length
+  b = a;
+  b.push_back(0);
+  EXPECT_NE(HashModel(a.data(), a.size()), HashModel(b.data(), b.size()));
+
+  EXPECT_EQ(HashModel(nullptr, 0), HashModel(nullptr, 0));
+}
+
+TEST(ModelCache, Key) {
+  std::string model = "not really a model";
+
+  std::string k1 = ModelCacheKey(model.data(), model.size(), "extended");
+  EXPECT_EQ(k1.size(), 33);
+  EXPECT_EQ(k1, ModelCacheKey(model.data(), model.size(), "extended"));
+
+  // The default level of onnxruntime is all
+  EXPECT_EQ(ModelCacheKey(model.data(), model.size(), ""),
+            ModelCacheKey(model.data(), model.size(), "all"));
+
+  EXPECT_NE(k1, ModelCacheKey(model.data(), model.size(), "basic"));
+  EXPECT_NE(k1, ModelCacheKey(model.data(), model.size() - 1, "extended"));
+
+  // The same model has the same prefix
+  EXPECT_EQ(k1.substr(0, 16),
+            ModelCacheKey(model.data(), model.size(), "basic").substr(0, 16));
+
+  EXPECT_EQ(ModelCacheFilename("/tmp", k1), "/tmp/" + k1 + ".ort");
+}
+
+TEST(ModelCache, IsModelCacheFilename) {
+  std::string model = "not really a model";
+  std::string key = ModelCacheKey(model.data(), model.size(), "extended");
+
+  EXPECT_TRUE(IsModelCacheFilename(key + ".ort"));
+  EXPECT_TRUE(IsModelCacheFilename(key + ".ort.3fa9c01d2e4b5a67-0.tmp"));
+  EXPECT_TRUE(IsModelCacheFilename(key + ".ort.1-1f.tmp"));
+
+  EXPECT_FALSE(IsModelCacheFilename(""));
+  EXPECT_FALSE(IsModelCacheFilename(key));
+  EXPECT_FALSE(IsModelCacheFilename(key + ".onnx"));
+  EXPECT_FALSE(IsModelCacheFilename(key + ".ort.bak"));
+  EXPECT_FALSE(IsModelCacheFilename(key + ".ort.1-.tmp"));
+  EXPECT_FALSE(IsModelCacheFilename(key + ".ort.-1.tmp"));
+  EXPECT_FALSE(IsModelCacheFilename(key + ".ort.1-1.tmp.txt"));
+  EXPECT_FALSE(IsModelCacheFilename("model.ort"));
+  EXPECT_FALSE(IsModelCacheFilename("x.tmp"));
+  EXPECT_FALSE(IsModelCacheFilename(key.substr(1) + "0.ort"));
+  EXPECT_FALSE(IsModelCacheFilename("0" + key + ".ort"));
+
+  // Upper case is not produced by ModelCacheKey()
+  std::string upper = key;
+  upper[0] = 'A';
+  EXPECT_FALSE(IsModelCacheFilename(upper + ".ort"));
+}
+
+TEST(ModelCache, Dir) {
+  std::string saved = GetModelCacheDir();
+
+  SetModelCacheDir("/tmp/cache");
+  EXPECT_EQ(GetModelCacheDir(), "/tmp/cache");
+
+  SetModelCacheDir(saved);
+}
+
+}  // namespace sherpa_onnx
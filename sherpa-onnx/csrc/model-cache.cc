@@ -0,0 +1,271 @@
+// sherpa-onnx/csrc/model-cache.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/model-cache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/mapped-file.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/tuning-profile.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+struct ModelCacheDir {
+  std::mutex mutex;
+  std::string dir;
+
+  ModelCacheDir() {
+    const char *s = std::getenv("SHERPA_ONNX_MODEL_CACHE_DIR");
+    if (s) {
+      dir = s;
+    }
+  }
+};
+
+ModelCacheDir &GetModelCacheDirImpl() {
+  static ModelCacheDir *d = new ModelCacheDir;
+  return *d;
+}
+
+// The finalizer of MurmurHash3
+uint64_t Mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+std::string ToHex(uint64_t h) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+  return buf;
+}
+
+// Models in the ORT format are flatbuffers with the file identifier ORTM.
+// They are already optimized.
+bool IsOrtFormat(const void *model_data, size_t model_data_length) {
+  return model_data_length >= 8 &&
+         std::memcmp(static_cast<const char *>(model_data) + 4, "ORTM", 4) ==
+             0;
+}
+
+// Number of lowercase hex digits starting at s[pos]
+size_t NumHexDigits(const std::string &s, size_t pos) {
+  size_t n = 0;
+  for (; pos + n < s.size(); ++n) {
+    char c = s[pos + n];
+    if (!(c >= '0' && c <= '9') && !(c >= 'a' && c <= 'f')) {
+      break;
+    }
+  }
+  return n;
+}
+
+// See IsModelCacheFilename()
+std::string TempFilename(const std::string &filename) {
+  static const uint64_t kProcessTag =
+      (static_cast<uint64_t>(std::random_device{}()) << 32) |
+      std::random_device{}();
+  static std::atomic<uint64_t> counter{0};
+
+  std::ostringstream os;
+  os << filename << "." << std::hex << kProcessTag << "-"
+     << counter.fetch_add(1) << ".tmp";
+  return os.str();
+}
+
+std::unique_ptr<Ort::Session> LoadFromCache(
+    const Ort::Env &env, const std::string &filename,
+    const Ort::SessionOptions &sess_opts) {
+  auto file = MappedFile::Open(filename);
+  if (!file) {
+    return nullptr;
+  }
+
+  try {
+    return std::make_unique<Ort::Session>(env, file->Data(), file->Size(),
+                                          sess_opts);
+  } catch (const Ort::Exception &e) {
+    SHERPA_ONNX_LOGE("Failed to load the cached model '%s': %s. Remove it",
+                     filename.c_str(), e.what());
+  }
+
+  file.reset();
+  std::remove(filename.c_str());
+  return nullptr;
+}
+
+std::unique_ptr<Ort::Session> CreateAndSave(
+    const Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts, const std::string &filename) {
+  // Write to a temporary file first so that another process loading the
+  // same model never sees a partially written entry
+  std::string tmp = TempFilename(filename);
+
+  Ort::SessionOptions opts = sess_opts.Clone();
+#if defined(_WIN32)
+  std::wstring wtmp = ToWideString(tmp);
+  opts.SetOptimizedModelFilePath(wtmp.c_str());
+#else
+  opts.SetOptimizedModelFilePath(tmp.c_str());
+#endif
+  opts.AddConfigEntry("session.save_model_format", "ORT");
+
+  std::unique_ptr<Ort::Session> sess;
+  try {
+    sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                          opts);
+  } catch (const Ort::Exception &e) {
+    SHERPA_ONNX_LOGE("Failed to save the optimized model to '%s': %s",
+                     tmp.c_str(), e.what());
+    std::remove(tmp.c_str());
+    return nullptr;
+  }
+
+#if defined(_WIN32)
+  std::remove(filename.c_str());
+#endif
+
+  if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+    SHERPA_ONNX_LOGE("Failed to rename '%s' to '%s'", tmp.c_str(),
+                     filename.c_str());
+    std::remove(tmp.c_str());
+  }
+
+  return sess;
+}
+
+}  // namespace
+
+void SetModelCacheDir(const std::string &dir) {
+  auto &d = GetModelCacheDirImpl();
+  std::lock_guard<std::mutex> lock(d.mutex);
+  d.dir = dir;
+}
+
+std::string GetModelCacheDir() {
+  auto &d = GetModelCacheDirImpl();
+  std::lock_guard<std::mutex> lock(d.mutex);
+  return d.dir;
+}
+
+uint64_t HashModel(const void *data, size_t n) {
+  constexpr uint64_t kPrime = 0x9e3779b97f4a7c15ULL;
+
+  const char *p = static_cast<const char *>(data);
+  uint64_t h = Mix(n + kPrime);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t w;
+    std::memcpy(&w, p + i, 8);
+    h = (h ^ Mix(w)) * kPrime;
+  }
+
+  if (i < n) {
+    uint64_t w = 0;
+    std::memcpy(&w, p + i, n - i);
+    h = (h ^ Mix(w)) * kPrime;
+  }
+
+  return Mix(h);
+}
+
+std::string ModelCacheKey(const void *model_data, size_t model_data_length,
+                          const std::string &graph_optimization_level) {
+  std::string level = graph_optimization_level;
+  if (level.empty()) {
+    level = "all";
+  }
+
+  std::ostringstream os;
+  os << Ort::GetVersionString() << '\n' << level;
+  if (level == "all") {
+    // Layout transformations of this level depend on the instruction set
+    os << '\n' << CpuModelName();
+  }
+  std::string options = os.str();
+
+  return ToHex(HashModel(model_data, model_data_length)) + "-" +
+         ToHex(HashModel(options.data(), options.size()));
+}
+
+std::string ModelCacheFilename(const std::string &dir,
+                               const std::string &key) {
+  return dir + "/" + key + ".ort";
+}
+
+bool IsModelCacheFilename(const std::string &name) {
+  // The key, see ModelCacheKey()
+  if (NumHexDigits(name, 0) != 16 || name.compare(16, 1, "-") != 0 ||
+      NumHexDigits(name, 17) != 16 || name.compare(33, 4, ".ort") != 0) {
+    return false;
+  }
+
+  size_t pos = 37;
+  if (pos == name.size()) {
+    return true;
+  }
+
+  // A temporary file, see TempFilename()
+  if (name[pos] != '.') {
+    return false;
+  }
+  ++pos;
+
+  size_t n = NumHexDigits(name, pos);
+  if (n == 0 || name.compare(pos + n, 1, "-") != 0) {
+    return false;
+  }
+  pos += n + 1;
+
+  n = NumHexDigits(name, pos);
+  if (n == 0) {
+    return false;
+  }
+  pos += n;
+
+  return name.compare(pos, std::string::npos, ".tmp") == 0;
+}
+
+std::unique_ptr<Ort::Session> CreateCachedSession(
+    const Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts, const std::string &dir,
+    const std::string &graph_optimization_level) {
+  std::unique_ptr<Ort::Session> sess;
+  if (!dir.empty() && !IsOrtFormat(model_data, model_data_length)) {
+    std::string filename = ModelCacheFilename(
+        dir,
+        ModelCacheKey(model_data, model_data_length, graph_optimization_level));
+
+    sess = LoadFromCache(env, filename, sess_opts);
+    if (!sess) {
+      sess = CreateAndSave(env, model_data, model_data_length, sess_opts,
+                           filename);
+    }
+  }
+
+  if (!sess) {
+    sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                          sess_opts);
+  }
+
+  return sess;
+}
+
+}  // namespace sherpa_onnx
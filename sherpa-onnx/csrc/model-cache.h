@@ -0,0 +1,73 @@
+// sherpa-onnx/csrc/model-cache.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_MODEL_CACHE_H_
+#define SHERPA_ONNX_CSRC_MODEL_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+
+namespace sherpa_onnx {
+
+/** A cache of optimized models on disk.
+ *
+ * onnxruntime spends a large part of loading a model on graph
+ * optimizations, e.g., constant folding and fusing of nodes. The cache
+ * saves the optimized graph in the ORT format the first time a model is
+ * loaded, so that later loads skip the optimizations.
+ *
+ * The cache is disabled if the directory is empty, which is the default.
+ * It is initialized from the environment variable
+ * SHERPA_ONNX_MODEL_CACHE_DIR. The directory must exist.
+ */
+void SetModelCacheDir(const std::string &dir);
+
+std::string GetModelCacheDir();
+
+// A 64-bit hash of the given bytes. It reads 8 bytes per step so that
+// hashing a model of hundreds of MB takes only tens of milliseconds.
+uint64_t HashModel(const void *data, size_t n);
+
+/** Name of the cache entry for a model, without directory and extension.
+ *
+ * It depends on the content of the model, the version of onnxruntime and
+ * the graph optimization level. Optimizations of level all use the
+ * instruction set of the CPU, so the name of the CPU is also included for
+ * it.
+ *
+ * @param graph_optimization_level Empty for the default of onnxruntime, which
+ *                                 is all. Otherwise, one of disable, basic,
+ *                                 extended, all.
+ */
+std::string ModelCacheKey(const void *model_data, size_t model_data_length,
+                          const std::string &graph_optimization_level);
+
+// Path of the cache entry for the given key in dir
+std::string ModelCacheFilename(const std::string &dir, const std::string &key);
+
+// True if name, without directory, is a cache entry, i.e.,
+// <16 hex>-<16 hex>.ort, or a temporary file of an entry being written,
+// i.e., <16 hex>-<16 hex>.ort.<hex>-<hex>.tmp
+bool IsModelCacheFilename(const std::string &name);
+
+/** Create a session for the model, using the cache in dir.
+ *
+ * If the cache has an entry for the model, the session is created from it.
+ * Otherwise, the session is created from the model and the optimized graph
+ * is saved to the cache. An entry that cannot be loaded, e.g., because it
+ * is truncated, is removed and created again.
+ *
+ * Errors of the cache are logged and the model is loaded without it.
+ */
+std::unique_ptr<Ort::Session> CreateCachedSession(
+    const Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts, const std::string &dir,
+    const std::string &graph_optimization_level);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_MODEL_CACHE_H_
@@ -0,0 +1,251 @@
+// sherpa-onnx/csrc/native-joiner-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/native-joiner.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+// Helpers to write a joiner model in the protobuf wire format of ONNX
+std::string Varint(uint64_t v) {
+  std::string s;
+  while (v >= 0x80) {
+    s.push_back(static_cast<char>((v & 0x7f) | 0x80));
+    v >>= 7;
+  }
+  s.push_back(static_cast<char>(v));
+  return s;
+}
+
+std::string Bytes(int32_t field, const std::string &value) {
+  return Varint((field << 3) | 2) + Varint(value.size()) + value;
+}
+
+std::string Int(int32_t field, int64_t value) {
+  return Varint(field << 3) + Varint(static_cast<uint64_t>(value));
+}
+
+std::string Tensor(const std::string &name, const std::vector<int64_t> &dims,
+                   const std::vector<float> &data) {
+  std::string s;
+  for (auto d : dims) {
+    s += Int(1, d);
+  }
+  s += Int(2, 1);  // float
+  s += Bytes(8, name);
+
+  std::string raw(data.size() * sizeof(float), '\0');
+  std::memcpy(&raw[0], data.data(), raw.size());
+  s += Bytes(9, raw);
+  return s;
+}
+
+// Return a node of a GraphProto
+std::string Node(const std::string &op_type,
+                 const std::vector<std::string> &inputs,
+                 const std::string &output,
+                 const std::string &attributes = "") {
+  std::string s;
+  for (const auto &i : inputs) {
+    s += Bytes(1, i);
+  }
+  s += Bytes(2, output);
+  s += Bytes(4, op_type);
+  s += attributes;
+  return Bytes(1, s);
+}
+
+std::string IntAttribute(const std::string &name, int64_t value) {
+  return Bytes(5, Bytes(1, name) + Int(3, value));
+}
+
+std::string ValueInfo(const std::string &name) { return Bytes(1, name); }
+
+std::vector<float> Random(int32_t n, int32_t seed) {
+  std::vector<float> v(n);
+  for (int32_t i = 0; i != n; ++i) {
+    v[i] = std::sin(0.37f * (i + 1) * (seed + 1));
+  }
+  return v;
+}
+
+// y = W x + b, W is (out_dim, in_dim)
+std::vector<float> Linear(const std::vector<float> &w,
+                          const std::vector<float> &b,
+                          const std::vector<float> &x, int32_t out_dim) {
+  int32_t in_dim = x.size();
+  std::vector<float> y(out_dim);
+  for (int32_t r = 0; r != out_dim; ++r) {
+    y[r] = b.empty() ? 0 : b[r];
+    for (int32_t c = 0; c != in_dim; ++c) {
+      y[r] += w[r * in_dim + c] * x[c];
+    }
+  }
+  return y;
+}
+
+std::vector<float> Transpose(const std::vector<float> &w, int32_t rows,
+                             int32_t cols) {
+  std::vector<float> ans(w.size());
+  for (int32_t r = 0; r != rows; ++r) {
+    for (int32_t c = 0; c != cols; ++c) {
+      ans[c * rows + r] = w[r * cols + c];
+    }
+  }
+  return ans;
+}
+
+}  // namespace
+
+TEST(NativeJoiner, WithoutProjections) {
+  int32_t joiner_dim = 13;
+  int32_t vocab_size = 10;
+
+  auto w = Random(vocab_size * joiner_dim, 1);
+  auto b = Random(vocab_size, 2);
+
+  std::string graph;
+  graph += Node("Add", {"encoder_out", "decoder_out"}, "sum");
+  graph += Node("Tanh", {"sum"}, "hidden");
+  graph += Node("Gemm", {"hidden", "w", "b"}, "logit",
+                IntAttribute("transB", 1));
+  graph += Bytes(5, Tensor("w", {vocab_size, joiner_dim}, w));
+  graph += Bytes(5, Tensor("b", {vocab_size}, b));
+  graph += Bytes(11, ValueInfo("encoder_out"));
+  graph += Bytes(11, ValueInfo("decoder_out"));
+  graph += Bytes(12, ValueInfo("logit"));
+
+  std::string model = Int(1, 8) + Bytes(7, graph);
+
+  auto joiner = NativeJoiner::Create(model.data(), model.size(), false);
+  ASSERT_NE(joiner, nullptr);
+
+  EXPECT_EQ(joiner->EncoderDim(), joiner_dim);
+  EXPECT_EQ(joiner->DecoderDim(), joiner_dim);
+  EXPECT_EQ(joiner->JoinerDim(), joiner_dim);
+  EXPECT_EQ(joiner->VocabSize(), vocab_size);
+
+  auto e = Random(joiner_dim, 3);
+  auto d = Random(joiner_dim, 4);
+
+  std::vector<float> hidden(joiner_dim);
+  for (int32_t i = 0; i != joiner_dim; ++i) {
+    hidden[i] = std::tanh(e[i] + d[i]);
+  }
+  auto expected = Linear(w, b, hidden, vocab_size);
+
+  std::vector<float> e_proj(joiner_dim);
+  std::vector<float> d_proj(joiner_dim);
+  joiner->ProjectEncoder(e.data(), 1, e_proj.data());
+  joiner->ProjectDecoder(d.data(), 1, d_proj.data());
+
+  std::vector<float> logit(vocab_size);
+  joiner->Run(e_proj.data(), d_proj.data(), logit.data());
+
+  for (int32_t i = 0; i != vocab_size; ++i) {
+    EXPECT_NEAR(logit[i], expected[i], 1e-5);
+  }
+}
+
+TEST(NativeJoiner, WithProjections) {
+  int32_t encoder_dim = 17;
+  int32_t decoder_dim = 6;
+  int32_t joiner_dim = 9;
+  int32_t vocab_size = 21;
+
+  auto we = Random(joiner_dim * encoder_dim, 1);
+  auto be = Random(joiner_dim, 2);
+  auto wd = Random(joiner_dim * decoder_dim, 3);
+  auto wo = Random(vocab_size * joiner_dim, 4);
+  auto bo = Random(vocab_size, 5);
+
+  // The encoder projection is MatMul + Add, the decoder projection is
+  // MatMul without bias, and the output layer is Gemm with transB=0.
+  std::string graph;
+  graph += Node("MatMul", {"encoder_out", "we"}, "e0");
+  graph += Node("Add", {"be", "e0"}, "e1");
+  graph += Node("MatMul", {"decoder_out", "wd"}, "d1");
+  graph += Node("Add", {"d1", "e1"}, "sum");
+  graph += Node("Tanh", {"sum"}, "hidden");
+  graph += Node("Gemm", {"hidden", "wo", "bo"}, "logit");
+  graph += Bytes(5, Tensor("we", {encoder_dim, joiner_dim},
+                           Transpose(we, joiner_dim, encoder_dim)));
+  graph += Bytes(5, Tensor("be", {joiner_dim}, be));
+  graph += Bytes(5, Tensor("wd", {decoder_dim, joiner_dim},
+                           Transpose(wd, joiner_dim, decoder_dim)));
+  graph += Bytes(5, Tensor("wo", {joiner_dim, vocab_size},
+                           Transpose(wo, vocab_size, joiner_dim)));
+  graph += Bytes(5, Tensor("bo", {vocab_size}, bo));
+  graph += Bytes(11, ValueInfo("encoder_out"));
+  graph += Bytes(11, ValueInfo("decoder_out"));
+  graph += Bytes(11, ValueInfo("we"));  // initializers can be inputs
+  graph += Bytes(12, ValueInfo("logit"));
+
+  std::string model = Int(1, 8) + Bytes(7, graph);
+
+  auto joiner = NativeJoiner::Create(model.data(), model.size(), false);
+  ASSERT_NE(joiner, nullptr);
+
+  EXPECT_EQ(joiner->EncoderDim(), encoder_dim);
+  EXPECT_EQ(joiner->DecoderDim(), decoder_dim);
+  EXPECT_EQ(joiner->JoinerDim(), joiner_dim);
+  EXPECT_EQ(joiner->VocabSize(), vocab_size);
+
+  int32_t num_frames = 3;
+  auto e = Random(num_frames * encoder_dim, 6);
+  auto d = Random(decoder_dim, 7);
+
+  std::vector<float> e_proj(num_frames * joiner_dim);
+  std::vector<float> d_proj(joiner_dim);
+  joiner->ProjectEncoder(e.data(), num_frames, e_proj.data());
+  joiner->ProjectDecoder(d.data(), 1, d_proj.data());
+
+  auto d1 = Linear(wd, {}, d, joiner_dim);
+  for (int32_t t = 0; t != num_frames; ++t) {
+    std::vector<float> et(e.begin() + t * encoder_dim,
+                          e.begin() + (t + 1) * encoder_dim);
+    auto e1 = Linear(we, be, et, joiner_dim);
+
+    std::vector<float> hidden(joiner_dim);
+    for (int32_t i = 0; i != joiner_dim; ++i) {
+      hidden[i] = std::tanh(e1[i] + d1[i]);
+    }
+    auto expected = Linear(wo, bo, hidden, vocab_size);
+
+    std::vector<float> logit(vocab_size);
+    joiner->Run(e_proj.data() + t * joiner_dim, d_proj.data(), logit.data());
+
+    for (int32_t i = 0; i != vocab_size; ++i) {
+      EXPECT_NEAR(logit[i], expected[i], 1e-5);
+    }
+  }
+}
+
+TEST(NativeJoiner, Unsupported) {
+  std::string graph;
+  graph += Node("Add", {"encoder_out", "decoder_out"}, "sum");
+  graph += Node("Relu", {"sum"}, "hidden");
+  graph += Node("MatMul", {"hidden", "w"}, "logit");
+  graph += Bytes(5, Tensor("w", {2, 3}, Random(6, 1)));
+  graph += Bytes(11, ValueInfo("encoder_out"));
+  graph += Bytes(11, ValueInfo("decoder_out"));
+  graph += Bytes(12, ValueInfo("logit"));
+
+  std::string model = Int(1, 8) + Bytes(7, graph);
+  EXPECT_EQ(NativeJoiner::Create(model.data(), model.size(), false), nullptr);
+
+  std::string garbage = "not an onnx model";
+  EXPECT_EQ(NativeJoiner::Create(garbage.data(), garbage.size(), false),
+            nullptr);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,857 @@
+// sherpa-onnx/csrc/native-joiner.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/native-joiner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define SHERPA_ONNX_NATIVE_JOINER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SHERPA_ONNX_NATIVE_JOINER_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+// y = W x + b. The weight is stored as (out_dim, in_dim) in row-major.
+// An empty weight means the identity.
+struct JoinerLinear {
+  std::vector<float> weight;
+  std::vector<float> bias;
+  int32_t in_dim = 0;
+  int32_t out_dim = 0;
+};
+
+// A minimal reader of the protobuf wire format, enough to get the nodes
+// and the initializers of an ONNX model.
+class ProtoReader {
+ public:
+  ProtoReader(const uint8_t *p, size_t n) : p_(p), end_(p + n) {}
+
+  bool Ok() const { return ok_; }
+
+  // Read the next key. Return false at the end or on error.
+  bool Next(int32_t *field, int32_t *wire_type) {
+    if (!ok_ || p_ >= end_) {
+      return false;
+    }
+
+    uint64_t key = Varint();
+    *field = static_cast<int32_t>(key >> 3);
+    *wire_type = static_cast<int32_t>(key & 7);
+    return ok_;
+  }
+
+  uint64_t Varint() {
+    uint64_t ans = 0;
+    for (int32_t shift = 0; shift < 64; shift += 7) {
+      if (p_ >= end_) {
+        break;
+      }
+
+      uint8_t b = *p_++;
+      ans |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) {
+        return ans;
+      }
+    }
+
+    ok_ = false;
+    return 0;
+  }
+
+  // For wire type 2
+  ProtoReader Message() {
+    auto n = Varint();
+    if (!ok_ || n > static_cast<uint64_t>(end_ - p_)) {
+      ok_ = false;
+      return {nullptr, 0};
+    }
+
+    ProtoReader ans(p_, n);
+    p_ += n;
+    return ans;
+  }
+
+  std::string String() {
+    ProtoReader r = Message();
+    if (!r.p_) {
+      return {};
+    }
+    return {reinterpret_cast<const char *>(r.p_), r.Size()};
+  }
+
+  float Fixed32AsFloat() {
+    float f = 0;
+    if (end_ - p_ < 4) {
+      ok_ = false;
+      return f;
+    }
+
+    std::memcpy(&f, p_, 4);
+    p_ += 4;
+    return f;
+  }
+
+  void Skip(int32_t wire_type) {
+    switch (wire_type) {
+      case 0:
+        Varint();
+        break;
+      case 1:
+        Advance(8);
+        break;
+      case 2:
+        Message();
+        break;
+      case 5:
+        Advance(4);
+        break;
+      default:
+        ok_ = false;
+    }
+  }
+
+  size_t Size() const { return end_ - p_; }
+
+ private:
+  void Advance(size_t n) {
+    if (static_cast<size_t>(end_ - p_) < n) {
+      ok_ = false;
+      return;
+    }
+    p_ += n;
+  }
+
+ private:
+  const uint8_t *p_;
+  const uint8_t *end_;
+  bool ok_ = true;
+};
+
+// Subset of onnx.TensorProto. Only float tensors stored in the model
+// file are supported.
+struct Tensor {
+  std::string name;
+  std::vector<int64_t> dims;
+  std::vector<float> data;
+  bool supported = true;
+};
+
+// Subset of onnx.NodeProto
+struct Node {
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  std::string op_type;
+  std::unordered_map<std::string, int64_t> ints;
+  std::unordered_map<std::string, float> floats;
+  Tensor value;  // for Constant nodes
+};
+
+// Subset of onnx.GraphProto
+struct Graph {
+  std::vector<Node> nodes;
+  std::vector<Tensor> initializers;
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+};
+
+constexpr int32_t kOnnxFloat = 1;
+constexpr int32_t kOnnxExternalData = 1;
+
+Tensor ParseTensor(ProtoReader r) {
+  Tensor t;
+  int32_t data_type = 0;
+  std::string raw_data;
+
+  int32_t field, wire_type;
+  while (r.Next(&field, &wire_type)) {
+    if (field == 1 && wire_type == 0) {  // dims
+      t.dims.push_back(static_cast<int64_t>(r.Varint()));
+    } else if (field == 1 && wire_type == 2) {  // packed dims
+      ProtoReader dims = r.Message();
+      while (dims.Size() > 0 && dims.Ok()) {
+        t.dims.push_back(static_cast<int64_t>(dims.Varint()));
+      }
+    } else if (field == 2 && wire_type == 0) {
+      data_type = static_cast<int32_t>(r.Varint());
+    } else if (field == 4 && wire_type == 2) {  // packed float_data
+      ProtoReader data = r.Message();
+      while (data.Size() > 0 && data.Ok()) {
+        t.data.push_back(data.Fixed32AsFloat());
+      }
+    } else if (field == 4 && wire_type == 5) {
+      t.data.push_back(r.Fixed32AsFloat());
+    } else if (field == 8 && wire_type == 2) {
+      t.name = r.String();
+    } else if (field == 9 && wire_type == 2) {
+      raw_data = r.String();
+    } else if (field == 14 && wire_type == 0) {
+      if (r.Varint() == kOnnxExternalData) {
+        t.supported = false;
+      }
+    } else {
+      r.Skip(wire_type);
+    }
+  }
+
+  if (!r.Ok() || data_type != kOnnxFloat) {
+    t.supported = false;
+  }
+
+  if (t.supported && !raw_data.empty()) {
+    t.data.resize(raw_data.size() / sizeof(float));
+    std::memcpy(t.data.data(), raw_data.data(),
+                t.data.size() * sizeof(float));
+  }
+
+  int64_t numel = 1;
+  for (auto d : t.dims) {
+    numel *= d;
+  }
+
+  if (numel != static_cast<int64_t>(t.data.size())) {
+    t.supported = false;
+  }
+
+  return t;
+}
+
+void ParseAttribute(ProtoReader r, Node *node) {
+  std::string name;
+  float f = 0;
+  int64_t i = 0;
+  bool has_f = false;
+  bool has_i = false;
+  bool has_t = false;
+  Tensor t;
+
+  int32_t field, wire_type;
+  while (r.Next(&field, &wire_type)) {
+    if (field == 1 && wire_type == 2) {
+      name = r.String();
+    } else if (field == 2 && wire_type == 5) {
+      f = r.Fixed32AsFloat();
+      has_f = true;
+    } else if (field == 3 && wire_type == 0) {
+      i = static_cast<int64_t>(r.Varint());
+      has_i = true;
+    } else if (field == 5 && wire_type == 2) {
+      t = ParseTensor(r.Message());
+      has_t = true;
+    } else {
+      r.Skip(wire_type);
+    }
+  }
+
+  if (has_f) {
+    node->floats[name] = f;
+  }
+
+  if (has_i) {
+    node->ints[name] = i;
+  }
+
+  if (has_t && name == "value") {
+    node->value = std::move(t);
+  }
+}
+
+Node ParseNode(ProtoReader r) {
+  Node node;
+  node.value.supported = false;
+
+  int32_t field, wire_type;
+  while (r.Next(&field, &wire_type)) {
+    if (field == 1 && wire_type == 2) {
+      node.inputs.push_back(r.String());
+    } else if (field == 2 && wire_type == 2) {
+      node.outputs.push_back(r.String());
+    } else if (field == 4 && wire_type == 2) {
+      node.op_type = r.String();
+    } else if (field == 5 && wire_type == 2) {
+      ParseAttribute(r.Message(), &node);
+    } else {
+      r.Skip(wire_type);
+    }
+  }
+
+  return node;
+}
+
+// Return the name of a ValueInfoProto
+std::string ParseValueInfoName(ProtoReader r) {
+  std::string name;
+
+  int32_t field, wire_type;
+  while (r.Next(&field, &wire_type)) {
+    if (field == 1 && wire_type == 2) {
+      name = r.String();
+    } else {
+      r.Skip(wire_type);
+    }
+  }
+
+  return name;
+}
+
+bool ParseModel(const void *model_data, size_t model_data_length,
+                Graph *graph) {
+  ProtoReader model(reinterpret_cast<const uint8_t *>(model_data),
+                    model_data_length);
+
+  bool found = false;
+  int32_t field, wire_type;
+  while (model.Next(&field, &wire_type)) {
+    if (field != 7 || wire_type != 2) {
+      model.Skip(wire_type);
+      continue;
+    }
+
+    found = true;
+    ProtoReader g = model.Message();
+    while (g.Next(&field, &wire_type)) {
+      if (field == 1 && wire_type == 2) {
+        graph->nodes.push_back(ParseNode(g.Message()));
+      } else if (field == 5 && wire_type == 2) {
+        graph->initializers.push_back(ParseTensor(g.Message()));
+      } else if (field == 11 && wire_type == 2) {
+        graph->inputs.push_back(ParseValueInfoName(g.Message()));
+      } else if (field == 12 && wire_type == 2) {
+        graph->outputs.push_back(ParseValueInfoName(g.Message()));
+      } else {
+        g.Skip(wire_type);
+      }
+    }
+
+    if (!g.Ok()) {
+      return false;
+    }
+  }
+
+  return found && model.Ok();
+}
+
+// Match a Linear layer that is exported either as Gemm or as MatMul
+// followed by an optional Add.
+class GraphMatcher {
+ public:
+  explicit GraphMatcher(Graph *graph) {
+    for (auto &t : graph->initializers) {
+      constants_[t.name] = &t;
+    }
+
+    for (auto &node : graph->nodes) {
+      if (node.op_type == "Constant" && node.outputs.size() == 1) {
+        constants_[node.outputs[0]] = &node.value;
+        continue;
+      }
+
+      for (const auto &name : node.outputs) {
+        producers_[name] = &node;
+      }
+    }
+  }
+
+  const Tensor *Constant(const std::string &name) const {
+    auto it = constants_.find(name);
+    if (it == constants_.end() || !it->second->supported) {
+      return nullptr;
+    }
+    return it->second;
+  }
+
+  const Node *Producer(const std::string &name, const char *op_type) const {
+    auto it = producers_.find(name);
+    if (it == producers_.end() || it->second->op_type != op_type) {
+      return nullptr;
+    }
+    return it->second;
+  }
+
+  bool IsConstant(const std::string &name) const {
+    return constants_.count(name) != 0;
+  }
+
+  // If `out` is the output of a linear layer, return its input in `in`
+  bool MatchLinear(const std::string &out, JoinerLinear *linear,
+                   std::string *in) const {
+    if (const Node *gemm = Producer(out, "Gemm")) {
+      return MatchGemm(*gemm, linear, in);
+    }
+
+    const Node *matmul = Producer(out, "MatMul");
+    const Tensor *bias = nullptr;
+
+    if (const Node *add = Producer(out, "Add")) {
+      if (add->inputs.size() != 2) {
+        return false;
+      }
+
+      for (int32_t i = 0; i != 2; ++i) {
+        if ((bias = Constant(add->inputs[i]))) {
+          matmul = Producer(add->inputs[1 - i], "MatMul");
+          break;
+        }
+      }
+    }
+
+    if (!matmul || matmul->inputs.size() != 2) {
+      return false;
+    }
+
+    // MatMul stores the weight as (in_dim, out_dim)
+    const Tensor *w = Constant(matmul->inputs[1]);
+    if (!w || w->dims.size() != 2) {
+      return false;
+    }
+
+    if (!SetWeight(*w, /*transposed*/ true, linear)) {
+      return false;
+    }
+
+    if (bias && !SetBias(*bias, linear)) {
+      return false;
+    }
+
+    *in = matmul->inputs[0];
+    return true;
+  }
+
+ private:
+  bool MatchGemm(const Node &gemm, JoinerLinear *linear,
+                 std::string *in) const {
+    auto attr = [&gemm](const char *name, int64_t default_value) {
+      auto it = gemm.ints.find(name);
+      return it == gemm.ints.end() ? default_value : it->second;
+    };
+
+    auto scale = [&gemm](const char *name) {
+      auto it = gemm.floats.find(name);
+      return it == gemm.floats.end() ? 1.0f : it->second;
+    };
+
+    if (attr("transA", 0) != 0 || scale("alpha") != 1 || scale("beta") != 1 ||
+        gemm.inputs.size() < 2) {
+      return false;
+    }
+
+    const Tensor *w = Constant(gemm.inputs[1]);
+    if (!w || w->dims.size() != 2) {
+      return false;
+    }
+
+    if (!SetWeight(*w, attr("transB", 0) == 0, linear)) {
+      return false;
+    }
+
+    if (gemm.inputs.size() > 2 && !gemm.inputs[2].empty()) {
+      const Tensor *bias = Constant(gemm.inputs[2]);
+      if (!bias || !SetBias(*bias, linear)) {
+        return false;
+      }
+    }
+
+    *in = gemm.inputs[0];
+    return true;
+  }
+
+  // If transposed is true, w is (in_dim, out_dim); otherwise, it is
+  // (out_dim, in_dim)
+  static bool SetWeight(const Tensor &w, bool transposed,
+                        JoinerLinear *linear) {
+    int32_t rows = static_cast<int32_t>(w.dims[0]);
+    int32_t cols = static_cast<int32_t>(w.dims[1]);
+
+    if (!transposed) {
+      linear->out_dim = rows;
+      linear->in_dim = cols;
+      linear->weight = w.data;
+      return true;
+    }
+
+    linear->in_dim = rows;
+    linear->out_dim = cols;
+    linear->weight.resize(w.data.size());
+    for (int32_t r = 0; r != rows; ++r) {
+      for (int32_t c = 0; c != cols; ++c) {
+        linear->weight[c * rows + r] = w.data[r * cols + c];
+      }
+    }
+
+    return true;
+  }
+
+  static bool SetBias(const Tensor &b, JoinerLinear *linear) {
+    if (static_cast<int32_t>(b.data.size()) != linear->out_dim) {
+      return false;
+    }
+
+    linear->bias = b.data;
+    return true;
+  }
+
+ private:
+  std::unordered_map<std::string, const Tensor *> constants_;
+  std::unordered_map<std::string, const Node *> producers_;
+};
+
+// y[r] = b[r] + sum_c w[r][c] * x[c] for r in [0, rows). b can be nullptr.
+using GemvFunc = void (*)(const float *w, const float *b, const float *x,
+                          int32_t rows, int32_t cols, float *y);
+
+void GemvScalar(const float *w, const float *b, const float *x, int32_t rows,
+                int32_t cols, float *y) {
+  for (int32_t r = 0; r != rows; ++r, w += cols) {
+    float sum = b ? b[r] : 0;
+    for (int32_t c = 0; c != cols; ++c) {
+      sum += w[c] * x[c];
+    }
+    y[r] = sum;
+  }
+}
+
+#if SHERPA_ONNX_NATIVE_JOINER_AVX2
+__attribute__((target("avx2,fma"))) inline float HorizontalSum(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+// Four rows at a time so that each load of x is used four times
+__attribute__((target("avx2,fma"))) void GemvAvx2(const float *w,
+                                                  const float *b,
+                                                  const float *x, int32_t rows,
+                                                  int32_t cols, float *y) {
+  int32_t cols8 = cols & ~7;
+  int32_t r = 0;
+  for (; r + 4 <= rows; r += 4) {
+    const float *w0 = w + r * cols;
+    const float *w1 = w0 + cols;
+    const float *w2 = w1 + cols;
+    const float *w3 = w2 + cols;
+
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+
+    int32_t c = 0;
+    for (; c < cols8; c += 8) {
+      __m256 xv = _mm256_loadu_ps(x + c);
+      acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w0 + c), xv, acc0);
+      acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(w1 + c), xv, acc1);
+      acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(w2 + c), xv, acc2);
+      acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(w3 + c), xv, acc3);
+    }
+
+    float s0 = HorizontalSum(acc0);
+    float s1 = HorizontalSum(acc1);
+    float s2 = HorizontalSum(acc2);
+    float s3 = HorizontalSum(acc3);
+
+    for (; c < cols; ++c) {
+      s0 += w0[c] * x[c];
+      s1 += w1[c] * x[c];
+      s2 += w2[c] * x[c];
+      s3 += w3[c] * x[c];
+    }
+
+    y[r] = s0 + (b ? b[r] : 0);
+    y[r + 1] = s1 + (b ? b[r + 1] : 0);
+    y[r + 2] = s2 + (b ? b[r + 2] : 0);
+    y[r + 3] = s3 + (b ? b[r + 3] : 0);
+  }
+
+  if (r < rows) {
+    GemvScalar(w + r * cols, b ? b + r : nullptr, x, rows - r, cols, y + r);
+  }
+}
+#endif
+
+#if SHERPA_ONNX_NATIVE_JOINER_NEON
+inline float HorizontalSum(float32x4_t v) {
+#if defined(__aarch64__)
+  return vaddvq_f32(v);
+#else
+  float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+}
+
+inline float32x4_t MultiplyAdd(float32x4_t acc, float32x4_t a,
+                               float32x4_t b) {
+#if defined(__aarch64__)
+  return vfmaq_f32(acc, a, b);
+#else
+  return vmlaq_f32(acc, a, b);
+#endif
+}
+
+// Four rows at a time so that each load of x is used four times
+void GemvNeon(const float *w, const float *b, const float *x, int32_t rows,
+              int32_t cols, float *y) {
+  int32_t cols4 = cols & ~3;
+  int32_t r = 0;
+  for (; r + 4 <= rows; r += 4) {
+    const float *w0 = w + r * cols;
+    const float *w1 = w0 + cols;
+    const float *w2 = w1 + cols;
+    const float *w3 = w2 + cols;
+
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    float32x4_t acc2 = vdupq_n_f32(0);
+    float32x4_t acc3 = vdupq_n_f32(0);
+
+    int32_t c = 0;
+    for (; c < cols4; c += 4) {
+      float32x4_t xv = vld1q_f32(x + c);
+      acc0 = MultiplyAdd(acc0, vld1q_f32(w0 + c), xv);
+      acc1 = MultiplyAdd(acc1, vld1q_f32(w1 + c), xv);
+      acc2 = MultiplyAdd(acc2, vld1q_f32(w2 + c), xv);
+      acc3 = MultiplyAdd(acc3, vld1q_f32(w3 + c), xv);
+    }
+
+    float s0 = HorizontalSum(acc0);
+    float s1 = HorizontalSum(acc1);
+    float s2 = HorizontalSum(acc2);
+    float s3 = HorizontalSum(acc3);
+
+    for (; c < cols; ++c) {
+      s0 += w0[c] * x[c];
+      s1 += w1[c] * x[c];
+      s2 += w2[c] * x[c];
+      s3 += w3[c] * x[c];
+    }
+
+    y[r] = s0 + (b ? b[r] : 0);
+    y[r + 1] = s1 + (b ? b[r + 1] : 0);
+    y[r + 2] = s2 + (b ? b[r + 2] : 0);
+    y[r + 3] = s3 + (b ? b[r + 3] : 0);
+  }
+
+  if (r < rows) {
+    GemvScalar(w + r * cols, b ? b + r : nullptr, x, rows - r, cols, y + r);
+  }
+}
+#endif
+
+GemvFunc SelectGemv() {
+#if SHERPA_ONNX_NATIVE_JOINER_AVX2
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return GemvAvx2;
+  }
+#endif
+
+#if SHERPA_ONNX_NATIVE_JOINER_NEON
+  return GemvNeon;
+#endif
+
+  return GemvScalar;
+}
+
+}  // namespace
+
+class NativeJoiner::Impl {
+ public:
+  Impl(JoinerLinear encoder_proj, JoinerLinear decoder_proj,
+       JoinerLinear output_linear)
+      : encoder_proj_(std::move(encoder_proj)),
+        decoder_proj_(std::move(decoder_proj)),
+        output_linear_(std::move(output_linear)),
+        gemv_(SelectGemv()) {}
+
+  int32_t EncoderDim() const { return encoder_proj_.in_dim; }
+
+  int32_t DecoderDim() const { return decoder_proj_.in_dim; }
+
+  int32_t JoinerDim() const { return output_linear_.in_dim; }
+
+  int32_t VocabSize() const { return output_linear_.out_dim; }
+
+  void ProjectEncoder(const float *encoder_out, int32_t n, float *out) const {
+    Project(encoder_proj_, encoder_out, n, out);
+  }
+
+  void ProjectDecoder(const float *decoder_out, int32_t n, float *out) const {
+    Project(decoder_proj_, decoder_out, n, out);
+  }
+
+  void Run(const float *encoder_proj, const float *decoder_proj,
+           float *logit) const {
+    // Reused across calls, so there is no allocation per frame
+    thread_local std::vector<float> hidden;
+
+    int32_t dim = JoinerDim();
+    hidden.resize(dim);
+
+    for (int32_t i = 0; i != dim; ++i) {
+      hidden[i] = std::tanh(encoder_proj[i] + decoder_proj[i]);
+    }
+
+    Apply(output_linear_, hidden.data(), logit);
+  }
+
+ private:
+  void Project(const JoinerLinear &linear, const float *in, int32_t n,
+               float *out) const {
+    if (linear.weight.empty()) {
+      std::copy(in, in + n * linear.in_dim, out);
+      return;
+    }
+
+    for (int32_t i = 0; i != n; ++i) {
+      Apply(linear, in + i * linear.in_dim, out + i * linear.out_dim);
+    }
+  }
+
+  void Apply(const JoinerLinear &linear, const float *x, float *y) const {
+    gemv_(linear.weight.data(), linear.bias.empty() ? nullptr
+                                                    : linear.bias.data(),
+          x, linear.out_dim, linear.in_dim, y);
+  }
+
+ private:
+  JoinerLinear encoder_proj_;
+  JoinerLinear decoder_proj_;
+  JoinerLinear output_linear_;
+  GemvFunc gemv_;
+};
+
+NativeJoiner::NativeJoiner(std::unique_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
+NativeJoiner::~NativeJoiner() = default;
+
+std::unique_ptr<NativeJoiner> NativeJoiner::Create(const void *model_data,
+                                                   size_t model_data_length,
+                                                   bool debug) {
+  auto fail = [debug](const char *reason) {
+    if (debug) {
+      SHERPA_ONNX_LOGE("Use onnxruntime for the joiner: %s", reason);
+    }
+    return nullptr;
+  };
+
+  Graph graph;
+  if (!ParseModel(model_data, model_data_length, &graph)) {
+    return fail("failed to parse the model");
+  }
+
+  GraphMatcher matcher(&graph);
+
+  // Older models also list initializers as graph inputs
+  std::vector<std::string> inputs;
+  for (const auto &name : graph.inputs) {
+    if (!matcher.IsConstant(name)) {
+      inputs.push_back(name);
+    }
+  }
+
+  if (inputs.size() != 2 || graph.outputs.size() != 1) {
+    return fail("expect 2 inputs and 1 output");
+  }
+
+  JoinerLinear output_linear;
+  std::string hidden;
+  if (!matcher.MatchLinear(graph.outputs[0], &output_linear, &hidden)) {
+    return fail("the output is not computed by a linear layer");
+  }
+
+  const Node *tanh_node = matcher.Producer(hidden, "Tanh");
+  if (!tanh_node || tanh_node->inputs.size() != 1) {
+    return fail("expect tanh before the output layer");
+  }
+
+  const Node *add = matcher.Producer(tanh_node->inputs[0], "Add");
+  if (!add || add->inputs.size() != 2) {
+    return fail("expect add before tanh");
+  }
+
+  // projections[0] is for encoder_out, which is the first input of the
+  // joiner model, and projections[1] is for decoder_out
+  JoinerLinear projections[2];
+  bool matched[2] = {false, false};
+
+  for (const auto &name : add->inputs) {
+    std::string in = name;
+    JoinerLinear linear;
+
+    if (name != inputs[0] && name != inputs[1] &&
+        !matcher.MatchLinear(name, &linear, &in)) {
+      return fail("unsupported projection");
+    }
+
+    int32_t k = in == inputs[0] ? 0 : (in == inputs[1] ? 1 : -1);
+    if (k == -1 || matched[k]) {
+      return fail("the inputs are not added");
+    }
+
+    if (linear.weight.empty()) {
+      // No projection. Use the identity.
+      linear.in_dim = linear.out_dim = output_linear.in_dim;
+    }
+
+    if (linear.out_dim != output_linear.in_dim) {
+      return fail("dim mismatch");
+    }
+
+    projections[k] = std::move(linear);
+    matched[k] = true;
+  }
+
+  if (debug) {
+    SHERPA_ONNX_LOGE(
+        "Use the native joiner. encoder_dim: %d, decoder_dim: %d, "
+        "joiner_dim: %d, vocab_size: %d",
+        projections[0].in_dim, projections[1].in_dim, output_linear.in_dim,
+        output_linear.out_dim);
+  }
+
+  return std::unique_ptr<NativeJoiner>(new NativeJoiner(std::make_unique<Impl>(
+      std::move(projections[0]), std::move(projections[1]),
+      std::move(output_linear))));
+}
+
+int32_t NativeJoiner::EncoderDim() const { return impl_->EncoderDim(); }
+
+int32_t NativeJoiner::DecoderDim() const { return impl_->DecoderDim(); }
+
+int32_t NativeJoiner::JoinerDim() const { return impl_->JoinerDim(); }
+
+int32_t NativeJoiner::VocabSize() const { return impl_->VocabSize(); }
+
+void NativeJoiner::ProjectEncoder(const float *encoder_out, int32_t n,
+                                  float *out) const {
+  impl_->ProjectEncoder(encoder_out, n, out);
+}
+
+void NativeJoiner::ProjectDecoder(const float *decoder_out, int32_t n,
+                                  float *out) const {
+  impl_->ProjectDecoder(decoder_out, n, out);
+}
+
+void NativeJoiner::Run(const float *encoder_proj, const float *decoder_proj,
+                       float *logit) const {
+  impl_->Run(encoder_proj, decoder_proj, logit);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,89 @@
+// sherpa-onnx/csrc/native-joiner.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_NATIVE_JOINER_H_
+#define SHERPA_ONNX_CSRC_NATIVE_JOINER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Run the joiner of a transducer model without onnxruntime.
+ *
+ * The joiner of icefall computes
+ *
+ *   logit = output_linear(tanh(encoder_proj(encoder_out) +
+ *                              decoder_proj(decoder_out)))
+ *
+ * where encoder_proj and decoder_proj are optional (they are usually
+ * exported as part of the encoder and decoder models).
+ *
+ * Create() reads the weights from the initializers of the joiner model.
+ * Since the projections depend on only one of the inputs, callers compute
+ * them once per chunk or per emission with ProjectEncoder() and
+ * ProjectDecoder(), and then call Run() for each (frame, hypothesis) pair.
+ * The linear layers use AVX2 or NEON kernels if the CPU supports them.
+ *
+ * All methods are const and thread-safe.
+ */
+class NativeJoiner {
+ public:
+  ~NativeJoiner();
+
+  /** Load the joiner from the content of joiner.onnx.
+   *
+   * @return Return nullptr if the model does not match the pattern above,
+   *         e.g., if it is quantized. The caller should use onnxruntime
+   *         in that case.
+   */
+  static std::unique_ptr<NativeJoiner> Create(const void *model_data,
+                                              size_t model_data_length,
+                                              bool debug);
+
+  // Dim of the encoder_out input of the joiner model
+  int32_t EncoderDim() const;
+
+  // Dim of the decoder_out input of the joiner model
+  int32_t DecoderDim() const;
+
+  // Dim of the projections, i.e., the input dim of output_linear
+  int32_t JoinerDim() const;
+
+  int32_t VocabSize() const;
+
+  /**
+   * @param encoder_out  A 2-d array of shape (n, EncoderDim())
+   * @param n  Number of rows in encoder_out
+   * @param out  On return, it is a 2-d array of shape (n, JoinerDim())
+   */
+  void ProjectEncoder(const float *encoder_out, int32_t n, float *out) const;
+
+  /**
+   * @param decoder_out  A 2-d array of shape (n, DecoderDim())
+   * @param n  Number of rows in decoder_out
+   * @param out  On return, it is a 2-d array of shape (n, JoinerDim())
+   */
+  void ProjectDecoder(const float *decoder_out, int32_t n, float *out) const;
+
+  /**
+   * @param encoder_proj  An array of JoinerDim() from ProjectEncoder()
+   * @param decoder_proj  An array of JoinerDim() from ProjectDecoder()
+   * @param logit  On return, it contains VocabSize() logits
+   */
+  void Run(const float *encoder_proj, const float *decoder_proj,
+           float *logit) const;
+
+ private:
+  class Impl;
+  explicit NativeJoiner(std::unique_ptr<Impl> impl);
+
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_NATIVE_JOINER_H_
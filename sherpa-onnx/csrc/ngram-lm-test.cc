@@ -0,0 +1,119 @@
+// sherpa-onnx/csrc/ngram-lm-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/ngram-lm.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static const char *kArpa = R"(
+\data\
+ngram 1=5
+ngram 2=4
+ngram 3=3
+
+\1-grams:
+-1.0	<s>	-0.5
+-0.6	</s>
+-0.7	1	-0.3
+-0.8	2	-0.2
+-0.9	3
+
+\2-grams:
+-0.3	<s> 1	-0.1
+-0.4	1 2	-0.15
+-0.5	2 3
+-0.2	2 </s>
+
+\3-grams:
+-0.1	<s> 1 2
+-0.05	1 2 3
+-0.02	3 1 2
+
+\end\
+)";
+
+static float Score(const NGramLM &lm, const std::vector<int64_t> &tokens,
+                   bool add_end) {
+  return lm.ScoreSequence(tokens.data(), tokens.size(), add_end) /
+         std::log(10.0f);
+}
+
+static void TestScores(const NGramLM &lm) {
+  EXPECT_EQ(lm.Order(), 3);
+
+  // trigrams
+  EXPECT_NEAR(Score(lm, {1, 2, 3}, false), -0.3 - 0.1 - 0.05, 1e-3);
+
+  // back off to the unigram </s>
+  EXPECT_NEAR(Score(lm, {1, 2, 3}, true), -0.3 - 0.1 - 0.05 - 0.6, 1e-3);
+
+  // back-off weights of <s> and 2
+  EXPECT_NEAR(Score(lm, {2, 2}, false), (-0.5 - 0.8) + (-0.2 - 0.8), 1e-3);
+  EXPECT_NEAR(Score(lm, {3, 1}, false), (-0.5 - 0.9) + (-0.7), 1e-3);
+
+  // "3 1" is not in the ARPA file but "3 1 2" is
+  EXPECT_NEAR(Score(lm, {3, 1, 2}, false), (-0.5 - 0.9) + (-0.7) + (-0.02),
+              1e-3);
+
+  // Tokens that are not in the LM
+  EXPECT_NEAR(Score(lm, {7}, false), -0.5 - 7, 1e-3);
+  EXPECT_NEAR(Score(lm, {0}, false), -0.5 - 7, 1e-3);
+
+  // Incremental scoring gives the same result
+  NGramLMState state;
+  float sum = 0;
+  for (int32_t t : {3, 1, 2, 3}) {
+    sum += lm.Score(state, t, &state);
+  }
+  sum += lm.ScoreEnd(state);
+  EXPECT_NEAR(sum, lm.ScoreSequence(std::vector<int64_t>{3, 1, 2, 3}.data(), 4,
+                                    true),
+              1e-5);
+
+  // The state keeps at most order - 1 words
+  EXPECT_EQ(state.num_words, 2);
+  EXPECT_EQ(state.words[0], 3);
+  EXPECT_EQ(state.words[1], 2);
+}
+
+TEST(NGramLM, Arpa) {
+  std::istringstream is(kArpa);
+  EXPECT_TRUE(NGramLM::IsNGramLM(is));
+  NGramLM lm(is);
+  TestScores(lm);
+}
+
+TEST(NGramLM, Binary) {
+  std::istringstream is(kArpa);
+  NGramLM lm(is);
+
+  std::string filename = "ngram-lm-test.bin";
+  lm.Save(filename);
+  EXPECT_TRUE(NGramLM::IsNGramLM(filename));
+
+  {
+    NGramLM lm2(filename);
+    TestScores(lm2);
+  }
+
+  {
+    std::ifstream is(filename, std::ios::binary);
+    EXPECT_TRUE(NGramLM::IsNGramLM(is));
+    NGramLM lm3(is);
+    TestScores(lm3);
+  }
+
+  std::remove(filename.c_str());
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,744 @@
+// sherpa-onnx/csrc/ngram-lm.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/ngram-lm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/mapped-file.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'H', 'N', 'G', 'R', 'A', 'M', '1'};
+constexpr int32_t kVersion = 1;
+
+// log10 probability of tokens that are not in the ARPA file if it
+// does not contain <unk>
+constexpr float kOovLog10Prob = -7.0f;
+
+constexpr float kLn10 = 2.302585092994046f;
+
+// Layout of the binary format:
+//
+//   Header
+//   Entry[counts[0] + 1]  // unigrams, indexed by word ID
+//   Entry[counts[1] + 1]  // bigrams
+//   ...
+//
+// The last entry of each order is a sentinel so that the children of
+// entry i of order k are
+// [entries[k][i].child_begin, entries[k][i + 1].child_begin) of order k + 1.
+//
+// The trie is keyed by the reversed n-gram, i.e., the children of the
+// entry of (h2, ..., hk, w) are the entries of (h1, h2, ..., hk, w) and
+// they are sorted by h1. Walking from the unigram of w through its most
+// recent history words visits longer and longer n-grams ending with w.
+struct Header {
+  char magic[8];
+  int32_t version;
+  int32_t order;
+
+  // Token IDs are in [0, num_words - 3). <s>, </s> and <unk> follow them
+  int32_t num_words;
+  int32_t bos;
+  int32_t eos;
+  int32_t unk;
+
+  // counts[k] is the number of (k+1)-grams
+  int64_t counts[kNGramLMMaxOrder];
+
+  // Quantization of log10 probabilities and back-off weights of each
+  // order: value = min + q * step
+  float prob_min[kNGramLMMaxOrder];
+  float prob_step[kNGramLMMaxOrder];
+  float bow_min[kNGramLMMaxOrder];
+  float bow_step[kNGramLMMaxOrder];
+};
+
+struct Entry {
+  int32_t word;
+  uint16_t prob;
+  uint16_t bow;
+  uint32_t child_begin;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "");
+static_assert(sizeof(Entry) == 12, "");
+
+std::string Trim(const std::string &s) {
+  const char *ws = " \t\r\n";
+  auto begin = s.find_first_not_of(ws);
+  if (begin == std::string::npos) {
+    return {};
+  }
+  auto end = s.find_last_not_of(ws);
+  return s.substr(begin, end - begin + 1);
+}
+
+class ArpaBuilder {
+ public:
+  // Return the binary format of the ARPA file in is
+  std::vector<char> Build(std::istream &is) {
+    Parse(is);
+    MapWords();
+    FillClosure();
+    return Serialize();
+  }
+
+ private:
+  struct NGram {
+    float prob = 0;  // log10
+    float bow = 0;   // log10
+    int64_t index = 0;
+  };
+
+  // words are in the usual order, i.e., the predicted word is the last one
+  using NGramMap = std::map<std::vector<int32_t>, NGram>;
+
+  static constexpr int32_t kBos = -1;
+  static constexpr int32_t kEos = -2;
+  static constexpr int32_t kUnk = -3;
+
+  static bool ParseWord(const std::string &s, int32_t *word) {
+    if (s == "<s>") {
+      *word = kBos;
+    } else if (s == "</s>") {
+      *word = kEos;
+    } else if (s == "<unk>" || s == "<UNK>") {
+      *word = kUnk;
+    } else {
+      char *end = nullptr;
+      int64_t v = std::strtoll(s.c_str(), &end, 10);
+      if (s.empty() || *end != '\0' || v < 0 || v > (1 << 30)) {
+        return false;
+      }
+      *word = static_cast<int32_t>(v);
+    }
+    return true;
+  }
+
+  void Parse(std::istream &is) {
+    std::string line;
+    bool found_data = false;
+    while (std::getline(is, line)) {
+      if (Trim(line) == "\\data\\") {
+        found_data = true;
+        break;
+      }
+    }
+
+    if (!found_data) {
+      SHERPA_ONNX_LOGE("Invalid ARPA file: \\data\\ is not found");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    std::vector<int64_t> counts;
+    while (std::getline(is, line)) {
+      line = Trim(line);
+      if (line.empty()) {
+        if (counts.empty()) continue;
+        break;
+      }
+
+      int32_t k = 0;
+      long long count = 0;  // NOLINT
+      if (sscanf(line.c_str(), "ngram %d=%lld", &k, &count) != 2 ||
+          k != static_cast<int32_t>(counts.size()) + 1) {
+        SHERPA_ONNX_LOGE("Invalid ARPA header line: '%s'", line.c_str());
+        SHERPA_ONNX_EXIT(-1);
+      }
+      counts.push_back(count);
+    }
+
+    while (!counts.empty() && counts.back() == 0) {
+      counts.pop_back();
+    }
+
+    order_ = static_cast<int32_t>(counts.size());
+    if (order_ < 1 || order_ > kNGramLMMaxOrder) {
+      SHERPA_ONNX_LOGE("Expect the order of the LM in [1, %d]. Given: %d",
+                       kNGramLMMaxOrder, order_);
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    raw_.resize(order_);
+
+    for (int32_t k = 0; k != order_; ++k) {
+      std::string section = "\\" + std::to_string(k + 1) + "-grams:";
+      while (std::getline(is, line) && Trim(line) != section) {
+      }
+
+      if (!is) {
+        SHERPA_ONNX_LOGE("Invalid ARPA file: %s is not found",
+                         section.c_str());
+        SHERPA_ONNX_EXIT(-1);
+      }
+
+      raw_[k].reserve(counts[k]);
+
+      std::vector<std::string> fields;
+      for (int64_t i = 0; i < counts[k];) {
+        if (!std::getline(is, line)) {
+          SHERPA_ONNX_LOGE("Invalid ARPA file: too few %d-grams", k + 1);
+          SHERPA_ONNX_EXIT(-1);
+        }
+
+        SplitStringToVector(line, " \t", true, &fields);
+        if (fields.empty()) {
+          continue;
+        }
+
+        int32_t n = static_cast<int32_t>(fields.size());
+        if (n != k + 2 && n != k + 3) {
+          SHERPA_ONNX_LOGE("Invalid %d-gram line: '%s'", k + 1, line.c_str());
+          SHERPA_ONNX_EXIT(-1);
+        }
+
+        std::pair<std::vector<int32_t>, NGram> ngram;
+        ngram.second.prob = std::strtof(fields[0].c_str(), nullptr);
+        ngram.second.bow =
+            n == k + 3 ? std::strtof(fields[k + 2].c_str(), nullptr) : 0;
+
+        ngram.first.resize(k + 1);
+        for (int32_t j = 0; j <= k; ++j) {
+          if (!ParseWord(fields[j + 1], &ngram.first[j])) {
+            SHERPA_ONNX_LOGE(
+                "Words of the ARPA file must be token IDs, <s>, </s> or "
+                "<unk>. Given: '%s'",
+                fields[j + 1].c_str());
+            SHERPA_ONNX_EXIT(-1);
+          }
+          if (ngram.first[j] >= 0) {
+            max_token_ = std::max(max_token_, ngram.first[j]);
+          }
+        }
+
+        raw_[k].push_back(std::move(ngram));
+        ++i;
+      }
+    }
+  }
+
+  // Replace the placeholders of <s>, </s> and <unk> with real word IDs
+  void MapWords() {
+    num_words_ = max_token_ + 4;
+    bos_ = max_token_ + 1;
+    eos_ = max_token_ + 2;
+    unk_ = max_token_ + 3;
+
+    maps_.resize(order_);
+    for (int32_t k = 0; k != order_; ++k) {
+      for (auto &ngram : raw_[k]) {
+        for (auto &w : ngram.first) {
+          if (w == kBos) w = bos_;
+          if (w == kEos) w = eos_;
+          if (w == kUnk) w = unk_;
+        }
+        maps_[k][std::move(ngram.first)] = ngram.second;
+      }
+      raw_[k].clear();
+      raw_[k].shrink_to_fit();
+    }
+
+    // Every word gets a unigram so that they can be indexed by word ID
+    float unk_prob = kOovLog10Prob;
+    auto it = maps_[0].find({unk_});
+    if (it != maps_[0].end()) {
+      unk_prob = it->second.prob;
+    }
+
+    float min_prob = 0;
+    for (const auto &p : maps_[0]) {
+      if (p.first[0] != bos_) {
+        min_prob = std::min(min_prob, p.second.prob);
+      }
+    }
+
+    for (int32_t w = 0; w != num_words_; ++w) {
+      auto p = maps_[0].insert({{w}, NGram{}});
+      if (w == bos_) {
+        // <s> is never predicted. Its probability is usually -99, which
+        // would waste the range of the quantization
+        p.first->second.prob = min_prob;
+      } else if (p.second) {
+        p.first->second.prob = unk_prob;
+      }
+    }
+  }
+
+  // log10 P(words.back() | words[0..n-1)) computed with back-off
+  float BackoffProb(const std::vector<int32_t> &words) const {
+    int32_t n = static_cast<int32_t>(words.size());
+    auto it = maps_[n - 1].find(words);
+    if (it != maps_[n - 1].end()) {
+      return it->second.prob;
+    }
+
+    std::vector<int32_t> context(words.begin(), words.end() - 1);
+    float bow = 0;
+    auto c = maps_[n - 2].find(context);
+    if (c != maps_[n - 2].end()) {
+      bow = c->second.bow;
+    }
+
+    return bow + BackoffProb({words.begin() + 1, words.end()});
+  }
+
+  // Make sure the suffix and the prefix of every n-gram are in the LM.
+  // Missing ones are added with back-off probabilities and zero back-off
+  // weights, which does not change the distribution.
+  void FillClosure() {
+    for (int32_t k = order_ - 1; k >= 1; --k) {
+      std::vector<std::vector<int32_t>> missing;
+      for (const auto &p : maps_[k]) {
+        std::vector<int32_t> suffix(p.first.begin() + 1, p.first.end());
+        std::vector<int32_t> prefix(p.first.begin(), p.first.end() - 1);
+        if (!maps_[k - 1].count(suffix)) missing.push_back(std::move(suffix));
+        if (!maps_[k - 1].count(prefix)) missing.push_back(std::move(prefix));
+      }
+
+      for (auto &words : missing) {
+        if (maps_[k - 1].count(words)) {
+          continue;
+        }
+        NGram ngram;
+        ngram.prob = BackoffProb(words);
+        maps_[k - 1][std::move(words)] = ngram;
+      }
+    }
+  }
+
+  static void Quantize(const std::vector<float> &values, float *min,
+                       float *step) {
+    *min = 0;
+    *step = 0;
+    if (values.empty()) {
+      return;
+    }
+
+    auto p = std::minmax_element(values.begin(), values.end());
+    *min = *p.first;
+    *step = (*p.second - *p.first) / 65535;
+  }
+
+  static uint16_t QuantizeValue(float v, float min, float step) {
+    if (step == 0) {
+      return 0;
+    }
+    float q = std::round((v - min) / step);
+    return static_cast<uint16_t>(std::max(0.0f, std::min(q, 65535.0f)));
+  }
+
+  std::vector<char> Serialize() {
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.order = order_;
+    header.num_words = num_words_;
+    header.bos = bos_;
+    header.eos = eos_;
+    header.unk = unk_;
+
+    // Assign indexes. Unigrams are indexed by word ID. An n-gram of
+    // order k + 1 is sorted by (index of its suffix, its first word).
+    std::vector<std::vector<std::pair<std::pair<int64_t, int32_t>, NGram *>>>
+        sorted(order_);
+    for (int32_t k = 0; k != order_; ++k) {
+      header.counts[k] = static_cast<int64_t>(maps_[k].size());
+      sorted[k].reserve(maps_[k].size());
+
+      for (auto &p : maps_[k]) {
+        int64_t parent = -1;
+        if (k > 0) {
+          std::vector<int32_t> suffix(p.first.begin() + 1, p.first.end());
+          parent = maps_[k - 1].at(suffix).index;
+        }
+        sorted[k].push_back({{parent, p.first[0]}, &p.second});
+      }
+
+      std::sort(sorted[k].begin(), sorted[k].end(),
+                [](const auto &a, const auto &b) { return a.first < b.first; });
+
+      for (int64_t i = 0; i != static_cast<int64_t>(sorted[k].size()); ++i) {
+        sorted[k][i].second->index = i;
+      }
+
+      std::vector<float> probs;
+      std::vector<float> bows;
+      probs.reserve(sorted[k].size());
+      bows.reserve(sorted[k].size());
+      for (const auto &p : sorted[k]) {
+        probs.push_back(p.second->prob);
+        bows.push_back(p.second->bow);
+      }
+      Quantize(probs, &header.prob_min[k], &header.prob_step[k]);
+      Quantize(bows, &header.bow_min[k], &header.bow_step[k]);
+    }
+
+    size_t size = sizeof(Header);
+    for (int32_t k = 0; k != order_; ++k) {
+      size += (header.counts[k] + 1) * sizeof(Entry);
+    }
+
+    std::vector<char> buf(size);
+    std::memcpy(buf.data(), &header, sizeof(Header));
+
+    Entry *entries = reinterpret_cast<Entry *>(buf.data() + sizeof(Header));
+    for (int32_t k = 0; k != order_; ++k) {
+      int64_t n = header.counts[k];
+
+      // child_begin[i] is the number of children of entries before i
+      std::vector<uint32_t> child_begin(n + 1, 0);
+      if (k + 1 < order_) {
+        for (const auto &p : sorted[k + 1]) {
+          ++child_begin[p.first.first + 1];
+        }
+        for (int64_t i = 0; i != n; ++i) {
+          child_begin[i + 1] += child_begin[i];
+        }
+      }
+
+      for (int64_t i = 0; i != n; ++i) {
+        const auto &p = sorted[k][i];
+        Entry &e = entries[i];
+        e.word = p.first.second;
+        e.prob = QuantizeValue(p.second->prob, header.prob_min[k],
+                               header.prob_step[k]);
+        e.bow = QuantizeValue(p.second->bow, header.bow_min[k],
+                              header.bow_step[k]);
+        e.child_begin = child_begin[i];
+      }
+
+      entries[n] = Entry{-1, 0, 0, child_begin[n]};
+      entries += n + 1;
+    }
+
+    return buf;
+  }
+
+ private:
+  int32_t order_ = 0;
+  int32_t max_token_ = -1;
+  int32_t num_words_ = 0;
+  int32_t bos_ = 0;
+  int32_t eos_ = 0;
+  int32_t unk_ = 0;
+
+  std::vector<std::vector<std::pair<std::vector<int32_t>, NGram>>> raw_;
+  std::vector<NGramMap> maps_;
+};
+
+// Check the magic of the binary format without changing the read position
+bool IsBinaryNGramLM(std::istream &is) {
+  auto pos = is.tellg();
+  char magic[sizeof(kMagic)] = {};
+  is.read(magic, sizeof(magic));
+  bool ans = is && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+  is.clear();
+  is.seekg(pos);
+  return ans;
+}
+
+bool IsBinaryNGramLM(const std::string &filename) {
+  std::ifstream is(filename, std::ios::binary);
+  return is && IsBinaryNGramLM(is);
+}
+
+}  // namespace
+
+class NGramLM::Impl {
+ public:
+  explicit Impl(const std::string &filename) {
+    if (IsBinaryNGramLM(filename)) {
+      // n-grams are accessed randomly, so don't read the whole file ahead
+      file_ = GetSharedMappedFile(filename, true);
+      if (!file_) {
+        SHERPA_ONNX_LOGE("Failed to map '%s'", filename.c_str());
+        SHERPA_ONNX_EXIT(-1);
+      }
+      Init(file_->Data(), file_->Size());
+      return;
+    }
+
+    std::ifstream is(filename);
+    if (!is) {
+      SHERPA_ONNX_LOGE("Failed to open '%s'", filename.c_str());
+      SHERPA_ONNX_EXIT(-1);
+    }
+    InitFromArpa(is);
+  }
+
+  explicit Impl(std::istream &is) {
+    if (IsBinaryNGramLM(is)) {
+      buf_.assign(std::istreambuf_iterator<char>(is),
+                  std::istreambuf_iterator<char>());
+      Init(buf_.data(), buf_.size());
+      return;
+    }
+
+    InitFromArpa(is);
+  }
+
+  void Save(const std::string &filename) const {
+    std::ofstream os(filename, std::ios::binary);
+    os.write(data_, size_);
+    if (!os) {
+      SHERPA_ONNX_LOGE("Failed to write '%s'", filename.c_str());
+      SHERPA_ONNX_EXIT(-1);
+    }
+  }
+
+  int32_t Order() const { return header_->order; }
+
+  float Score(const NGramLMState &state, int32_t token,
+              NGramLMState *next) const {
+    int32_t word = header_->unk;
+    if (token >= 0 && token < header_->bos) {
+      word = token;
+    }
+    return ScoreWord(state, word, next);
+  }
+
+  float ScoreEnd(const NGramLMState &state) const {
+    NGramLMState next;
+    return ScoreWord(state, header_->eos, &next);
+  }
+
+ private:
+  void InitFromArpa(std::istream &is) {
+    buf_ = ArpaBuilder().Build(is);
+    Init(buf_.data(), buf_.size());
+  }
+
+  void Init(const char *data, size_t size) {
+    data_ = data;
+    size_ = size;
+
+    if (size < sizeof(Header)) {
+      SHERPA_ONNX_LOGE("Invalid n-gram LM: file is too small");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    header_ = reinterpret_cast<const Header *>(data);
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 ||
+        header_->version != kVersion) {
+      SHERPA_ONNX_LOGE("Invalid n-gram LM: unknown format or version");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    if (header_->order < 1 || header_->order > kNGramLMMaxOrder) {
+      SHERPA_ONNX_LOGE("Invalid n-gram LM: order %d", header_->order);
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    size_t expected = sizeof(Header);
+    const char *p = data + sizeof(Header);
+    for (int32_t k = 0; k != header_->order; ++k) {
+      if (header_->counts[k] < 0) {
+        SHERPA_ONNX_LOGE("Invalid n-gram LM: negative number of %d-grams",
+                         k + 1);
+        SHERPA_ONNX_EXIT(-1);
+      }
+
+      entries_[k] = reinterpret_cast<const Entry *>(p);
+      size_t n = (header_->counts[k] + 1) * sizeof(Entry);
+      p += n;
+      expected += n;
+    }
+
+    if (expected != size || header_->counts[0] != header_->num_words) {
+      SHERPA_ONNX_LOGE("Invalid n-gram LM: expected %zu bytes, given %zu",
+                       expected, size);
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    int32_t num_words = header_->num_words;
+    if (header_->bos < 0 || header_->bos >= num_words || header_->eos < 0 ||
+        header_->eos >= num_words || header_->unk < 0 ||
+        header_->unk >= num_words) {
+      SHERPA_ONNX_LOGE("Invalid n-gram LM: special word IDs out of range");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    // Child() searches [child_begin[i], child_begin[i + 1]) of the next
+    // order, so the ranges must be ascending and end within it
+    for (int32_t k = 0; k + 1 < header_->order; ++k) {
+      const Entry *e = entries_[k];
+      int64_t n = header_->counts[k];
+      for (int64_t i = 0; i != n; ++i) {
+        if (e[i].child_begin > e[i + 1].child_begin) {
+          SHERPA_ONNX_LOGE(
+              "Invalid n-gram LM: child ranges of %d-grams are not sorted",
+              k + 1);
+          SHERPA_ONNX_EXIT(-1);
+        }
+      }
+
+      if (e[n].child_begin > static_cast<uint64_t>(header_->counts[k + 1])) {
+        SHERPA_ONNX_LOGE(
+            "Invalid n-gram LM: child ranges of %d-grams are out of bounds",
+            k + 1);
+        SHERPA_ONNX_EXIT(-1);
+      }
+    }
+  }
+
+  float Prob(int32_t k, const Entry &e) const {
+    return header_->prob_min[k] + e.prob * header_->prob_step[k];
+  }
+
+  float Bow(int32_t k, const Entry &e) const {
+    return header_->bow_min[k] + e.bow * header_->bow_step[k];
+  }
+
+  // Return the index in order k + 1 of the child of entries_[k][i] with
+  // the given word, or -1 if there is no such child
+  int64_t Child(int32_t k, int64_t i, int32_t word) const {
+    const Entry *begin = entries_[k + 1] + entries_[k][i].child_begin;
+    const Entry *end = entries_[k + 1] + entries_[k][i + 1].child_begin;
+    const Entry *it = std::lower_bound(
+        begin, end, word,
+        [](const Entry &e, int32_t word) { return e.word < word; });
+    if (it == end || it->word != word) {
+      return -1;
+    }
+    return it - entries_[k + 1];
+  }
+
+  float ScoreWord(const NGramLMState &state, int32_t word,
+                  NGramLMState *next) const {
+    NGramLMState context = state;
+    if (context.num_words == 0) {
+      context.words[0] = header_->bos;
+      context.num_words = 1;
+    }
+
+    int32_t order = header_->order;
+
+    // Find the longest n-gram (c_k, ..., c_1, word), where c_1 is the most
+    // recent word of the context
+    int64_t i = word;
+    int32_t k = 0;
+    float log10_prob = Prob(0, entries_[0][i]);
+    while (k + 1 < order && k < context.num_words) {
+      int64_t c = Child(k, i, context.words[k]);
+      if (c < 0) break;
+      ++k;
+      i = c;
+      log10_prob = Prob(k, entries_[k][i]);
+    }
+
+    // Add back-off weights of the contexts longer than k words
+    if (k < context.num_words) {
+      int64_t j = context.words[0];
+      for (int32_t m = 0;; ++m) {
+        // entries_[m][j] is the context (c_{m+1}, ..., c_1)
+        if (m + 1 > k) {
+          log10_prob += Bow(m, entries_[m][j]);
+        }
+
+        if (m + 1 == context.num_words) break;
+
+        j = Child(m, j, context.words[m + 1]);
+        if (j < 0) break;
+      }
+    }
+
+    // (c_k, ..., c_1, word) is the longest history that can be extended.
+    // Keep at least one word so that it is not taken as the start of a
+    // sentence, e.g., for unigram LMs.
+    int32_t num_words = std::max(std::min(k + 1, order - 1), 1);
+    NGramLMState ans;
+    ans.words[0] = word;
+    std::copy(context.words.begin(), context.words.begin() + num_words - 1,
+              ans.words.begin() + 1);
+    ans.num_words = num_words;
+    *next = ans;
+
+    return log10_prob * kLn10;
+  }
+
+ private:
+  // Owns the data if it is built from an ARPA file
+  std::vector<char> buf_;
+
+  // Owns the data if it is loaded from a binary file
+  std::shared_ptr<const MappedFile> file_;
+
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  const Header *header_ = nullptr;
+  const Entry *entries_[kNGramLMMaxOrder] = {};
+};
+
+NGramLM::NGramLM(const std::string &filename)
+    : impl_(std::make_unique<Impl>(filename)) {}
+
+NGramLM::NGramLM(std::istream &is) : impl_(std::make_unique<Impl>(is)) {}
+
+NGramLM::~NGramLM() = default;
+
+bool NGramLM::IsNGramLM(const std::string &filename) {
+  std::ifstream is(filename, std::ios::binary);
+  return is && IsNGramLM(is);
+}
+
+bool NGramLM::IsNGramLM(std::istream &is) {
+  if (IsBinaryNGramLM(is)) {
+    return true;
+  }
+
+  // An ARPA file starts with \data\, possibly after blank lines
+  auto pos = is.tellg();
+  std::string word;
+  is >> word;
+  is.clear();
+  is.seekg(pos);
+
+  return word == "\\data\\";
+}
+
+void NGramLM::Save(const std::string &filename) const { impl_->Save(filename); }
+
+int32_t NGramLM::Order() const { return impl_->Order(); }
+
+float NGramLM::Score(const NGramLMState &state, int32_t token,
+                     NGramLMState *next) const {
+  return impl_->Score(state, token, next);
+}
+
+float NGramLM::ScoreEnd(const NGramLMState &state) const {
+  return impl_->ScoreEnd(state);
+}
+
+float NGramLM::ScoreSequence(const int64_t *tokens, int32_t n,
+                             bool add_end) const {
+  NGramLMState state;
+  float ans = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    ans += Score(state, static_cast<int32_t>(tokens[i]), &state);
+  }
+
+  if (add_end) {
+    ans += ScoreEnd(state);
+  }
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,98 @@
+// sherpa-onnx/csrc/ngram-lm.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_NGRAM_LM_H_
+#define SHERPA_ONNX_CSRC_NGRAM_LM_H_
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+class MappedFile;
+
+// Max order of an n-gram LM
+constexpr int32_t kNGramLMMaxOrder = 8;
+
+// The history of a hypothesis as seen by an n-gram LM. It is small and
+// cheap to copy, so it is stored in each Hypothesis.
+struct NGramLMState {
+  // Most recent word first. Only words that may still be used as the
+  // context of a longer n-gram are kept.
+  std::array<int32_t, kNGramLMMaxOrder - 1> words;
+
+  // 0 means no word has been scored yet, i.e., the start of a sentence
+  int32_t num_words = 0;
+};
+
+/** A back-off n-gram language model over token IDs.
+ *
+ * It is loaded either from an ARPA file, whose words are token IDs from
+ * tokens.txt plus <s>, </s> and <unk> (e.g., the n-gram LMs of icefall),
+ * or from the binary format written by Save().
+ *
+ * The binary format is memory-mapped and used in place, so it loads
+ * instantly and its pages are shared by all processes using the same
+ * file. n-grams are stored in a trie of sorted arrays keyed by the
+ * reversed context. Log probabilities and back-off weights are
+ * quantized to 16 bits per order.
+ *
+ * All methods are const and thread-safe.
+ */
+class NGramLM {
+ public:
+  // Load an ARPA file or a binary file written by Save()
+  explicit NGramLM(const std::string &filename);
+
+  // Load an ARPA file or the binary format from a stream. The binary
+  // format is copied into memory.
+  explicit NGramLM(std::istream &is);
+
+  ~NGramLM();
+
+  // True if filename is an ARPA file or a binary file written by Save()
+  static bool IsNGramLM(const std::string &filename);
+
+  // Like above, but check the content of a stream. The read position of
+  // the stream is not changed.
+  static bool IsNGramLM(std::istream &is);
+
+  // Write the binary format
+  void Save(const std::string &filename) const;
+
+  int32_t Order() const;
+
+  /** Return the natural log probability of token given state.
+   *
+   * @param state  The history. Use a default-constructed state for the
+   *               start of a sentence.
+   * @param token  Token ID. IDs not in the LM are scored as <unk>.
+   * @param next  On return, the history after token. It can be the same
+   *              object as state.
+   */
+  float Score(const NGramLMState &state, int32_t token,
+              NGramLMState *next) const;
+
+  // Return the natural log probability of </s> given state
+  float ScoreEnd(const NGramLMState &state) const;
+
+  /** Return the natural log probability of a token sequence.
+   *
+   * @param tokens  Token IDs. <s> is prepended implicitly.
+   * @param add_end  True to include the probability of </s>.
+   */
+  float ScoreSequence(const int64_t *tokens, int32_t n, bool add_end) const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_NGRAM_LM_H_
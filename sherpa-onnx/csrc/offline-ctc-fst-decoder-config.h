@@ -16,10 +16,15 @@ struct OfflineCtcFstDecoderConfig {
   std::string graph;
   int32_t max_active = 3000;
 
+  // Number of threads for decoding the utterances of a batch in parallel.
+  // 1 decodes them one by one on the calling thread.
+  int32_t num_threads = 1;
+
   OfflineCtcFstDecoderConfig() = default;
 
-  OfflineCtcFstDecoderConfig(const std::string &graph, int32_t max_active)
-      : graph(graph), max_active(max_active) {}
+  OfflineCtcFstDecoderConfig(const std::string &graph, int32_t max_active,
+                             int32_t num_threads = 1)
+      : graph(graph), max_active(max_active), num_threads(num_threads) {}
 
   std::string ToString() const;
 
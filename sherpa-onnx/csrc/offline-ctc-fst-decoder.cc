@@ -80,7 +80,40 @@ static OfflineCtcDecoderResult DecodeOne(kaldi_decoder::FasterDecoder *decoder,
 
 OfflineCtcFstDecoder::OfflineCtcFstDecoder(
     const OfflineCtcFstDecoderConfig &config)
-    : config_(config), fst_(ReadGraph(config_.graph)) {}
+    : config_(config), fst_(GetSharedGraph(config_.graph)) {
+  if (!fst_) {
+    SHERPA_ONNX_LOGE("Failed to load the decoding graph %s",
+                     config_.graph.c_str());
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  options_.max_active = config_.max_active;
+
+  if (config_.num_threads > 1) {
+    // The calling thread also decodes, so one thread fewer is needed
+    pool_ = std::make_unique<ThreadPool>(config_.num_threads - 1);
+  }
+}
+
+std::unique_ptr<kaldi_decoder::FasterDecoder>
+OfflineCtcFstDecoder::AcquireDecoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!decoders_.empty()) {
+      auto decoder = std::move(decoders_.back());
+      decoders_.pop_back();
+      return decoder;
+    }
+  }
+
+  return std::make_unique<kaldi_decoder::FasterDecoder>(*fst_, options_);
+}
+
+void OfflineCtcFstDecoder::ReleaseDecoder(
+    std::unique_ptr<kaldi_decoder::FasterDecoder> decoder) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  decoders_.push_back(std::move(decoder));
+}
 
 std::vector<OfflineCtcDecoderResult> OfflineCtcFstDecoder::Decode(
     Ort::Value log_probs, Ort::Value log_probs_length) {
@@ -97,20 +130,26 @@ std::vector<OfflineCtcDecoderResult> OfflineCtcFstDecoder::Decode(
 
   assert(shape[0] == length_shape[0]);
 
-  kaldi_decoder::FasterDecoderOptions opts;
-  opts.max_active = config_.max_active;
-  kaldi_decoder::FasterDecoder faster_decoder(*fst_, opts);
-
   const float *start = log_probs.GetTensorData<float>();
+  const int64_t *lengths = log_probs_length.GetTensorData<int64_t>();
 
-  std::vector<OfflineCtcDecoderResult> ans;
-  ans.reserve(batch_size);
+  std::vector<OfflineCtcDecoderResult> ans(batch_size);
 
-  for (int32_t i = 0; i != batch_size; ++i) {
+  auto decode = [&](int32_t i) {
     const float *p = start + i * T * vocab_size;
-    int32_t num_frames = log_probs_length.GetTensorData<int64_t>()[i];
-    auto r = DecodeOne(&faster_decoder, p, num_frames, vocab_size);
-    ans.push_back(std::move(r));
+    int32_t num_frames = lengths[i];
+
+    auto decoder = AcquireDecoder();
+    ans[i] = DecodeOne(decoder.get(), p, num_frames, vocab_size);
+    ReleaseDecoder(std::move(decoder));
+  };
+
+  if (pool_) {
+    pool_->ParallelFor(batch_size, decode);
+  } else {
+    for (int32_t i = 0; i != batch_size; ++i) {
+      decode(i);
+    }
   }
 
   return ans;
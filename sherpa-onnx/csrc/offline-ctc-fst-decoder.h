@@ -6,12 +6,15 @@
 #define SHERPA_ONNX_CSRC_OFFLINE_CTC_FST_DECODER_H_
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 
 #include "fst/fst.h"
+#include "kaldi-decoder/csrc/faster-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-fst-decoder-config.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/thread-pool.h"
 
 namespace sherpa_onnx {
 
@@ -19,13 +22,30 @@ class OfflineCtcFstDecoder : public OfflineCtcDecoder {
  public:
   explicit OfflineCtcFstDecoder(const OfflineCtcFstDecoderConfig &config);
 
+  // Utterances of a batch are decoded in parallel if config.num_threads > 1
   std::vector<OfflineCtcDecoderResult> Decode(
       Ort::Value log_probs, Ort::Value log_probs_length) override;
 
+ private:
+  // Take an idle decoder or create a new one
+  std::unique_ptr<kaldi_decoder::FasterDecoder> AcquireDecoder();
+
+  void ReleaseDecoder(std::unique_ptr<kaldi_decoder::FasterDecoder> decoder);
+
  private:
   OfflineCtcFstDecoderConfig config_;
+  kaldi_decoder::FasterDecoderOptions options_;
+
+  // Shared by all decoders in the process that use the same graph
+  std::shared_ptr<const fst::Fst<fst::StdArc>> fst_;
+
+  // Decoders are kept after use so that their token storage is reused.
+  // There are at most as many as utterances decoded at the same time.
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<kaldi_decoder::FasterDecoder>> decoders_;
 
-  std::unique_ptr<fst::Fst<fst::StdArc>> fst_;
+  // nullptr if config_.num_threads is 1
+  std::unique_ptr<ThreadPool> pool_;
 };
 
 }  // namespace sherpa_onnx
@@ -0,0 +1,192 @@
+// sherpa-onnx/csrc/offline-ctc-prefix-beam-search-decoder.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-ctc-prefix-beam-search-decoder.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+struct Prefix {
+  std::vector<int32_t> timestamps;
+
+  // log prob of the paths ending with a blank
+  float log_pb = kNegInf;
+
+  // log prob of the paths ending with the last token of the prefix
+  float log_pnb = kNegInf;
+
+  // Scaled LM log prob of the prefix
+  float lm_log_prob = 0;
+
+  NGramLMState lm_state;
+
+  float CtcLogProb() const { return LogAdd<float>()(log_pb, log_pnb); }
+
+  float TotalLogProb() const { return CtcLogProb() + lm_log_prob; }
+};
+
+using Prefixes = std::map<std::vector<int64_t>, Prefix>;
+
+}  // namespace
+
+OfflineCtcDecoderResult OfflineCtcPrefixBeamSearchDecoder::Decode(
+    const float *log_probs, int32_t num_frames, int32_t vocab_size) const {
+  LogAdd<float> log_add;
+
+  Prefixes cur;
+  cur[{}].log_pb = 0;
+
+  int32_t num_tokens = std::min(max_active_paths_, vocab_size);
+
+  for (int32_t t = 0; t != num_frames; ++t, log_probs += vocab_size) {
+    auto topk = TopkIndex(log_probs, vocab_size, num_tokens);
+
+    // blank is always considered so that prefixes can end with it
+    if (std::find(topk.begin(), topk.end(), blank_id_) == topk.end()) {
+      topk.push_back(blank_id_);
+    }
+
+    Prefixes next;
+    for (const auto &p : cur) {
+      const auto &ys = p.first;
+      const Prefix &prefix = p.second;
+
+      // ys in the next frame. It has the same tokens as prefix.
+      Prefix *same = nullptr;
+      auto get_same = [&]() -> Prefix & {
+        if (!same) {
+          auto it = next.find(ys);
+          if (it == next.end()) {
+            Prefix n;
+            n.timestamps = prefix.timestamps;
+            n.lm_log_prob = prefix.lm_log_prob;
+            n.lm_state = prefix.lm_state;
+            it = next.emplace(ys, std::move(n)).first;
+          }
+          same = &it->second;
+        }
+        return *same;
+      };
+
+      for (int32_t c : topk) {
+        float lp = log_probs[c];
+
+        if (c == blank_id_) {
+          Prefix &n = get_same();
+          n.log_pb = log_add(n.log_pb, prefix.CtcLogProb() + lp);
+          continue;
+        }
+
+        if (!ys.empty() && c == ys.back()) {
+          // Repeated tokens without a blank in between are merged
+          Prefix &n = get_same();
+          n.log_pnb = log_add(n.log_pnb, prefix.log_pnb + lp);
+        }
+
+        std::vector<int64_t> new_ys = ys;
+        new_ys.push_back(c);
+
+        auto it = next.find(new_ys);
+        if (it == next.end()) {
+          Prefix n;
+          n.timestamps = prefix.timestamps;
+          n.timestamps.push_back(t);
+          n.lm_log_prob = prefix.lm_log_prob;
+          if (lm_) {
+            n.lm_log_prob +=
+                lm_scale_ * lm_->Score(prefix.lm_state, c, &n.lm_state);
+          }
+          it = next.emplace(std::move(new_ys), std::move(n)).first;
+        }
+
+        // After a blank, or a different token
+        float from = (!ys.empty() && c == ys.back()) ? prefix.log_pb
+                                                     : prefix.CtcLogProb();
+        it->second.log_pnb = log_add(it->second.log_pnb, from + lp);
+      }
+    }
+
+    if (static_cast<int32_t>(next.size()) > max_active_paths_) {
+      std::vector<std::pair<float, const std::vector<int64_t> *>> scores;
+      scores.reserve(next.size());
+      for (const auto &p : next) {
+        scores.emplace_back(p.second.TotalLogProb(), &p.first);
+      }
+
+      std::nth_element(
+          scores.begin(), scores.begin() + max_active_paths_, scores.end(),
+          [](const auto &a, const auto &b) { return a.first > b.first; });
+
+      cur.clear();
+      for (int32_t i = 0; i != max_active_paths_; ++i) {
+        auto it = next.find(*scores[i].second);
+        cur.insert(std::move(*it));
+      }
+    } else {
+      cur = std::move(next);
+    }
+  }
+
+  const std::vector<int64_t> *best = nullptr;
+  const Prefix *best_prefix = nullptr;
+  float best_score = kNegInf;
+  for (const auto &p : cur) {
+    float score = p.second.TotalLogProb();
+    if (lm_) {
+      score += lm_scale_ * lm_->ScoreEnd(p.second.lm_state);
+    }
+
+    if (!best || score > best_score) {
+      best = &p.first;
+      best_prefix = &p.second;
+      best_score = score;
+    }
+  }
+
+  OfflineCtcDecoderResult r;
+  if (best) {
+    r.tokens = *best;
+    r.timestamps = best_prefix->timestamps;
+  }
+
+  return r;
+}
+
+std::vector<OfflineCtcDecoderResult> OfflineCtcPrefixBeamSearchDecoder::Decode(
+    Ort::Value log_probs, Ort::Value log_probs_length) {
+  std::vector<int64_t> shape = log_probs.GetTensorTypeAndShapeInfo().GetShape();
+  int32_t batch_size = static_cast<int32_t>(shape[0]);
+  int32_t num_frames = static_cast<int32_t>(shape[1]);
+  int32_t vocab_size = static_cast<int32_t>(shape[2]);
+
+  const int64_t *p_log_probs_length = log_probs_length.GetTensorData<int64_t>();
+
+  std::vector<OfflineCtcDecoderResult> ans;
+  ans.reserve(batch_size);
+
+  for (int32_t b = 0; b != batch_size; ++b) {
+    const float *p_log_probs =
+        log_probs.GetTensorData<float>() + b * num_frames * vocab_size;
+
+    ans.push_back(Decode(p_log_probs,
+                         static_cast<int32_t>(p_log_probs_length[b]),
+                         vocab_size));
+  }
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
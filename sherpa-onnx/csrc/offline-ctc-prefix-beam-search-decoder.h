@@ -0,0 +1,48 @@
+// sherpa-onnx/csrc/offline-ctc-prefix-beam-search-decoder.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_CTC_PREFIX_BEAM_SEARCH_DECODER_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_CTC_PREFIX_BEAM_SEARCH_DECODER_H_
+
+#include <vector>
+
+#include "sherpa-onnx/csrc/ngram-lm.h"
+#include "sherpa-onnx/csrc/offline-ctc-decoder.h"
+
+namespace sherpa_onnx {
+
+class OfflineCtcPrefixBeamSearchDecoder : public OfflineCtcDecoder {
+ public:
+  /**
+   * @param blank_id  ID of the blank symbol.
+   * @param max_active_paths  Beam size. It is also the number of tokens
+   *                          considered per frame.
+   * @param lm  Optional n-gram LM for shallow fusion. Not owned.
+   * @param lm_scale  Scale of the LM scores.
+   */
+  OfflineCtcPrefixBeamSearchDecoder(int32_t blank_id, int32_t max_active_paths,
+                                    const NGramLM *lm = nullptr,
+                                    float lm_scale = 0)
+      : blank_id_(blank_id),
+        max_active_paths_(max_active_paths),
+        lm_(lm),
+        lm_scale_(lm_scale) {}
+
+  std::vector<OfflineCtcDecoderResult> Decode(
+      Ort::Value log_probs, Ort::Value log_probs_length) override;
+
+ private:
+  OfflineCtcDecoderResult Decode(const float *log_probs, int32_t num_frames,
+                                 int32_t vocab_size) const;
+
+ private:
+  int32_t blank_id_;
+  int32_t max_active_paths_;
+  const NGramLM *lm_;
+  float lm_scale_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_CTC_PREFIX_BEAM_SEARCH_DECODER_H_
@@ -12,12 +12,18 @@
 namespace sherpa_onnx {
 
 void OfflineLMConfig::Register(ParseOptions *po) {
-  po->Register("lm", &model, "Path to LM model.");
+  po->Register("lm", &model,
+               "Path to LM model. Either an RNN LM (*.onnx) or an n-gram LM, "
+               "i.e., an ARPA file over token IDs or the output of "
+               "sherpa-onnx-arpa-to-ngram.");
   po->Register("lm-scale", &scale, "LM scale.");
   po->Register("lm-num-threads", &lm_num_threads,
                "Number of threads to run the neural network of LM model");
   po->Register("lm-provider", &lm_provider,
                "Specify a provider to LM model use: cpu, cuda, coreml");
+  po->Register("lm-use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
 }
 
 bool OfflineLMConfig::Validate() const {
@@ -34,7 +40,9 @@ std::string OfflineLMConfig::ToString() const {
 
   os << "OfflineLMConfig(";
   os << "model=\"" << model << "\", ";
-  os << "scale=" << scale << ")";
+  os << "scale=" << scale << ", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ")";
 
   return os.str();
 }
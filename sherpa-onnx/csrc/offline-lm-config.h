@@ -19,6 +19,10 @@ struct OfflineLMConfig {
   int32_t lm_num_threads = 1;
   std::string lm_provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   OfflineLMConfig() = default;
 
   OfflineLMConfig(const std::string &model, float scale, int32_t lm_num_threads,
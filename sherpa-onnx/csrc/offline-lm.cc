@@ -5,6 +5,9 @@
 #include "sherpa-onnx/csrc/offline-lm.h"
 
 #include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -17,17 +20,30 @@
 #include "rawfile/raw_file_manager.h"
 #endif
 
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/ngram-lm.h"
+#include "sherpa-onnx/csrc/offline-ngram-lm.h"
 #include "sherpa-onnx/csrc/offline-rnn-lm.h"
 
 namespace sherpa_onnx {
 
 std::unique_ptr<OfflineLM> OfflineLM::Create(const OfflineLMConfig &config) {
+  if (NGramLM::IsNGramLM(config.model)) {
+    return std::make_unique<OfflineNGramLM>(config);
+  }
+
   return std::make_unique<OfflineRnnLM>(config);
 }
 
 template <typename Manager>
 std::unique_ptr<OfflineLM> OfflineLM::Create(Manager *mgr,
                                              const OfflineLMConfig &config) {
+  auto buf = ReadFile(mgr, config.model);
+  std::istringstream is(std::string(buf.begin(), buf.end()));
+  if (NGramLM::IsNGramLM(is)) {
+    return std::make_unique<OfflineNGramLM>(std::make_unique<NGramLM>(is));
+  }
+
   return std::make_unique<OfflineRnnLM>(mgr, config);
 }
 
@@ -36,6 +36,10 @@ void OfflineModelConfig::Register(ParseOptions *po) {
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
 
+  po->Register("use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
+
   po->Register("model-type", &model_type,
                "Specify it to reduce model initialization time. "
                "Valid values are: transducer, paraformer, nemo_ctc, whisper, "
@@ -141,6 +145,8 @@ std::string OfflineModelConfig::ToString() const {
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
   os << "provider=\"" << provider << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ", ";
   os << "model_type=\"" << model_type << "\", ";
   os << "modeling_unit=\"" << modeling_unit << "\", ";
   os << "bpe_vocab=\"" << bpe_vocab << "\")";
@@ -37,6 +37,10 @@ struct OfflineModelConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   // With the help of this field, we only need to load the model once
   // instead of twice; and therefore it reduces initialization time.
   //
@@ -0,0 +1,41 @@
+// sherpa-onnx/csrc/offline-ngram-lm.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-ngram-lm.h"
+
+#include <array>
+#include <memory>
+#include <utility>
+
+namespace sherpa_onnx {
+
+OfflineNGramLM::OfflineNGramLM(const OfflineLMConfig &config)
+    : lm_(std::make_unique<NGramLM>(config.model)) {}
+
+OfflineNGramLM::OfflineNGramLM(std::unique_ptr<NGramLM> lm)
+    : lm_(std::move(lm)) {}
+
+Ort::Value OfflineNGramLM::Rescore(Ort::Value x, Ort::Value x_lens) {
+  std::vector<int64_t> shape = x.GetTensorTypeAndShapeInfo().GetShape();
+  int32_t batch_size = static_cast<int32_t>(shape[0]);
+  int32_t max_len = static_cast<int32_t>(shape[1]);
+
+  const int64_t *p_x = x.GetTensorData<int64_t>();
+  const int64_t *p_x_lens = x_lens.GetTensorData<int64_t>();
+
+  Ort::AllocatorWithDefaultOptions allocator;
+  std::array<int64_t, 1> nll_shape{batch_size};
+  Ort::Value nll = Ort::Value::CreateTensor<float>(allocator, nll_shape.data(),
+                                                   nll_shape.size());
+  float *p_nll = nll.GetTensorMutableData<float>();
+
+  for (int32_t i = 0; i != batch_size; ++i) {
+    p_nll[i] = -lm_->ScoreSequence(p_x + i * max_len,
+                                   static_cast<int32_t>(p_x_lens[i]), true);
+  }
+
+  return nll;
+}
+
+}  // namespace sherpa_onnx
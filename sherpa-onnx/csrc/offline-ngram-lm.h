@@ -0,0 +1,39 @@
+// sherpa-onnx/csrc/offline-ngram-lm.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_NGRAM_LM_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_NGRAM_LM_H_
+
+#include <memory>
+
+#include "sherpa-onnx/csrc/ngram-lm.h"
+#include "sherpa-onnx/csrc/offline-lm-config.h"
+#include "sherpa-onnx/csrc/offline-lm.h"
+
+namespace sherpa_onnx {
+
+class OfflineNGramLM : public OfflineLM {
+ public:
+  explicit OfflineNGramLM(const OfflineLMConfig &config);
+
+  explicit OfflineNGramLM(std::unique_ptr<NGramLM> lm);
+
+  /** Rescore a batch of sentences.
+   *
+   * @param x A 2-D tensor of shape (N, L) with data type int64.
+   * @param x_lens A 1-D tensor of shape (N,) with data type int64.
+   *               It contains number of valid tokens in x before padding.
+   * @return Return a 1-D tensor of shape (N,) containing the negative log
+   *         likelihood of each utterance, including </s>. Its data type is
+   *         float32.
+   */
+  Ort::Value Rescore(Ort::Value x, Ort::Value x_lens) override;
+
+ private:
+  std::unique_ptr<NGramLM> lm_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_NGRAM_LM_H_
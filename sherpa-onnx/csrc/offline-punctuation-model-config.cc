@@ -21,6 +21,10 @@ void OfflinePunctuationModelConfig::Register(ParseOptions *po) {
 
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
+
+  po->Register("use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
 }
 
 bool OfflinePunctuationModelConfig::Validate() const {
@@ -45,7 +49,9 @@ std::string OfflinePunctuationModelConfig::ToString() const {
   os << "ct_transformer=\"" << ct_transformer << "\", ";
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
-  os << "provider=\"" << provider << "\")";
+  os << "provider=\"" << provider << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ")";
 
   return os.str();
 }
@@ -17,6 +17,10 @@ struct OfflinePunctuationModelConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   OfflinePunctuationModelConfig() = default;
 
   OfflinePunctuationModelConfig(const std::string &ct_transformer,
@@ -0,0 +1,133 @@
+// sherpa-onnx/csrc/offline-recognizer-batch-queue.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-recognizer-batch-queue.h"
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+static int32_t FramesPerSecond(const OfflineRecognizer *recognizer) {
+  float frame_shift_ms = recognizer->GetConfig().feat_config.frame_shift_ms;
+  if (frame_shift_ms <= 0) {
+    return 100;
+  }
+
+  return static_cast<int32_t>(1000 / frame_shift_ms);
+}
+
+OfflineRecognizerBatchQueue::OfflineRecognizerBatchQueue(
+    const OfflineRecognizer *recognizer, const BatchingConfig &config,
+    int32_t num_threads /*= 1*/)
+    : recognizer_(recognizer),
+      batcher_(config, FramesPerSecond(recognizer)) {
+  if (!config.Validate()) {
+    SHERPA_ONNX_LOGE("Errors in the batching config: %s",
+                     config.ToString().c_str());
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  if (num_threads <= 0) {
+    num_threads = 1;
+  }
+
+  workers_.reserve(num_threads);
+  for (int32_t i = 0; i != num_threads; ++i) {
+    workers_.emplace_back([this]() { Worker(); });
+  }
+}
+
+OfflineRecognizerBatchQueue::~OfflineRecognizerBatchQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+
+  for (auto &t : workers_) {
+    t.join();
+  }
+}
+
+void OfflineRecognizerBatchQueue::Push(std::unique_ptr<OfflineStream> s,
+                                       Callback callback) {
+  int32_t num_frames = s->NumFrames();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batcher_.Push({std::move(s), std::move(callback)}, num_frames);
+  }
+  cv_.notify_one();
+}
+
+int32_t OfflineRecognizerBatchQueue::NumPending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return batcher_.Size();
+}
+
+BatchingStats OfflineRecognizerBatchQueue::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return batcher_.GetStats();
+}
+
+void OfflineRecognizerBatchQueue::Worker() {
+  std::vector<Request> batch;
+  std::vector<OfflineStream *> ss;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true) {
+        int32_t wait_ms = 0;
+        // On stop, we flush the pending streams instead of waiting for
+        // the buckets to fill up
+        if (batcher_.Pop(&batch, &wait_ms, stop_)) {
+          break;
+        }
+
+        if (stop_) {
+          return;
+        }
+
+        if (wait_ms < 0) {
+          cv_.wait(lock);
+        } else {
+          cv_.wait_for(lock, std::chrono::milliseconds(wait_ms));
+        }
+      }
+
+      if (!batcher_.Empty()) {
+        // let another worker form the next batch while we are decoding
+        cv_.notify_one();
+      }
+    }
+
+    ss.resize(batch.size());
+    for (int32_t i = 0; i != static_cast<int32_t>(batch.size()); ++i) {
+      ss[i] = batch[i].stream.get();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    recognizer_->DecodeStreams(ss.data(), static_cast<int32_t>(ss.size()));
+
+    auto end = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end - start).count();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batcher_.AddProcessingTime(elapsed);
+    }
+
+    for (auto &r : batch) {
+      r.callback(std::move(r.stream));
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
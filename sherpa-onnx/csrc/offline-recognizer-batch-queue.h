@@ -0,0 +1,94 @@
+// sherpa-onnx/csrc/offline-recognizer-batch-queue.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_RECOGNIZER_BATCH_QUEUE_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_RECOGNIZER_BATCH_QUEUE_H_
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "sherpa-onnx/csrc/length-bucketed-batcher.h"
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/offline-stream.h"
+
+namespace sherpa_onnx {
+
+/** Decode streams submitted from any thread in length-bucketed batches.
+ *
+ * Streams are grouped by their number of feature frames according to
+ * BatchingConfig and decoded by a pool of worker threads with
+ * OfflineRecognizer::DecodeStreams(). Once a stream is decoded, the callback
+ * provided in Push() is invoked from a worker thread.
+ *
+ * Usage:
+ *
+ *   OfflineRecognizer recognizer(config);
+ *   OfflineRecognizerBatchQueue queue(&recognizer, batching_config, 2);
+ *
+ *   auto s = recognizer.CreateStream();
+ *   s->AcceptWaveform(sample_rate, samples, n);
+ *   queue.Push(std::move(s), [](std::unique_ptr<OfflineStream> s) {
+ *     std::cout << s->GetResult().text << "\n";
+ *   });
+ */
+class OfflineRecognizerBatchQueue {
+ public:
+  using Callback = std::function<void(std::unique_ptr<OfflineStream>)>;
+
+  /**
+   * @param recognizer  **Borrowed** from outside. It must outlive this
+   *                    object.
+   * @param config  Configuration of the batching policy.
+   * @param num_threads  Number of worker threads calling DecodeStreams().
+   */
+  OfflineRecognizerBatchQueue(const OfflineRecognizer *recognizer,
+                              const BatchingConfig &config,
+                              int32_t num_threads = 1);
+
+  // It decodes all pending streams before returning.
+  ~OfflineRecognizerBatchQueue();
+
+  OfflineRecognizerBatchQueue(const OfflineRecognizerBatchQueue &) = delete;
+  OfflineRecognizerBatchQueue &operator=(const OfflineRecognizerBatchQueue &) =
+      delete;
+
+  /** Submit a stream for decoding.
+   *
+   * @param s  A stream that has received all of its samples.
+   * @param callback  It is called with the stream once the stream is
+   *                  decoded. Use s->GetResult() to get the result.
+   */
+  void Push(std::unique_ptr<OfflineStream> s, Callback callback);
+
+  // Number of streams waiting to be decoded
+  int32_t NumPending() const;
+
+  BatchingStats GetStats() const;
+
+ private:
+  struct Request {
+    std::unique_ptr<OfflineStream> stream;
+    Callback callback;
+  };
+
+  void Worker();
+
+ private:
+  const OfflineRecognizer *recognizer_;  // not owned
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  LengthBucketedBatcher<Request> batcher_;
+  bool stop_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_RECOGNIZER_BATCH_QUEUE_H_
@@ -12,10 +12,14 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/ngram-lm.h"
 #include "sherpa-onnx/csrc/offline-ctc-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-fst-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-ctc-model.h"
+#include "sherpa-onnx/csrc/offline-ctc-prefix-beam-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/pad-sequence.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
@@ -77,6 +81,16 @@ class OfflineRecognizerCtcImpl : public OfflineRecognizerImpl {
         config_(config),
         symbol_table_(config_.model_config.tokens),
         model_(OfflineCtcModel::Create(config_.model_config)) {
+    if (UseLM()) {
+      if (!NGramLM::IsNGramLM(config_.lm_config.model)) {
+        SHERPA_ONNX_LOGE(
+            "Only n-gram LMs are supported for CTC models. Given: '%s'",
+            config_.lm_config.model.c_str());
+        exit(-1);
+      }
+      lm_ = std::make_unique<NGramLM>(config_.lm_config.model);
+    }
+
     Init();
   }
 
@@ -86,6 +100,18 @@ class OfflineRecognizerCtcImpl : public OfflineRecognizerImpl {
         config_(config),
         symbol_table_(mgr, config_.model_config.tokens),
         model_(OfflineCtcModel::Create(mgr, config_.model_config)) {
+    if (UseLM()) {
+      auto buf = ReadFile(mgr, config_.lm_config.model);
+      std::istringstream is(std::string(buf.begin(), buf.end()));
+      if (!NGramLM::IsNGramLM(is)) {
+        SHERPA_ONNX_LOGE(
+            "Only n-gram LMs are supported for CTC models. Given: '%s'",
+            config_.lm_config.model.c_str());
+        exit(-1);
+      }
+      lm_ = std::make_unique<NGramLM>(is);
+    }
+
     Init();
   }
 
@@ -133,32 +159,47 @@ class OfflineRecognizerCtcImpl : public OfflineRecognizerImpl {
       decoder_ = std::make_unique<OfflineCtcFstDecoder>(
           config_.ctc_fst_decoder_config);
     } else if (config_.decoding_method == "greedy_search") {
-      if (!symbol_table_.Contains("<blk>") &&
-          !symbol_table_.Contains("<eps>") &&
-          !symbol_table_.Contains("<blank>")) {
-        SHERPA_ONNX_LOGE(
-            "We expect that tokens.txt contains "
-            "the symbol <blk> or <eps> or <blank> and its ID.");
-        exit(-1);
-      }
+      decoder_ = std::make_unique<OfflineCtcGreedySearchDecoder>(GetBlankId());
+    } else if (config_.decoding_method == "modified_beam_search") {
+      decoder_ = std::make_unique<OfflineCtcPrefixBeamSearchDecoder>(
+          GetBlankId(), config_.max_active_paths, lm_.get(),
+          config_.lm_config.scale);
+    } else {
+      SHERPA_ONNX_LOGE(
+          "Only greedy_search and modified_beam_search are supported at "
+          "present. Given %s",
+          config_.decoding_method.c_str());
+      exit(-1);
+    }
+  }
 
-      int32_t blank_id = 0;
-      if (symbol_table_.Contains("<blk>")) {
-        blank_id = symbol_table_["<blk>"];
-      } else if (symbol_table_.Contains("<eps>")) {
-        // for tdnn models of the yesno recipe from icefall
-        blank_id = symbol_table_["<eps>"];
-      } else if (symbol_table_.Contains("<blank>")) {
-        // for Wenet CTC models
-        blank_id = symbol_table_["<blank>"];
-      }
+  bool UseLM() const {
+    return config_.ctc_fst_decoder_config.graph.empty() &&
+           config_.decoding_method == "modified_beam_search" &&
+           !config_.lm_config.model.empty();
+  }
 
-      decoder_ = std::make_unique<OfflineCtcGreedySearchDecoder>(blank_id);
-    } else {
-      SHERPA_ONNX_LOGE("Only greedy_search is supported at present. Given %s",
-                       config_.decoding_method.c_str());
+  int32_t GetBlankId() const {
+    if (!symbol_table_.Contains("<blk>") && !symbol_table_.Contains("<eps>") &&
+        !symbol_table_.Contains("<blank>")) {
+      SHERPA_ONNX_LOGE(
+          "We expect that tokens.txt contains "
+          "the symbol <blk> or <eps> or <blank> and its ID.");
       exit(-1);
     }
+
+    int32_t blank_id = 0;
+    if (symbol_table_.Contains("<blk>")) {
+      blank_id = symbol_table_["<blk>"];
+    } else if (symbol_table_.Contains("<eps>")) {
+      // for tdnn models of the yesno recipe from icefall
+      blank_id = symbol_table_["<eps>"];
+    } else if (symbol_table_.Contains("<blank>")) {
+      // for Wenet CTC models
+      blank_id = symbol_table_["<blank>"];
+    }
+
+    return blank_id;
   }
 
   std::unique_ptr<OfflineStream> CreateStream() const override {
@@ -266,6 +307,10 @@ class OfflineRecognizerCtcImpl : public OfflineRecognizerImpl {
   OfflineRecognizerConfig config_;
   SymbolTable symbol_table_;
   std::unique_ptr<OfflineCtcModel> model_;
+
+  // Used only by modified_beam_search
+  std::unique_ptr<NGramLM> lm_;
+
   std::unique_ptr<OfflineCtcDecoder> decoder_;
 };
 
@@ -24,6 +24,7 @@
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/offline-recognizer-ctc-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-fire-red-asr-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-moonshine-impl.h"
@@ -32,7 +33,9 @@
 #include "sherpa-onnx/csrc/offline-recognizer-transducer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-transducer-nemo-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-whisper-impl.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/warm-up.h"
 
 namespace sherpa_onnx {
 
@@ -123,8 +126,7 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
 
   auto buf = ReadFile(model_filename);
 
-  auto encoder_sess =
-      std::make_unique<Ort::Session>(env, buf.data(), buf.size(), sess_opts);
+  auto encoder_sess = CreateSession(env, buf.data(), buf.size(), sess_opts);
 
   Ort::ModelMetadata meta_data = encoder_sess->GetModelMetadata();
 
@@ -306,8 +308,7 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
 
   auto buf = ReadFile(mgr, model_filename);
 
-  auto encoder_sess =
-      std::make_unique<Ort::Session>(env, buf.data(), buf.size(), sess_opts);
+  auto encoder_sess = CreateSession(env, buf.data(), buf.size(), sess_opts);
 
   Ort::ModelMetadata meta_data = encoder_sess->GetModelMetadata();
 
@@ -497,6 +498,8 @@ OfflineRecognizerImpl::OfflineRecognizerImpl(
 
 std::string OfflineRecognizerImpl::ApplyInverseTextNormalization(
     std::string text) const {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_offline_itn_seconds",
+                             "Time of inverse text normalization");
   text = RemoveInvalidUtf8Sequences(text);
 
   if (!itn_list_.empty()) {
@@ -508,6 +511,36 @@ std::string OfflineRecognizerImpl::ApplyInverseTextNormalization(
   return text;
 }
 
+void OfflineRecognizerImpl::WarmUp(int32_t num_runs, int32_t max_batch_size,
+                                   float max_duration) const {
+  if (num_runs <= 0) {
+    return;
+  }
+
+  int32_t sample_rate = config_.feat_config.sampling_rate;
+
+  // Each length is a different shape for the encoder and each batch size
+  // multiplies it
+  for (float duration : WarmUpDurations(max_duration)) {
+    std::vector<float> samples = GenerateWarmUpAudio(duration, sample_rate);
+
+    for (int32_t batch_size : PowersOfTwoUpTo(max_batch_size)) {
+      for (int32_t i = 0; i < num_runs; ++i) {
+        std::vector<std::unique_ptr<OfflineStream>> streams;
+        std::vector<OfflineStream *> ss;
+        for (int32_t k = 0; k != batch_size; ++k) {
+          streams.push_back(CreateStream());
+          streams.back()->AcceptWaveform(sample_rate, samples.data(),
+                                         samples.size());
+          ss.push_back(streams.back().get());
+        }
+
+        DecodeStreams(ss.data(), ss.size());
+      }
+    }
+  }
+}
+
 void OfflineRecognizerImpl::SetConfig(const OfflineRecognizerConfig &config) {
   config_ = config;
 }
@@ -48,6 +48,11 @@ class OfflineRecognizerImpl {
 
   std::string ApplyInverseTextNormalization(std::string text) const;
 
+  // Decode synthetic utterances of 1, 2, 4, ..., max_duration seconds,
+  // each num_runs times with 1, 2, 4, ..., max_batch_size streams at a time
+  void WarmUp(int32_t num_runs, int32_t max_batch_size,
+              float max_duration) const;
+
  private:
   OfflineRecognizerConfig config_;
   // for inverse text normalization. Used only if
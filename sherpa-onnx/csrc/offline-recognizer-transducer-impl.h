@@ -17,6 +17,7 @@
 #include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/log.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/offline-transducer-decoder.h"
@@ -25,6 +26,7 @@
 #include "sherpa-onnx/csrc/offline-transducer-modified-beam-search-decoder.h"
 #include "sherpa-onnx/csrc/pad-sequence.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
+#include "sherpa-onnx/csrc/trace.h"
 #include "sherpa-onnx/csrc/utils.h"
 #include "ssentencepiece/csrc/ssentencepiece.h"
 
@@ -160,28 +162,19 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
                        hotwords.c_str());
     }
 
-    int32_t num_default_hws = hotwords_.size();
-    int32_t num_hws = current.size();
-
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_hws,
-                            config_.hotwords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_hws,
-                            config_.hotwords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
+    // Only the hotwords of this stream are compiled. They are layered on
+    // top of the default hotwords, which are shared by all streams.
+    ContextGraphPtr context_graph;
+    if (current.empty()) {
+      context_graph = hotwords_graph_;
+    } else if (hotwords_graph_) {
+      context_graph = std::make_shared<ContextGraph>(
+          hotwords_graph_, current, config_.hotwords_score, 0.0f,
+          current_scores);
     } else {
-      // Do nothing.
+      context_graph = std::make_shared<ContextGraph>(
+          current, config_.hotwords_score, current_scores);
     }
-
-    auto context_graph = std::make_shared<ContextGraph>(
-        current, config_.hotwords_score, current_scores);
     return std::make_unique<OfflineStream>(config_.feat_config, context_graph);
   }
 
@@ -230,9 +223,23 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
     Ort::Value x = PadSequence(model_->Allocator(), features_pointer,
                                -23.025850929940457f);
 
-    auto t = model_->RunEncoder(std::move(x), std::move(x_length));
-    auto results =
-        decoder_->Decode(std::move(t.first), std::move(t.second), ss, n);
+    std::pair<Ort::Value, Ort::Value> t{Ort::Value{nullptr},
+                                        Ort::Value{nullptr}};
+    {
+      SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_offline_encoder_seconds",
+                                 "Time to run the encoder for a batch");
+      SHERPA_ONNX_TRACE_SCOPE_N("OfflineTransducerModel::RunEncoder", n);
+      t = model_->RunEncoder(std::move(x), std::move(x_length));
+    }
+
+    std::vector<OfflineTransducerDecoderResult> results;
+    {
+      SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_offline_search_seconds",
+                                 "Time to run the decoding search for a batch");
+      SHERPA_ONNX_TRACE_SCOPE_N("OfflineTransducerDecoder::Decode", n);
+      results =
+          decoder_->Decode(std::move(t.first), std::move(t.second), ss, n);
+    }
 
     int32_t frame_shift_ms = 10;
     for (int32_t i = 0; i != n; ++i) {
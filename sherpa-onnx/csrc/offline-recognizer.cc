@@ -4,6 +4,8 @@
 
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <memory>
 
 #if __ANDROID_API__ >= 9
@@ -17,9 +19,11 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/offline-lm-config.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace sherpa_onnx {
 
@@ -33,7 +37,9 @@ void OfflineRecognizerConfig::Register(ParseOptions *po) {
       "decoding-method", &decoding_method,
       "decoding method,"
       "Valid values: greedy_search, modified_beam_search. "
-      "modified_beam_search is applicable only for transducer models.");
+      "modified_beam_search is applicable only for transducer and CTC models. "
+      "For CTC models, it is prefix beam search and --lm, if given, must be "
+      "an n-gram LM.");
 
   po->Register("max-active-paths", &max_active_paths,
                "Used only when decoding_method is modified_beam_search");
@@ -67,13 +73,14 @@ void OfflineRecognizerConfig::Register(ParseOptions *po) {
 }
 
 bool OfflineRecognizerConfig::Validate() const {
-  if (decoding_method == "modified_beam_search" && !lm_config.model.empty()) {
+  if (decoding_method == "modified_beam_search") {
     if (max_active_paths <= 0) {
       SHERPA_ONNX_LOGE("max_active_paths is less than 0! Given: %d",
                        max_active_paths);
       return false;
     }
-    if (!lm_config.Validate()) {
+
+    if (!lm_config.model.empty() && !lm_config.Validate()) {
       return false;
     }
   }
@@ -161,8 +168,60 @@ std::unique_ptr<OfflineStream> OfflineRecognizer::CreateStream() const {
   return impl_->CreateStream();
 }
 
+namespace {
+
+struct OfflineDecodeMetrics {
+  Histogram *decode_seconds;
+  Histogram *batch_size;
+  Counter *audio_seconds;
+
+  OfflineDecodeMetrics() {
+    auto &registry = MetricsRegistry::Global();
+    decode_seconds =
+        registry.GetHistogram("sherpa_onnx_offline_decode_seconds",
+                              "Time of OfflineRecognizer::DecodeStreams()");
+    batch_size = registry.GetHistogram(
+        "sherpa_onnx_offline_batch_size",
+        "Number of streams per call of OfflineRecognizer::DecodeStreams()",
+        Histogram::SizeBounds());
+    audio_seconds =
+        registry.GetCounter("sherpa_onnx_offline_audio_seconds_total",
+                            "Seconds of audio decoded by OfflineRecognizer");
+    registry.AddRatio("sherpa_onnx_offline_rtf",
+                      "Real-time factor of OfflineRecognizer::DecodeStreams()",
+                      "sherpa_onnx_offline_decode_seconds",
+                      "sherpa_onnx_offline_audio_seconds_total");
+  }
+};
+
+}  // namespace
+
 void OfflineRecognizer::DecodeStreams(OfflineStream **ss, int32_t n) const {
+  SHERPA_ONNX_TRACE_SCOPE_N("OfflineRecognizer::DecodeStreams", n);
+
+  if (!MetricsEnabled()) {
+    impl_->DecodeStreams(ss, n);
+    return;
+  }
+
+  static OfflineDecodeMetrics metrics;
+
+  int64_t num_frames = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    num_frames += ss[i]->NumFrames();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
   impl_->DecodeStreams(ss, n);
+
+  auto end = std::chrono::steady_clock::now();
+
+  // All of the supported models use a frame shift of 10 ms
+  metrics.audio_seconds->Inc(num_frames * 0.01);
+  metrics.decode_seconds->Observe(
+      std::chrono::duration<double>(end - start).count());
+  metrics.batch_size->Observe(n);
 }
 
 void OfflineRecognizer::SetConfig(const OfflineRecognizerConfig &config) {
@@ -173,6 +232,12 @@ OfflineRecognizerConfig OfflineRecognizer::GetConfig() const {
   return impl_->GetConfig();
 }
 
+void OfflineRecognizer::WarmUp(int32_t num_runs, int32_t max_batch_size /*= 1*/,
+                               float max_duration /*= 8*/) const {
+  impl_->WarmUp(num_runs, std::max(max_batch_size, 1),
+                std::max(max_duration, 1.0f));
+}
+
 #if __ANDROID_API__ >= 9
 template OfflineRecognizer::OfflineRecognizer(
     AAssetManager *mgr, const OfflineRecognizerConfig &config);
@@ -122,6 +122,22 @@ class OfflineRecognizer {
 
   OfflineRecognizerConfig GetConfig() const;
 
+  /** Decode synthetic audio so that onnxruntime allocates memory and
+   * selects kernels for the common shapes before the first real request.
+   *
+   * Utterances of 1, 2, 4, ..., max_duration seconds are decoded with
+   * 1, 2, 4, ..., max_batch_size streams at a time.
+   *
+   * @param num_runs Number of runs of each shape. Nothing is run if it is
+   *                 not positive.
+   * @param max_batch_size Largest number of streams decoded together. It is
+   *                       at least 1.
+   * @param max_duration Length in seconds of the longest utterance. It is
+   *                     at least 1.
+   */
+  void WarmUp(int32_t num_runs, int32_t max_batch_size = 1,
+              float max_duration = 8) const;
+
  private:
   std::unique_ptr<OfflineRecognizerImpl> impl_;
 };
@@ -21,6 +21,10 @@ void OfflineSpeakerSegmentationModelConfig::Register(ParseOptions *po) {
 
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
+
+  po->Register("use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
 }
 
 bool OfflineSpeakerSegmentationModelConfig::Validate() const {
@@ -49,7 +53,9 @@ std::string OfflineSpeakerSegmentationModelConfig::ToString() const {
   os << "pyannote=" << pyannote.ToString() << ", ";
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
-  os << "provider=\"" << provider << "\")";
+  os << "provider=\"" << provider << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ")";
 
   return os.str();
 }
@@ -18,6 +18,10 @@ struct OfflineSpeakerSegmentationModelConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   OfflineSpeakerSegmentationModelConfig() = default;
 
   explicit OfflineSpeakerSegmentationModelConfig(
@@ -19,6 +19,10 @@ void OfflineSpeechDenoiserModelConfig::Register(ParseOptions *po) {
 
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
+
+  po->Register("use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
 }
 
 bool OfflineSpeechDenoiserModelConfig::Validate() const {
@@ -32,7 +36,9 @@ std::string OfflineSpeechDenoiserModelConfig::ToString() const {
   os << "gtcrn=" << gtcrn.ToString() << ", ";
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
-  os << "provider=\"" << provider << "\")";
+  os << "provider=\"" << provider << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ")";
 
   return os.str();
 }
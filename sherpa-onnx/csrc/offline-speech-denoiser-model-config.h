@@ -18,6 +18,10 @@ struct OfflineSpeechDenoiserModelConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   OfflineSpeechDenoiserModelConfig() = default;
 
   OfflineSpeechDenoiserModelConfig(OfflineSpeechDenoiserGtcrnModelConfig gtcrn,
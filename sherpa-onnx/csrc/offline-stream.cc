@@ -138,6 +138,12 @@ class OfflineStream::Impl {
   }
 
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
+    AcceptPartialWaveform(sampling_rate, waveform, n);
+    InputFinished();
+  }
+
+  void AcceptPartialWaveform(int32_t sampling_rate, const float *waveform,
+                             int32_t n) {
     if (config_.normalize_samples) {
       AcceptWaveformImpl(sampling_rate, waveform, n);
     } else {
@@ -149,9 +155,33 @@ class OfflineStream::Impl {
     }
   }
 
+  void InputFinished() {
+    if (resampler_) {
+      // Flush samples buffered inside the resampler
+      std::vector<float> samples;
+      resampler_->Resample(nullptr, 0, true, &samples);
+      AcceptResampledWaveform(samples.data(), samples.size());
+    }
+
+    if (is_moonshine_) {
+      return;
+    } else if (fbank_) {
+      fbank_->InputFinished();
+    } else if (mfcc_) {
+      mfcc_->InputFinished();
+    } else {
+      whisper_fbank_->InputFinished();
+    }
+  }
+
   void AcceptWaveformImpl(int32_t sampling_rate, const float *waveform,
                           int32_t n) {
-    if (sampling_rate != config_.sampling_rate) {
+    if (sampling_rate == config_.sampling_rate) {
+      AcceptResampledWaveform(waveform, n);
+      return;
+    }
+
+    if (!resampler_) {
       SHERPA_ONNX_LOGE(
           "Creating a resampler:\n"
           "   in_sample_rate: %d\n"
@@ -162,42 +192,32 @@ class OfflineStream::Impl {
       float lowpass_cutoff = 0.99 * 0.5 * min_freq;
 
       int32_t lowpass_filter_width = 6;
-      auto resampler = std::make_unique<LinearResample>(
+      resampler_ = std::make_unique<LinearResample>(
           sampling_rate, config_.sampling_rate, lowpass_cutoff,
           lowpass_filter_width);
-      std::vector<float> samples;
-      resampler->Resample(waveform, n, true, &samples);
-
-      if (is_moonshine_) {
-        samples_.insert(samples_.end(), samples.begin(), samples.end());
-      } else if (fbank_) {
-        fbank_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                               samples.size());
-        fbank_->InputFinished();
-      } else if (mfcc_) {
-        mfcc_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                              samples.size());
-        mfcc_->InputFinished();
-      } else {
-        whisper_fbank_->AcceptWaveform(config_.sampling_rate, samples.data(),
-                                       samples.size());
-        whisper_fbank_->InputFinished();
-      }
+    } else if (sampling_rate != resampler_->GetInputSamplingRate()) {
+      SHERPA_ONNX_LOGE(
+          "You changed the input sampling rate!! Expected: %d, given: "
+          "%d",
+          resampler_->GetInputSamplingRate(), sampling_rate);
+      exit(-1);
+    }
 
-      return;
-    }  // if (sampling_rate != config_.sampling_rate)
+    std::vector<float> samples;
+    resampler_->Resample(waveform, n, false, &samples);
+    AcceptResampledWaveform(samples.data(), samples.size());
+  }
 
+  // The samples are at config_.sampling_rate
+  void AcceptResampledWaveform(const float *waveform, int32_t n) {
     if (is_moonshine_) {
       samples_.insert(samples_.end(), waveform, waveform + n);
     } else if (fbank_) {
-      fbank_->AcceptWaveform(sampling_rate, waveform, n);
-      fbank_->InputFinished();
+      fbank_->AcceptWaveform(config_.sampling_rate, waveform, n);
     } else if (mfcc_) {
-      mfcc_->AcceptWaveform(sampling_rate, waveform, n);
-      mfcc_->InputFinished();
+      mfcc_->AcceptWaveform(config_.sampling_rate, waveform, n);
     } else {
-      whisper_fbank_->AcceptWaveform(sampling_rate, waveform, n);
-      whisper_fbank_->InputFinished();
+      whisper_fbank_->AcceptWaveform(config_.sampling_rate, waveform, n);
     }
   }
 
@@ -209,14 +229,22 @@ class OfflineStream::Impl {
     return mfcc_ ? mfcc_opts_.num_ceps : opts_.mel_opts.num_bins;
   }
 
+  int32_t NumFrames() const {
+    if (is_moonshine_) {
+      return samples_.size() / (config_.sampling_rate / 100);
+    }
+
+    return fbank_  ? fbank_->NumFramesReady()
+           : mfcc_ ? mfcc_->NumFramesReady()
+                   : whisper_fbank_->NumFramesReady();
+  }
+
   std::vector<float> GetFrames() const {
     if (is_moonshine_) {
       return samples_;
     }
 
-    int32_t n = fbank_  ? fbank_->NumFramesReady()
-                : mfcc_ ? mfcc_->NumFramesReady()
-                        : whisper_fbank_->NumFramesReady();
+    int32_t n = NumFrames();
     assert(n > 0 && "Please first call AcceptWaveform()");
 
     int32_t feature_dim = FeatureDim();
@@ -320,6 +348,10 @@ class OfflineStream::Impl {
 
   // used only when is_moonshine_== true
   std::vector<float> samples_;
+
+  // Created on the first call to AcceptWaveform() if the input sampling
+  // rate differs from config_.sampling_rate
+  std::unique_ptr<LinearResample> resampler_;
 };
 
 OfflineStream::OfflineStream(const FeatureExtractorConfig &config /*= {}*/,
@@ -341,8 +373,33 @@ void OfflineStream::AcceptWaveform(int32_t sampling_rate, const float *waveform,
   impl_->AcceptWaveform(sampling_rate, waveform, n);
 }
 
+void OfflineStream::AcceptWaveform(int32_t sampling_rate,
+                                   const CircularBufferView &waveform) const {
+  if (waveform.size1) {
+    impl_->AcceptPartialWaveform(sampling_rate, waveform.data1,
+                                 waveform.size1);
+  }
+
+  if (waveform.size2) {
+    impl_->AcceptPartialWaveform(sampling_rate, waveform.data2,
+                                 waveform.size2);
+  }
+
+  impl_->InputFinished();
+}
+
+void OfflineStream::AcceptPartialWaveform(int32_t sampling_rate,
+                                          const float *waveform,
+                                          int32_t n) const {
+  impl_->AcceptPartialWaveform(sampling_rate, waveform, n);
+}
+
+void OfflineStream::InputFinished() const { impl_->InputFinished(); }
+
 int32_t OfflineStream::FeatureDim() const { return impl_->FeatureDim(); }
 
+int32_t OfflineStream::NumFrames() const { return impl_->NumFrames(); }
+
 std::vector<float> OfflineStream::GetFrames() const {
   return impl_->GetFrames();
 }
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "sherpa-onnx/csrc/circular-buffer.h"
 #include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/features.h"
 #include "sherpa-onnx/csrc/parse-options.h"
@@ -77,12 +78,43 @@ class OfflineStream {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  /** Like the above overload, but the samples are given as a view, e.g.,
+   * a speech segment from VoiceActivityDetector::FrontView(), so they
+   * are not copied into a contiguous array first.
+   */
+  void AcceptWaveform(int32_t sampling_rate,
+                      const CircularBufferView &waveform) const;
+
+  /** Accept a part of the input samples. Features are computed
+   * incrementally as samples arrive. It can be called multiple times.
+   * Call InputFinished() after the last part.
+   *
+   * It has the same arguments as AcceptWaveform(). The sampling rate
+   * must be the same for all parts of a stream.
+   *
+   * Note: Do not mix it with AcceptWaveform().
+   */
+  void AcceptPartialWaveform(int32_t sampling_rate, const float *waveform,
+                             int32_t n) const;
+
+  /** Signal that there are no more samples for this stream.
+   * Must be called after the last AcceptPartialWaveform().
+   */
+  void InputFinished() const;
+
   /// Return feature dim of this extractor.
   ///
   /// Note: if it is Moonshine, then it returns the number of audio samples
   /// currently received.
   int32_t FeatureDim() const;
 
+  /// Return number of feature frames of this stream. It does not copy the
+  /// features.
+  ///
+  /// Note: if it is Moonshine, then it returns the number of 10 ms
+  /// frames of the audio samples currently received.
+  int32_t NumFrames() const;
+
   // Get all the feature frames of this stream in a 1-D array, which is
   // flattened from a 2-D array of shape (num_frames, feat_dim).
   std::vector<float> GetFrames() const;
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-transducer-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <array>
 #include <iterator>
 #include <utility>
 
@@ -14,6 +15,27 @@
 
 namespace sherpa_onnx {
 
+// Build the decoder input for the given rows of results only
+static Ort::Value BuildDecoderInput(
+    OfflineTransducerModel *model,
+    const std::vector<OfflineTransducerDecoderResult> &results,
+    const std::vector<int32_t> &rows) {
+  int32_t context_size = model->ContextSize();
+  std::array<int64_t, 2> shape{static_cast<int64_t>(rows.size()),
+                               context_size};
+  Ort::Value decoder_input = Ort::Value::CreateTensor<int64_t>(
+      model->Allocator(), shape.data(), shape.size());
+  int64_t *p = decoder_input.GetTensorMutableData<int64_t>();
+
+  for (auto i : rows) {
+    const auto &tokens = results[i].tokens;
+    std::copy(tokens.end() - context_size, tokens.end(), p);
+    p += context_size;
+  }
+
+  return decoder_input;
+}
+
 std::vector<OfflineTransducerDecoderResult>
 OfflineTransducerGreedySearchDecoder::Decode(Ort::Value encoder_out,
                                              Ort::Value encoder_out_length,
@@ -38,6 +60,10 @@ OfflineTransducerGreedySearchDecoder::Decode(Ort::Value encoder_out,
   auto decoder_input = model_->BuildDecoderInput(ans, ans.size());
   Ort::Value decoder_out = model_->RunDecoder(std::move(decoder_input));
 
+  // Utterances that have emitted a token in the current frame
+  std::vector<int32_t> emitted_rows;
+  emitted_rows.reserve(batch_size);
+
   int32_t start = 0;
   int32_t t = 0;
   for (auto n : packed_encoder_out.batch_sizes) {
@@ -47,7 +73,7 @@ OfflineTransducerGreedySearchDecoder::Decode(Ort::Value encoder_out,
     Ort::Value logit = model_->RunJoiner(std::move(cur_encoder_out),
                                          std::move(cur_decoder_out));
     float *p_logit = logit.GetTensorMutableData<float>();
-    bool emitted = false;
+    emitted_rows.clear();
     for (int32_t i = 0; i != n; ++i) {
       if (blank_penalty_ > 0.0) {
         p_logit[0] -= blank_penalty_;  // assuming blank id is 0
@@ -62,12 +88,18 @@ OfflineTransducerGreedySearchDecoder::Decode(Ort::Value encoder_out,
       if (y != 0 && y != unk_id_) {
         ans[i].tokens.push_back(y);
         ans[i].timestamps.push_back(t);
-        emitted = true;
+        emitted_rows.push_back(i);
       }
     }
-    if (emitted) {
+    if (static_cast<int32_t>(emitted_rows.size()) == n) {
       Ort::Value decoder_input = model_->BuildDecoderInput(ans, n);
       decoder_out = model_->RunDecoder(std::move(decoder_input));
+    } else if (!emitted_rows.empty()) {
+      // Run the decoder only for utterances that have emitted a token
+      // and copy the outputs to their rows of decoder_out
+      Ort::Value decoder_input = BuildDecoderInput(model_, ans, emitted_rows);
+      Ort::Value new_decoder_out = model_->RunDecoder(std::move(decoder_input));
+      ScatterRows(&new_decoder_out, emitted_rows, &decoder_out);
     }
     ++t;
   }
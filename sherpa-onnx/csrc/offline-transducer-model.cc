@@ -19,9 +19,11 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/offline-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/session.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace sherpa_onnx {
 
@@ -155,8 +157,8 @@ class OfflineTransducerModel::Impl {
 
  private:
   void InitEncoder(void *model_data, size_t model_data_length) {
-    encoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                  sess_opts_);
 
     GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                   &encoder_input_names_ptr_);
@@ -179,8 +181,8 @@ class OfflineTransducerModel::Impl {
   }
 
   void InitDecoder(void *model_data, size_t model_data_length) {
-    decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                  sess_opts_);
 
     GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                   &decoder_input_names_ptr_);
@@ -203,8 +205,8 @@ class OfflineTransducerModel::Impl {
   }
 
   void InitJoiner(void *model_data, size_t model_data_length) {
-    joiner_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    joiner_sess_ = CreateSession(env_, model_data, model_data_length,
+                                 sess_opts_);
 
     GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                   &joiner_input_names_ptr_);
@@ -270,11 +272,21 @@ std::pair<Ort::Value, Ort::Value> OfflineTransducerModel::RunEncoder(
 }
 
 Ort::Value OfflineTransducerModel::RunDecoder(Ort::Value decoder_input) {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_offline_decoder_seconds",
+                             "Time to run the decoder model");
+  SHERPA_ONNX_TRACE_SCOPE("OfflineTransducerModel::RunDecoder");
+  SHERPA_ONNX_COUNTER_INC(
+      "sherpa_onnx_offline_decoder_rows_total",
+      "Number of hypotheses the decoder model has been run on",
+      decoder_input.GetTensorTypeAndShapeInfo().GetShape()[0]);
   return impl_->RunDecoder(std::move(decoder_input));
 }
 
 Ort::Value OfflineTransducerModel::RunJoiner(Ort::Value encoder_out,
                                              Ort::Value decoder_out) {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_offline_joiner_seconds",
+                             "Time to run the joiner model");
+  SHERPA_ONNX_TRACE_SCOPE("OfflineTransducerModel::RunJoiner");
   return impl_->RunJoiner(std::move(encoder_out), std::move(decoder_out));
 }
 
@@ -47,6 +47,9 @@ class OfflineTransducerModel {
    * https://github.com/k2-fsa/icefall/blob/master/egs/librispeech/ASR/pruned_transducer_stateless2/decoder.py
    *          for an example
    *
+   * It records the time spent in the decoder and the number of rows
+   * in metrics.
+   *
    * @param decoder_input It is usually of shape (N, context_size)
    * @return Return a tensor of shape (N, decoder_dim).
    */
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-tts-impl.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #if __ANDROID_API__ >= 9
@@ -19,6 +20,7 @@
 #include "sherpa-onnx/csrc/offline-tts-kokoro-impl.h"
 #include "sherpa-onnx/csrc/offline-tts-matcha-impl.h"
 #include "sherpa-onnx/csrc/offline-tts-vits-impl.h"
+#include "sherpa-onnx/csrc/warm-up.h"
 
 namespace sherpa_onnx {
 
@@ -34,6 +36,26 @@ std::vector<int64_t> OfflineTtsImpl::AddBlank(const std::vector<int64_t> &x,
   return buffer;
 }
 
+void OfflineTtsImpl::WarmUp(int32_t num_runs) const {
+  if (num_runs <= 0) {
+    return;
+  }
+
+  // English and Chinese so that most lexicons know some of the words
+  const std::string kSentence = "This is a warm up sentence. 这是预热。";
+
+  for (int32_t n : PowersOfTwoUpTo(4)) {
+    std::string text;
+    for (int32_t k = 0; k != n; ++k) {
+      text += kSentence + " ";
+    }
+
+    for (int32_t i = 0; i < num_runs; ++i) {
+      Generate(text);
+    }
+  }
+}
+
 std::unique_ptr<OfflineTtsImpl> OfflineTtsImpl::Create(
     const OfflineTtsConfig &config) {
   if (!config.model.vits.model.empty()) {
@@ -36,6 +36,11 @@ class OfflineTtsImpl {
 
   std::vector<int64_t> AddBlank(const std::vector<int64_t> &x,
                                 int32_t blank_id = 0) const;
+
+  // Generate audio num_runs times for each of a short, a medium and a long
+  // text so that the first requests do not pay for memory allocation and
+  // kernel selection of these lengths
+  void WarmUp(int32_t num_runs) const;
 };
 
 }  // namespace sherpa_onnx
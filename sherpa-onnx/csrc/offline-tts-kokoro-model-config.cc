@@ -30,6 +30,10 @@ void OfflineTtsKokoroModelConfig::Register(ParseOptions *po) {
                "Used only for Kokoro >= v1.0");
   po->Register("kokoro-length-scale", &length_scale,
                "Speech speed. Larger->Slower; Smaller->faster.");
+  po->Register("kokoro-lazy-voices", &lazy_voices,
+               "true to load the style embeddings of a speaker from "
+               "--kokoro-voices only when the speaker is used. Useful for "
+               "multi-speaker models when only a few speakers are used.");
 }
 
 bool OfflineTtsKokoroModelConfig::Validate() const {
@@ -127,7 +131,8 @@ std::string OfflineTtsKokoroModelConfig::ToString() const {
   os << "lexicon=\"" << lexicon << "\", ";
   os << "data_dir=\"" << data_dir << "\", ";
   os << "dict_dir=\"" << dict_dir << "\", ";
-  os << "length_scale=" << length_scale << ")";
+  os << "length_scale=" << length_scale << ", ";
+  os << "lazy_voices=" << (lazy_voices ? "True" : "False") << ")";
 
   return os.str();
 }
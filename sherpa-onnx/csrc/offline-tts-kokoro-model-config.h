@@ -27,6 +27,11 @@ struct OfflineTtsKokoroModelConfig {
   // speed = 1 / length_scale
   float length_scale = 1.0;
 
+  // voices.bin is always memory-mapped. If lazy_voices is true, only the
+  // pages of the speakers that are actually used are loaded into memory.
+  // Otherwise, the whole file is read ahead at startup.
+  bool lazy_voices = false;
+
   OfflineTtsKokoroModelConfig() = default;
 
   OfflineTtsKokoroModelConfig(const std::string &model,
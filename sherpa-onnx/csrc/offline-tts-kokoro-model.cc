@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-tts-kokoro-model.h"
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -20,6 +21,7 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/mapped-file.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
@@ -34,9 +36,18 @@ class OfflineTtsKokoroModel::Impl {
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     auto model_buf = ReadFile(config.kokoro.model);
-    auto voices_buf = ReadFile(config.kokoro.voices);
-    Init(model_buf.data(), model_buf.size(), voices_buf.data(),
-         voices_buf.size());
+
+    // voices.bin is mapped read-only and shared by all instances in
+    // this process that use the same file
+    voices_ = GetSharedMappedFile(config.kokoro.voices,
+                                  config.kokoro.lazy_voices);
+    if (!voices_) {
+      SHERPA_ONNX_LOGE("Failed to load --kokoro-voices '%s'",
+                       config.kokoro.voices.c_str());
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    Init(model_buf.data(), model_buf.size());
   }
 
   template <typename Manager>
@@ -46,9 +57,12 @@ class OfflineTtsKokoroModel::Impl {
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     auto model_buf = ReadFile(mgr, config.kokoro.model);
-    auto voices_buf = ReadFile(mgr, config.kokoro.voices);
-    Init(model_buf.data(), model_buf.size(), voices_buf.data(),
-         voices_buf.size());
+
+    // Files from an asset manager cannot be mapped, so we keep a copy
+    voices_ =
+        std::make_shared<MappedFile>(ReadFile(mgr, config.kokoro.voices));
+
+    Init(model_buf.data(), model_buf.size());
   }
 
   const OfflineTtsKokoroModelMetaData &GetMetaData() const {
@@ -76,12 +90,21 @@ class OfflineTtsKokoroModel::Impl {
       SHERPA_ONNX_EXIT(-1);
     }
 
-    /*const*/ float *p = styles_.data() + sid * dim0 * dim1 + len * dim1;
+    if (sid < 0 || sid >= num_speakers) {
+      SHERPA_ONNX_LOGE("sid should be in the range [0, %d). Given: %d",
+                       num_speakers, sid);
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    const float *p = GetStyle(sid, len);
 
     std::array<int64_t, 2> style_embedding_shape = {1, dim1};
+
+    // The style embedding points into the read-only mapping of voices.bin.
+    // It is safe since onnxruntime never writes to its inputs.
     Ort::Value style_embedding = Ort::Value::CreateTensor(
-        memory_info, p, dim1, style_embedding_shape.data(),
-        style_embedding_shape.size());
+        memory_info, const_cast<float *>(p), dim1,
+        style_embedding_shape.data(), style_embedding_shape.size());
 
     int64_t speed_shape = 1;
 
@@ -99,10 +122,25 @@ class OfflineTtsKokoroModel::Impl {
   }
 
  private:
-  void Init(void *model_data, size_t model_data_length, const char *voices_data,
-            size_t voices_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+  // Return a pointer to the style embedding of shape (style_dim_[2],)
+  // for the given speaker and token length
+  const float *GetStyle(int32_t sid, int32_t len) {
+    int32_t dim0 = style_dim_[0];
+    int32_t dim1 = style_dim_[2];
+    size_t speaker_size = static_cast<size_t>(dim0) * dim1 * sizeof(float);
+
+    if (config_.kokoro.lazy_voices) {
+      // Read ahead the pages of this speaker only. Pages of speakers
+      // that are never used are never loaded.
+      voices_->Prefetch(sid * speaker_size, speaker_size);
+    }
+
+    return styles_ + static_cast<size_t>(sid) * dim0 * dim1 +
+           static_cast<size_t>(len) * dim1;
+  }
+
+  void Init(void *model_data, size_t model_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -171,7 +209,7 @@ class OfflineTtsKokoroModel::Impl {
       SHERPA_ONNX_EXIT(-1);
     }
 
-    int32_t actual_num_floats = voices_data_length / sizeof(float);
+    int32_t actual_num_floats = voices_->Size() / sizeof(float);
     int32_t expected_num_floats =
         style_dim_[0] * style_dim_[2] * meta_data_.num_speakers;
 
@@ -192,9 +230,7 @@ class OfflineTtsKokoroModel::Impl {
       SHERPA_ONNX_EXIT(-1);
     }
 
-    styles_ = std::vector<float>(
-        reinterpret_cast<const float *>(voices_data),
-        reinterpret_cast<const float *>(voices_data) + expected_num_floats);
+    styles_ = reinterpret_cast<const float *>(voices_->Data());
 
     meta_data_.max_token_len = style_dim_[0];
   }
@@ -216,8 +252,11 @@ class OfflineTtsKokoroModel::Impl {
   OfflineTtsKokoroModelMetaData meta_data_;
   std::vector<int32_t> style_dim_;
 
+  std::shared_ptr<const MappedFile> voices_;
+
+  // Points into voices_.
   // (num_speakers, style_dim_[0], style_dim_[2])
-  std::vector<float> styles_;
+  const float *styles_ = nullptr;
 };
 
 OfflineTtsKokoroModel::OfflineTtsKokoroModel(
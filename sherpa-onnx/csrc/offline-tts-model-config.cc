@@ -22,6 +22,10 @@ void OfflineTtsModelConfig::Register(ParseOptions *po) {
 
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
+
+  po->Register("use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
 }
 
 bool OfflineTtsModelConfig::Validate() const {
@@ -54,8 +58,10 @@ std::string OfflineTtsModelConfig::ToString() const {
   os << "kokoro=" << kokoro.ToString() << ", ";
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
-  os << "provider=\"" << provider << "\")";
-  os << "provider_config=" << provider_config.ToString();
+  os << "provider=\"" << provider << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ", ";
+  os << "provider_config=" << provider_config.ToString() << ")";
 
   return os.str();
 }
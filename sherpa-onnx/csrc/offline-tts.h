@@ -102,6 +102,11 @@ class OfflineTts {
   // If it supports only a single speaker, then it return 0 or 1.
   int32_t NumSpeakers() const;
 
+  // Generate audio for texts of a few lengths so that onnxruntime
+  // allocates memory and selects kernels before the first real request.
+  // Each length is run num_runs times.
+  void WarmUp(int32_t num_runs) const;
+
  private:
   std::unique_ptr<OfflineTtsImpl> impl_;
 };
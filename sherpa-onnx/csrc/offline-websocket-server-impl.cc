@@ -5,22 +5,84 @@
 #include "sherpa-onnx/csrc/offline-websocket-server-impl.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace sherpa_onnx {
 
+void ConnectionData::AcceptBytes(const uint8_t *p, int32_t n) {
+  cur += n;
+
+  int32_t bytes_per_sample = BytesPerSample(format);
+
+  // First, complete the sample that was split across messages
+  if (num_partial_bytes > 0) {
+    int32_t k = std::min(bytes_per_sample - num_partial_bytes, n);
+    std::copy(p, p + k, partial_sample + num_partial_bytes);
+    num_partial_bytes += k;
+    p += k;
+    n -= k;
+
+    if (num_partial_bytes < bytes_per_sample) {
+      return;
+    }
+
+    float f;
+    DecodeAudioSamples(format, partial_sample, 1, &f);
+    stream->AcceptPartialWaveform(sample_rate, &f, 1);
+    num_partial_bytes = 0;
+  }
+
+  int32_t num_samples = n / bytes_per_sample;
+  if (num_samples > 0) {
+    if (format == AudioSampleFormat::kFloat32 &&
+        reinterpret_cast<uintptr_t>(p) % alignof(float) == 0) {
+      stream->AcceptPartialWaveform(
+          sample_rate, reinterpret_cast<const float *>(p), num_samples);
+    } else {
+      std::vector<float> samples(num_samples);
+      DecodeAudioSamples(format, p, num_samples, samples.data());
+      stream->AcceptPartialWaveform(sample_rate, samples.data(), num_samples);
+    }
+
+    p += num_samples * bytes_per_sample;
+    n -= num_samples * bytes_per_sample;
+  }
+
+  std::copy(p, p + n, partial_sample);
+  num_partial_bytes = n;
+}
+
 void OfflineWebsocketDecoderConfig::Register(ParseOptions *po) {
   recognizer_config.Register(po);
-
-  po->Register("max-batch-size", &max_batch_size,
-               "Max batch size for decoding.");
+  batching_config.Register(po);
 
   po->Register(
       "max-utterance-length", &max_utterance_length,
       "Max utterance length in seconds. If we receive an utterance "
       "longer than this value, we will reject the connection. "
       "If you have enough memory, you can select a large value for it.");
+
+  po->Register("batching-stats-interval", &stats_interval,
+               "Print batching statistics, e.g., padding ratio and "
+               "throughput, after every this number of batches. "
+               "0 to disable it.");
+
+  po->Register("warm-up", &warm_up,
+               "Number of warm-up runs of each utterance length and batch "
+               "size before serving. 0 to disable it. Lengths are 1, 2, "
+               "4, ... --warm-up-max-duration seconds and batch sizes are "
+               "1, 2, 4, ... --max-batch-size");
+
+  po->Register("warm-up-max-duration", &warm_up_max_duration,
+               "Length in seconds of the longest utterance of the warm-up");
 }
 
 void OfflineWebsocketDecoderConfig::Validate() const {
@@ -29,8 +91,8 @@ void OfflineWebsocketDecoderConfig::Validate() const {
     exit(-1);
   }
 
-  if (max_batch_size <= 0) {
-    SHERPA_ONNX_LOGE("Expect --max-batch-size > 0. Given: %d", max_batch_size);
+  if (!batching_config.Validate()) {
+    SHERPA_ONNX_LOGE("Error in batching config");
     exit(-1);
   }
 
@@ -39,68 +101,113 @@ void OfflineWebsocketDecoderConfig::Validate() const {
                      max_utterance_length);
     exit(-1);
   }
+
+  if (warm_up < 0) {
+    SHERPA_ONNX_LOGE("Expect --warm-up >= 0. Given: %d", warm_up);
+    exit(-1);
+  }
+
+  if (warm_up > 0 && warm_up_max_duration < 1) {
+    SHERPA_ONNX_LOGE("Expect --warm-up-max-duration >= 1. Given: %f",
+                     warm_up_max_duration);
+    exit(-1);
+  }
 }
 
 OfflineWebsocketDecoder::OfflineWebsocketDecoder(OfflineWebsocketServer *server)
     : config_(server->GetConfig().decoder_config),
+      streams_(config_.batching_config),
       server_(server),
-      recognizer_(config_.recognizer_config) {}
+      recognizer_(config_.recognizer_config) {
+  queue_depth_ = MetricsRegistry::Global().GetGauge(
+      "sherpa_onnx_offline_server_queue_depth",
+      "Number of utterances that are waiting to be decoded");
+}
+
+void OfflineWebsocketDecoder::WarmUp() const {
+  recognizer_.WarmUp(config_.warm_up, config_.batching_config.max_batch_size,
+                     config_.warm_up_max_duration);
+}
 
 void OfflineWebsocketDecoder::Push(connection_hdl hdl, ConnectionDataPtr d) {
+  // 100 frames per second, i.e., 10 ms frame shift
+  int32_t num_frames = d->stream->NumFrames();
+
   std::lock_guard<std::mutex> lock(mutex_);
-  streams_.push_back({hdl, d});
+  streams_.Push({hdl, d}, num_frames);
+  queue_depth_->Set(streams_.Size());
+  SHERPA_ONNX_TRACE_COUNTER("pending_utterances", streams_.Size());
+}
+
+void OfflineWebsocketDecoder::ScheduleDecode(int32_t delay_ms) {
+  if (timer_pending_) {
+    // The pending timer expires no later than the new deadline since
+    // utterances are enqueued in time order.
+    return;
+  }
+
+  timer_pending_ = true;
+
+  auto timer = std::make_shared<asio::steady_timer>(
+      server_->GetWorkContext(), std::chrono::milliseconds(delay_ms));
+
+  timer->async_wait([this, timer](const asio::error_code & /*ec*/) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      timer_pending_ = false;
+    }
+    Decode();
+  });
 }
 
 void OfflineWebsocketDecoder::Decode() {
+  SHERPA_ONNX_TRACE_SCOPE("OfflineWebsocketDecoder::Decode");
+
   std::unique_lock<std::mutex> lock(mutex_);
-  if (streams_.empty()) {
+
+  std::vector<std::pair<connection_hdl, ConnectionDataPtr>> batch;
+  int32_t wait_ms = 0;
+  if (!streams_.Pop(&batch, &wait_ms)) {
+    if (wait_ms > 0) {
+      ScheduleDecode(wait_ms);
+    }
     return;
   }
 
-  int32_t size =
-      std::min(static_cast<int32_t>(streams_.size()), config_.max_batch_size);
-  SHERPA_ONNX_LOGE("size: %d", size);
+  queue_depth_->Set(streams_.Size());
+  SHERPA_ONNX_TRACE_COUNTER("pending_utterances", streams_.Size());
+
+  if (!streams_.Empty()) {
+    // There may be more batches ready. Let another work thread take them.
+    asio::post(server_->GetWorkContext(), [this]() { Decode(); });
+  }
 
   // We first lock the mutex for streams_, take items from it, and then
   // unlock the mutex; in doing so we don't need to lock the mutex to
   // access hdl and connection_data later.
-  std::vector<connection_hdl> handles(size);
+  lock.unlock();
 
-  // Store connection_data here to prevent the data from being freed
-  // while we are still using it.
-  std::vector<ConnectionDataPtr> connection_data(size);
+  int32_t size = static_cast<int32_t>(batch.size());
 
-  std::vector<const float *> samples(size);
-  std::vector<int32_t> samples_length(size);
-  std::vector<std::unique_ptr<OfflineStream>> ss(size);
+  // Features have been computed while receiving the samples.
+  // batch[i].second keeps the stream alive while we are still using it.
   std::vector<OfflineStream *> p_ss(size);
-
   for (int32_t i = 0; i != size; ++i) {
-    auto &p = streams_.front();
-    handles[i] = p.first;
-    connection_data[i] = p.second;
-    streams_.pop_front();
-
-    auto sample_rate = connection_data[i]->sample_rate;
-    auto samples =
-        reinterpret_cast<const float *>(&connection_data[i]->data[0]);
-    auto num_samples = connection_data[i]->expected_byte_size / sizeof(float);
-    auto s = recognizer_.CreateStream();
-    s->AcceptWaveform(sample_rate, samples, num_samples);
-
-    ss[i] = std::move(s);
-    p_ss[i] = ss[i].get();
+    p_ss[i] = batch[i].second->stream.get();
   }
 
-  lock.unlock();
+  auto start = std::chrono::steady_clock::now();
 
   // Note: DecodeStreams is thread-safe
   recognizer_.DecodeStreams(p_ss.data(), size);
 
+  auto end = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(end - start).count();
+
   for (int32_t i = 0; i != size; ++i) {
-    connection_hdl hdl = handles[i];
+    connection_hdl hdl = batch[i].first;
     asio::post(server_->GetConnectionContext(),
-               [this, hdl, result = ss[i]->GetResult()]() {
+               [this, hdl, result = p_ss[i]->GetResult()]() {
                  websocketpp::lib::error_code ec;
                  server_->GetServer().send(hdl, result.AsJsonString(),
                                            websocketpp::frame::opcode::text,
@@ -111,6 +218,15 @@ void OfflineWebsocketDecoder::Decode() {
                  }
                });
   }
+
+  lock.lock();
+  streams_.AddProcessingTime(elapsed);
+
+  const auto &stats = streams_.GetStats();
+  if (config_.stats_interval > 0 &&
+      stats.num_batches % config_.stats_interval == 0) {
+    SHERPA_ONNX_LOGE("%s", stats.ToString().c_str());
+  }
 }
 
 void OfflineWebsocketServerConfig::Register(ParseOptions *po) {
@@ -118,6 +234,10 @@ void OfflineWebsocketServerConfig::Register(ParseOptions *po) {
   po->Register("log-file", &log_file,
                "Path to the log file. Logs are "
                "appended to this file");
+
+  po->Register("enable-metrics", &enable_metrics,
+               "If true, export latency, throughput and queue metrics at "
+               "http://<server-ip>:<port>/metrics");
 }
 
 void OfflineWebsocketServerConfig::Validate() const {
@@ -136,8 +256,21 @@ OfflineWebsocketServer::OfflineWebsocketServer(
       decoder_(this) {
   SetupLog();
 
+  num_connections_ = MetricsRegistry::Global().GetGauge(
+      "sherpa_onnx_offline_server_connections",
+      "Number of active websocket connections");
+
+  if (config_.enable_metrics) {
+    MetricsRegistry::SetEnabled(true);
+  }
+
   server_.init_asio(&io_conn_);
 
+  server_.set_http_handler([this](connection_hdl hdl) { OnHttp(hdl); });
+
+  server_.set_validate_handler(
+      [this](connection_hdl hdl) { return OnValidate(hdl); });
+
   server_.set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
 
   server_.set_close_handler([this](connection_hdl hdl) { OnClose(hdl); });
@@ -161,6 +294,7 @@ void OfflineWebsocketServer::SetupLog() {
 void OfflineWebsocketServer::OnOpen(connection_hdl hdl) {
   std::lock_guard<std::mutex> lock(mutex_);
   connections_.emplace(hdl, std::make_shared<ConnectionData>());
+  num_connections_->Set(connections_.size());
 
   SHERPA_ONNX_LOGE("Number of active connections: %d",
                    static_cast<int32_t>(connections_.size()));
@@ -169,11 +303,47 @@ void OfflineWebsocketServer::OnOpen(connection_hdl hdl) {
 void OfflineWebsocketServer::OnClose(connection_hdl hdl) {
   std::lock_guard<std::mutex> lock(mutex_);
   connections_.erase(hdl);
+  num_connections_->Set(connections_.size());
 
   SHERPA_ONNX_LOGE("Number of active connections: %d",
                    static_cast<int32_t>(connections_.size()));
 }
 
+bool OfflineWebsocketServer::OnValidate(connection_hdl hdl) {
+  if (ready_) {
+    return true;
+  }
+
+  auto con = server_.get_con_from_hdl(hdl);
+  con->set_status(websocketpp::http::status_code::service_unavailable);
+  return false;
+}
+
+void OfflineWebsocketServer::OnHttp(connection_hdl hdl) {
+  auto con = server_.get_con_from_hdl(hdl);
+
+  if (con->get_resource() == "/ready") {
+    if (ready_) {
+      con->set_status(websocketpp::http::status_code::ok);
+      con->set_body("Ready\n");
+    } else {
+      con->set_status(websocketpp::http::status_code::service_unavailable);
+      con->set_body("Warming up\n");
+    }
+    return;
+  }
+
+  if (!config_.enable_metrics || con->get_resource() != "/metrics") {
+    con->set_status(websocketpp::http::status_code::not_found);
+    con->set_body("Not found. Please use a websocket client\n");
+    return;
+  }
+
+  con->set_status(websocketpp::http::status_code::ok);
+  con->append_header("Content-Type", "text/plain; version=0.0.4");
+  con->set_body(MetricsRegistry::Global().ToText());
+}
+
 void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
                                        server::message_ptr msg) {
   std::unique_lock<std::mutex> lock(mutex_);
@@ -181,12 +351,20 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
   lock.unlock();
   const std::string &payload = msg->get_payload();
 
+  // Used only by AUDIO_FORMAT messages. The sample rate in the header of
+  // each audio file takes precedence.
+  int32_t sample_rate = 0;
+
   switch (msg->get_opcode()) {
     case websocketpp::frame::opcode::text:
       if (payload == "Done") {
         // The client will not send any more data. We can close the
         // connection now.
         Close(hdl, websocketpp::close::status::normal, "Done");
+      } else if (connection_data->expected_byte_size == 0 &&
+                 ParseAudioFormatMessage(payload, &connection_data->format,
+                                         &sample_rate)) {
+        // The format is used for the following audio files
       } else {
         Close(hdl, websocketpp::close::status::normal,
               std::string("Invalid payload: ") + payload);
@@ -194,7 +372,8 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
       break;
 
     case websocketpp::frame::opcode::binary: {
-      auto p = reinterpret_cast<const int8_t *>(payload.data());
+      auto p = reinterpret_cast<const uint8_t *>(payload.data());
+      int32_t n = static_cast<int32_t>(payload.size());
 
       if (connection_data->expected_byte_size == 0) {
         if (payload.size() < 8) {
@@ -208,11 +387,14 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
         connection_data->expected_byte_size =
             *reinterpret_cast<const int32_t *>(p + 4);
 
+        int32_t bytes_per_sample = BytesPerSample(connection_data->format);
+
         int32_t max_byte_size_ = decoder_.GetConfig().max_utterance_length *
-                                 connection_data->sample_rate * sizeof(float);
+                                 connection_data->sample_rate *
+                                 bytes_per_sample;
         if (connection_data->expected_byte_size > max_byte_size_) {
           float num_samples =
-              connection_data->expected_byte_size / sizeof(float);
+              connection_data->expected_byte_size / bytes_per_sample;
 
           float duration = num_samples / connection_data->sample_rate;
 
@@ -225,29 +407,38 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
           break;
         }
 
-        connection_data->data.resize(connection_data->expected_byte_size);
-        std::copy(payload.begin() + 8, payload.end(),
-                  connection_data->data.data());
-        connection_data->cur = payload.size() - 8;
-      } else {
-        std::copy(payload.begin(), payload.end(),
-                  connection_data->data.data() + connection_data->cur);
-        connection_data->cur += payload.size();
+        connection_data->stream = decoder_.CreateStream();
+
+        p += 8;
+        n -= 8;
       }
 
+      if (connection_data->cur + n > connection_data->expected_byte_size) {
+        Close(hdl, websocketpp::close::status::normal,
+              "Received more bytes than expected");
+        break;
+      }
+
+      connection_data->AcceptBytes(p, n);
+
       if (connection_data->expected_byte_size == connection_data->cur) {
+        if (connection_data->num_partial_bytes != 0) {
+          Close(hdl, websocketpp::close::status::normal,
+                "Number of bytes is not a multiple of the sample size");
+          break;
+        }
+
+        // Decoding can start right away since features are ready
+        connection_data->stream->InputFinished();
+
         auto d = std::make_shared<ConnectionData>(std::move(*connection_data));
         // Clear it so that we can handle the next audio file from the client.
         // The client can send multiple audio files for recognition without
         // the need to create another connection.
-        connection_data->sample_rate = 0;
-        connection_data->expected_byte_size = 0;
-        connection_data->cur = 0;
+        connection_data->Clear();
 
         decoder_.Push(hdl, d);
 
-        connection_data->Clear();
-
         asio::post(io_work_, [this]() { decoder_.Decode(); });
       }
       break;
@@ -281,6 +472,22 @@ void OfflineWebsocketServer::Run(uint16_t port) {
   server_.set_reuse_addr(true);
   server_.listen(asio::ip::tcp::v4(), port);
   server_.start_accept();
+
+  // The warm-up runs in a work thread so that GET /ready is answered while
+  // it is running
+  asio::post(io_work_, [this]() {
+    if (config_.decoder_config.warm_up > 0) {
+      auto start = std::chrono::steady_clock::now();
+      decoder_.WarmUp();
+      float elapsed_seconds =
+          std::chrono::duration<float>(std::chrono::steady_clock::now() -
+                                       start)
+              .count();
+      SHERPA_ONNX_LOGE("Warm up completed in %.3f s.", elapsed_seconds);
+    }
+
+    ready_ = true;
+  });
 }
 
 }  // namespace sherpa_onnx
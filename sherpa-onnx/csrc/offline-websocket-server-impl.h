@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <atomic>
 #include <deque>
 #include <fstream>
 #include <map>
@@ -13,6 +14,9 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/audio-sample-format.h"
+#include "sherpa-onnx/csrc/length-bucketed-batcher.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/tee-stream.h"
@@ -36,6 +40,13 @@ namespace sherpa_onnx {
  * The byte stream can be broken into arbitrary number of messages.
  * We require that the first message has to be at least 8 bytes so that
  * we can get `sample_rate` and `expected_byte_size` from the first message.
+ *
+ * To send samples in a more compact format, the client can send a text
+ * message "AUDIO_FORMAT <format> <sample_rate>" before the byte stream,
+ * where format is one of float32, int16, mulaw, alaw. It applies to all
+ * subsequent audio files of the connection. `expected_byte_size` is then
+ * the number of bytes in that format. The sample rate from the 8-byte
+ * header takes precedence. See also audio-sample-format.h
  */
 struct ConnectionData {
   // Sample rate of the audio samples the client
@@ -47,16 +58,29 @@ struct ConnectionData {
   // Number of bytes received so far
   int32_t cur = 0;
 
-  // It saves the received samples from the client.
-  // We will **reinterpret_cast** it to float.
-  // We expect that data.size() == expected_byte_size
-  std::vector<int8_t> data;
+  // Received samples are fed into this stream as soon as they arrive,
+  // so features are computed while the rest of the audio is still being
+  // transferred. The raw bytes are not kept.
+  std::unique_ptr<OfflineStream> stream;
+
+  // Format of the samples sent by the client. It is kept across
+  // audio files of a connection.
+  AudioSampleFormat format = AudioSampleFormat::kFloat32;
+
+  // A message may end in the middle of a sample. We save the bytes
+  // of the incomplete sample here.
+  uint8_t partial_sample[sizeof(float)];
+  int32_t num_partial_bytes = 0;
+
+  // Feed n bytes of audio samples into the stream
+  void AcceptBytes(const uint8_t *p, int32_t n);
 
   void Clear() {
     sample_rate = 0;
     expected_byte_size = 0;
     cur = 0;
-    data.clear();
+    stream.reset();
+    num_partial_bytes = 0;
   }
 };
 
@@ -65,10 +89,22 @@ using ConnectionDataPtr = std::shared_ptr<ConnectionData>;
 struct OfflineWebsocketDecoderConfig {
   OfflineRecognizerConfig recognizer_config;
 
-  int32_t max_batch_size = 5;
+  // --max-batch-size, --max-batch-frames, --batch-bucket-width and
+  // --max-batch-wait-ms
+  BatchingConfig batching_config;
+
+  // Print batching statistics after every this number of batches.
+  // 0 to disable it.
+  int32_t stats_interval = 100;
 
   float max_utterance_length = 300;  // seconds
 
+  // Number of warm-up runs of each shape before serving. 0 to disable it.
+  // Utterances of 1, 2, 4, ..., warm_up_max_duration seconds are decoded
+  // in batches of 1, 2, 4, ..., max_batch_size
+  int32_t warm_up = 0;
+  float warm_up_max_duration = 8;  // seconds
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -97,19 +133,36 @@ class OfflineWebsocketDecoder {
 
   const OfflineWebsocketDecoderConfig &GetConfig() const { return config_; }
 
+  std::unique_ptr<OfflineStream> CreateStream() const {
+    return recognizer_.CreateStream();
+  }
+
+  // Run the warm-up given by the config
+  void WarmUp() const;
+
+ private:
+  // Run Decode() after the given number of milliseconds.
+  // The caller should hold mutex_.
+  void ScheduleDecode(int32_t delay_ms);
+
  private:
   OfflineWebsocketDecoderConfig config_;
 
   /** When we have received all the data from the client, we put it into
-   * this queue; the worker threads will get items from this queue for
+   * this queue; the worker threads will get batches from this queue for
    * decoding.
    *
-   * Number of items to take from this queue is determined by
-   * `--max-batch-size`. If there are not enough items in the queue, we won't
-   * wait and take whatever we have for decoding.
+   * Utterances of similar lengths are put into the same batch. See
+   * BatchingConfig for how batches are formed. If a bucket is not full,
+   * we wait at most `--max-batch-wait-ms` before decoding it.
    */
   std::mutex mutex_;
-  std::deque<std::pair<connection_hdl, ConnectionDataPtr>> streams_;
+  LengthBucketedBatcher<std::pair<connection_hdl, ConnectionDataPtr>> streams_;
+
+  // true if there is a timer that will invoke Decode()
+  bool timer_pending_ = false;
+
+  Gauge *queue_depth_;  // size of streams_
 
   OfflineWebsocketServer *server_;  // Not owned
   OfflineRecognizer recognizer_;
@@ -119,6 +172,10 @@ struct OfflineWebsocketServerConfig {
   OfflineWebsocketDecoderConfig decoder_config;
   std::string log_file = "./log.txt";
 
+  // If true, metrics are exported in the Prometheus text format
+  // at http://<server-ip>:<port>/metrics
+  bool enable_metrics = false;
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -130,15 +187,23 @@ class OfflineWebsocketServer {
                          const OfflineWebsocketServerConfig &config);
 
   asio::io_context &GetConnectionContext() { return io_conn_; }
+  asio::io_context &GetWorkContext() { return io_work_; }
   server &GetServer() { return server_; }
 
   void Run(uint16_t port);
 
   const OfflineWebsocketServerConfig &GetConfig() const { return config_; }
 
+  // True after the warm-up. Before that, websocket connections are
+  // refused and GET /ready returns 503.
+  bool IsReady() const { return ready_; }
+
  private:
   void SetupLog();
 
+  // It is invoked before a websocket handshake is accepted
+  bool OnValidate(connection_hdl hdl);
+
   // When a websocket client is connected, it will invoke this method
   // (Not for HTTP)
   void OnOpen(connection_hdl hdl);
@@ -146,6 +211,9 @@ class OfflineWebsocketServer {
   // When a websocket client is disconnected, it will invoke this method
   void OnClose(connection_hdl hdl);
 
+  // For plain HTTP requests. It serves GET /metrics and GET /ready
+  void OnHttp(connection_hdl hdl);
+
   // When a message is received from a websocket client, this method will
   // be invoked.
   //
@@ -161,6 +229,8 @@ class OfflineWebsocketServer {
   //     indicating total number of bytes of samples the client will send.
   //     We assume each sample is a float containing 4 bytes and has been
   //     normalized to the range [-1, 1].
+  //     Samples are fed into an OfflineStream as soon as they arrive so
+  //     that features are computed while the client is still sending.
   // (4) When the server receives all the samples from the client, it will
   //     start to decode them. Once decoded, the server sends a text message
   //     to the client containing the decoded results
@@ -198,6 +268,10 @@ class OfflineWebsocketServer {
   TeeStream tee_;
 
   OfflineWebsocketDecoder decoder_;
+
+  Gauge *num_connections_;
+
+  std::atomic<bool> ready_{false};
 };
 
 }  // namespace sherpa_onnx
@@ -2,10 +2,15 @@
 //
 // Copyright (c)  2022-2023  Xiaomi Corporation
 
+#include <csignal>
+#include <string>
+
 #include "asio.hpp"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-websocket-server-impl.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/shared-runtime.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 static constexpr const char *kUsageMessage = R"(
 Automatic speech recognition with sherpa-onnx using websocket.
@@ -36,6 +41,40 @@ Usage:
   --log-file=./log.txt \
   --max-batch-size=5
 
+Utterances of similar lengths are decoded in the same batch to reduce
+computation wasted on padding. For instance,
+
+  --max-batch-size=32 \
+  --max-batch-frames=30000 \
+  --batch-bucket-width=5 \
+  --max-batch-wait-ms=20
+
+groups utterances into 5-second buckets, limits a batch to 32 utterances
+and 30000 padded feature frames (100 frames per second), and waits at
+most 20 ms for a bucket to fill up.
+
+Use --enable-metrics=1 to export per-stage latencies (p50/p99), batch
+sizes, queue depths and the real-time factor in the Prometheus text
+format:
+
+  curl http://127.0.0.1:6006/metrics
+
+Use --warm-up=2 to decode synthetic utterances of 1, 2, 4, ...,
+--warm-up-max-duration seconds with batches of 1, 2, 4, ...,
+--max-batch-size utterances before serving requests. Websocket
+connections are refused with 503 until the server is ready. Load
+balancers can poll:
+
+  curl http://127.0.0.1:6006/ready
+
+Use --trace-file=./trace.json to record a trace that can be viewed with
+https://ui.perfetto.dev. The trace is completed when the server receives
+SIGINT (Ctrl+C) or SIGTERM.
+
+Use --use-shared-runtime=true to run the model with one intra-op thread
+pool of onnxruntime for the whole process instead of its own pools. See
+--ort-intra-op-num-threads and --ort-cpu-affinity.
+
 Please refer to
 https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
 for a list of pre-trained models to download.
@@ -64,6 +103,14 @@ int32_t main(int32_t argc, char *argv[]) {
 
   po.Register("port", &port, "The port on which the server will listen.");
 
+  std::string trace_file;
+  po.Register("trace-file", &trace_file,
+              "If not empty, write a Chrome trace of the decoding to this "
+              "file");
+
+  sherpa_onnx::SharedRuntimeConfig shared_runtime_config;
+  shared_runtime_config.Register(&po);
+
   config.Register(&po);
   po.DisableOption("sample-rate");
 
@@ -82,9 +129,26 @@ int32_t main(int32_t argc, char *argv[]) {
 
   config.Validate();
 
+  // It has to be created before any model
+  if (config.recognizer_config.model_config.use_shared_runtime &&
+      !sherpa_onnx::InitSharedRuntime(shared_runtime_config)) {
+    exit(EXIT_FAILURE);
+  }
+
   asio::io_context io_conn;  // for network connections
   asio::io_context io_work;  // for neural network and decoding
 
+  asio::signal_set signals(io_conn);
+  if (!trace_file.empty() &&
+      sherpa_onnx::Tracer::Global().Start(trace_file)) {
+    signals.add(SIGINT);
+    signals.add(SIGTERM);
+    signals.async_wait([](const asio::error_code & /*ec*/, int32_t /*sig*/) {
+      sherpa_onnx::Tracer::Global().Stop();
+      exit(EXIT_SUCCESS);
+    });
+  }
+
   sherpa_onnx::OfflineWebsocketServer server(io_conn, io_work, config);
   server.Run(port);
 
@@ -21,7 +21,7 @@ namespace sherpa_onnx {
 
 OnlineCtcFstDecoder::OnlineCtcFstDecoder(
     const OnlineCtcFstDecoderConfig &config, int32_t blank_id)
-    : config_(config), fst_(ReadGraph(config.graph)), blank_id_(blank_id) {
+    : config_(config), fst_(GetSharedGraph(config.graph)), blank_id_(blank_id) {
   options_.max_active = config_.max_active;
 }
 
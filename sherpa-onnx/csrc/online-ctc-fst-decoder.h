@@ -30,7 +30,8 @@ class OnlineCtcFstDecoder : public OnlineCtcDecoder {
   OnlineCtcFstDecoderConfig config_;
   kaldi_decoder::FasterDecoderOptions options_;
 
-  std::unique_ptr<fst::Fst<fst::StdArc>> fst_;
+  // Shared by all decoders in the process that use the same graph
+  std::shared_ptr<const fst::Fst<fst::StdArc>> fst_;
   int32_t blank_id_ = 0;
 };
 
@@ -12,7 +12,10 @@
 namespace sherpa_onnx {
 
 void OnlineLMConfig::Register(ParseOptions *po) {
-  po->Register("lm", &model, "Path to LM model.");
+  po->Register("lm", &model,
+               "Path to LM model. Either an RNN LM (*.onnx) or an n-gram LM, "
+               "i.e., an ARPA file over token IDs or the output of "
+               "sherpa-onnx-arpa-to-ngram.");
   po->Register("lm-scale", &scale, "LM scale.");
   po->Register("lm-num-threads", &lm_num_threads,
                "Number of threads to run the neural network of LM model");
@@ -20,6 +23,9 @@ void OnlineLMConfig::Register(ParseOptions *po) {
                "Specify a provider to LM model use: cpu, cuda, coreml");
   po->Register("lm-shallow-fusion", &shallow_fusion,
                "Boolean whether to use shallow fusion or rescore.");
+  po->Register("lm-use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
 }
 
 bool OnlineLMConfig::Validate() const {
@@ -37,7 +43,9 @@ std::string OnlineLMConfig::ToString() const {
   os << "OnlineLMConfig(";
   os << "model=\"" << model << "\", ";
   os << "scale=" << scale << ", ";
-  os << "shallow_fusion=" << (shallow_fusion ? "True" : "False") << ")";
+  os << "shallow_fusion=" << (shallow_fusion ? "True" : "False") << ", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ")";
 
   return os.str();
 }
@@ -21,6 +21,10 @@ struct OnlineLMConfig {
   // enable shallow fusion
   bool shallow_fusion = true;
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   OnlineLMConfig() = default;
 
   OnlineLMConfig(const std::string &model, float scale, int32_t lm_num_threads,
@@ -6,14 +6,21 @@
 #include "sherpa-onnx/csrc/online-lm.h"
 
 #include <algorithm>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/ngram-lm.h"
+#include "sherpa-onnx/csrc/online-ngram-lm.h"
 #include "sherpa-onnx/csrc/online-rnn-lm.h"
 
 namespace sherpa_onnx {
 
 std::unique_ptr<OnlineLM> OnlineLM::Create(const OnlineLMConfig &config) {
+  if (NGramLM::IsNGramLM(config.model)) {
+    return std::make_unique<OnlineNGramLM>(config);
+  }
+
   return std::make_unique<OnlineRnnLM>(config);
 }
 
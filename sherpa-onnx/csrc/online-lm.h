@@ -56,6 +56,16 @@ class OnlineLM {
    *
    */
   virtual void ComputeLMScoreSF(float scale, Hypothesis *hyp) = 0;
+
+  /** Like ComputeLMScoreSF() but for n hyps, e.g., all hyps of all streams
+   * that have emitted a token in a frame. Implementations can score them
+   * together with a single run of the LM.
+   */
+  virtual void ComputeLMScoresSF(float scale, Hypothesis **hyps, int32_t n) {
+    for (int32_t i = 0; i != n; ++i) {
+      ComputeLMScoreSF(scale, hyps[i]);
+    }
+  }
 };
 
 }  // namespace sherpa_onnx
@@ -24,9 +24,19 @@ void OnlineModelConfig::Register(ParseOptions *po) {
   po->Register("num-threads", &num_threads,
                "Number of threads to run the neural network");
 
+  po->Register("graph-optimization-level", &graph_optimization_level,
+               "Graph optimization level of onnxruntime: disable, basic, "
+               "extended or all. Leave it empty to use the default of "
+               "onnxruntime");
+
+  po->Register("use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
+
   po->Register("warm-up", &warm_up,
-               "Number of warm-up to run the onnxruntime"
-               "Valid vales are: zipformer2");
+               "Number of warm-up runs of onnxruntime for each batch size "
+               "1, 2, 4, ... up to the max batch size before serving. "
+               "0 to disable it");
 
   po->Register("debug", &debug,
                "true to print model information while loading it.");
@@ -109,6 +119,18 @@ bool OnlineModelConfig::Validate() const {
     }
   }
 
+  if (!graph_optimization_level.empty() &&
+      graph_optimization_level != "disable" &&
+      graph_optimization_level != "basic" &&
+      graph_optimization_level != "extended" &&
+      graph_optimization_level != "all") {
+    SHERPA_ONNX_LOGE(
+        "--graph-optimization-level should be one of disable, basic, "
+        "extended, all. Given: '%s'",
+        graph_optimization_level.c_str());
+    return false;
+  }
+
   if (!tokens_buf.empty() && FileExists(tokens)) {
     SHERPA_ONNX_LOGE(
         "you can not provide a tokens_buf and a tokens file: '%s', "
@@ -168,6 +190,9 @@ std::string OnlineModelConfig::ToString() const {
   os << "provider_config=" << provider_config.ToString() << ", ";
   os << "tokens=\"" << tokens << "\", ";
   os << "num_threads=" << num_threads << ", ";
+  os << "graph_optimization_level=\"" << graph_optimization_level << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ", ";
   os << "warm_up=" << warm_up << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
   os << "model_type=\"" << model_type << "\", ";
@@ -24,6 +24,15 @@ struct OnlineModelConfig {
   ProviderConfig provider_config;
   std::string tokens;
   int32_t num_threads = 1;
+
+  // Empty to use the default of onnxruntime. Otherwise, one of
+  // disable, basic, extended, all
+  std::string graph_optimization_level;
+
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   int32_t warm_up = 0;
   bool debug = false;
 
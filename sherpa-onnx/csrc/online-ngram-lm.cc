@@ -0,0 +1,57 @@
+// sherpa-onnx/csrc/online-ngram-lm.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-ngram-lm.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+OnlineNGramLM::OnlineNGramLM(const OnlineLMConfig &config)
+    : lm_(std::make_unique<NGramLM>(config.model)) {}
+
+OnlineNGramLM::OnlineNGramLM(std::unique_ptr<NGramLM> lm)
+    : lm_(std::move(lm)) {}
+
+std::vector<Ort::Value> OnlineNGramLM::GetInitStates() { return {}; }
+
+std::pair<Ort::Value, std::vector<Ort::Value>>
+OnlineNGramLM::GetInitStatesSF() {
+  return {Ort::Value{nullptr}, std::vector<Ort::Value>{}};
+}
+
+std::pair<Ort::Value, std::vector<Ort::Value>> OnlineNGramLM::ScoreToken(
+    Ort::Value /*x*/, std::vector<Ort::Value> /*states*/) {
+  return {Ort::Value{nullptr}, std::vector<Ort::Value>{}};
+}
+
+void OnlineNGramLM::ComputeLMScore(float scale, int32_t context_size,
+                                   std::vector<Hypotheses> *hyps) {
+  for (auto &hyp : *hyps) {
+    for (auto &h_m : hyp) {
+      auto &h = h_m.second;
+      const auto &ys = h.ys;
+
+      // Score only the tokens added since the last call
+      for (int32_t i = context_size + h.cur_scored_pos;
+           i < static_cast<int32_t>(ys.size()); ++i) {
+        h.lm_log_prob += scale * lm_->Score(h.ngram_lm_state,
+                                            static_cast<int32_t>(ys[i]),
+                                            &h.ngram_lm_state);
+      }
+      h.cur_scored_pos = static_cast<int32_t>(ys.size()) - context_size;
+    }
+  }
+}
+
+void OnlineNGramLM::ComputeLMScoreSF(float scale, Hypothesis *hyp) {
+  hyp->lm_log_prob +=
+      scale * lm_->Score(hyp->ngram_lm_state,
+                         static_cast<int32_t>(hyp->ys.back()),
+                         &hyp->ngram_lm_state);
+}
+
+}  // namespace sherpa_onnx
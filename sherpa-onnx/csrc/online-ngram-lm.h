@@ -0,0 +1,48 @@
+// sherpa-onnx/csrc/online-ngram-lm.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_NGRAM_LM_H_
+#define SHERPA_ONNX_CSRC_ONLINE_NGRAM_LM_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/ngram-lm.h"
+#include "sherpa-onnx/csrc/online-lm-config.h"
+#include "sherpa-onnx/csrc/online-lm.h"
+
+namespace sherpa_onnx {
+
+// An n-gram LM for modified beam search. Unlike OnlineRnnLM, it does not
+// run any neural network; the state of a hypothesis is
+// Hypothesis::ngram_lm_state.
+class OnlineNGramLM : public OnlineLM {
+ public:
+  explicit OnlineNGramLM(const OnlineLMConfig &config);
+
+  explicit OnlineNGramLM(std::unique_ptr<NGramLM> lm);
+
+  // Not used by n-gram LMs. It returns an empty vector.
+  std::vector<Ort::Value> GetInitStates() override;
+
+  // Not used by n-gram LMs. It returns empty values.
+  std::pair<Ort::Value, std::vector<Ort::Value>> GetInitStatesSF() override;
+
+  // Not used by n-gram LMs. It returns empty values.
+  std::pair<Ort::Value, std::vector<Ort::Value>> ScoreToken(
+      Ort::Value x, std::vector<Ort::Value> states) override;
+
+  void ComputeLMScore(float scale, int32_t context_size,
+                      std::vector<Hypotheses> *hyps) override;
+
+  void ComputeLMScoreSF(float scale, Hypothesis *hyp) override;
+
+ private:
+  std::unique_ptr<NGramLM> lm_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_NGRAM_LM_H_
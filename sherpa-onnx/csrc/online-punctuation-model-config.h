@@ -19,6 +19,10 @@ struct OnlinePunctuationModelConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   OnlinePunctuationModelConfig() = default;
 
   OnlinePunctuationModelConfig(const std::string &cnn_bilstm,
@@ -19,12 +19,15 @@
 #include "fst/extensions/far/far.h"
 #include "kaldifst/csrc/kaldi-fst-io.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/online-recognizer-ctc-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-paraformer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-transducer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-transducer-nemo-impl.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/warm-up.h"
 
 #if SHERPA_ONNX_ENABLE_RKNN
 #include "sherpa-onnx/csrc/rknn/online-recognizer-ctc-rknn-impl.h"
@@ -63,8 +66,8 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
     sess_opts.SetInterOpNumThreads(1);
 
     auto decoder_model = ReadFile(config.model_config.transducer.decoder);
-    auto sess = std::make_unique<Ort::Session>(env, decoder_model.data(),
-                                               decoder_model.size(), sess_opts);
+    auto sess = CreateSession(env, decoder_model.data(), decoder_model.size(),
+                              sess_opts);
 
     size_t node_count = sess->GetOutputCount();
 
@@ -100,8 +103,8 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
     sess_opts.SetInterOpNumThreads(1);
 
     auto decoder_model = ReadFile(mgr, config.model_config.transducer.decoder);
-    auto sess = std::make_unique<Ort::Session>(env, decoder_model.data(),
-                                               decoder_model.size(), sess_opts);
+    auto sess = CreateSession(env, decoder_model.data(), decoder_model.size(),
+                              sess_opts);
 
     size_t node_count = sess->GetOutputCount();
 
@@ -217,8 +220,15 @@ OnlineRecognizerImpl::OnlineRecognizerImpl(Manager *mgr,
   }      // if (!config.rule_fars.empty())
 }
 
+void OnlineRecognizerImpl::WarmpUpRecognizer(int32_t warmup,
+                                             int32_t mbs) const {
+  WarmUpStreams(*this, config_.feat_config.sampling_rate, warmup, mbs);
+}
+
 std::string OnlineRecognizerImpl::ApplyInverseTextNormalization(
     std::string text) const {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_itn_seconds",
+                             "Time of inverse text normalization");
   text = RemoveInvalidUtf8Sequences(text);
 
   if (!itn_list_.empty()) {
@@ -230,6 +240,53 @@ std::string OnlineRecognizerImpl::ApplyInverseTextNormalization(
   return text;
 }
 
+std::string OnlineRecognizerImpl::ApplyInverseTextNormalization(
+    OnlineStream *s, const SymbolTable &sym) const {
+  OnlineResultCache &cache = s->GetResultCache();
+  if (sym.IsByteBpe()) {
+    // Decoding byte-level BPE depends on the preceding text, so we
+    // decode and normalize the whole text
+    return ApplyInverseTextNormalization(sym.DecodeByteBpe(cache.RawText()));
+  }
+
+  return cache.Normalize(
+      [this](std::string text) {
+        return ApplyInverseTextNormalization(std::move(text));
+      },
+      config_.itn_tail_tokens, IsFinalResult(s));
+}
+
+std::string OnlineRecognizerImpl::ApplyInverseTextNormalizationDelta(
+    OnlineStream *s, const SymbolTable &sym, int32_t *offset) const {
+  OnlineResultCache &cache = s->GetResultCache();
+  if (sym.IsByteBpe()) {
+    return cache.TextDelta(
+        ApplyInverseTextNormalization(sym.DecodeByteBpe(cache.RawText())),
+        offset);
+  }
+
+  auto itn = [this](std::string text) {
+    return ApplyInverseTextNormalization(std::move(text));
+  };
+
+  if (itn_list_.empty()) {
+    // Only invalid UTF-8 sequences are removed. Pieces that start at a
+    // UTF-8 character give the same text as the whole, so the tail is
+    // used even for final results
+    constexpr int32_t kTailTokens = 16;
+    return cache.NormalizeDelta(itn, kTailTokens, false, offset);
+  }
+
+  return cache.NormalizeDelta(itn, config_.itn_tail_tokens, IsFinalResult(s),
+                              offset);
+}
+
+bool OnlineRecognizerImpl::IsFinalResult(OnlineStream *s) const {
+  int32_t num_frames = s->NumFramesReady();
+  return IsEndpoint(s) ||
+         (num_frames > 0 && s->IsLastFrame(num_frames - 1) && !IsReady(s));
+}
+
 #if __ANDROID_API__ >= 9
 template OnlineRecognizerImpl::OnlineRecognizerImpl(
     AAssetManager *mgr, const OnlineRecognizerConfig &config);
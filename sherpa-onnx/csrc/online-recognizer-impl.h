@@ -13,6 +13,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/csrc/symbol-table.h"
 
 namespace sherpa_onnx {
 
@@ -42,23 +43,45 @@ class OnlineRecognizerImpl {
 
   virtual bool IsReady(OnlineStream *s) const = 0;
 
-  virtual void WarmpUpRecognizer(int32_t warmup, int32_t mbs) const {
-    // ToDo extending to other  models
-    SHERPA_ONNX_LOGE("Only zipformer2 model supports Warm up for now.");
-    exit(-1);
-  }
+  // Decode synthetic audio warmup times with 1, 2, 4, ..., mbs streams at
+  // a time. See WarmUpStreams() in warm-up.h
+  virtual void WarmpUpRecognizer(int32_t warmup, int32_t mbs) const;
 
   virtual void DecodeStreams(OnlineStream **ss, int32_t n) const = 0;
 
   virtual OnlineRecognizerResult GetResult(OnlineStream *s) const = 0;
 
+  // Recognizers that build results incrementally override it.
+  // See OnlineRecognizer::GetDeltaResult()
+  virtual OnlineRecognizerResult GetDeltaResult(OnlineStream *s) const {
+    return GetResult(s);
+  }
+
   virtual bool IsEndpoint(OnlineStream *s) const = 0;
 
   virtual void Reset(OnlineStream *s) const = 0;
 
   std::string ApplyInverseTextNormalization(std::string text) const;
 
+  // Apply inverse text normalization to the text in the result cache of
+  // the stream. If config.itn_tail_tokens is positive, only the tail of
+  // the text is normalized for partial results.
+  // See OnlineResultCache::Normalize()
+  std::string ApplyInverseTextNormalization(OnlineStream *s,
+                                            const SymbolTable &sym) const;
+
+  // The same as above, but return only the text after the first *offset
+  // Unicode code points, which are the same as in the text of the previous
+  // call. See OnlineResultCache::NormalizeDelta()
+  std::string ApplyInverseTextNormalizationDelta(OnlineStream *s,
+                                                 const SymbolTable &sym,
+                                                 int32_t *offset) const;
+
  private:
+  // True if the result of the stream is final and its whole text is
+  // normalized
+  bool IsFinalResult(OnlineStream *s) const;
+
   OnlineRecognizerConfig config_;
   // for inverse text normalization. Used only if
   // config.rule_fsts is not empty or
@@ -6,16 +6,15 @@
 #define SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_TRANSDUCER_IMPL_H_
 
 #include <algorithm>
-#include <ios>
 #include <memory>
 #include <regex>  // NOLINT
-#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/online-lm.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
@@ -25,53 +24,54 @@
 #include "sherpa-onnx/csrc/online-transducer-modified-beam-search-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
+#include "sherpa-onnx/csrc/trace.h"
+#include "sherpa-onnx/csrc/two-stage-pipeline.h"
 #include "sherpa-onnx/csrc/utils.h"
 #include "ssentencepiece/csrc/ssentencepiece.h"
 
 namespace sherpa_onnx {
 
+// Only tokens that are new since the previous call for the same stream
+// are converted. The text is left empty. Use
+// OnlineRecognizerImpl::ApplyInverseTextNormalization(s, sym_table) to get it.
+//
+// If delta is true, the result contains only the tokens that changed since
+// the previous call with delta set. See OnlineRecognizer::GetDeltaResult()
 OnlineRecognizerResult Convert(const OnlineTransducerDecoderResult &src,
                                const SymbolTable &sym_table,
                                float frame_shift_ms, int32_t subsampling_factor,
-                               int32_t segment, int32_t frames_since_start) {
+                               int32_t segment, int32_t frames_since_start,
+                               OnlineResultCache *cache, bool delta) {
   OnlineRecognizerResult r;
-  r.tokens.reserve(src.tokens.size());
-  r.timestamps.reserve(src.tokens.size());
-
-  std::string text;
-  for (auto i : src.tokens) {
-    auto sym = sym_table[i];
-
-    text.append(sym);
-
-    if (sym.size() == 1 && (sym[0] < 0x20 || sym[0] > 0x7e)) {
-      // for bpe models with byte_fallback
-      // (but don't rewrite printable characters 0x20..0x7e,
-      //  which collide with standard BPE units)
-      std::ostringstream os;
-      os << "<0x" << std::hex << std::uppercase
-         << (static_cast<int32_t>(sym[0]) & 0xff) << ">";
-      sym = os.str();
-    }
-
-    r.tokens.push_back(std::move(sym));
-  }
 
-  if (sym_table.IsByteBpe()) {
-    text = sym_table.DecodeByteBpe(text);
+  cache->Update(src.tokens, sym_table, src.timestamps);
+
+  const auto &tokens = cache->Tokens();
+  size_t begin = 0;
+  if (delta) {
+    begin = cache->TakeDeltaBegin();
+    r.is_delta = true;
+    r.token_offset = static_cast<int32_t>(begin);
+    r.tokens.assign(tokens.begin() + begin, tokens.end());
+  } else {
+    r.tokens = tokens;
   }
 
-  r.text = std::move(text);
-
   float frame_shift_s = frame_shift_ms / 1000. * subsampling_factor;
-  for (auto t : src.timestamps) {
-    float time = frame_shift_s * t;
-    r.timestamps.push_back(time);
+  if (begin < src.timestamps.size()) {
+    r.timestamps.reserve(src.timestamps.size() - begin);
+    for (size_t i = begin; i != src.timestamps.size(); ++i) {
+      r.timestamps.push_back(frame_shift_s * src.timestamps[i]);
+    }
   }
 
-  r.ys_probs = std::move(src.ys_probs);
-  r.lm_probs = std::move(src.lm_probs);
-  r.context_scores = std::move(src.context_scores);
+  auto tail = [begin](const std::vector<float> &v) {
+    return std::vector<float>(v.begin() + std::min(begin, v.size()), v.end());
+  };
+
+  r.ys_probs = tail(src.ys_probs);
+  r.lm_probs = tail(src.lm_probs);
+  r.context_scores = tail(src.context_scores);
 
   r.segment = segment;
   r.start_time = frames_since_start * frame_shift_ms / 1000.;
@@ -85,7 +85,9 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       : OnlineRecognizerImpl(config),
         config_(config),
         model_(OnlineTransducerModel::Create(config.model_config)),
-        endpoint_(config_.endpoint_config) {
+        endpoint_(config_.endpoint_config),
+        pipeline_(config.pipeline ? std::make_unique<TwoStagePipeline>()
+                                  : nullptr) {
     if (!config.model_config.tokens_buf.empty()) {
       sym_ = SymbolTable(config.model_config.tokens_buf, false);
     } else {
@@ -139,7 +141,9 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
         config_(config),
         model_(OnlineTransducerModel::Create(mgr, config.model_config)),
         sym_(mgr, config.model_config.tokens),
-        endpoint_(config_.endpoint_config) {
+        endpoint_(config_.endpoint_config),
+        pipeline_(config.pipeline ? std::make_unique<TwoStagePipeline>()
+                                  : nullptr) {
     if (sym_.Contains("<unk>")) {
       unk_id_ = sym_["<unk>"];
     }
@@ -200,28 +204,19 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
                        hotwords.c_str());
     }
 
-    int32_t num_default_hws = hotwords_.size();
-    int32_t num_hws = current.size();
-
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_hws,
-                            config_.hotwords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_hws,
-                            config_.hotwords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
+    // Only the hotwords of this stream are compiled. They are layered on
+    // top of the default hotwords, which are shared by all streams.
+    ContextGraphPtr context_graph;
+    if (current.empty()) {
+      context_graph = hotwords_graph_;
+    } else if (hotwords_graph_) {
+      context_graph = std::make_shared<ContextGraph>(
+          hotwords_graph_, current, config_.hotwords_score, 0.0f,
+          current_scores);
     } else {
-      // Do nothing.
+      context_graph = std::make_shared<ContextGraph>(
+          current, config_.hotwords_score, current_scores);
     }
-
-    auto context_graph = std::make_shared<ContextGraph>(
-        current, config_.hotwords_score, current_scores);
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, context_graph);
     InitOnlineStream(stream.get());
@@ -233,120 +228,42 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
            s->NumFramesReady();
   }
 
-  // Warmping up engine with wp: warm_up count and max-batch-size
-  void WarmpUpRecognizer(int32_t warmup, int32_t mbs) const override {
-    auto max_batch_size = mbs;
-    if (warmup <= 0 || warmup > 100) {
-      return;
-    }
-    int32_t chunk_size = model_->ChunkSize();
-    int32_t chunk_shift = model_->ChunkShift();
-    int32_t feature_dim = 80;
-    std::vector<OnlineTransducerDecoderResult> results(max_batch_size);
-    std::vector<float> features_vec(max_batch_size * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(max_batch_size);
-
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    std::array<int64_t, 3> x_shape{max_batch_size, chunk_size, feature_dim};
-
-    for (int32_t i = 0; i != max_batch_size; ++i) {
-      states_vec[i] = model_->GetEncoderInitStates();
-      results[i] = decoder_->GetEmptyResult();
-    }
-
-    for (int32_t i = 0; i != warmup; ++i) {
-      auto states = model_->StackStates(states_vec);
-      Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
-                                              features_vec.size(),
-                                              x_shape.data(), x_shape.size());
-      auto x_copy = Clone(model_->Allocator(), &x);
-      auto pair = model_->RunEncoder(std::move(x), std::move(states),
-                                     std::move(x_copy));
-      decoder_->Decode(std::move(pair.first), &results);
-    }
-  }
-
   void DecodeStreams(OnlineStream **ss, int32_t n) const override {
-    int32_t chunk_size = model_->ChunkSize();
-    int32_t chunk_shift = model_->ChunkShift();
-
-    int32_t feature_dim = ss[0]->FeatureDim();
-
-    std::vector<OnlineTransducerDecoderResult> results(n);
-    std::vector<float> features_vec(n * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(n);
-    std::vector<int64_t> all_processed_frames(n);
-    bool has_context_graph = false;
-
-    for (int32_t i = 0; i != n; ++i) {
-      if (!has_context_graph && ss[i]->GetContextGraph()) {
-        has_context_graph = true;
-      }
-
-      const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_size);
-
-      // Question: should num_processed_frames include chunk_shift?
-      ss[i]->GetNumProcessedFrames() += chunk_shift;
-
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_size * feature_dim);
-
-      results[i] = std::move(ss[i]->GetResult());
-      states_vec[i] = std::move(ss[i]->GetStates());
-      all_processed_frames[i] = num_processed_frames;
+    if (!pipeline_) {
+      DecodeBatch batch{ss, n};
+      RunEncoderStage(&batch);
+      RunSearchStage(&batch);
+      return;
     }
 
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    std::array<int64_t, 3> x_shape{n, chunk_size, feature_dim};
-
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
-                                            features_vec.size(), x_shape.data(),
-                                            x_shape.size());
-
-    std::array<int64_t, 1> processed_frames_shape{
-        static_cast<int64_t>(all_processed_frames.size())};
-
-    Ort::Value processed_frames = Ort::Value::CreateTensor(
-        memory_info, all_processed_frames.data(), all_processed_frames.size(),
-        processed_frames_shape.data(), processed_frames_shape.size());
-
-    auto states = model_->StackStates(states_vec);
-
-    auto pair = model_->RunEncoder(std::move(x), std::move(states),
-                                   std::move(processed_frames));
-
-    if (has_context_graph) {
-      decoder_->Decode(std::move(pair.first), ss, &results);
-    } else {
-      decoder_->Decode(std::move(pair.first), &results);
+    // Split the streams into batches so that the encoder of a batch can
+    // run while the search of the previous batch is running. Each stream
+    // belongs to exactly one batch, so it is never in two stages at once.
+    int32_t batch_size =
+        config_.pipeline_batch_size > 0 ? config_.pipeline_batch_size : n;
+
+    std::vector<std::unique_ptr<DecodeBatch>> batches;
+    std::vector<TwoStagePipeline::Job> jobs;
+    for (int32_t i = 0; i < n; i += batch_size) {
+      auto batch = std::make_unique<DecodeBatch>();
+      batch->ss = ss + i;
+      batch->n = std::min(batch_size, n - i);
+
+      DecodeBatch *b = batch.get();
+      jobs.push_back({[this, b]() { RunEncoderStage(b); },
+                      [this, b]() { RunSearchStage(b); }});
+      batches.push_back(std::move(batch));
     }
 
-    std::vector<std::vector<Ort::Value>> next_states =
-        model_->UnStackStates(pair.second);
-
-    for (int32_t i = 0; i != n; ++i) {
-      ss[i]->SetResult(results[i]);
-      ss[i]->SetStates(std::move(next_states[i]));
-    }
+    pipeline_->Run(std::move(jobs));
   }
 
   OnlineRecognizerResult GetResult(OnlineStream *s) const override {
-    OnlineTransducerDecoderResult decoder_result = s->GetResult();
-    decoder_->StripLeadingBlanks(&decoder_result);
+    return GetResult(s, false);
+  }
 
-    // TODO(fangjun): Remember to change these constants if needed
-    int32_t frame_shift_ms = 10;
-    int32_t subsampling_factor = 4;
-    auto r = Convert(decoder_result, sym_, frame_shift_ms, subsampling_factor,
-                     s->GetCurrentSegment(), s->GetNumFramesSinceStart());
-    r.text = ApplyInverseTextNormalization(std::move(r.text));
-    return r;
+  OnlineRecognizerResult GetDeltaResult(OnlineStream *s) const override {
+    return GetResult(s, true);
   }
 
   bool IsEndpoint(OnlineStream *s) const override {
@@ -410,6 +327,24 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
   }
 
  private:
+  OnlineRecognizerResult GetResult(OnlineStream *s, bool delta) const {
+    OnlineTransducerDecoderResult decoder_result = s->GetResult();
+    decoder_->StripLeadingBlanks(&decoder_result);
+
+    // TODO(fangjun): Remember to change these constants if needed
+    int32_t frame_shift_ms = 10;
+    int32_t subsampling_factor = 4;
+    auto r = Convert(decoder_result, sym_, frame_shift_ms, subsampling_factor,
+                     s->GetCurrentSegment(), s->GetNumFramesSinceStart(),
+                     &s->GetResultCache(), delta);
+    if (delta) {
+      r.text = ApplyInverseTextNormalizationDelta(s, sym_, &r.text_offset);
+    } else {
+      r.text = ApplyInverseTextNormalization(s, sym_);
+    }
+    return r;
+  }
+
   void InitHotwords() {
     // each line in hotwords_file contains space-separated words
 
@@ -483,6 +418,121 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
     stream->SetStates(model_->GetEncoderInitStates());
   }
 
+ private:
+  // A batch of streams between the encoder stage and the search stage
+  struct DecodeBatch {
+    OnlineStream **ss = nullptr;
+    int32_t n = 0;
+
+    bool has_context_graph = false;
+    std::vector<OnlineTransducerDecoderResult> results;
+    Ort::Value encoder_out{nullptr};
+    std::vector<Ort::Value> next_states;
+  };
+
+  // Gather the features and the states of the streams and run the encoder
+  void RunEncoderStage(DecodeBatch *batch) const {
+    OnlineStream **ss = batch->ss;
+    int32_t n = batch->n;
+
+    int32_t chunk_size = model_->ChunkSize();
+    int32_t chunk_shift = model_->ChunkShift();
+
+    int32_t feature_dim = ss[0]->FeatureDim();
+
+    auto &results = batch->results;
+    results.resize(n);
+
+    std::vector<float> features_vec(n * chunk_size * feature_dim);
+    std::vector<std::vector<Ort::Value>> states_vec(n);
+    std::vector<int64_t> all_processed_frames(n);
+
+    for (int32_t i = 0; i != n; ++i) {
+      if (!batch->has_context_graph && ss[i]->GetContextGraph()) {
+        batch->has_context_graph = true;
+      }
+
+      const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
+      std::vector<float> features =
+          ss[i]->GetFrames(num_processed_frames, chunk_size);
+
+      // Question: should num_processed_frames include chunk_shift?
+      ss[i]->GetNumProcessedFrames() += chunk_shift;
+
+      std::copy(features.begin(), features.end(),
+                features_vec.data() + i * chunk_size * feature_dim);
+
+      results[i] = std::move(ss[i]->GetResult());
+      states_vec[i] = std::move(ss[i]->GetStates());
+      all_processed_frames[i] = num_processed_frames;
+    }
+
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::array<int64_t, 3> x_shape{n, chunk_size, feature_dim};
+
+    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
+                                            features_vec.size(), x_shape.data(),
+                                            x_shape.size());
+
+    std::array<int64_t, 1> processed_frames_shape{
+        static_cast<int64_t>(all_processed_frames.size())};
+
+    Ort::Value processed_frames = Ort::Value::CreateTensor(
+        memory_info, all_processed_frames.data(), all_processed_frames.size(),
+        processed_frames_shape.data(), processed_frames_shape.size());
+
+    std::vector<Ort::Value> states;
+    {
+      SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_stack_states_seconds",
+                                 "Time to stack the encoder states");
+      SHERPA_ONNX_TRACE_SCOPE("OnlineTransducerModel::StackStates");
+      states = model_->StackStates(states_vec);
+    }
+
+    {
+      SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_encoder_seconds",
+                                 "Time to run the encoder for a batch");
+      SHERPA_ONNX_TRACE_SCOPE_N("OnlineTransducerModel::RunEncoder", n);
+      auto pair = model_->RunEncoder(std::move(x), std::move(states),
+                                     std::move(processed_frames));
+      batch->encoder_out = std::move(pair.first);
+      batch->next_states = std::move(pair.second);
+    }
+  }
+
+  // Run the search on the encoder output and update the streams
+  void RunSearchStage(DecodeBatch *batch) const {
+    OnlineStream **ss = batch->ss;
+    int32_t n = batch->n;
+    auto &results = batch->results;
+
+    {
+      SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_search_seconds",
+                                 "Time to run the decoding search for a batch");
+      SHERPA_ONNX_TRACE_SCOPE_N("OnlineTransducerDecoder::Decode", n);
+      if (batch->has_context_graph) {
+        decoder_->Decode(std::move(batch->encoder_out), ss, &results);
+      } else {
+        decoder_->Decode(std::move(batch->encoder_out), &results);
+      }
+    }
+
+    std::vector<std::vector<Ort::Value>> next_states;
+    {
+      SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_unstack_states_seconds",
+                                 "Time to unstack the encoder states");
+      SHERPA_ONNX_TRACE_SCOPE("OnlineTransducerModel::UnStackStates");
+      next_states = model_->UnStackStates(batch->next_states);
+    }
+
+    for (int32_t i = 0; i != n; ++i) {
+      ss[i]->SetResult(results[i]);
+      ss[i]->SetStates(std::move(next_states[i]));
+    }
+  }
+
  private:
   OnlineRecognizerConfig config_;
   std::vector<std::vector<int32_t>> hotwords_;
@@ -495,6 +545,9 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
   SymbolTable sym_;
   Endpoint endpoint_;
   int32_t unk_id_ = -1;
+
+  // Non-null if config_.pipeline is true
+  std::unique_ptr<TwoStagePipeline> pipeline_;
 };
 
 }  // namespace sherpa_onnx
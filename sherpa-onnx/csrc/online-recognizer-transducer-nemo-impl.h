@@ -31,7 +31,8 @@ namespace sherpa_onnx {
 OnlineRecognizerResult Convert(const OnlineTransducerDecoderResult &src,
                                const SymbolTable &sym_table,
                                float frame_shift_ms, int32_t subsampling_factor,
-                               int32_t segment, int32_t frames_since_start);
+                               int32_t segment, int32_t frames_since_start,
+                               OnlineResultCache *cache, bool delta);
 
 class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
  public:
@@ -93,14 +94,11 @@ class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
   }
 
   OnlineRecognizerResult GetResult(OnlineStream *s) const override {
-    // TODO(fangjun): Remember to change these constants if needed
-    int32_t frame_shift_ms = 10;
-    int32_t subsampling_factor = model_->SubsamplingFactor();
-    auto r = Convert(s->GetResult(), symbol_table_, frame_shift_ms,
-                     subsampling_factor, s->GetCurrentSegment(),
-                     s->GetNumFramesSinceStart());
-    r.text = ApplyInverseTextNormalization(std::move(r.text));
-    return r;
+    return GetResult(s, false);
+  }
+
+  OnlineRecognizerResult GetDeltaResult(OnlineStream *s) const override {
+    return GetResult(s, true);
   }
 
   bool IsEndpoint(OnlineStream *s) const override {
@@ -205,6 +203,22 @@ class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
   }
 
  private:
+  OnlineRecognizerResult GetResult(OnlineStream *s, bool delta) const {
+    // TODO(fangjun): Remember to change these constants if needed
+    int32_t frame_shift_ms = 10;
+    int32_t subsampling_factor = model_->SubsamplingFactor();
+    auto r = Convert(s->GetResult(), symbol_table_, frame_shift_ms,
+                     subsampling_factor, s->GetCurrentSegment(),
+                     s->GetNumFramesSinceStart(), &s->GetResultCache(), delta);
+    if (delta) {
+      r.text =
+          ApplyInverseTextNormalizationDelta(s, symbol_table_, &r.text_offset);
+    } else {
+      r.text = ApplyInverseTextNormalization(s, symbol_table_);
+    }
+    return r;
+  }
+
   void PostInit() {
     config_.feat_config.nemo_normalize_type =
         model_->FeatureNormalizationMethod();
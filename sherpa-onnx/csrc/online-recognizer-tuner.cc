@@ -0,0 +1,278 @@
+// sherpa-onnx/csrc/online-recognizer-tuner.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-recognizer-tuner.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/warm-up.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+struct RunStats {
+  double elapsed_seconds = 0;
+
+  // Average time of a DecodeStreams() call
+  double seconds_per_call = 0;
+};
+
+RunStats Run(const OnlineRecognizer &recognizer,
+             const std::vector<float> &samples, int32_t sample_rate,
+             int32_t batch_size) {
+  std::vector<float> tail_paddings(static_cast<int32_t>(0.3 * sample_rate));
+
+  std::vector<std::unique_ptr<OnlineStream>> streams;
+  for (int32_t i = 0; i != batch_size; ++i) {
+    auto s = recognizer.CreateStream();
+    s->AcceptWaveform(sample_rate, samples.data(), samples.size());
+    s->AcceptWaveform(sample_rate, tail_paddings.data(),
+                      tail_paddings.size());
+    s->InputFinished();
+    streams.push_back(std::move(s));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  int32_t num_calls = 0;
+  std::vector<OnlineStream *> ready;
+  while (true) {
+    ready.clear();
+    for (auto &s : streams) {
+      if (recognizer.IsReady(s.get())) {
+        ready.push_back(s.get());
+      }
+    }
+
+    if (ready.empty()) {
+      break;
+    }
+
+    recognizer.DecodeStreams(ready.data(), ready.size());
+    ++num_calls;
+  }
+
+  RunStats ans;
+  ans.elapsed_seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+  ans.seconds_per_call =
+      num_calls > 0 ? ans.elapsed_seconds / num_calls : ans.elapsed_seconds;
+  return ans;
+}
+
+}  // namespace
+
+void OnlineRecognizerTunerConfig::Register(ParseOptions *po) {
+  po->Register("tune-max-num-threads", &max_num_threads,
+               "Largest number of intra-op threads to try. 0 means the "
+               "number of hardware threads");
+
+  po->Register("tune-max-batch-size", &max_batch_size,
+               "Largest batch size to try");
+
+  po->Register("tune-duration", &duration,
+               "Seconds of synthetic audio decoded by each stream in a run");
+
+  po->Register("tune-max-latency-ms", &max_latency_ms,
+               "If positive, batch sizes whose average time of decoding a "
+               "chunk exceeds it are not used");
+}
+
+bool OnlineRecognizerTunerConfig::Validate() const {
+  if (max_num_threads < 0) {
+    SHERPA_ONNX_LOGE("--tune-max-num-threads should be >= 0. Given: %d",
+                     max_num_threads);
+    return false;
+  }
+
+  if (max_batch_size < 1) {
+    SHERPA_ONNX_LOGE("--tune-max-batch-size should be > 0. Given: %d",
+                     max_batch_size);
+    return false;
+  }
+
+  if (duration <= 0) {
+    SHERPA_ONNX_LOGE("--tune-duration should be > 0. Given: %.3f", duration);
+    return false;
+  }
+
+  return true;
+}
+
+std::string OnlineRecognizerTunerConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "OnlineRecognizerTunerConfig(";
+  os << "max_num_threads=" << max_num_threads << ", ";
+  os << "max_batch_size=" << max_batch_size << ", ";
+  os << "duration=" << duration << ", ";
+  os << "max_latency_ms=" << max_latency_ms << ")";
+
+  return os.str();
+}
+
+std::vector<std::string> ModelFiles(const OnlineModelConfig &config) {
+  std::vector<std::string> ans;
+  for (const auto &f :
+       {config.transducer.encoder, config.transducer.decoder,
+        config.transducer.joiner, config.paraformer.encoder,
+        config.paraformer.decoder, config.wenet_ctc.model,
+        config.zipformer2_ctc.model, config.nemo_ctc.model}) {
+    if (!f.empty()) {
+      ans.push_back(f);
+    }
+  }
+  return ans;
+}
+
+TuningProfile TuneOnlineRecognizer(
+    const OnlineRecognizerConfig &config,
+    const OnlineRecognizerTunerConfig &tuner_config) {
+  int32_t sample_rate = config.feat_config.sampling_rate;
+  std::vector<float> samples =
+      GenerateWarmUpAudio(tuner_config.duration, sample_rate);
+  std::vector<float> warm_up_samples = GenerateWarmUpAudio(1, sample_rate);
+
+  int32_t max_num_threads = tuner_config.max_num_threads;
+  if (max_num_threads == 0) {
+    max_num_threads =
+        std::max<int32_t>(1, std::thread::hardware_concurrency());
+  }
+
+  struct Result {
+    int32_t num_threads;
+    std::string level;
+    double elapsed_seconds;
+  };
+  std::vector<Result> results;
+
+  for (const char *level : {"basic", "extended", "all"}) {
+    for (int32_t num_threads : PowersOfTwoUpTo(max_num_threads)) {
+      OnlineRecognizerConfig c = config;
+      c.model_config.num_threads = num_threads;
+      c.model_config.graph_optimization_level = level;
+
+      OnlineRecognizer recognizer(c);
+      Run(recognizer, warm_up_samples, sample_rate, 1);
+      RunStats stats = Run(recognizer, samples, sample_rate, 1);
+
+      SHERPA_ONNX_LOGE(
+          "num_threads: %d, graph_optimization_level: %s, RTF: %.4f",
+          num_threads, level, stats.elapsed_seconds / tuner_config.duration);
+
+      results.push_back({num_threads, level, stats.elapsed_seconds});
+    }
+  }
+
+  double best = results[0].elapsed_seconds;
+  for (const auto &r : results) {
+    best = std::min(best, r.elapsed_seconds);
+  }
+
+  // More threads take CPU time from other streams and processes, so we
+  // use the fewest threads that are almost as fast as the best
+  const Result *chosen = nullptr;
+  for (const auto &r : results) {
+    if (r.elapsed_seconds > 1.1 * best) {
+      continue;
+    }
+
+    if (!chosen || r.num_threads < chosen->num_threads ||
+        (r.num_threads == chosen->num_threads &&
+         r.elapsed_seconds < chosen->elapsed_seconds)) {
+      chosen = &r;
+    }
+  }
+
+  TuningProfile profile;
+  profile.num_threads = chosen->num_threads;
+  profile.graph_optimization_level = chosen->level;
+
+  OnlineRecognizerConfig c = config;
+  ApplyTuningProfile(profile, &c);
+  OnlineRecognizer recognizer(c);
+  Run(recognizer, warm_up_samples, sample_rate, 1);
+
+  double best_throughput = 0;
+  std::vector<std::pair<int32_t, double>> throughputs;
+  for (int32_t batch_size : PowersOfTwoUpTo(tuner_config.max_batch_size)) {
+    RunStats stats = Run(recognizer, samples, sample_rate, batch_size);
+    double throughput =
+        batch_size * tuner_config.duration / stats.elapsed_seconds;
+
+    SHERPA_ONNX_LOGE(
+        "batch_size: %d, audio seconds per second: %.2f, ms per chunk: %.2f",
+        batch_size, throughput, 1000 * stats.seconds_per_call);
+
+    if (tuner_config.max_latency_ms > 0 &&
+        1000 * stats.seconds_per_call > tuner_config.max_latency_ms) {
+      break;
+    }
+
+    throughputs.emplace_back(batch_size, throughput);
+    best_throughput = std::max(best_throughput, throughput);
+  }
+
+  profile.max_batch_size = 1;
+  for (const auto &p : throughputs) {
+    if (p.second >= 0.95 * best_throughput) {
+      profile.max_batch_size = p.first;
+      break;
+    }
+  }
+
+  return profile;
+}
+
+void ApplyTuningProfile(const TuningProfile &profile,
+                        OnlineRecognizerConfig *config) {
+  config->model_config.num_threads = profile.num_threads;
+  config->model_config.graph_optimization_level =
+      profile.graph_optimization_level;
+}
+
+bool LoadOrTuneOnlineRecognizer(
+    const std::string &profile_file, bool tune,
+    const OnlineRecognizerTunerConfig &tuner_config,
+    OnlineRecognizerConfig *config, TuningProfile *profile) {
+  std::string model_hash = HashFiles(ModelFiles(config->model_config));
+  std::string cpu_model = CpuModelName();
+
+  if (LoadTuningProfile(profile_file, model_hash, cpu_model, profile)) {
+    SHERPA_ONNX_LOGE("Use %s from '%s'", profile->ToString().c_str(),
+                     profile_file.c_str());
+    ApplyTuningProfile(*profile, config);
+    return true;
+  }
+
+  if (!tune) {
+    return false;
+  }
+
+  SHERPA_ONNX_LOGE("Tuning for %s on %s. It may take a while.",
+                   model_hash.c_str(), cpu_model.c_str());
+
+  *profile = TuneOnlineRecognizer(*config, tuner_config);
+  SHERPA_ONNX_LOGE("Tuned: %s", profile->ToString().c_str());
+
+  if (!SaveTuningProfile(profile_file, model_hash, cpu_model, *profile)) {
+    SHERPA_ONNX_LOGE("Failed to save the profile to '%s'",
+                     profile_file.c_str());
+  }
+
+  ApplyTuningProfile(*profile, config);
+  return true;
+}
+
+}  // namespace sherpa_onnx
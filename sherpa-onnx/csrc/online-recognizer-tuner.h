@@ -0,0 +1,77 @@
+// sherpa-onnx/csrc/online-recognizer-tuner.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_TUNER_H_
+#define SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_TUNER_H_
+
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/tuning-profile.h"
+
+namespace sherpa_onnx {
+
+struct OnlineRecognizerTunerConfig {
+  // Largest number of intra-op threads to try. 0 means the number of
+  // hardware threads
+  int32_t max_num_threads = 0;
+
+  // Largest batch size to try
+  int32_t max_batch_size = 16;
+
+  // Seconds of synthetic audio decoded by each stream in a run
+  float duration = 5;
+
+  // If positive, batch sizes whose average time of a DecodeStreams() call
+  // exceeds it are not used
+  float max_latency_ms = 0;
+
+  void Register(ParseOptions *po);
+  bool Validate() const;
+
+  std::string ToString() const;
+};
+
+// Model files of the config. Their content identifies a profile.
+std::vector<std::string> ModelFiles(const OnlineModelConfig &config);
+
+/** Benchmark the models of the given config on synthetic audio and return
+ * the parameters that work best on this machine.
+ *
+ * It first tries each graph optimization level with 1, 2, 4, ... intra-op
+ * threads at batch size 1 and picks the fewest threads that are within
+ * 10% of the fastest run. With those, it tries batch sizes 1, 2, 4, ...
+ * and picks the smallest one whose throughput is within 5% of the best.
+ *
+ * It can take minutes since the models are loaded once for each
+ * combination of threads and optimization level.
+ */
+TuningProfile TuneOnlineRecognizer(
+    const OnlineRecognizerConfig &config,
+    const OnlineRecognizerTunerConfig &tuner_config);
+
+// Set the number of threads and the graph optimization level of config.
+// The batch size is used by the caller, e.g., a server.
+void ApplyTuningProfile(const TuningProfile &profile,
+                        OnlineRecognizerConfig *config);
+
+/** Apply the profile saved in profile_file for the models of config on
+ * this CPU.
+ *
+ * If there is none and tune is true, it runs TuneOnlineRecognizer(), saves
+ * the result to profile_file and applies it.
+ *
+ * @return Return true if a profile is applied. On return, profile contains
+ *         it.
+ */
+bool LoadOrTuneOnlineRecognizer(
+    const std::string &profile_file, bool tune,
+    const OnlineRecognizerTunerConfig &tuner_config,
+    OnlineRecognizerConfig *config, TuningProfile *profile);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_TUNER_H_
@@ -7,9 +7,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>  // NOLINT
+#include <cstdint>
 #include <iomanip>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -23,8 +26,10 @@
 #endif
 
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace sherpa_onnx {
 
@@ -62,6 +67,27 @@ std::string VecToString<std::string>(const std::vector<std::string> &vec,
   return oss.str();
 }
 
+/// Helper for `OnlineRecognizerResult::AsDeltaJsonString()`
+std::string DeltaJsonString(const OnlineRecognizerResult &r,
+                            int32_t text_offset, const std::string &text,
+                            int32_t token_offset,
+                            const std::vector<std::string> &tokens,
+                            const std::vector<float> &timestamps) {
+  std::ostringstream os;
+  os << "{ ";
+  os << "\"text_offset\": " << text_offset << ", ";
+  os << "\"text\": " << std::quoted(text) << ", ";
+  os << "\"token_offset\": " << token_offset << ", ";
+  os << "\"tokens\": " << VecToString(tokens) << ", ";
+  os << "\"timestamps\": " << VecToString(timestamps, 2) << ", ";
+  os << "\"segment\": " << r.segment << ", ";
+  os << "\"start_time\": " << std::fixed << std::setprecision(2)
+     << r.start_time << ", ";
+  os << "\"is_final\": " << (r.is_final ? "true" : "false");
+  os << "}";
+  return os.str();
+}
+
 }  // namespace
 
 std::string OnlineRecognizerResult::AsJsonString() const {
@@ -82,6 +108,57 @@ std::string OnlineRecognizerResult::AsJsonString() const {
   return os.str();
 }
 
+std::string OnlineRecognizerResult::AsDeltaJsonString(
+    const OnlineRecognizerResult &prev) const {
+  if (is_delta) {
+    return DeltaJsonString(*this, text_offset, text, token_offset, tokens,
+                           timestamps);
+  }
+
+  size_t text_bytes = 0;
+  int32_t num_chars = 0;
+  size_t num_tokens = 0;
+
+  if (prev.segment == segment) {
+    size_t n = std::min(text.size(), prev.text.size());
+    text_bytes =
+        std::mismatch(text.begin(), text.begin() + n, prev.text.begin())
+            .first -
+        text.begin();
+
+    // Don't split a UTF-8 character
+    while (text_bytes > 0 && text_bytes < text.size() &&
+           (static_cast<uint8_t>(text[text_bytes]) & 0xc0) == 0x80) {
+      --text_bytes;
+    }
+
+    for (size_t i = 0; i != text_bytes; ++i) {
+      if ((static_cast<uint8_t>(text[i]) & 0xc0) != 0x80) {
+        ++num_chars;
+      }
+    }
+
+    n = std::min(tokens.size(), prev.tokens.size());
+    while (num_tokens < n && tokens[num_tokens] == prev.tokens[num_tokens] &&
+           (num_tokens >= timestamps.size() ||
+            num_tokens >= prev.timestamps.size() ||
+            timestamps[num_tokens] == prev.timestamps[num_tokens])) {
+      ++num_tokens;
+    }
+  }
+
+  std::vector<std::string> new_tokens(tokens.begin() + num_tokens,
+                                      tokens.end());
+  std::vector<float> new_timestamps;
+  if (num_tokens < timestamps.size()) {
+    new_timestamps.assign(timestamps.begin() + num_tokens, timestamps.end());
+  }
+
+  return DeltaJsonString(*this, num_chars, text.substr(text_bytes),
+                         static_cast<int32_t>(num_tokens), new_tokens,
+                         new_timestamps);
+}
+
 void OnlineRecognizerConfig::Register(ParseOptions *po) {
   feat_config.Register(po);
   model_config.Register(po);
@@ -121,17 +198,36 @@ void OnlineRecognizerConfig::Register(ParseOptions *po) {
       "rule-fars", &rule_fars,
       "If not empty, it specifies fst archives for inverse text normalization. "
       "If there are multiple archives, they are separated by a comma.");
+
+  po->Register("pipeline", &pipeline,
+               "True to run the encoder of a batch in parallel with the "
+               "search of the previous batch. Used only for transducer "
+               "models.");
+
+  po->Register("pipeline-batch-size", &pipeline_batch_size,
+               "Used only when --pipeline is true. Streams passed to "
+               "DecodeStreams() are split into batches of this size so that "
+               "they can overlap. 0 means not to split them.");
+
+  po->Register("enable-snapshots", &feat_config.enable_snapshots,
+               "True to keep the most recent samples of each stream so that "
+               "OnlineStream::Serialize() can snapshot it");
+
+  po->Register("itn-tail-tokens", &itn_tail_tokens,
+               "If positive, partial results of transducer models apply "
+               "inverse text normalization only to about the last this many "
+               "tokens. Final results are always normalized as a whole.");
 }
 
 bool OnlineRecognizerConfig::Validate() const {
-  if (decoding_method == "modified_beam_search" && !lm_config.model.empty()) {
+  if (decoding_method == "modified_beam_search") {
     if (max_active_paths <= 0) {
       SHERPA_ONNX_LOGE("max_active_paths is less than 0! Given: %d",
                        max_active_paths);
       return false;
     }
 
-    if (!lm_config.Validate()) {
+    if (!lm_config.model.empty() && !lm_config.Validate()) {
       return false;
     }
   }
@@ -144,6 +240,18 @@ bool OnlineRecognizerConfig::Validate() const {
     return false;
   }
 
+  if (pipeline_batch_size < 0) {
+    SHERPA_ONNX_LOGE("--pipeline-batch-size should be >= 0. Given: %d",
+                     pipeline_batch_size);
+    return false;
+  }
+
+  if (itn_tail_tokens < 0) {
+    SHERPA_ONNX_LOGE("--itn-tail-tokens should be >= 0. Given: %d",
+                     itn_tail_tokens);
+    return false;
+  }
+
   if (!ctc_fst_decoder_config.graph.empty() &&
       !ctc_fst_decoder_config.Validate()) {
     SHERPA_ONNX_LOGE("Errors in ctc_fst_decoder_config");
@@ -198,7 +306,10 @@ std::string OnlineRecognizerConfig::ToString() const {
   os << "blank_penalty=" << blank_penalty << ", ";
   os << "temperature_scale=" << temperature_scale << ", ";
   os << "rule_fsts=\"" << rule_fsts << "\", ";
-  os << "rule_fars=\"" << rule_fars << "\")";
+  os << "rule_fars=\"" << rule_fars << "\", ";
+  os << "pipeline=" << (pipeline ? "True" : "False") << ", ";
+  os << "pipeline_batch_size=" << pipeline_batch_size << ", ";
+  os << "itn_tail_tokens=" << itn_tail_tokens << ")";
 
   return os.str();
 }
@@ -228,18 +339,83 @@ bool OnlineRecognizer::IsReady(OnlineStream *s) const {
 
 void OnlineRecognizer::WarmpUpRecognizer(int32_t warmup, int32_t mbs) const {
   if (warmup > 0) {
-    impl_->WarmpUpRecognizer(warmup, mbs);
+    impl_->WarmpUpRecognizer(warmup, std::max(mbs, 1));
   }
 }
 
+namespace {
+
+struct OnlineDecodeMetrics {
+  Histogram *decode_seconds;
+  Histogram *batch_size;
+  Counter *audio_seconds;
+
+  OnlineDecodeMetrics() {
+    auto &registry = MetricsRegistry::Global();
+    decode_seconds =
+        registry.GetHistogram("sherpa_onnx_online_decode_seconds",
+                              "Time of OnlineRecognizer::DecodeStreams()");
+    batch_size = registry.GetHistogram(
+        "sherpa_onnx_online_batch_size",
+        "Number of streams per call of OnlineRecognizer::DecodeStreams()",
+        Histogram::SizeBounds());
+    audio_seconds =
+        registry.GetCounter("sherpa_onnx_online_audio_seconds_total",
+                            "Seconds of audio decoded by OnlineRecognizer");
+    registry.AddRatio("sherpa_onnx_online_rtf",
+                      "Real-time factor of OnlineRecognizer::DecodeStreams()",
+                      "sherpa_onnx_online_decode_seconds",
+                      "sherpa_onnx_online_audio_seconds_total");
+  }
+};
+
+}  // namespace
+
 void OnlineRecognizer::DecodeStreams(OnlineStream **ss, int32_t n) const {
+  SHERPA_ONNX_TRACE_SCOPE_N("OnlineRecognizer::DecodeStreams", n);
+
+  if (!MetricsEnabled()) {
+    impl_->DecodeStreams(ss, n);
+    return;
+  }
+
+  static OnlineDecodeMetrics metrics;
+
+  int64_t num_frames = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    num_frames -= ss[i]->GetNumProcessedFrames();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
   impl_->DecodeStreams(ss, n);
+
+  auto end = std::chrono::steady_clock::now();
+
+  for (int32_t i = 0; i != n; ++i) {
+    num_frames += ss[i]->GetNumProcessedFrames();
+  }
+
+  // All of the supported models use a frame shift of 10 ms
+  metrics.audio_seconds->Inc(num_frames * 0.01);
+  metrics.decode_seconds->Observe(
+      std::chrono::duration<double>(end - start).count());
+  metrics.batch_size->Observe(n);
 }
 
 OnlineRecognizerResult OnlineRecognizer::GetResult(OnlineStream *s) const {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_get_result_seconds",
+                             "Time of OnlineRecognizer::GetResult()");
   return impl_->GetResult(s);
 }
 
+OnlineRecognizerResult OnlineRecognizer::GetDeltaResult(
+    OnlineStream *s) const {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_get_result_seconds",
+                             "Time of OnlineRecognizer::GetResult()");
+  return impl_->GetDeltaResult(s);
+}
+
 bool OnlineRecognizer::IsEndpoint(OnlineStream *s) const {
   return impl_->IsEndpoint(s);
 }
@@ -55,6 +55,15 @@ struct OnlineRecognizerResult {
   /// True if the end of this segment is reached
   bool is_final = false;
 
+  /// Set by OnlineRecognizer::GetDeltaResult() for recognizers that build
+  /// results incrementally. If true, tokens, timestamps, ys_probs, lm_probs
+  /// and context_scores start at the token token_offset, and text starts
+  /// at the Unicode code point text_offset. What is before them is the
+  /// same as in the previous delta result of the stream.
+  bool is_delta = false;
+  int32_t token_offset = 0;
+  int32_t text_offset = 0;
+
   /** Return a json string.
    *
    * The returned string contains:
@@ -71,6 +80,31 @@ struct OnlineRecognizerResult {
    *   }
    */
   std::string AsJsonString() const;
+
+  /** Return a compact json string that contains only what has changed
+   * since prev, which is the previous result sent for the same stream.
+   *
+   * The returned string contains:
+   *   {
+   *     "text_offset": x,
+   *     "text": "The text after text_offset",
+   *     "token_offset": x,
+   *     "tokens": [x, x, x],
+   *     "timestamps": [x, x, x],
+   *     "segment": x,
+   *     "start_time": x,
+   *     "is_final": true|false
+   *   }
+   *
+   * A client gets the full text by keeping the first text_offset
+   * characters (Unicode code points) of the previous text and appending
+   * "text". Tokens and timestamps are updated in the same way with
+   * token_offset. Offsets are 0 for the first result of a segment.
+   *
+   * If is_delta is true, the offsets of this result are used and prev is
+   * ignored. Otherwise, they are found by comparing with prev.
+   */
+  std::string AsDeltaJsonString(const OnlineRecognizerResult &prev) const;
 };
 
 struct OnlineRecognizerConfig {
@@ -106,6 +140,20 @@ struct OnlineRecognizerConfig {
   /// "hotwords_file"
   std::string hotwords_buf;
 
+  /// used only for transducer models. If true, the encoder of a batch runs
+  /// on one thread while the search of the previous batch runs on another.
+  bool pipeline = false;
+
+  /// used only when pipeline is true. DecodeStreams() splits its streams
+  /// into batches of this size so that they can overlap. 0 means no split.
+  int32_t pipeline_batch_size = 0;
+
+  /// used only for transducer models. If positive, partial results apply
+  /// inverse text normalization only to roughly the last this many tokens
+  /// and reuse the normalized text of older tokens. Results at endpoints
+  /// and at the end of input are always normalized as a whole.
+  int32_t itn_tail_tokens = 0;
+
   OnlineRecognizerConfig() = default;
 
   OnlineRecognizerConfig(
@@ -179,6 +227,10 @@ class OnlineRecognizer {
    * Warmups up onnxruntime sessions by apply optimization and
    * allocating memory prior
    *
+   * It decodes synthetic audio with 1, 2, 4, ..., mbs streams at a time
+   * so that the shapes of all batch sizes up to mbs are seen before the
+   * first request. It works for all types of models.
+   *
    * @param warmup Number of warmups.
    * @param mbs : max-batch-size Max batch size for the models
    */
@@ -193,6 +245,14 @@ class OnlineRecognizer {
 
   OnlineRecognizerResult GetResult(OnlineStream *s) const;
 
+  /** Return the changes of the result since the previous call for the
+   * same stream. Streaming transducers return a result with is_delta set
+   * that contains only the tokens and the text that changed, so the cost
+   * does not grow with the utterance length. Other models return the
+   * whole result. Pass it to OnlineRecognizerResult::AsDeltaJsonString().
+   */
+  OnlineRecognizerResult GetDeltaResult(OnlineStream *s) const;
+
   // Return true if we detect an endpoint for this stream.
   // Note: If this function returns true, you usually want to
   // invoke Reset(s).
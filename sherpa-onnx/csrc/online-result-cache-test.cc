@@ -0,0 +1,245 @@
+// sherpa-onnx/csrc/online-result-cache-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-result-cache.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/online-stream.h"
+
+namespace sherpa_onnx {
+
+static SymbolTable CreateSymbolTable() {
+  return SymbolTable(
+      "<blk> 0\n"
+      "▁HELLO 1\n"
+      "▁WORLD 2\n"
+      "S 3\n"
+      "▁TWO 4\n"
+      "你好 5\n"
+      "世界 6\n"
+      "你如 7\n",
+      false);
+}
+
+// Apply a delta to text as a client does. offset is in code points
+static void ApplyTextDelta(int32_t offset, const std::string &delta,
+                           std::string *text) {
+  size_t i = 0;
+  int32_t n = 0;
+  for (; i < text->size(); ++i) {
+    if ((static_cast<uint8_t>((*text)[i]) & 0xc0) != 0x80) {
+      if (n == offset) {
+        break;
+      }
+      ++n;
+    }
+  }
+  EXPECT_EQ(n, offset);
+
+  text->resize(i);
+  text->append(delta);
+}
+
+TEST(OnlineResultCache, Update) {
+  SymbolTable sym = CreateSymbolTable();
+  OnlineResultCache cache;
+
+  EXPECT_EQ(cache.Update({1}, sym), 0);
+  EXPECT_EQ(cache.RawText(), " HELLO");
+
+  EXPECT_EQ(cache.Update({1, 2}, sym), 1);
+  EXPECT_EQ(cache.RawText(), " HELLO WORLD");
+
+  EXPECT_EQ(cache.Update({1, 2, 3}, sym), 2);
+  EXPECT_EQ(cache.RawText(), " HELLO WORLDS");
+  EXPECT_EQ(cache.Tokens(),
+            (std::vector<std::string>{" HELLO", " WORLD", "S"}));
+
+  // The best path is changed, e.g., by beam search
+  EXPECT_EQ(cache.Update({1, 4}, sym), 1);
+  EXPECT_EQ(cache.RawText(), " HELLO TWO");
+  EXPECT_EQ(cache.Tokens(), (std::vector<std::string>{" HELLO", " TWO"}));
+
+  EXPECT_EQ(cache.Update({}, sym), 0);
+  EXPECT_EQ(cache.RawText(), "");
+  EXPECT_TRUE(cache.Tokens().empty());
+}
+
+TEST(OnlineResultCache, Normalize) {
+  SymbolTable sym = CreateSymbolTable();
+  OnlineResultCache cache;
+
+  int32_t num_calls = 0;
+  auto itn = [&num_calls](std::string text) {
+    ++num_calls;
+    return "[" + text + "]";
+  };
+
+  cache.Update({1, 2, 3}, sym);
+  EXPECT_EQ(cache.Normalize(itn, 0, false), "[ HELLO WORLDS]");
+  EXPECT_EQ(cache.Normalize(itn, 1, true), "[ HELLO WORLDS]");
+
+  // Too few tokens to split
+  EXPECT_EQ(cache.Normalize(itn, 2, false), " [HELLO WORLDS]");
+
+  // The head ends before a word, so S stays with WORLD
+  cache.Update({1, 2, 3, 4, 2}, sym);
+  EXPECT_EQ(cache.Normalize(itn, 1, false), " [HELLO WORLDS TWO] [WORLD]");
+
+  // The head is normalized only once
+  num_calls = 0;
+  EXPECT_EQ(cache.Normalize(itn, 1, false), " [HELLO WORLDS TWO] [WORLD]");
+  EXPECT_EQ(num_calls, 1);
+
+  // Changing the head invalidates it
+  cache.Update({1, 4}, sym);
+  EXPECT_EQ(cache.Normalize(itn, 1, false), " [HELLO TWO]");
+}
+
+TEST(OnlineResultCache, TakeDeltaBegin) {
+  SymbolTable sym = CreateSymbolTable();
+  OnlineResultCache cache;
+
+  cache.Update({1, 2}, sym);
+  EXPECT_EQ(cache.TakeDeltaBegin(), 0);
+
+  cache.Update({1, 2, 3}, sym);
+  EXPECT_EQ(cache.TakeDeltaBegin(), 2);
+  EXPECT_EQ(cache.TakeDeltaBegin(), 3);
+
+  // The smallest prefix of all updates since the previous call is used
+  cache.Update({1, 4}, sym);
+  cache.Update({1, 4, 2, 3}, sym);
+  EXPECT_EQ(cache.TakeDeltaBegin(), 1);
+
+  // A changed timestamp changes the token
+  cache.Update({1, 4, 2, 3}, sym, {0, 4, 8, 12});
+  EXPECT_EQ(cache.TakeDeltaBegin(), 4);
+  cache.Update({1, 4, 2, 3}, sym, {0, 4, 9, 12});
+  EXPECT_EQ(cache.TakeDeltaBegin(), 2);
+
+  cache.Clear();
+  cache.Update({1, 4}, sym);
+  EXPECT_EQ(cache.TakeDeltaBegin(), 0);
+}
+
+TEST(OnlineResultCache, Delta) {
+  SymbolTable sym = CreateSymbolTable();
+  OnlineResultCache cache;
+
+  auto itn = [](std::string text) { return text; };
+
+  // What a client rebuilds from the deltas
+  std::string text;
+  std::vector<std::string> tokens;
+  int32_t text_offset = 0;
+  int32_t token_offset = 0;
+
+  auto step = [&](const std::vector<int64_t> &ids, int32_t tail_tokens,
+                  bool final) {
+    cache.Update(ids, sym);
+
+    token_offset = cache.TakeDeltaBegin();
+    tokens.resize(token_offset);
+    tokens.insert(tokens.end(), cache.Tokens().begin() + token_offset,
+                  cache.Tokens().end());
+    EXPECT_EQ(tokens, cache.Tokens());
+
+    std::string delta =
+        cache.NormalizeDelta(itn, tail_tokens, final, &text_offset);
+    ApplyTextDelta(text_offset, delta, &text);
+    EXPECT_EQ(text, cache.RawText());
+    return delta;
+  };
+
+  EXPECT_EQ(step({5}, 1, false), "你好");
+  EXPECT_EQ(text_offset, 0);
+
+  EXPECT_EQ(step({5, 6}, 1, false), "世界");
+  EXPECT_EQ(token_offset, 1);
+  EXPECT_EQ(text_offset, 2);
+
+  // The best path is rewritten. The changed bytes start in the middle of
+  // a character, which is sent in full
+  EXPECT_EQ(step({7}, 1, false), "如");
+  EXPECT_EQ(token_offset, 0);
+  EXPECT_EQ(text_offset, 1);
+
+  // A long utterance. Older tokens move to the normalized head and are not
+  // compared again
+  std::vector<int64_t> ids = {7};
+  for (int32_t i = 0; i != 20; ++i) {
+    int32_t n = static_cast<int32_t>(text.size());
+    ids.push_back(i % 2 ? 6 : 1);
+    std::string delta = step(ids, 2, false);
+    EXPECT_EQ(delta, cache.Tokens().back());
+    EXPECT_EQ(text.size(), n + delta.size());
+  }
+
+  // Rewrite a token in the head. The space before it is unchanged
+  ids[1] = 4;
+  step(ids, 2, false);
+  EXPECT_EQ(token_offset, 1);
+  EXPECT_EQ(text_offset, 3);
+
+  // The whole text of a final result is compared
+  ids.push_back(5);
+  EXPECT_EQ(step(ids, 2, true), "你好");
+
+  ids.back() = 6;
+  EXPECT_EQ(step(ids, 2, false), "世界");
+
+  // A new segment
+  cache.Clear();
+  EXPECT_EQ(step({2}, 2, false), " WORLD");
+  EXPECT_EQ(token_offset, 0);
+  EXPECT_EQ(text_offset, 0);
+}
+
+// An endpoint resets the stream. The first delta of the next segment
+// must not refer to the text of the previous one
+TEST(OnlineResultCache, StreamReset) {
+  SymbolTable sym = CreateSymbolTable();
+  OnlineStream s;
+
+  auto itn = [](std::string text) { return text; };
+
+  OnlineResultCache &cache = s.GetResultCache();
+  int32_t offset = -1;
+  cache.Update({1, 2}, sym);
+  EXPECT_EQ(cache.TakeDeltaBegin(), 0);
+  EXPECT_EQ(cache.NormalizeDelta(itn, 2, false, &offset), " HELLO WORLD");
+  EXPECT_EQ(offset, 0);
+
+  s.Reset();
+
+  cache.Update({1, 4}, sym);
+  EXPECT_EQ(cache.TakeDeltaBegin(), 0);
+  EXPECT_EQ(cache.NormalizeDelta(itn, 2, false, &offset), " HELLO TWO");
+  EXPECT_EQ(offset, 0);
+}
+
+TEST(OnlineResultCache, TextDelta) {
+  OnlineResultCache cache;
+
+  int32_t offset = -1;
+  EXPECT_EQ(cache.TextDelta("你好世界", &offset), "你好世界");
+  EXPECT_EQ(offset, 0);
+
+  EXPECT_EQ(cache.TextDelta("你好世界!", &offset), "!");
+  EXPECT_EQ(offset, 4);
+
+  EXPECT_EQ(cache.TextDelta("你如", &offset), "如");
+  EXPECT_EQ(offset, 1);
+
+  cache.Clear();
+  EXPECT_EQ(cache.TextDelta("你如", &offset), "你如");
+  EXPECT_EQ(offset, 0);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,255 @@
+// sherpa-onnx/csrc/online-result-cache.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-result-cache.h"
+
+#include <algorithm>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+namespace {
+
+// Normalize text and append it to out. A leading space separates words
+// and is kept outside of the normalized text.
+void AppendNormalized(const std::function<std::string(std::string)> &itn,
+                      std::string text, std::string *out) {
+  size_t n = text.find_first_not_of(' ');
+  if (n == std::string::npos) {
+    out->append(text);
+    return;
+  }
+
+  if (n > 0) {
+    out->push_back(' ');
+    text.erase(0, n);
+  }
+
+  out->append(itn(std::move(text)));
+}
+
+// Number of Unicode code points in s[begin, end)
+int32_t CountChars(const std::string &s, size_t begin, size_t end) {
+  int32_t n = 0;
+  for (size_t i = begin; i < end; ++i) {
+    if ((static_cast<uint8_t>(s[i]) & 0xc0) != 0x80) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+// Length of the common prefix of a and b that does not end in the middle
+// of a UTF-8 character of a
+size_t CommonPrefix(const std::string &a, size_t a_begin, const std::string &b,
+                    size_t b_begin) {
+  size_t n = std::min(a.size() - a_begin, b.size() - b_begin);
+  size_t k = std::mismatch(a.begin() + a_begin, a.begin() + a_begin + n,
+                           b.begin() + b_begin)
+                 .first -
+             (a.begin() + a_begin);
+
+  while (k > 0 && a_begin + k < a.size() &&
+         (static_cast<uint8_t>(a[a_begin + k]) & 0xc0) == 0x80) {
+    --k;
+  }
+
+  return k;
+}
+
+}  // namespace
+
+int32_t OnlineResultCache::Update(
+    const std::vector<int64_t> &ids, const SymbolTable &sym,
+    const std::vector<int32_t> &timestamps /*= {}*/) {
+  int32_t n = static_cast<int32_t>(std::min(ids_.size(), ids.size()));
+  int32_t num_timestamps =
+      static_cast<int32_t>(std::min(timestamps_.size(), timestamps.size()));
+  int32_t k = 0;
+  while (k < n && ids_[k] == ids[k] &&
+         (k >= num_timestamps || timestamps_[k] == timestamps[k])) {
+    ++k;
+  }
+
+  raw_text_.resize(TokenBegin(k));
+  ids_.resize(k);
+  tokens_.resize(k);
+  token_ends_.resize(k);
+
+  timestamps_.resize(std::min<size_t>(timestamps_.size(), k));
+  if (timestamps_.size() < timestamps.size()) {
+    timestamps_.insert(timestamps_.end(),
+                       timestamps.begin() + timestamps_.size(),
+                       timestamps.end());
+  }
+
+  if (num_normalized_tokens_ > k) {
+    if (last_head_size_ > 0) {
+      // Keep the text of the previous delta to compare with
+      last_tail_.insert(0, normalized_head_, 0, last_head_size_);
+      last_head_size_ = 0;
+      last_head_chars_ = 0;
+    }
+
+    normalized_head_.clear();
+    num_normalized_tokens_ = 0;
+    normalized_head_chars_ = 0;
+  }
+
+  delta_begin_ = std::min(delta_begin_, k);
+
+  for (int32_t i = k; i < static_cast<int32_t>(ids.size()); ++i) {
+    auto s = sym[ids[i]];
+    raw_text_.append(s);
+    token_ends_.push_back(static_cast<int32_t>(raw_text_.size()));
+
+    if (s.size() == 1 && (s[0] < 0x20 || s[0] > 0x7e)) {
+      // for bpe models with byte_fallback
+      // (but don't rewrite printable characters 0x20..0x7e,
+      //  which collide with standard BPE units)
+      std::ostringstream os;
+      os << "<0x" << std::hex << std::uppercase
+         << (static_cast<int32_t>(s[0]) & 0xff) << ">";
+      s = os.str();
+    }
+
+    ids_.push_back(ids[i]);
+    tokens_.push_back(std::move(s));
+  }
+
+  return k;
+}
+
+int32_t OnlineResultCache::TakeDeltaBegin() {
+  int32_t ans = delta_begin_;
+  delta_begin_ = static_cast<int32_t>(tokens_.size());
+  return ans;
+}
+
+std::string OnlineResultCache::Normalize(
+    const std::function<std::string(std::string)> &itn, int32_t tail_tokens,
+    bool final) {
+  if (tail_tokens <= 0 || final) {
+    return itn(raw_text_);
+  }
+
+  ExtendNormalizedHead(itn, tail_tokens);
+
+  std::string ans = normalized_head_;
+  AppendNormalized(itn, raw_text_.substr(TokenBegin(num_normalized_tokens_)),
+                   &ans);
+  return ans;
+}
+
+std::string OnlineResultCache::NormalizeDelta(
+    const std::function<std::string(std::string)> &itn, int32_t tail_tokens,
+    bool final, int32_t *offset) {
+  if (tail_tokens <= 0 || final) {
+    return TextDelta(itn(raw_text_), offset);
+  }
+
+  ExtendNormalizedHead(itn, tail_tokens);
+
+  std::string tail;
+  AppendNormalized(itn, raw_text_.substr(TokenBegin(num_normalized_tokens_)),
+                   &tail);
+
+  if (last_head_size_ < 0) {
+    last_head_size_ = 0;
+    last_head_chars_ = 0;
+    last_tail_.clear();
+  }
+
+  // The head only grows until it is invalidated, so the previous text and
+  // this one share normalized_head_[0, last_head_size_)
+  std::string text = normalized_head_.substr(last_head_size_) + tail;
+  size_t k = CommonPrefix(text, 0, last_tail_, 0);
+  *offset = last_head_chars_ + CountChars(text, 0, k);
+
+  last_head_size_ = static_cast<int32_t>(normalized_head_.size());
+  last_head_chars_ = normalized_head_chars_;
+  last_tail_ = std::move(tail);
+
+  return text.substr(k);
+}
+
+std::string OnlineResultCache::TextDelta(std::string text, int32_t *offset) {
+  size_t k = 0;
+  if (last_head_size_ >= 0) {
+    k = CommonPrefix(text, 0, normalized_head_.substr(0, last_head_size_), 0);
+    if (k == static_cast<size_t>(last_head_size_)) {
+      k += CommonPrefix(text, k, last_tail_, 0);
+    }
+  }
+
+  *offset = CountChars(text, 0, k);
+
+  std::string ans = text.substr(k);
+
+  last_head_size_ = 0;
+  last_head_chars_ = 0;
+  last_tail_ = std::move(text);
+
+  return ans;
+}
+
+void OnlineResultCache::Clear() {
+  ids_.clear();
+  timestamps_.clear();
+  tokens_.clear();
+  token_ends_.clear();
+  raw_text_.clear();
+  normalized_head_.clear();
+  num_normalized_tokens_ = 0;
+  normalized_head_chars_ = 0;
+  delta_begin_ = 0;
+  last_head_size_ = -1;
+  last_head_chars_ = 0;
+  last_tail_.clear();
+}
+
+void OnlineResultCache::ExtendNormalizedHead(
+    const std::function<std::string(std::string)> &itn, int32_t tail_tokens) {
+  int32_t n = static_cast<int32_t>(tokens_.size());
+  if (n - num_normalized_tokens_ <= 2 * tail_tokens) {
+    return;
+  }
+
+  int32_t end = FindBoundary(num_normalized_tokens_ + 1, n - tail_tokens);
+  int32_t b = TokenBegin(num_normalized_tokens_);
+  size_t old_size = normalized_head_.size();
+  AppendNormalized(itn, raw_text_.substr(b, TokenBegin(end) - b),
+                   &normalized_head_);
+  normalized_head_chars_ +=
+      CountChars(normalized_head_, old_size, normalized_head_.size());
+  num_normalized_tokens_ = end;
+}
+
+int32_t OnlineResultCache::FindBoundary(int32_t begin, int32_t end) const {
+  // Prefer the start of a word
+  for (int32_t i = end; i >= begin; --i) {
+    int32_t b = TokenBegin(i);
+    if (b < static_cast<int32_t>(raw_text_.size()) && raw_text_[b] == ' ') {
+      return i;
+    }
+  }
+
+  // There are no spaces, e.g., for Chinese. Any token that does not start
+  // in the middle of a UTF-8 character will do
+  for (int32_t i = end; i >= begin; --i) {
+    int32_t b = TokenBegin(i);
+    if (b < static_cast<int32_t>(raw_text_.size()) &&
+        (static_cast<uint8_t>(raw_text_[b]) & 0xc0) != 0x80) {
+      return i;
+    }
+  }
+
+  return end;
+}
+
+}  // namespace sherpa_onnx
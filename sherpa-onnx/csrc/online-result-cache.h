@@ -0,0 +1,122 @@
+// sherpa-onnx/csrc/online-result-cache.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_RESULT_CACHE_H_
+#define SHERPA_ONNX_CSRC_ONLINE_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/symbol-table.h"
+
+namespace sherpa_onnx {
+
+/** Per-stream cache of the token strings and the text of a partial result.
+ *
+ * A recognizer calls GetResult() after every chunk, but usually only a few
+ * tokens at the end of the best path are new. Update() converts only the
+ * tokens after the longest common prefix with the previous call, so the
+ * cost of a partial result does not grow with the utterance length.
+ */
+class OnlineResultCache {
+ public:
+  /** Update the cache with the token IDs of the current best path.
+   *
+   * @param timestamps  If not empty, the frame indexes of the tokens. A
+   *                    token whose timestamp changed is also treated as
+   *                    changed.
+   * @return Return the number of leading tokens that are unchanged since
+   *         the previous call.
+   */
+  int32_t Update(const std::vector<int64_t> &ids, const SymbolTable &sym,
+                 const std::vector<int32_t> &timestamps = {});
+
+  /** Return the number of leading tokens that are unchanged since the
+   * previous call of this function, i.e., over all calls of Update() in
+   * between. It is 0 for the first call after Clear().
+   */
+  int32_t TakeDeltaBegin();
+
+  // Token strings. Single non-printable bytes are shown as <0xXX>
+  const std::vector<std::string> &Tokens() const { return tokens_; }
+
+  // Concatenation of the symbols of all tokens
+  const std::string &RawText() const { return raw_text_; }
+
+  /** Apply inverse text normalization to RawText().
+   *
+   * If tail_tokens is positive and final is false, only the last
+   * tail_tokens to 2 * tail_tokens tokens are normalized on each call. Older
+   * tokens are normalized in pieces that end at word boundaries and the
+   * results are cached. It is an approximation, since a piece cannot
+   * see its right context, so final results should pass final=true to
+   * normalize the whole text.
+   *
+   * @param itn  It normalizes a piece of text.
+   */
+  std::string Normalize(const std::function<std::string(std::string)> &itn,
+                        int32_t tail_tokens, bool final);
+
+  /** The same as Normalize() but return only the text after the first
+   * *offset Unicode code points, which are the same as in the text of the
+   * previous call of NormalizeDelta() or TextDelta().
+   *
+   * For partial results with a positive tail_tokens, only the tail of the
+   * text is compared, so the cost does not grow with the utterance length.
+   */
+  std::string NormalizeDelta(
+      const std::function<std::string(std::string)> &itn, int32_t tail_tokens,
+      bool final, int32_t *offset);
+
+  /** Return the part of text after the first *offset Unicode code points
+   * that are the same as in the text of the previous call of
+   * NormalizeDelta() or TextDelta(). It compares the whole text, so use it
+   * only if the text is not built by NormalizeDelta().
+   */
+  std::string TextDelta(std::string text, int32_t *offset);
+
+  void Clear();
+
+ private:
+  // Byte offset in raw_text_ where token i begins
+  int32_t TokenBegin(int32_t i) const {
+    return i == 0 ? 0 : token_ends_[i - 1];
+  }
+
+  // Return a token index in [begin, end] before which a new piece of text
+  // can start
+  int32_t FindBoundary(int32_t begin, int32_t end) const;
+
+  // Normalize more tokens into normalized_head_ if the tail is too long
+  void ExtendNormalizedHead(
+      const std::function<std::string(std::string)> &itn, int32_t tail_tokens);
+
+ private:
+  std::vector<int64_t> ids_;
+  std::vector<int32_t> timestamps_;
+  std::vector<std::string> tokens_;
+  std::vector<int32_t> token_ends_;
+  std::string raw_text_;
+
+  // Normalized text of tokens [0, num_normalized_tokens_)
+  std::string normalized_head_;
+  int32_t num_normalized_tokens_ = 0;
+  int32_t normalized_head_chars_ = 0;  // number of code points
+
+  // Used by TakeDeltaBegin()
+  int32_t delta_begin_ = 0;
+
+  // The text of the previous delta is normalized_head_.substr(0,
+  // last_head_size_) + last_tail_. last_head_size_ is -1 if there is no
+  // previous delta
+  int32_t last_head_size_ = -1;
+  int32_t last_head_chars_ = 0;
+  std::string last_tail_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_RESULT_CACHE_H_
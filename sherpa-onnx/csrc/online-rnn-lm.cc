@@ -6,16 +6,24 @@
 #include "sherpa-onnx/csrc/online-rnn-lm.h"
 
 #include <algorithm>
+#include <array>
+#include <list>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/cat.h"
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/trace.h"
+#include "sherpa-onnx/csrc/unbind.h"
 
 namespace sherpa_onnx {
 
@@ -31,33 +39,114 @@ class OnlineRnnLM::Impl {
 
   // shallow fusion scoring function
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) {
-    if (hyp->nn_lm_states.empty()) {
-      auto init_states = GetInitStatesSF();
-      hyp->nn_lm_scores.value = std::move(init_states.first);
-      hyp->nn_lm_states = Convert(std::move(init_states.second));
+    ComputeLMScoresSF(scale, &hyp, 1);
+  }
+
+  // shallow fusion scoring function for a batch of hyps.
+  //
+  // The scores of the next token of all hyps whose tokens are not in the
+  // cache are computed with a single run of the model. Hyps with the same
+  // tokens, e.g., from different streams, are computed only once.
+  void ComputeLMScoresSF(float scale, Hypothesis **hyps, int32_t n) {
+    // rows[i] contains the hyps of the i-th row of the batch
+    std::vector<std::vector<Hypothesis *>> rows;
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, int32_t> key_to_row;
+
+    for (int32_t i = 0; i != n; ++i) {
+      Hypothesis *hyp = hyps[i];
+      if (hyp->nn_lm_states.empty()) {
+        auto init_states = GetInitStatesSF();
+        hyp->nn_lm_scores.value = std::move(init_states.first);
+        hyp->nn_lm_states = Convert(std::move(init_states.second));
+      }
+
+      // get lm score for cur token given the hyp->ys[:-1] and save to
+      // lm_log_prob
+      const float *nn_lm_scores =
+          hyp->nn_lm_scores.value.GetTensorData<float>();
+      hyp->lm_log_prob += nn_lm_scores[hyp->ys.back()] * scale;
+
+      std::string key = CacheKey(hyp->ys);
+      if (LookupCache(key, hyp)) {
+        continue;
+      }
+
+      auto it = key_to_row.find(key);
+      if (it != key_to_row.end()) {
+        rows[it->second].push_back(hyp);
+        continue;
+      }
+
+      key_to_row[key] = static_cast<int32_t>(rows.size());
+      rows.push_back({hyp});
+      keys.push_back(std::move(key));
+    }
+
+    if (rows.empty()) {
+      return;
     }
 
-    // get lm score for cur token given the hyp->ys[:-1] and save to lm_log_prob
-    const float *nn_lm_scores = hyp->nn_lm_scores.value.GetTensorData<float>();
-    hyp->lm_log_prob += nn_lm_scores[hyp->ys.back()] * scale;
+    SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_lm_seconds",
+                               "Time to run the RNN LM for shallow fusion");
+    SHERPA_ONNX_TRACE_SCOPE("OnlineRnnLM::ComputeLMScoresSF");
 
     // get lm scores for next tokens given the hyp->ys[:] and save to
     // nn_lm_scores
-    std::array<int64_t, 2> x_shape{1, 1};
+    int32_t batch_size = static_cast<int32_t>(rows.size());
+    std::array<int64_t, 2> x_shape{batch_size, 1};
     Ort::Value x = Ort::Value::CreateTensor<int64_t>(allocator_, x_shape.data(),
                                                      x_shape.size());
-    *x.GetTensorMutableData<int64_t>() = hyp->ys.back();
-    auto lm_out = ScoreToken(std::move(x), Convert(hyp->nn_lm_states));
-    hyp->nn_lm_scores.value = std::move(lm_out.first);
-    hyp->nn_lm_states = Convert(std::move(lm_out.second));
+    int64_t *p_x = x.GetTensorMutableData<int64_t>();
+
+    std::vector<const Ort::Value *> h(batch_size);
+    std::vector<const Ort::Value *> c(batch_size);
+    for (int32_t i = 0; i != batch_size; ++i) {
+      const Hypothesis *hyp = rows[i][0];
+      p_x[i] = hyp->ys.back();
+      h[i] = &hyp->nn_lm_states[0].value;
+      c[i] = &hyp->nn_lm_states[1].value;
+    }
+
+    // states are of shape (num_layers, batch_size, hidden_size)
+    std::vector<Ort::Value> states;
+    states.reserve(2);
+    states.push_back(Cat(allocator_, h, 1));
+    states.push_back(Cat(allocator_, c, 1));
+
+    auto lm_out = ScoreToken(std::move(x), std::move(states));
+
+    auto next_scores = Unbind(allocator_, &lm_out.first, 0);
+    auto next_h = Unbind(allocator_, &lm_out.second[0], 1);
+    auto next_c = Unbind(allocator_, &lm_out.second[1], 1);
+
+    for (int32_t i = 0; i != batch_size; ++i) {
+      CacheEntry entry;
+      entry.scores.value = std::move(next_scores[i]);
+      entry.states.emplace_back(std::move(next_h[i]));
+      entry.states.emplace_back(std::move(next_c[i]));
+
+      for (Hypothesis *hyp : rows[i]) {
+        hyp->nn_lm_scores = entry.scores;
+        hyp->nn_lm_states = entry.states;
+      }
+
+      InsertCache(std::move(keys[i]), std::move(entry));
+    }
   }
 
   // classic rescore function
+  //
+  // Hyps of a stream often share the prefix to be scored, e.g., hyps
+  // that differ only in the last token. It is scored once and the result is
+  // copied to the other hyps.
   void ComputeLMScore(float scale, int32_t context_size,
                       std::vector<Hypotheses> *hyps) {
     Ort::AllocatorWithDefaultOptions allocator;
 
     for (auto &hyp : *hyps) {
+      std::unordered_map<std::string, const Hypothesis *> scored;
+
       for (auto &h_m : hyp) {
         auto &h = h_m.second;
         auto &ys = h.ys;
@@ -68,32 +157,47 @@ class OnlineRnnLM::Impl {
           continue;
         }
 
+        if (token_num_in_chunk < h.lm_rescore_min_chunk) {
+          continue;
+        }
+
+        // ys[:-1] is scored. cur_scored_pos is in the key since hyps with
+        // the same tokens may have scored different parts of them.
+        std::string key = CacheKey(ys, ys.size() - 1) + "/" +
+                          std::to_string(h.cur_scored_pos);
+        auto it = scored.find(key);
+        if (it != scored.end()) {
+          h.lm_log_prob = it->second->lm_log_prob;
+          h.nn_lm_states = it->second->nn_lm_states;
+          h.cur_scored_pos = it->second->cur_scored_pos;
+          continue;
+        }
+
         if (h.nn_lm_states.empty()) {
           h.nn_lm_states = Convert(GetInitStates());
         }
 
-        if (token_num_in_chunk >= h.lm_rescore_min_chunk) {
-          std::array<int64_t, 2> x_shape{1, token_num_in_chunk};
+        std::array<int64_t, 2> x_shape{1, token_num_in_chunk};
 
-          Ort::Value x = Ort::Value::CreateTensor<int64_t>(
-              allocator, x_shape.data(), x_shape.size());
-          int64_t *p_x = x.GetTensorMutableData<int64_t>();
-          std::copy(ys.begin() + context_size + h.cur_scored_pos, ys.end() - 1,
-                    p_x);
+        Ort::Value x = Ort::Value::CreateTensor<int64_t>(
+            allocator, x_shape.data(), x_shape.size());
+        int64_t *p_x = x.GetTensorMutableData<int64_t>();
+        std::copy(ys.begin() + context_size + h.cur_scored_pos, ys.end() - 1,
+                  p_x);
 
-          // streaming forward by NN LM
-          auto out =
-              ScoreToken(std::move(x), Convert(std::move(h.nn_lm_states)));
+        // streaming forward by NN LM
+        auto out = ScoreToken(std::move(x), Convert(std::move(h.nn_lm_states)));
 
-          // update NN LM score in hyp
-          const float *p_nll = out.first.GetTensorData<float>();
-          h.lm_log_prob = -scale * (*p_nll);
+        // update NN LM score in hyp
+        const float *p_nll = out.first.GetTensorData<float>();
+        h.lm_log_prob = -scale * (*p_nll);
 
-          // update NN LM states in hyp
-          h.nn_lm_states = Convert(std::move(out.second));
+        // update NN LM states in hyp
+        h.nn_lm_states = Convert(std::move(out.second));
 
-          h.cur_scored_pos += token_num_in_chunk;
-        }
+        h.cur_scored_pos += token_num_in_chunk;
+
+        scored[std::move(key)] = &h;
       }
     }
   }
@@ -138,11 +242,57 @@ class OnlineRnnLM::Impl {
   }
 
  private:
+  struct CacheEntry {
+    CopyableOrtValue scores;
+    std::vector<CopyableOrtValue> states;
+  };
+
+  // The first n tokens of ys as a string
+  static std::string CacheKey(const std::vector<int64_t> &ys, size_t n) {
+    return std::string(reinterpret_cast<const char *>(ys.data()),
+                       n * sizeof(int64_t));
+  }
+
+  static std::string CacheKey(const std::vector<int64_t> &ys) {
+    return CacheKey(ys, ys.size());
+  }
+
+  // If the scores and states after key are cached, copy them to hyp and
+  // return true.
+  bool LookupCache(const std::string &key, Hypothesis *hyp) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+      return false;
+    }
+
+    // move it to the front as the most recently used one
+    lru_.splice(lru_.begin(), lru_, it->second);
+
+    hyp->nn_lm_scores = it->second->second.scores;
+    hyp->nn_lm_states = it->second->second.states;
+    return true;
+  }
+
+  void InsertCache(std::string key, CacheEntry entry) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (cache_.count(key)) {
+      return;
+    }
+
+    lru_.emplace_front(std::move(key), std::move(entry));
+    cache_[lru_.front().first] = lru_.begin();
+
+    if (static_cast<int32_t>(lru_.size()) > kMaxCacheSize) {
+      cache_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+  }
+
   void Init(const OnlineLMConfig &config) {
     auto buf = ReadFile(config_.model);
 
-    sess_ = std::make_unique<Ort::Session>(env_, buf.data(), buf.size(),
-                                           sess_opts_);
+    sess_ = CreateSession(env_, buf.data(), buf.size(), sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -203,6 +353,19 @@ class OnlineRnnLM::Impl {
   int32_t rnn_num_layers_ = 2;
   int32_t rnn_hidden_size_ = 512;
   int32_t sos_id_ = 1;
+
+  // Scores and states of recently scored token sequences for shallow
+  // fusion, keyed by the token sequence. A hyp that emits a token it has
+  // already tried in a previous frame, which is common, hits the cache.
+  //
+  // Each entry holds one row of scores and states, i.e., a few KB for
+  // typical LMs.
+  static constexpr int32_t kMaxCacheSize = 1024;
+  std::list<std::pair<std::string, CacheEntry>> lru_;
+  std::unordered_map<std::string,
+                     std::list<std::pair<std::string, CacheEntry>>::iterator>
+      cache_;
+  std::mutex cache_mutex_;
 };
 
 OnlineRnnLM::OnlineRnnLM(const OnlineLMConfig &config)
@@ -236,4 +399,10 @@ void OnlineRnnLM::ComputeLMScoreSF(float scale, Hypothesis *hyp) {
   return impl_->ComputeLMScoreSF(scale, hyp);
 }
 
+// shallow fusion scores of a batch of hyps
+void OnlineRnnLM::ComputeLMScoresSF(float scale, Hypothesis **hyps,
+                                    int32_t n) {
+  return impl_->ComputeLMScoresSF(scale, hyps, n);
+}
+
 }  // namespace sherpa_onnx
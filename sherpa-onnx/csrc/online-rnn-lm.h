@@ -58,6 +58,9 @@ class OnlineRnnLM : public OnlineLM {
    */
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) override;
 
+  // Score all hyps with a single run of the model
+  void ComputeLMScoresSF(float scale, Hypothesis **hyps, int32_t n) override;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
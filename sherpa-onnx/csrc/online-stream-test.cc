@@ -0,0 +1,52 @@
+// sherpa-onnx/csrc/online-stream-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-stream.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(OnlineStream, RestoreFrameIndexes) {
+  FeatureExtractorConfig config;
+  config.enable_snapshots = true;
+
+  std::vector<float> samples(16000);
+  for (size_t i = 0; i != samples.size(); ++i) {
+    samples[i] = 0.5f * std::sin(i * 0.013f);
+  }
+
+  OnlineStream s(config);
+  s.AcceptWaveform(16000, samples.data(), samples.size());
+
+  // Frames before 8 are not needed any more
+  s.GetFrames(8, 8);
+
+  auto restore = [&s, &config](int32_t num_processed_frames) {
+    s.GetNumProcessedFrames() = num_processed_frames;
+    std::string snapshot = s.Serialize();
+    EXPECT_FALSE(snapshot.empty());
+
+    OnlineStream t(config);
+    return t.Deserialize(snapshot);
+  };
+
+  EXPECT_TRUE(restore(14));
+  EXPECT_TRUE(restore(8));
+  EXPECT_TRUE(restore(s.NumFramesReady()));
+
+  // Earlier frames are discarded
+  EXPECT_FALSE(restore(7));
+  EXPECT_FALSE(restore(-1));
+
+  // Later frames are not ready
+  EXPECT_FALSE(restore(s.NumFramesReady() + 1));
+}
+
+}  // namespace sherpa_onnx
@@ -3,15 +3,212 @@
 // Copyright (c)  2023  Xiaomi Corporation
 #include "sherpa-onnx/csrc/online-stream.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/binary-io.h"
+#include "sherpa-onnx/csrc/compact-tensors.h"
 #include "sherpa-onnx/csrc/features.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/transducer-keyword-decoder.h"
 
 namespace sherpa_onnx {
 
+namespace {
+
+// Increase it when the format of OnlineStream::Serialize() changes
+constexpr int32_t kSnapshotVersion = 1;
+constexpr uint32_t kSnapshotMagic = 0x534f5353;  // SOSS
+
+void WriteTensors(const std::vector<Ort::Value> &tensors, BinaryWriter *w) {
+  w->Write(static_cast<int32_t>(tensors.size()));
+  for (const auto &t : tensors) {
+    w->Write(t);
+  }
+}
+
+bool ReadTensors(BinaryReader *r, OrtAllocator *allocator,
+                 std::vector<Ort::Value> *tensors) {
+  int32_t n = 0;
+  if (!r->Read(&n) || n < 0) {
+    return false;
+  }
+
+  tensors->clear();
+  tensors->reserve(n);
+  for (int32_t i = 0; i != n; ++i) {
+    Ort::Value v{nullptr};
+    if (!r->Read(&v, allocator)) {
+      return false;
+    }
+    tensors->push_back(std::move(v));
+  }
+
+  return true;
+}
+
+// The state of a context graph is saved as its level, i.e., the number of
+// trailing tokens of ys that lead to it from the root.
+void WriteHypothesis(const Hypothesis &h, BinaryWriter *w) {
+  w->Write(h.ys);
+  w->Write(h.timestamps);
+  w->Write(h.ys_probs);
+  w->Write(h.lm_probs);
+  w->Write(h.context_scores);
+  w->Write(h.log_prob);
+  w->Write(h.lm_log_prob);
+  w->Write(h.nn_lm_scores.value);
+  w->Write(h.cur_scored_pos);
+
+  w->Write(static_cast<int32_t>(h.nn_lm_states.size()));
+  for (const auto &v : h.nn_lm_states) {
+    w->Write(v.value);
+  }
+
+  w->Write(h.ngram_lm_state);
+  w->Write(h.context_state ? h.context_state->level : -1);
+  w->Write(h.num_trailing_blanks);
+}
+
+bool ReadHypothesis(BinaryReader *r, OrtAllocator *allocator,
+                    const ContextGraph *context_graph, Hypothesis *h) {
+  int32_t num_nn_lm_states = 0;
+  if (!r->Read(&h->ys) || !r->Read(&h->timestamps) || !r->Read(&h->ys_probs) ||
+      !r->Read(&h->lm_probs) || !r->Read(&h->context_scores) ||
+      !r->Read(&h->log_prob) || !r->Read(&h->lm_log_prob) ||
+      !r->Read(&h->nn_lm_scores.value, allocator) ||
+      !r->Read(&h->cur_scored_pos) || !r->Read(&num_nn_lm_states) ||
+      num_nn_lm_states < 0) {
+    return false;
+  }
+
+  h->nn_lm_states.resize(num_nn_lm_states);
+  for (auto &v : h->nn_lm_states) {
+    if (!r->Read(&v.value, allocator)) {
+      return false;
+    }
+  }
+
+  int32_t level = -1;
+  if (!r->Read(&h->ngram_lm_state) || !r->Read(&level) ||
+      !r->Read(&h->num_trailing_blanks)) {
+    return false;
+  }
+
+  h->context_state = nullptr;
+  if (level < 0) {
+    return true;
+  }
+
+  if (!context_graph || level > static_cast<int32_t>(h->ys.size())) {
+    SHERPA_ONNX_LOGE(
+        "The snapshot uses a context graph. Please create the stream with "
+        "the same hotwords");
+    return false;
+  }
+
+  const ContextState *state = context_graph->Root();
+  for (auto it = h->ys.end() - level; it != h->ys.end(); ++it) {
+    state = std::get<1>(context_graph->ForwardOneStep(state, *it, false));
+  }
+  h->context_state = state;
+
+  return true;
+}
+
+void WriteResult(const OnlineTransducerDecoderResult &r, BinaryWriter *w) {
+  w->Write(r.frame_offset);
+  w->Write(r.tokens);
+  w->Write(r.num_trailing_blanks);
+  w->Write(r.timestamps);
+  w->Write(r.ys_probs);
+  w->Write(r.lm_probs);
+  w->Write(r.context_scores);
+  w->Write(r.decoder_out);
+
+  w->Write(r.hyps.Size());
+  for (const auto &p : r.hyps) {
+    WriteHypothesis(p.second, w);
+  }
+}
+
+bool ReadResult(BinaryReader *r, OrtAllocator *allocator,
+                const ContextGraph *context_graph,
+                OnlineTransducerDecoderResult *result) {
+  int32_t num_hyps = 0;
+  if (!r->Read(&result->frame_offset) || !r->Read(&result->tokens) ||
+      !r->Read(&result->num_trailing_blanks) || !r->Read(&result->timestamps) ||
+      !r->Read(&result->ys_probs) || !r->Read(&result->lm_probs) ||
+      !r->Read(&result->context_scores) ||
+      !r->Read(&result->decoder_out, allocator) || !r->Read(&num_hyps) ||
+      num_hyps < 0) {
+    return false;
+  }
+
+  std::vector<Hypothesis> hyps(num_hyps);
+  for (auto &h : hyps) {
+    if (!ReadHypothesis(r, allocator, context_graph, &h)) {
+      return false;
+    }
+  }
+  result->hyps = Hypotheses(std::move(hyps));
+
+  return true;
+}
+
+void WriteResult(const OnlineCtcDecoderResult &r, BinaryWriter *w) {
+  w->Write(r.frame_offset);
+  w->Write(r.tokens);
+  w->Write(r.words);
+  w->Write(r.timestamps);
+  w->Write(r.num_trailing_blanks);
+}
+
+bool ReadResult(BinaryReader *r, OnlineCtcDecoderResult *result) {
+  return r->Read(&result->frame_offset) && r->Read(&result->tokens) &&
+         r->Read(&result->words) && r->Read(&result->timestamps) &&
+         r->Read(&result->num_trailing_blanks);
+}
+
+void WriteResult(const OnlineParaformerDecoderResult &r, BinaryWriter *w) {
+  w->Write(r.tokens);
+  w->Write(r.last_non_blank_frame_index);
+}
+
+bool ReadResult(BinaryReader *r, OnlineParaformerDecoderResult *result) {
+  return r->Read(&result->tokens) &&
+         r->Read(&result->last_non_blank_frame_index);
+}
+
+// Return true if both lists have tensors of the same shapes
+bool SameShapes(const std::vector<Ort::Value> &a,
+                const std::vector<Ort::Value> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i != a.size(); ++i) {
+    if (static_cast<bool>(a[i]) != static_cast<bool>(b[i])) {
+      return false;
+    }
+
+    if (a[i] && a[i].GetTensorTypeAndShapeInfo().GetShape() !=
+                    b[i].GetTensorTypeAndShapeInfo().GetShape()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
 class OnlineStream::Impl {
  public:
   explicit Impl(const FeatureExtractorConfig &config,
@@ -40,6 +237,10 @@ class OnlineStream::Impl {
     // we don't reset the feature extractor
     start_frame_index_ += num_processed_frames_;
     num_processed_frames_ = 0;
+
+    // The next segment starts with an empty result, so its first delta
+    // must not refer to the text of the previous segment
+    result_cache_.Clear();
   }
 
   int32_t &GetNumProcessedFrames() { return num_processed_frames_; }
@@ -86,31 +287,44 @@ class OnlineStream::Impl {
   int32_t FeatureDim() const { return feat_extractor_.FeatureDim(); }
 
   void SetStates(std::vector<Ort::Value> states) {
+    Restore();
     states_ = std::move(states);
   }
 
-  std::vector<Ort::Value> &GetStates() { return states_; }
+  std::vector<Ort::Value> &GetStates() {
+    Restore();
+    return states_;
+  }
 
   void SetNeMoDecoderStates(std::vector<Ort::Value> decoder_states) {
+    Restore();
     decoder_states_ = std::move(decoder_states);
   }
 
-  std::vector<Ort::Value> &GetNeMoDecoderStates() { return decoder_states_; }
+  std::vector<Ort::Value> &GetNeMoDecoderStates() {
+    Restore();
+    return decoder_states_;
+  }
 
   const ContextGraphPtr &GetContextGraph() const { return context_graph_; }
 
   std::vector<float> &GetParaformerFeatCache() {
+    Restore();
     return paraformer_feat_cache_;
   }
 
   std::vector<float> &GetParaformerEncoderOutCache() {
+    Restore();
     return paraformer_encoder_out_cache_;
   }
 
   std::vector<float> &GetParaformerAlphaCache() {
+    Restore();
     return paraformer_alpha_cache_;
   }
 
+  OnlineResultCache &GetResultCache() { return result_cache_; }
+
   void SetFasterDecoder(std::unique_ptr<kaldi_decoder::FasterDecoder> decoder) {
     faster_decoder_ = std::move(decoder);
   }
@@ -123,6 +337,217 @@ class OnlineStream::Impl {
     return faster_decoder_processed_frames_;
   }
 
+  void CompactStates(bool fp16, const std::string &spill_dir) {
+    if (compact_states_) {
+      return;
+    }
+
+    // The paraformer caches are put after the model states as 1-d tensors
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::vector<Ort::Value> tensors;
+    tensors.reserve(states_.size() + decoder_states_.size() + 3);
+    for (auto &v : states_) {
+      tensors.push_back(View(&v));
+    }
+
+    for (auto &v : decoder_states_) {
+      tensors.push_back(View(&v));
+    }
+
+    // onnxruntime does not accept a null pointer even if the size is 0
+    float dummy = 0;
+    for (auto *cache : ParaformerCaches()) {
+      std::array<int64_t, 1> shape{static_cast<int64_t>(cache->size())};
+      float *p = cache->empty() ? &dummy : cache->data();
+      tensors.push_back(Ort::Value::CreateTensor(
+          memory_info, p, cache->size(), shape.data(), shape.size()));
+    }
+
+    compact_states_ =
+        std::make_unique<CompactTensors>(tensors, fp16, spill_dir);
+    num_compact_states_ = states_.size();
+    num_compact_decoder_states_ = decoder_states_.size();
+
+    tensors.clear();
+    states_.clear();
+    decoder_states_.clear();
+    for (auto *cache : ParaformerCaches()) {
+      std::vector<float>().swap(*cache);
+    }
+  }
+
+  bool IsCompacted() const { return compact_states_ != nullptr; }
+
+  std::string Serialize() {
+    if (faster_decoder_) {
+      SHERPA_ONNX_LOGE(
+          "Streams decoded with an FST graph cannot be serialized");
+      return {};
+    }
+
+    Restore();
+
+    BinaryWriter w;
+    w.Write(kSnapshotMagic);
+    w.Write(kSnapshotVersion);
+
+    if (!feat_extractor_.Serialize(&w)) {
+      return {};
+    }
+
+    w.Write(num_processed_frames_);
+    w.Write(start_frame_index_);
+    w.Write(segment_);
+
+    WriteTensors(states_, &w);
+    WriteTensors(decoder_states_, &w);
+
+    WriteResult(result_, &w);
+    WriteResult(ctc_result_, &w);
+    WriteResult(paraformer_result_, &w);
+
+    w.Write(paraformer_feat_cache_);
+    w.Write(paraformer_encoder_out_cache_);
+    w.Write(paraformer_alpha_cache_);
+
+    return std::move(w.Data());
+  }
+
+  bool Deserialize(const char *data, size_t size) {
+    Restore();
+
+    BinaryReader r(data, size);
+
+    uint32_t magic = 0;
+    int32_t version = 0;
+    if (!r.Read(&magic) || magic != kSnapshotMagic || !r.Read(&version)) {
+      SHERPA_ONNX_LOGE("Not a snapshot of an OnlineStream");
+      return false;
+    }
+
+    if (version != kSnapshotVersion) {
+      SHERPA_ONNX_LOGE("Unsupported snapshot version %d. Expected: %d",
+                       version, kSnapshotVersion);
+      return false;
+    }
+
+    if (!feat_extractor_.Deserialize(&r)) {
+      return false;
+    }
+
+    Ort::AllocatorWithDefaultOptions allocator;
+
+    std::vector<Ort::Value> states;
+    std::vector<Ort::Value> decoder_states;
+    int32_t num_processed_frames = 0;
+    int32_t start_frame_index = 0;
+    if (!r.Read(&num_processed_frames) || !r.Read(&start_frame_index) ||
+        !r.Read(&segment_) || !ReadTensors(&r, allocator, &states) ||
+        !ReadTensors(&r, allocator, &decoder_states)) {
+      SHERPA_ONNX_LOGE("Corrupted snapshot");
+      return false;
+    }
+
+    // The next frame to decode must not have been discarded by the
+    // feature extractor and must not be after the last ready frame
+    int64_t next_frame =
+        static_cast<int64_t>(start_frame_index) + num_processed_frames;
+    if (num_processed_frames < 0 || start_frame_index < 0 ||
+        next_frame < feat_extractor_.FirstAvailableFrame() ||
+        next_frame > feat_extractor_.NumFramesReady()) {
+      SHERPA_ONNX_LOGE("Invalid frame indexes in the snapshot");
+      return false;
+    }
+
+    num_processed_frames_ = num_processed_frames;
+    start_frame_index_ = start_frame_index;
+
+    // The recognizer sets the initial states of a new stream. They
+    // must match the saved states if the snapshot is from the same model.
+    if ((!states_.empty() && !SameShapes(states_, states)) ||
+        (!decoder_states_.empty() &&
+         !SameShapes(decoder_states_, decoder_states))) {
+      SHERPA_ONNX_LOGE("The snapshot is from a different model");
+      return false;
+    }
+
+    states_ = std::move(states);
+    decoder_states_ = std::move(decoder_states);
+
+    if (!ReadResult(&r, allocator, context_graph_.get(), &result_) ||
+        !ReadResult(&r, &ctc_result_) || !ReadResult(&r, &paraformer_result_) ||
+        !r.Read(&paraformer_feat_cache_) ||
+        !r.Read(&paraformer_encoder_out_cache_) ||
+        !r.Read(&paraformer_alpha_cache_) || r.Remaining() != 0) {
+      SHERPA_ONNX_LOGE("Corrupted snapshot");
+      return false;
+    }
+
+    return true;
+  }
+
+  int64_t StatesBytes() const {
+    if (compact_states_) {
+      return compact_states_->NumBytes();
+    }
+
+    int64_t ans = NumBytes(states_) + NumBytes(decoder_states_);
+    ans += (paraformer_feat_cache_.size() +
+            paraformer_encoder_out_cache_.size() +
+            paraformer_alpha_cache_.size()) *
+           sizeof(float);
+    return ans;
+  }
+
+ private:
+  std::array<std::vector<float> *, 3> ParaformerCaches() {
+    return {&paraformer_feat_cache_, &paraformer_encoder_out_cache_,
+            &paraformer_alpha_cache_};
+  }
+
+  // Undo CompactStates()
+  void Restore() {
+    if (!compact_states_) {
+      return;
+    }
+
+    Ort::AllocatorWithDefaultOptions allocator;
+
+    int32_t k = 0;
+    states_.reserve(num_compact_states_);
+    for (int32_t i = 0; i != num_compact_states_; ++i, ++k) {
+      states_.push_back(compact_states_->Get(k, allocator));
+    }
+
+    decoder_states_.reserve(num_compact_decoder_states_);
+    for (int32_t i = 0; i != num_compact_decoder_states_; ++i, ++k) {
+      decoder_states_.push_back(compact_states_->Get(k, allocator));
+    }
+
+    for (auto *cache : ParaformerCaches()) {
+      Ort::Value v = compact_states_->Get(k++, allocator);
+      const float *p = v.GetTensorData<float>();
+      cache->assign(p, p + v.GetTensorTypeAndShapeInfo().GetElementCount());
+    }
+
+    compact_states_.reset();
+  }
+
+  static int64_t NumBytes(const std::vector<Ort::Value> &tensors) {
+    int64_t ans = 0;
+    for (const auto &t : tensors) {
+      auto type_and_shape = t.GetTensorTypeAndShapeInfo();
+      int64_t element_size = type_and_shape.GetElementType() ==
+                                     ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64
+                                 ? 8
+                                 : 4;
+      ans += type_and_shape.GetElementCount() * element_size;
+    }
+    return ans;
+  }
+
  private:
   FeatureExtractor feat_extractor_;
   /// For contextual-biasing
@@ -143,6 +568,14 @@ class OnlineStream::Impl {
   OnlineParaformerDecoderResult paraformer_result_;
   std::unique_ptr<kaldi_decoder::FasterDecoder> faster_decoder_;
   int32_t faster_decoder_processed_frames_ = 0;
+
+  // It is not saved by Serialize() and is rebuilt on demand
+  OnlineResultCache result_cache_;
+
+  // Non-null if the states above are compacted
+  std::unique_ptr<CompactTensors> compact_states_;
+  int32_t num_compact_states_ = 0;
+  int32_t num_compact_decoder_states_ = 0;
 };
 
 OnlineStream::OnlineStream(const FeatureExtractorConfig &config /*= {}*/,
@@ -264,4 +697,27 @@ std::vector<float> &OnlineStream::GetParaformerAlphaCache() {
   return impl_->GetParaformerAlphaCache();
 }
 
+OnlineResultCache &OnlineStream::GetResultCache() {
+  return impl_->GetResultCache();
+}
+
+void OnlineStream::CompactStates(bool fp16,
+                                 const std::string &spill_dir /*= ""*/) {
+  impl_->CompactStates(fp16, spill_dir);
+}
+
+bool OnlineStream::IsCompacted() const { return impl_->IsCompacted(); }
+
+int64_t OnlineStream::StatesBytes() const { return impl_->StatesBytes(); }
+
+std::string OnlineStream::Serialize() const { return impl_->Serialize(); }
+
+bool OnlineStream::Deserialize(const char *data, size_t size) {
+  return impl_->Deserialize(data, size);
+}
+
+bool OnlineStream::Deserialize(const std::string &data) {
+  return impl_->Deserialize(data.data(), data.size());
+}
+
 }  // namespace sherpa_onnx
@@ -5,7 +5,9 @@
 #ifndef SHERPA_ONNX_CSRC_ONLINE_STREAM_H_
 #define SHERPA_ONNX_CSRC_ONLINE_STREAM_H_
 
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "kaldi-decoder/csrc/faster-decoder.h"
@@ -14,6 +16,7 @@
 #include "sherpa-onnx/csrc/features.h"
 #include "sherpa-onnx/csrc/online-ctc-decoder.h"
 #include "sherpa-onnx/csrc/online-paraformer-decoder.h"
+#include "sherpa-onnx/csrc/online-result-cache.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 
 namespace sherpa_onnx {
@@ -61,6 +64,7 @@ class OnlineStream {
    */
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const;
 
+  // Start a new segment. It also clears the result cache
   void Reset();
 
   int32_t FeatureDim() const;
@@ -111,6 +115,56 @@ class OnlineStream {
   std::vector<float> &GetParaformerEncoderOutCache();
   std::vector<float> &GetParaformerAlphaCache();
 
+  // Used by the recognizer to build partial results incrementally
+  OnlineResultCache &GetResultCache();
+
+  /** Compact the model states, e.g., the encoder caches, of an idle stream
+   * to reduce its memory footprint.
+   *
+   * The states are restored automatically the next time they are accessed,
+   * e.g., by GetStates() in DecodeStreams(), so callers don't need to do
+   * anything else.
+   *
+   * @param fp16  True to store float states in half precision. It is
+   *              lossy.
+   * @param spill_dir  If not empty, the states are spilled to a
+   *                   memory-mapped file in this directory.
+   */
+  void CompactStates(bool fp16, const std::string &spill_dir = "");
+
+  // True if CompactStates() has been called and the states have not been
+  // restored yet.
+  bool IsCompacted() const;
+
+  // Number of bytes the model states occupy in memory.
+  int64_t StatesBytes() const;
+
+  /** Save the decoding state of this stream so that decoding can continue
+   * in another stream, e.g., in another process, with Deserialize().
+   *
+   * The snapshot contains the model states, the decoding result, the
+   * features and samples that are not consumed yet, and the counters of
+   * this stream. It has a version number and is in the native byte order.
+   *
+   * The stream must be created with feat_config.enable_snapshots.
+   *
+   * @return Return an empty string on error, e.g., for streams that are
+   *         decoded with an FST graph.
+   */
+  std::string Serialize() const;
+
+  /** Restore a snapshot from Serialize().
+   *
+   * It must be called on a stream that is newly created by a recognizer
+   * with the same config, and with the same hotwords if any, before it
+   * accepts any waveform.
+   *
+   * @return Return false if the snapshot is invalid. The stream should not
+   *         be used in that case.
+   */
+  bool Deserialize(const char *data, size_t size);
+  bool Deserialize(const std::string &data);
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
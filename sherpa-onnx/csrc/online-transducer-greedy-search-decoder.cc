@@ -5,14 +5,39 @@
 #include "sherpa-onnx/csrc/online-transducer-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace sherpa_onnx {
 
+// Like OnlineTransducerModel::RunJoinerWithMetrics(), but for frame t of all
+// streams. Projections are computed by the caller.
+//
+// @param encoder_proj  A 3-d array of shape (N, T, joiner_dim)
+// @param decoder_proj  A 2-d array of shape (N, joiner_dim)
+// @param logit  On return, it is a 2-d array of shape (N, vocab_size)
+static void RunNativeJoiner(const NativeJoiner &joiner,
+                            const float *encoder_proj,
+                            const float *decoder_proj, int32_t batch_size,
+                            int32_t num_frames, int32_t t, float *logit) {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_joiner_seconds",
+                             "Time to run the joiner model");
+  SHERPA_ONNX_TRACE_SCOPE("NativeJoiner::Run");
+
+  int32_t joiner_dim = joiner.JoinerDim();
+  int32_t vocab_size = joiner.VocabSize();
+  for (int32_t i = 0; i != batch_size; ++i) {
+    joiner.Run(encoder_proj + (i * num_frames + t) * joiner_dim,
+               decoder_proj + i * joiner_dim, logit + i * vocab_size);
+  }
+}
+
 static void UseCachedDecoderOut(
     const std::vector<OnlineTransducerDecoderResult> &results,
     Ort::Value *decoder_out) {
@@ -50,6 +75,28 @@ static void UpdateCachedDecoderOut(
   }
 }
 
+// Like OnlineTransducerModel::BuildDecoderInput(), but only for the given
+// rows of results
+static Ort::Value BuildDecoderInput(
+    OnlineTransducerModel *model,
+    const std::vector<OnlineTransducerDecoderResult> &results,
+    const std::vector<int32_t> &rows) {
+  int32_t context_size = model->ContextSize();
+  std::array<int64_t, 2> shape{static_cast<int64_t>(rows.size()),
+                               context_size};
+  Ort::Value decoder_input = Ort::Value::CreateTensor<int64_t>(
+      model->Allocator(), shape.data(), shape.size());
+  int64_t *p = decoder_input.GetTensorMutableData<int64_t>();
+
+  for (auto i : rows) {
+    const auto &tokens = results[i].tokens;
+    std::copy(tokens.end() - context_size, tokens.end(), p);
+    p += context_size;
+  }
+
+  return decoder_input;
+}
+
 OnlineTransducerDecoderResult
 OnlineTransducerGreedySearchDecoder::GetEmptyResult() const {
   int32_t context_size = model_->ContextSize();
@@ -109,18 +156,61 @@ void OnlineTransducerGreedySearchDecoder::Decode(
     UseCachedDecoderOut(*result, &decoder_out);
   } else {
     Ort::Value decoder_input = model_->BuildDecoderInput(*result);
-    decoder_out = model_->RunDecoder(std::move(decoder_input));
+    decoder_out = model_->RunDecoderWithMetrics(std::move(decoder_input));
+  }
+
+  // Use onnxruntime if the native joiner does not match the models
+  const NativeJoiner *native_joiner = model_->GetNativeJoiner();
+  if (native_joiner &&
+      (native_joiner->EncoderDim() != encoder_out_shape[2] ||
+       native_joiner->DecoderDim() !=
+           decoder_out.GetTensorTypeAndShapeInfo().GetShape().back() ||
+       native_joiner->VocabSize() != vocab_size)) {
+    native_joiner = nullptr;
+  }
+
+  // With the native joiner, the encoder output is projected once per chunk
+  // and the decoder output once per emission. The buffers are reused for
+  // all frames.
+  std::vector<float> encoder_proj;
+  std::vector<float> decoder_proj;
+  std::vector<float> native_logit;
+  if (native_joiner) {
+    int32_t joiner_dim = native_joiner->JoinerDim();
+    encoder_proj.resize(batch_size * num_frames * joiner_dim);
+    native_joiner->ProjectEncoder(encoder_out.GetTensorData<float>(),
+                                  batch_size * num_frames,
+                                  encoder_proj.data());
+
+    decoder_proj.resize(batch_size * joiner_dim);
+    native_joiner->ProjectDecoder(decoder_out.GetTensorData<float>(),
+                                  batch_size, decoder_proj.data());
+
+    native_logit.resize(batch_size * vocab_size);
   }
 
+  // Streams that have emitted a token in the current frame
+  std::vector<int32_t> emitted_rows;
+  emitted_rows.reserve(batch_size);
+
   for (int32_t t = 0; t != num_frames; ++t) {
-    Ort::Value cur_encoder_out =
-        GetEncoderOutFrame(model_->Allocator(), &encoder_out, t);
-    Ort::Value logit =
-        model_->RunJoiner(std::move(cur_encoder_out), View(&decoder_out));
+    Ort::Value logit{nullptr};
+    float *p_logit = nullptr;
 
-    float *p_logit = logit.GetTensorMutableData<float>();
+    if (native_joiner) {
+      RunNativeJoiner(*native_joiner, encoder_proj.data(),
+                      decoder_proj.data(), batch_size, num_frames, t,
+                      native_logit.data());
+      p_logit = native_logit.data();
+    } else {
+      Ort::Value cur_encoder_out =
+          GetEncoderOutFrame(model_->Allocator(), &encoder_out, t);
+      logit = model_->RunJoinerWithMetrics(std::move(cur_encoder_out),
+                                           View(&decoder_out));
+      p_logit = logit.GetTensorMutableData<float>();
+    }
 
-    bool emitted = false;
+    emitted_rows.clear();
     for (int32_t i = 0; i < batch_size; ++i, p_logit += vocab_size) {
       auto &r = (*result)[i];
       if (blank_penalty_ > 0.0) {
@@ -134,7 +224,7 @@ void OnlineTransducerGreedySearchDecoder::Decode(
       // blank id is hardcoded to 0
       // also, it treats unk as blank
       if (y != 0 && y != unk_id_) {
-        emitted = true;
+        emitted_rows.push_back(i);
         r.tokens.push_back(y);
         r.timestamps.push_back(t + r.frame_offset);
         r.num_trailing_blanks = 0;
@@ -157,9 +247,33 @@ void OnlineTransducerGreedySearchDecoder::Decode(
         r.ys_probs.push_back(p_logprob[y]);
       }
     }
-    if (emitted) {
+    if (static_cast<int32_t>(emitted_rows.size()) == batch_size) {
       Ort::Value decoder_input = model_->BuildDecoderInput(*result);
-      decoder_out = model_->RunDecoder(std::move(decoder_input));
+      decoder_out = model_->RunDecoderWithMetrics(std::move(decoder_input));
+
+      if (native_joiner) {
+        native_joiner->ProjectDecoder(decoder_out.GetTensorData<float>(),
+                                      batch_size, decoder_proj.data());
+      }
+    } else if (!emitted_rows.empty()) {
+      // Only streams that have emitted a token need a new decoder output.
+      // With large batches, that is usually a small fraction of them.
+      Ort::Value decoder_input =
+          BuildDecoderInput(model_, *result, emitted_rows);
+      Ort::Value new_decoder_out =
+          model_->RunDecoderWithMetrics(std::move(decoder_input));
+      ScatterRows(&new_decoder_out, emitted_rows, &decoder_out);
+
+      if (native_joiner) {
+        int32_t joiner_dim = native_joiner->JoinerDim();
+        int32_t decoder_dim = native_joiner->DecoderDim();
+        const float *p = new_decoder_out.GetTensorData<float>();
+        for (auto i : emitted_rows) {
+          native_joiner->ProjectDecoder(p, 1,
+                                        decoder_proj.data() + i * joiner_dim);
+          p += decoder_dim;
+        }
+      }
     }
   }
 
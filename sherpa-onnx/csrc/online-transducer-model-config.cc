@@ -14,6 +14,10 @@ void OnlineTransducerModelConfig::Register(ParseOptions *po) {
   po->Register("encoder", &encoder, "Path to encoder.onnx");
   po->Register("decoder", &decoder, "Path to decoder.onnx");
   po->Register("joiner", &joiner, "Path to joiner.onnx");
+  po->Register("native-joiner", &native_joiner,
+               "True to run the joiner with built-in SIMD kernels instead of "
+               "onnxruntime. It falls back to onnxruntime if joiner.onnx is "
+               "not a float model of the form linear(tanh(a + b))");
 }
 
 bool OnlineTransducerModelConfig::Validate() const {
@@ -43,7 +47,8 @@ std::string OnlineTransducerModelConfig::ToString() const {
   os << "OnlineTransducerModelConfig(";
   os << "encoder=\"" << encoder << "\", ";
   os << "decoder=\"" << decoder << "\", ";
-  os << "joiner=\"" << joiner << "\")";
+  os << "joiner=\"" << joiner << "\", ";
+  os << "native_joiner=" << (native_joiner ? "True" : "False") << ")";
 
   return os.str();
 }
@@ -15,6 +15,10 @@ struct OnlineTransducerModelConfig {
   std::string decoder;
   std::string joiner;
 
+  // True to run the joiner without onnxruntime if the joiner model is
+  // supported. See native-joiner.h
+  bool native_joiner = false;
+
   OnlineTransducerModelConfig() = default;
   OnlineTransducerModelConfig(const std::string &encoder,
                               const std::string &decoder,
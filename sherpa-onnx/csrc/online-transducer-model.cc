@@ -17,15 +17,19 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/online-conformer-transducer-model.h"
 #include "sherpa-onnx/csrc/online-ebranchformer-transducer-model.h"
 #include "sherpa-onnx/csrc/online-lstm-transducer-model.h"
 #include "sherpa-onnx/csrc/online-zipformer-transducer-model.h"
 #include "sherpa-onnx/csrc/online-zipformer2-transducer-model.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace {
 
@@ -49,8 +53,7 @@ static ModelType GetModelType(char *model_data, size_t model_data_length,
   sess_opts.SetIntraOpNumThreads(1);
   sess_opts.SetInterOpNumThreads(1);
 
-  auto sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
-                                             sess_opts);
+  auto sess = CreateSession(env, model_data, model_data_length, sess_opts);
 
   Ort::ModelMetadata meta_data = sess->GetModelMetadata();
   if (debug) {
@@ -138,6 +141,26 @@ std::unique_ptr<OnlineTransducerModel> OnlineTransducerModel::Create(
   return nullptr;
 }
 
+Ort::Value OnlineTransducerModel::RunDecoderWithMetrics(
+    Ort::Value decoder_input) {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_decoder_seconds",
+                             "Time to run the decoder model");
+  SHERPA_ONNX_TRACE_SCOPE("OnlineTransducerModel::RunDecoder");
+  SHERPA_ONNX_COUNTER_INC(
+      "sherpa_onnx_online_decoder_rows_total",
+      "Number of hypotheses the decoder model has been run on",
+      decoder_input.GetTensorTypeAndShapeInfo().GetShape()[0]);
+  return RunDecoder(std::move(decoder_input));
+}
+
+Ort::Value OnlineTransducerModel::RunJoinerWithMetrics(Ort::Value encoder_out,
+                                                       Ort::Value decoder_out) {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_joiner_seconds",
+                             "Time to run the joiner model");
+  SHERPA_ONNX_TRACE_SCOPE("OnlineTransducerModel::RunJoiner");
+  return RunJoiner(std::move(encoder_out), std::move(decoder_out));
+}
+
 Ort::Value OnlineTransducerModel::BuildDecoderInput(
     const std::vector<OnlineTransducerDecoderResult> &results) {
   int32_t batch_size = static_cast<int32_t>(results.size());
@@ -172,6 +195,23 @@ Ort::Value OnlineTransducerModel::BuildDecoderInput(
   return decoder_input;
 }
 
+void OnlineTransducerModel::InitNativeJoiner(void *model_data,
+                                             size_t model_data_length,
+                                             const OnlineModelConfig &config) {
+  if (!config.transducer.native_joiner) {
+    return;
+  }
+
+  native_joiner_ =
+      NativeJoiner::Create(model_data, model_data_length, config.debug);
+
+  if (!native_joiner_) {
+    SHERPA_ONNX_LOGE(
+        "The joiner model is not supported by --native-joiner. Use "
+        "onnxruntime for it");
+  }
+}
+
 template <typename Manager>
 std::unique_ptr<OnlineTransducerModel> OnlineTransducerModel::Create(
     Manager *mgr, const OnlineModelConfig &config) {
@@ -10,6 +10,7 @@
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/hypothesis.h"
+#include "sherpa-onnx/csrc/native-joiner.h"
 #include "sherpa-onnx/csrc/online-model-config.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/online-transducer-model-config.h"
@@ -105,6 +106,13 @@ class OnlineTransducerModel {
   virtual Ort::Value RunJoiner(Ort::Value encoder_out,
                                Ort::Value decoder_out) = 0;
 
+  /** The same as RunDecoder() and RunJoiner() but they also record the
+   * time spent in the model in metrics and traces. Decoders use them.
+   */
+  Ort::Value RunDecoderWithMetrics(Ort::Value decoder_input);
+  Ort::Value RunJoinerWithMetrics(Ort::Value encoder_out,
+                                  Ort::Value decoder_out);
+
   /** If we are using a stateless decoder and if it contains a
    *  Conv1D, this function returns the kernel size of the convolution layer.
    */
@@ -138,6 +146,21 @@ class OnlineTransducerModel {
       const std::vector<OnlineTransducerDecoderResult> &results);
 
   Ort::Value BuildDecoderInput(const std::vector<Hypothesis> &hyps);
+
+  /** Return the joiner that runs without onnxruntime.
+   *
+   * It is nullptr if --native-joiner is not given or if the joiner
+   * model is not supported by it. Decoders use RunJoiner() in that case.
+   */
+  const NativeJoiner *GetNativeJoiner() const { return native_joiner_.get(); }
+
+ protected:
+  // Subclasses call it with the content of joiner.onnx
+  void InitNativeJoiner(void *model_data, size_t model_data_length,
+                        const OnlineModelConfig &config);
+
+ private:
+  std::unique_ptr<NativeJoiner> native_joiner_;
 };
 
 }  // namespace sherpa_onnx
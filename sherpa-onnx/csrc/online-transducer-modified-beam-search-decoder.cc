@@ -10,10 +10,47 @@
 #include <vector>
 
 #include "sherpa-onnx/csrc/log.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace sherpa_onnx {
 
+// Like OnlineTransducerModel::RunJoinerWithMetrics(), but for frame t of all
+// hypotheses. Hypotheses hyps_row_splits[b] to hyps_row_splits[b+1] - 1
+// belong to stream b.
+//
+// @param encoder_proj  A 3-d array of shape (N, T, joiner_dim)
+// @param decoder_out  A 2-d array of shape (num_hyps, decoder_dim)
+// @param decoder_proj  A buffer for the projected decoder_out
+// @param logit  On return, it is a 2-d array of shape (num_hyps, vocab_size)
+static void RunNativeJoiner(const NativeJoiner &joiner,
+                            const float *encoder_proj,
+                            const float *decoder_out,
+                            const std::vector<int32_t> &hyps_row_splits,
+                            int32_t num_frames, int32_t t,
+                            std::vector<float> *decoder_proj, float *logit) {
+  SHERPA_ONNX_SCOPED_LATENCY("sherpa_onnx_online_joiner_seconds",
+                             "Time to run the joiner model");
+  SHERPA_ONNX_TRACE_SCOPE("NativeJoiner::Run");
+
+  int32_t joiner_dim = joiner.JoinerDim();
+  int32_t vocab_size = joiner.VocabSize();
+  int32_t num_hyps = hyps_row_splits.back();
+
+  decoder_proj->resize(num_hyps * joiner_dim);
+  joiner.ProjectDecoder(decoder_out, num_hyps, decoder_proj->data());
+
+  int32_t batch_size = static_cast<int32_t>(hyps_row_splits.size()) - 1;
+  for (int32_t b = 0; b != batch_size; ++b) {
+    const float *e = encoder_proj + (b * num_frames + t) * joiner_dim;
+    for (int32_t i = hyps_row_splits[b]; i != hyps_row_splits[b + 1]; ++i) {
+      joiner.Run(e, decoder_proj->data() + i * joiner_dim,
+                 logit + i * vocab_size);
+    }
+  }
+}
+
 static void UseCachedDecoderOut(
     const std::vector<int32_t> &hyps_row_splits,
     const std::vector<OnlineTransducerDecoderResult> &results,
@@ -77,6 +114,7 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
 void OnlineTransducerModifiedBeamSearchDecoder::Decode(
     Ort::Value encoder_out, OnlineStream **ss,
     std::vector<OnlineTransducerDecoderResult> *result) {
+  SHERPA_ONNX_TRACE_SCOPE("OnlineTransducerModifiedBeamSearchDecoder::Decode");
   std::vector<int64_t> encoder_out_shape =
       encoder_out.GetTensorTypeAndShapeInfo().GetShape();
 
@@ -94,6 +132,19 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
   int32_t num_frames = static_cast<int32_t>(encoder_out_shape[1]);
   int32_t vocab_size = model_->VocabSize();
 
+  // The decoder dim is checked against the first decoder_out below
+  const NativeJoiner *native_joiner = model_->GetNativeJoiner();
+  if (native_joiner && (native_joiner->EncoderDim() != encoder_out_shape[2] ||
+                        native_joiner->VocabSize() != vocab_size)) {
+    native_joiner = nullptr;
+  }
+
+  // With the native joiner, the encoder output is projected once per chunk.
+  // The buffers are reused for all frames.
+  std::vector<float> encoder_proj;
+  std::vector<float> decoder_proj;
+  std::vector<float> native_logit;
+
   std::vector<Hypotheses> cur;
   for (auto &r : *result) {
     cur.push_back(std::move(r.hyps));
@@ -116,19 +167,45 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
     cur.reserve(batch_size);
 
     Ort::Value decoder_input = model_->BuildDecoderInput(prev);
-    Ort::Value decoder_out = model_->RunDecoder(std::move(decoder_input));
+    Ort::Value decoder_out =
+        model_->RunDecoderWithMetrics(std::move(decoder_input));
     if (t == 0) {
       UseCachedDecoderOut(hyps_row_splits, *result, &decoder_out);
-    }
 
-    Ort::Value cur_encoder_out =
-        GetEncoderOutFrame(model_->Allocator(), &encoder_out, t);
-    cur_encoder_out =
-        Repeat(model_->Allocator(), &cur_encoder_out, hyps_row_splits);
-    Ort::Value logit =
-        model_->RunJoiner(std::move(cur_encoder_out), View(&decoder_out));
+      // Use onnxruntime if the native joiner does not match the decoder
+      if (native_joiner &&
+          native_joiner->DecoderDim() !=
+              decoder_out.GetTensorTypeAndShapeInfo().GetShape().back()) {
+        native_joiner = nullptr;
+      }
 
-    float *p_logit = logit.GetTensorMutableData<float>();
+      if (native_joiner) {
+        encoder_proj.resize(batch_size * num_frames *
+                            native_joiner->JoinerDim());
+        native_joiner->ProjectEncoder(encoder_out.GetTensorData<float>(),
+                                      batch_size * num_frames,
+                                      encoder_proj.data());
+      }
+    }
+
+    Ort::Value logit{nullptr};
+    float *p_logit = nullptr;
+
+    if (native_joiner) {
+      native_logit.resize(num_hyps * vocab_size);
+      RunNativeJoiner(*native_joiner, encoder_proj.data(),
+                      decoder_out.GetTensorData<float>(), hyps_row_splits,
+                      num_frames, t, &decoder_proj, native_logit.data());
+      p_logit = native_logit.data();
+    } else {
+      Ort::Value cur_encoder_out =
+          GetEncoderOutFrame(model_->Allocator(), &encoder_out, t);
+      cur_encoder_out =
+          Repeat(model_->Allocator(), &cur_encoder_out, hyps_row_splits);
+      logit = model_->RunJoinerWithMetrics(std::move(cur_encoder_out),
+                                           View(&decoder_out));
+      p_logit = logit.GetTensorMutableData<float>();
+    }
 
     // copy raw logits, apply temperature-scaling  (for confidences)
     // Note: temperature scaling is used only for the confidences,
@@ -167,6 +244,12 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
     }
     p_logprob = p_logit;  // we changed p_logprob in the above for loop
 
+    // New hyps that have emitted a token in this frame. With shallow
+    // fusion, they are scored by the LM together after all streams are
+    // processed.
+    std::vector<Hypothesis *> lm_hyps;
+    std::vector<float> lm_prev_log_probs;
+
     for (int32_t b = 0; b != batch_size; ++b) {
       int32_t frame_offset = (*result)[b].frame_offset;
       int32_t start = hyps_row_splits[b];
@@ -186,7 +269,8 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
 
         // blank is hardcoded to 0
         // also, it treats unk as blank
-        if (new_token != 0 && new_token != unk_id_) {
+        bool emitted = new_token != 0 && new_token != unk_id_;
+        if (emitted) {
           new_hyp.ys.push_back(new_token);
           new_hyp.timestamps.push_back(t + frame_offset);
           new_hyp.num_trailing_blanks = 0;
@@ -196,9 +280,6 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
             context_score = std::get<0>(context_res);
             new_hyp.context_state = std::get<1>(context_res);
           }
-          if (lm_ && shallow_fusion_) {
-            lm_->ComputeLMScoreSF(lm_scale_, &new_hyp);
-          }
         } else {
           ++new_hyp.num_trailing_blanks;
         }
@@ -213,31 +294,41 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
         }
 
         // export the per-token log scores
-        if (new_token != 0 && new_token != unk_id_) {
+        if (emitted) {
           float y_prob = logit_with_temperature[start * vocab_size + k];
           new_hyp.ys_probs.push_back(y_prob);
 
-          if (lm_ && shallow_fusion_) {  // export only if
-                                         // LM shallow fusion is used
-            float lm_prob = new_hyp.lm_log_prob - prev_lm_log_prob;
-
-            if (lm_scale_ != 0.0) {
-              lm_prob /= lm_scale_;  // remove lm-scale
-            }
-            new_hyp.lm_probs.push_back(lm_prob);
-          }
-
           // export only when `ContextGraph` is used
           if (ss != nullptr && ss[b]->GetContextGraph() != nullptr) {
             new_hyp.context_scores.push_back(context_score);
           }
         }
 
-        hyps.Add(std::move(new_hyp));
+        Hypothesis *added = hyps.Add(std::move(new_hyp));
+
+        // If it is merged into an existing hyp, that hyp has the same
+        // tokens and its LM scores are already up to date
+        if (added && emitted && lm_ && shallow_fusion_) {
+          lm_hyps.push_back(added);
+          lm_prev_log_probs.push_back(prev_lm_log_prob);
+        }
       }  // for (auto k : topk)
       cur.push_back(std::move(hyps));
       p_logprob += (end - start) * vocab_size;
     }  // for (int32_t b = 0; b != batch_size; ++b)
+
+    if (!lm_hyps.empty()) {
+      lm_->ComputeLMScoresSF(lm_scale_, lm_hyps.data(), lm_hyps.size());
+
+      // export the per-token LM scores
+      for (int32_t i = 0; i != static_cast<int32_t>(lm_hyps.size()); ++i) {
+        float lm_prob = lm_hyps[i]->lm_log_prob - lm_prev_log_probs[i];
+        if (lm_scale_ != 0.0) {
+          lm_prob /= lm_scale_;  // remove lm-scale
+        }
+        lm_hyps[i]->lm_probs.push_back(lm_prob);
+      }
+    }
   }    // for (int32_t t = 0; t != num_frames; ++t)
 
   // classic lm rescore
@@ -264,7 +355,7 @@ void OnlineTransducerModifiedBeamSearchDecoder::UpdateDecoderOut(
     return;
   }
   Ort::Value decoder_input = model_->BuildDecoderInput({*result});
-  result->decoder_out = model_->RunDecoder(std::move(decoder_input));
+  result->decoder_out = model_->RunDecoderWithMetrics(std::move(decoder_input));
 }
 
 }  // namespace sherpa_onnx
@@ -4,7 +4,9 @@
 #include <chrono>  // NOLINT
 #include <fstream>
 #include <string>
+#include <vector>
 
+#include "sherpa-onnx/csrc/audio-sample-format.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
@@ -32,18 +34,39 @@ Usage:
   /path/to/foo.wav
 
 It support only wave of with a single channel, 16kHz, 16-bit samples.
+
+Use --audio-format=int16, --audio-format=mulaw, or --audio-format=alaw
+to send samples in a more compact format than float32. For instance,
+to send 8 kHz mu-law audio as in telephony:
+
+./bin/sherpa-onnx-online-websocket-client \
+  --server-ip=127.0.0.1 \
+  --server-port=6006 \
+  --sample-rate=8000 \
+  --samples-per-message=1600 \
+  --audio-format=mulaw \
+  /path/to/foo-8k.wav
 )";
 
 class Client {
  public:
   Client(asio::io_context &io,  // NOLINT
          const std::string &ip, int16_t port, const std::vector<float> &samples,
-         int32_t samples_per_message, float seconds_per_message)
+         int32_t samples_per_message, float seconds_per_message,
+         sherpa_onnx::AudioSampleFormat format, int32_t sample_rate)
       : io_(io),
         uri_(/*secure*/ false, ip, port, /*resource*/ "/"),
-        samples_(samples),
         samples_per_message_(samples_per_message),
-        seconds_per_message_(seconds_per_message) {
+        seconds_per_message_(seconds_per_message),
+        format_(format),
+        sample_rate_(sample_rate) {
+    // Encode all samples once so that sending a message is just a memcpy
+    bytes_per_sample_ = sherpa_onnx::BytesPerSample(format);
+    num_samples_ = samples.size();
+    bytes_.resize(num_samples_ * bytes_per_sample_);
+    sherpa_onnx::EncodeAudioSamples(format, samples.data(), num_samples_,
+                                    bytes_.data());
+
     c_.clear_access_channels(websocketpp::log::alevel::all);
     // c_.set_access_channels(websocketpp::log::alevel::connect);
     // c_.set_access_channels(websocketpp::log::alevel::disconnect);
@@ -72,6 +95,17 @@ class Client {
   }
 
   void OnOpen(connection_hdl hdl) {
+    if (format_ != sherpa_onnx::AudioSampleFormat::kFloat32) {
+      websocketpp::lib::error_code ec;
+      c_.send(hdl, sherpa_onnx::BuildAudioFormatMessage(format_, sample_rate_),
+              websocketpp::frame::opcode::text, ec);
+      if (ec) {
+        SHERPA_ONNX_LOGE("Failed to send the audio format because %s",
+                         ec.message().c_str());
+        exit(EXIT_FAILURE);
+      }
+    }
+
     auto start_time = std::chrono::steady_clock::now();
     asio::post(
         io_, [this, hdl, start_time]() { this->SendMessage(hdl, start_time); });
@@ -95,7 +129,7 @@ class Client {
   void SendMessage(
       connection_hdl hdl,
       std::chrono::time_point<std::chrono::steady_clock> start_time) {
-    int32_t num_samples = samples_.size();
+    int32_t num_samples = num_samples_;
     int32_t num_messages = num_samples / samples_per_message_;
 
     websocketpp::lib::error_code ec;
@@ -115,8 +149,10 @@ class Client {
     }
 
     if (num_sent_messages_ < num_messages) {
-      c_.send(hdl, samples_.data() + num_sent_messages_ * samples_per_message_,
-              samples_per_message_ * sizeof(float),
+      c_.send(hdl,
+              bytes_.data() +
+                  num_sent_messages_ * samples_per_message_ * bytes_per_sample_,
+              samples_per_message_ * bytes_per_sample_,
               websocketpp::frame::opcode::binary, ec);
 
       if (ec) {
@@ -134,8 +170,9 @@ class Client {
       int32_t remaining_samples = num_samples % samples_per_message_;
       if (remaining_samples) {
         c_.send(hdl,
-                samples_.data() + num_sent_messages_ * samples_per_message_,
-                remaining_samples * sizeof(float),
+                bytes_.data() + num_sent_messages_ * samples_per_message_ *
+                                    bytes_per_sample_,
+                remaining_samples * bytes_per_sample_,
                 websocketpp::frame::opcode::binary, ec);
 
         if (ec) {
@@ -166,10 +203,17 @@ class Client {
   client c_;
   asio::io_context &io_;
   websocketpp::uri uri_;
-  std::vector<float> samples_;
   int32_t samples_per_message_ = 8000;  // 0.5 seconds
   float seconds_per_message_ = 0.2;
   int32_t num_sent_messages_ = 0;
+
+  sherpa_onnx::AudioSampleFormat format_;
+  int32_t sample_rate_;
+
+  // Samples encoded in format_
+  std::vector<uint8_t> bytes_;
+  int32_t bytes_per_sample_;
+  int32_t num_samples_;
 };
 
 int32_t main(int32_t argc, char *argv[]) {
@@ -180,6 +224,7 @@ int32_t main(int32_t argc, char *argv[]) {
   int32_t sample_rate = 16000;
   int32_t samples_per_message = 8000;
   float seconds_per_message = 0.2;
+  std::string audio_format = "float32";
 
   sherpa_onnx::ParseOptions po(kUsageMessage);
 
@@ -197,8 +242,18 @@ int32_t main(int32_t argc, char *argv[]) {
               "to send. If you select a very large value, it will take a long "
               "time to send all the samples");
 
+  po.Register("audio-format", &audio_format,
+              "Format of the samples sent to the server. Valid values: "
+              "float32, int16, mulaw, alaw");
+
   po.Read(argc, argv);
 
+  sherpa_onnx::AudioSampleFormat format;
+  if (!sherpa_onnx::ParseAudioSampleFormat(audio_format, &format)) {
+    SHERPA_ONNX_LOGE("Invalid --audio-format: %s", audio_format.c_str());
+    return -1;
+  }
+
   if (!websocketpp::uri_helper::ipv4_literal(server_ip.begin(),
                                              server_ip.end())) {
     SHERPA_ONNX_LOGE("Invalid server IP: %s", server_ip.c_str());
@@ -265,7 +320,7 @@ int32_t main(int32_t argc, char *argv[]) {
 
   asio::io_context io_conn;  // for network connections
   Client c(io_conn, server_ip, server_port, samples, samples_per_message,
-           seconds_per_message);
+           seconds_per_message, format, sample_rate);
 
   io_conn.run();  // will exit when the above connection is closed
 
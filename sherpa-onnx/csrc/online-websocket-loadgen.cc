@@ -0,0 +1,610 @@
+// sherpa-onnx/csrc/online-websocket-loadgen.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "asio.hpp"
+#include "sherpa-onnx/csrc/audio-sample-format.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+#include "websocketpp/client.hpp"
+#include "websocketpp/config/asio_no_tls_client.hpp"
+#include "websocketpp/uri.hpp"
+
+using client = websocketpp::client<websocketpp::config::asio_client>;
+
+using message_ptr = client::message_ptr;
+using websocketpp::connection_hdl;
+
+static constexpr const char *kUsageMessage = R"(
+Load generator for sherpa-onnx-online-websocket-server.
+
+It opens many concurrent connections, streams audio on each of them at
+real-time pace and prints a summary of the latencies and of the dropped
+connections.
+
+Usage:
+
+./bin/sherpa-onnx-online-websocket-loadgen \
+  --server-ip=127.0.0.1 \
+  --server-port=6006 \
+  --num-connections=500 \
+  --ramp-up-seconds=10 \
+  --chunk-ms=100 \
+  --duration=20 \
+  --num-io-threads=4 \
+  [/path/to/foo.wav bar.wav ...]
+
+If no wave files are given, each connection sends --duration seconds of
+synthesized noise. Otherwise, connection i sends wave file
+i % (number of wave files). The sample rate of the wave files must be
+equal to --sample-rate. No resampling is made.
+
+Connection i is opened at i * ramp-up-seconds / num-connections
+seconds. After it is opened, it sends a chunk of --chunk-ms audio every
+--chunk-ms milliseconds, followed by "Done".
+
+It reports
+
+  - partial-result latency: the time from sending a chunk to receiving
+    the first result after it
+  - final latency: the time from sending "Done" to receiving "Done!"
+  - send lag: how late a chunk is sent compared to real-time. If it is
+    large, the load generator itself is overloaded and you should
+    increase --num-io-threads
+  - dropped connections: connections that failed to open, were closed
+    before "Done!" or did not receive "Done!" within --timeout seconds
+
+Use --audio-format=int16, mulaw or alaw to send compact samples.
+
+Note: You may need to increase the limit of open files, e.g.,
+ulimit -n 65536, for thousands of connections.
+)";
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsBetween(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct LoadGenConfig {
+  std::string server_ip = "127.0.0.1";
+  int32_t server_port = 6006;
+  int32_t num_connections = 100;
+  float ramp_up_seconds = 5;
+  int32_t chunk_ms = 100;
+  float duration = 10;
+  int32_t sample_rate = 16000;
+  std::string audio_format = "float32";
+  int32_t num_io_threads = 1;
+  float timeout = 30;
+
+  sherpa_onnx::AudioSampleFormat format =
+      sherpa_onnx::AudioSampleFormat::kFloat32;
+
+  void Register(sherpa_onnx::ParseOptions *po) {
+    po->Register("server-ip", &server_ip,
+                 "IP address of the websocket server");
+    po->Register("server-port", &server_port, "Port of the websocket server");
+    po->Register("num-connections", &num_connections,
+                 "Number of concurrent connections");
+    po->Register("ramp-up-seconds", &ramp_up_seconds,
+                 "Connections are opened evenly during this number of "
+                 "seconds");
+    po->Register("chunk-ms", &chunk_ms,
+                 "Send a chunk of this many milliseconds of audio every "
+                 "this many milliseconds");
+    po->Register("duration", &duration,
+                 "Seconds of synthesized noise sent by each connection. Used "
+                 "only if no wave files are given");
+    po->Register("sample-rate", &sample_rate,
+                 "Sample rate of the audio. Should be the one expected by "
+                 "the server");
+    po->Register("audio-format", &audio_format,
+                 "Format of the samples sent to the server. Valid values: "
+                 "float32, int16, mulaw, alaw");
+    po->Register("num-io-threads", &num_io_threads,
+                 "Number of threads. Each thread runs a websocket client "
+                 "with num-connections / num-io-threads connections");
+    po->Register("timeout", &timeout,
+                 "A connection is dropped if it does not receive Done! "
+                 "within this number of seconds after sending Done");
+  }
+
+  bool Validate() {
+    if (!sherpa_onnx::ParseAudioSampleFormat(audio_format, &format)) {
+      SHERPA_ONNX_LOGE("Invalid --audio-format: %s", audio_format.c_str());
+      return false;
+    }
+
+    if (!websocketpp::uri_helper::ipv4_literal(server_ip.begin(),
+                                               server_ip.end())) {
+      SHERPA_ONNX_LOGE("Invalid server IP: %s", server_ip.c_str());
+      return false;
+    }
+
+    if (server_port <= 0 || server_port > 65535) {
+      SHERPA_ONNX_LOGE("Invalid server port: %d", server_port);
+      return false;
+    }
+
+    if (num_connections < 1 || num_io_threads < 1) {
+      SHERPA_ONNX_LOGE("--num-connections and --num-io-threads must be "
+                       "positive");
+      return false;
+    }
+
+    if (chunk_ms < 10) {
+      SHERPA_ONNX_LOGE("--chunk-ms is too small: %d", chunk_ms);
+      return false;
+    }
+
+    if (ramp_up_seconds < 0 || duration <= 0 || timeout <= 0) {
+      SHERPA_ONNX_LOGE("Invalid --ramp-up-seconds, --duration or --timeout");
+      return false;
+    }
+
+    return true;
+  }
+};
+
+// Audio encoded in the wire format
+struct EncodedAudio {
+  std::vector<uint8_t> bytes;
+  int32_t num_samples = 0;
+};
+
+EncodedAudio Encode(const std::vector<float> &samples,
+                    sherpa_onnx::AudioSampleFormat format) {
+  EncodedAudio ans;
+  ans.num_samples = samples.size();
+  ans.bytes.resize(samples.size() * sherpa_onnx::BytesPerSample(format));
+  sherpa_onnx::EncodeAudioSamples(format, samples.data(), samples.size(),
+                                  ans.bytes.data());
+  return ans;
+}
+
+std::vector<float> GenerateNoise(float duration, int32_t sample_rate,
+                                 int32_t seed) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<float> dist(0, 0.05);
+
+  std::vector<float> ans(static_cast<int32_t>(duration * sample_rate));
+  for (auto &s : ans) {
+    s = std::max(-1.0f, std::min(1.0f, dist(gen)));
+  }
+  return ans;
+}
+
+struct ConnectionStats {
+  // Time from sending a chunk to receiving the first result after it
+  std::vector<double> partial_latencies_ms;
+
+  // How late each chunk is sent compared to its schedule
+  std::vector<double> send_lags_ms;
+
+  // Time from sending Done to receiving Done!
+  double final_latency_ms = -1;
+
+  bool completed = false;
+  bool failed_to_connect = false;
+  bool closed_early = false;
+  bool timed_out = false;
+};
+
+class Session;
+
+// A websocket client running on its own thread with a subset of the
+// connections. Connections of different clients never share state,
+// so no locking is needed.
+class LoadGenClient {
+ public:
+  LoadGenClient(const LoadGenConfig &config,
+                const std::vector<EncodedAudio> &audio);
+
+  ~LoadGenClient();
+
+  // Add connection i. It is opened at start + delay
+  void Add(int32_t i, Clock::time_point start_time);
+
+  void Run() { io_.run(); }
+
+  std::vector<const ConnectionStats *> Stats() const;
+
+ private:
+  friend class Session;
+
+  const LoadGenConfig &config_;
+  const std::vector<EncodedAudio> &audio_;
+  asio::io_context io_;
+  client c_;
+  websocketpp::uri uri_;
+  std::vector<std::unique_ptr<Session>> sessions_;
+};
+
+class Session {
+ public:
+  Session(LoadGenClient *client, const EncodedAudio *audio)
+      : client_(client), audio_(audio), timer_(client->io_) {}
+
+  void Start(Clock::time_point t) {
+    timer_.expires_at(t);
+    timer_.async_wait([this](const asio::error_code &ec) {
+      if (!ec) {
+        Connect();
+      }
+    });
+  }
+
+  const ConnectionStats &Stats() const { return stats_; }
+
+ private:
+  void Connect() {
+    client &c = client_->c_;
+
+    websocketpp::lib::error_code ec;
+    client::connection_ptr con = c.get_connection(client_->uri_.str(), ec);
+    if (ec) {
+      SHERPA_ONNX_LOGE("Could not create connection to %s because %s",
+                       client_->uri_.str().c_str(), ec.message().c_str());
+      stats_.failed_to_connect = true;
+      return;
+    }
+
+    con->set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
+    con->set_fail_handler([this](connection_hdl hdl) { OnFail(hdl); });
+    con->set_close_handler([this](connection_hdl hdl) { OnClose(hdl); });
+    con->set_message_handler([this](connection_hdl hdl, message_ptr msg) {
+      OnMessage(hdl, msg);
+    });
+
+    c.connect(con);
+  }
+
+  void OnOpen(connection_hdl hdl) {
+    hdl_ = hdl;
+
+    const auto &config = client_->config_;
+    if (config.format != sherpa_onnx::AudioSampleFormat::kFloat32) {
+      websocketpp::lib::error_code ec;
+      client_->c_.send(
+          hdl,
+          sherpa_onnx::BuildAudioFormatMessage(config.format,
+                                               config.sample_rate),
+          websocketpp::frame::opcode::text, ec);
+      if (ec) {
+        Close("Failed to send the audio format");
+        return;
+      }
+    }
+
+    start_time_ = Clock::now();
+    ScheduleNextChunk();
+  }
+
+  void OnFail(connection_hdl /*hdl*/) {
+    stats_.failed_to_connect = true;
+    timer_.cancel();
+  }
+
+  void OnClose(connection_hdl /*hdl*/) {
+    if (!stats_.completed && !stats_.timed_out) {
+      stats_.closed_early = true;
+    }
+    closed_ = true;
+    timer_.cancel();
+  }
+
+  void OnMessage(connection_hdl /*hdl*/, message_ptr msg) {
+    auto now = Clock::now();
+    if (msg->get_payload() == "Done!") {
+      stats_.final_latency_ms = MillisecondsBetween(done_time_, now);
+      stats_.completed = true;
+      timer_.cancel();
+      Close("Done");
+      return;
+    }
+
+    // A partial result. It is the first result after the pending chunks
+    for (auto t : pending_chunks_) {
+      stats_.partial_latencies_ms.push_back(MillisecondsBetween(t, now));
+    }
+    pending_chunks_.clear();
+  }
+
+  void ScheduleNextChunk() {
+    const auto &config = client_->config_;
+    auto t = start_time_ + std::chrono::milliseconds(config.chunk_ms) *
+                               num_sent_chunks_;
+
+    timer_.expires_at(t);
+    timer_.async_wait([this, t](const asio::error_code &ec) {
+      if (!ec && !closed_) {
+        SendChunk(t);
+      }
+    });
+  }
+
+  void SendChunk(Clock::time_point scheduled) {
+    const auto &config = client_->config_;
+    int32_t chunk_size = config.chunk_ms * config.sample_rate / 1000;
+    int32_t bytes_per_sample = sherpa_onnx::BytesPerSample(config.format);
+
+    int32_t offset = num_sent_chunks_ * chunk_size;
+    int32_t n = std::min(chunk_size, audio_->num_samples - offset);
+
+    auto now = Clock::now();
+    stats_.send_lags_ms.push_back(MillisecondsBetween(scheduled, now));
+
+    websocketpp::lib::error_code ec;
+    if (n > 0) {
+      client_->c_.send(hdl_, audio_->bytes.data() + offset * bytes_per_sample,
+                       n * bytes_per_sample,
+                       websocketpp::frame::opcode::binary, ec);
+      if (ec) {
+        Close("Failed to send audio samples");
+        return;
+      }
+      pending_chunks_.push_back(now);
+      ++num_sent_chunks_;
+    }
+
+    if (offset + n < audio_->num_samples) {
+      ScheduleNextChunk();
+      return;
+    }
+
+    client_->c_.send(hdl_, "Done", websocketpp::frame::opcode::text, ec);
+    if (ec) {
+      Close("Failed to send Done");
+      return;
+    }
+    done_time_ = Clock::now();
+
+    timer_.expires_after(std::chrono::milliseconds(
+        static_cast<int32_t>(config.timeout * 1000)));
+    timer_.async_wait([this](const asio::error_code &ec) {
+      if (!ec && !stats_.completed && !closed_) {
+        stats_.timed_out = true;
+        Close("Timed out");
+      }
+    });
+  }
+
+  void Close(const std::string &reason) {
+    if (closed_) {
+      return;
+    }
+
+    websocketpp::lib::error_code ec;
+    client_->c_.close(hdl_, websocketpp::close::status::normal, reason, ec);
+    closed_ = true;
+  }
+
+ private:
+  LoadGenClient *client_;
+  const EncodedAudio *audio_;
+  asio::steady_timer timer_;
+
+  connection_hdl hdl_;
+  Clock::time_point start_time_;
+  Clock::time_point done_time_;
+  int32_t num_sent_chunks_ = 0;
+  bool closed_ = false;
+
+  // Send time of the chunks for which no result has been received
+  std::deque<Clock::time_point> pending_chunks_;
+
+  ConnectionStats stats_;
+};
+
+LoadGenClient::LoadGenClient(const LoadGenConfig &config,
+                             const std::vector<EncodedAudio> &audio)
+    : config_(config),
+      audio_(audio),
+      uri_(/*secure*/ false, config.server_ip, config.server_port,
+           /*resource*/ "/") {
+  c_.clear_access_channels(websocketpp::log::alevel::all);
+  c_.clear_error_channels(websocketpp::log::elevel::all);
+  c_.init_asio(&io_);
+
+  // Opening thousands of connections at once can take a while
+  c_.set_open_handshake_timeout(
+      static_cast<int64_t>(config.timeout * 1000));
+}
+
+LoadGenClient::~LoadGenClient() = default;
+
+void LoadGenClient::Add(int32_t i, Clock::time_point start_time) {
+  sessions_.push_back(
+      std::make_unique<Session>(this, &audio_[i % audio_.size()]));
+  sessions_.back()->Start(start_time);
+}
+
+std::vector<const ConnectionStats *> LoadGenClient::Stats() const {
+  std::vector<const ConnectionStats *> ans;
+  for (const auto &s : sessions_) {
+    ans.push_back(&s->Stats());
+  }
+  return ans;
+}
+
+// Nearest-rank percentile. v must be sorted
+double Percentile(const std::vector<double> &v, double q) {
+  if (v.empty()) {
+    return 0;
+  }
+
+  int32_t k = static_cast<int32_t>(std::ceil(q * v.size())) - 1;
+  k = std::max(0, std::min(k, static_cast<int32_t>(v.size()) - 1));
+  return v[k];
+}
+
+void PrintLatencies(const char *name, std::vector<double> v) {
+  std::sort(v.begin(), v.end());
+
+  double sum = 0;
+  for (auto d : v) {
+    sum += d;
+  }
+
+  fprintf(stderr,
+          "%-32s count: %-8d mean: %8.1f  p50: %8.1f  p90: %8.1f  "
+          "p99: %8.1f  max: %8.1f\n",
+          name, static_cast<int32_t>(v.size()),
+          v.empty() ? 0 : sum / v.size(), Percentile(v, 0.5),
+          Percentile(v, 0.9), Percentile(v, 0.99),
+          v.empty() ? 0 : v.back());
+}
+
+void PrintSummary(const LoadGenConfig &config,
+                  const std::vector<const ConnectionStats *> &stats,
+                  double audio_seconds, double elapsed_seconds) {
+  int32_t num_completed = 0;
+  int32_t num_failed = 0;
+  int32_t num_closed_early = 0;
+  int32_t num_timed_out = 0;
+
+  std::vector<double> partial;
+  std::vector<double> final_latencies;
+  std::vector<double> send_lags;
+
+  for (const auto s : stats) {
+    num_completed += s->completed;
+    num_failed += s->failed_to_connect;
+    num_closed_early += !s->failed_to_connect && s->closed_early;
+    num_timed_out += s->timed_out;
+
+    partial.insert(partial.end(), s->partial_latencies_ms.begin(),
+                   s->partial_latencies_ms.end());
+    send_lags.insert(send_lags.end(), s->send_lags_ms.begin(),
+                     s->send_lags_ms.end());
+
+    if (s->completed) {
+      final_latencies.push_back(s->final_latency_ms);
+    }
+  }
+
+  int32_t num_dropped = config.num_connections - num_completed;
+
+  fprintf(stderr, "\n----------Summary----------\n");
+  fprintf(stderr, "Server: %s:%d\n", config.server_ip.c_str(),
+          config.server_port);
+  fprintf(stderr, "Audio format: %s, sample rate: %d, chunk: %d ms\n",
+          config.audio_format.c_str(), config.sample_rate, config.chunk_ms);
+  fprintf(stderr, "Audio sent: %.1f seconds. Elapsed: %.1f seconds\n",
+          audio_seconds, elapsed_seconds);
+  fprintf(stderr,
+          "Connections: %d, completed: %d, dropped: %d (failed to connect: "
+          "%d, closed before Done!: %d, timed out: %d)\n",
+          config.num_connections, num_completed, num_dropped, num_failed,
+          num_closed_early, num_timed_out);
+  fprintf(stderr, "Latencies in ms:\n");
+  PrintLatencies("  partial result", partial);
+  PrintLatencies("  final result after Done", final_latencies);
+  PrintLatencies("  send lag", send_lags);
+}
+
+}  // namespace
+
+int32_t main(int32_t argc, char *argv[]) {
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  LoadGenConfig config;
+  config.Register(&po);
+
+  po.Read(argc, argv);
+
+  if (!config.Validate()) {
+    return -1;
+  }
+
+  std::vector<EncodedAudio> audio;
+  double audio_seconds = 0;
+
+  for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+    bool is_ok = false;
+    int32_t actual_sample_rate = -1;
+    std::vector<float> samples =
+        sherpa_onnx::ReadWave(po.GetArg(i), &actual_sample_rate, &is_ok);
+
+    if (!is_ok) {
+      SHERPA_ONNX_LOGE("Failed to read '%s'", po.GetArg(i).c_str());
+      return -1;
+    }
+
+    if (actual_sample_rate != config.sample_rate) {
+      SHERPA_ONNX_LOGE("Expected sample rate: %d, given %d in %s",
+                       config.sample_rate, actual_sample_rate,
+                       po.GetArg(i).c_str());
+      return -1;
+    }
+
+    audio.push_back(Encode(samples, config.format));
+  }
+
+  if (audio.empty()) {
+    // Use a few different clips so that the server does not see
+    // identical streams
+    int32_t n = std::min(config.num_connections, 16);
+    for (int32_t i = 0; i != n; ++i) {
+      audio.push_back(Encode(
+          GenerateNoise(config.duration, config.sample_rate, i),
+          config.format));
+    }
+  }
+
+  for (int32_t i = 0; i != config.num_connections; ++i) {
+    audio_seconds += audio[i % audio.size()].num_samples /
+                     static_cast<double>(config.sample_rate);
+  }
+
+  std::vector<std::unique_ptr<LoadGenClient>> clients;
+  for (int32_t i = 0; i != config.num_io_threads; ++i) {
+    clients.push_back(std::make_unique<LoadGenClient>(config, audio));
+  }
+
+  auto start = Clock::now();
+  for (int32_t i = 0; i != config.num_connections; ++i) {
+    auto delay = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config.ramp_up_seconds * i /
+                                      config.num_connections));
+    clients[i % clients.size()]->Add(i, start + delay);
+  }
+
+  SHERPA_ONNX_LOGE("Opening %d connections in %.1f seconds",
+                   config.num_connections, config.ramp_up_seconds);
+
+  std::vector<std::thread> threads;
+  for (auto &c : clients) {
+    threads.emplace_back([&c]() { c->Run(); });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  double elapsed_seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<const ConnectionStats *> stats;
+  for (const auto &c : clients) {
+    auto s = c->Stats();
+    stats.insert(stats.end(), s.begin(), s.end());
+  }
+
+  PrintSummary(config, stats, audio_seconds, elapsed_seconds);
+
+  return 0;
+}
@@ -4,10 +4,15 @@
 
 #include "sherpa-onnx/csrc/online-websocket-server-impl.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/log.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 namespace sherpa_onnx {
 
@@ -22,13 +27,42 @@ void OnlineWebsocketDecoderConfig::Register(ParseOptions *po) {
 
   po->Register("end-tail-padding", &end_tail_padding,
                "It determines the length of tail_padding at the end of audio.");
+
+  po->Register("idle-seconds", &idle_seconds,
+               "If positive, the model states of a stream that has not been "
+               "decoded for this number of seconds are compacted to save "
+               "memory. They are restored when the stream is decoded again.");
+
+  po->Register("idle-fp16", &idle_fp16,
+               "Used only when --idle-seconds is positive. True to store the "
+               "states of idle streams in half precision.");
+
+  po->Register("idle-spill-dir", &idle_spill_dir,
+               "Used only when --idle-seconds is positive. If not empty, the "
+               "states of idle streams are spilled to memory-mapped files in "
+               "this directory.");
+
+  po->Register("delta-results", &delta_results,
+               "True to send only the changes of a result since the previous "
+               "one of the same stream, e.g., the new tokens, instead of the "
+               "full result. Scores of tokens are not sent.");
 }
 
 void OnlineWebsocketDecoderConfig::Validate() const {
   recognizer_config.Validate();
+  SHERPA_ONNX_CHECK_GE(recognizer_config.model_config.warm_up, 0);
+  SHERPA_ONNX_CHECK_LT(recognizer_config.model_config.warm_up, 100);
   SHERPA_ONNX_CHECK_GT(loop_interval_ms, 0);
   SHERPA_ONNX_CHECK_GT(max_batch_size, 0);
   SHERPA_ONNX_CHECK_GT(end_tail_padding, 0);
+  SHERPA_ONNX_CHECK_GE(idle_seconds, 0);
+
+  if (idle_seconds > 0 && !idle_spill_dir.empty() &&
+      !FileExists(idle_spill_dir)) {
+    SHERPA_ONNX_LOGE("--idle-spill-dir '%s' does not exist",
+                     idle_spill_dir.c_str());
+    exit(-1);
+  }
 }
 
 void OnlineWebsocketServerConfig::Register(sherpa_onnx::ParseOptions *po) {
@@ -37,6 +71,10 @@ void OnlineWebsocketServerConfig::Register(sherpa_onnx::ParseOptions *po) {
   po->Register("log-file", &log_file,
                "Path to the log file. Logs are "
                "appended to this file");
+
+  po->Register("enable-metrics", &enable_metrics,
+               "If true, export latency, throughput and queue metrics at "
+               "http://<server-ip>:<port>/metrics");
 }
 
 void OnlineWebsocketServerConfig::Validate() const {
@@ -48,6 +86,23 @@ OnlineWebsocketDecoder::OnlineWebsocketDecoder(OnlineWebsocketServer *server)
       config_(server->GetConfig().decoder_config),
       timer_(server->GetWorkContext()) {
   recognizer_ = std::make_unique<OnlineRecognizer>(config_.recognizer_config);
+
+  auto &registry = MetricsRegistry::Global();
+  num_streams_ = registry.GetGauge("sherpa_onnx_online_server_streams",
+                                   "Number of streams in the decoder");
+  queue_depth_ =
+      registry.GetGauge("sherpa_onnx_online_server_queue_depth",
+                        "Number of streams that are waiting to be decoded");
+
+  num_idle_streams_ =
+      registry.GetGauge("sherpa_onnx_online_server_idle_streams",
+                        "Number of idle streams whose states are compacted");
+  idle_state_bytes_ = registry.GetGauge(
+      "sherpa_onnx_online_server_idle_state_bytes",
+      "Bytes of memory used by the states of idle streams");
+  bytes_per_idle_stream_ = registry.GetGauge(
+      "sherpa_onnx_online_server_bytes_per_idle_stream",
+      "Average bytes of memory used by the states of an idle stream");
 }
 
 std::shared_ptr<Connection> OnlineWebsocketDecoder::GetOrCreateConnection(
@@ -67,7 +122,9 @@ std::shared_ptr<Connection> OnlineWebsocketDecoder::GetOrCreateConnection(
 
 void OnlineWebsocketDecoder::AcceptWaveform(std::shared_ptr<Connection> c) {
   std::lock_guard<std::mutex> lock(c->mutex);
-  float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
+  float sample_rate = c->sample_rate > 0
+                          ? c->sample_rate
+                          : config_.recognizer_config.feat_config.sampling_rate;
   while (!c->samples.empty()) {
     const auto &s = c->samples.front();
     c->s->AcceptWaveform(sample_rate, s.data(), s.size());
@@ -78,7 +135,9 @@ void OnlineWebsocketDecoder::AcceptWaveform(std::shared_ptr<Connection> c) {
 void OnlineWebsocketDecoder::InputFinished(std::shared_ptr<Connection> c) {
   std::lock_guard<std::mutex> lock(c->mutex);
 
-  float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
+  float sample_rate = c->sample_rate > 0
+                          ? c->sample_rate
+                          : config_.recognizer_config.feat_config.sampling_rate;
 
   while (!c->samples.empty()) {
     const auto &s = c->samples.front();
@@ -95,6 +154,72 @@ void OnlineWebsocketDecoder::InputFinished(std::shared_ptr<Connection> c) {
   c->eof = true;
 }
 
+void OnlineWebsocketDecoder::Snapshot(std::shared_ptr<Connection> c) {
+  if (!TryAcquire(c)) {
+    // The stream is being decoded, so try again later
+    asio::post(server_->GetWorkContext(), [this, c]() { Snapshot(c); });
+    return;
+  }
+
+  // Include samples that are received but not yet processed
+  AcceptWaveform(c);
+
+  std::string data;
+  {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    data = c->s->Serialize();
+  }
+  Release(c);
+
+  asio::post(server_->GetConnectionContext(),
+             [this, hdl = c->hdl, data = std::move(data)]() {
+               if (data.empty()) {
+                 server_->Send(hdl, "Failed to snapshot!");
+               } else {
+                 server_->SendBinary(hdl, data);
+               }
+             });
+}
+
+void OnlineWebsocketDecoder::Restore(std::shared_ptr<Connection> c,
+                                     std::string snapshot) {
+  if (!TryAcquire(c)) {
+    asio::post(server_->GetWorkContext(),
+               [this, c, snapshot = std::move(snapshot)]() mutable {
+                 Restore(c, std::move(snapshot));
+               });
+    return;
+  }
+
+  std::shared_ptr<OnlineStream> s = recognizer_->CreateStream();
+  bool ok = s->Deserialize(snapshot);
+  if (ok) {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    c->s = std::move(s);
+    c->eof = false;
+    c->last_active = std::chrono::steady_clock::now();
+
+    // So that the next result is sent in full
+    c->last_result = {};
+    c->last_result.segment = -1;
+  }
+  Release(c);
+
+  asio::post(server_->GetConnectionContext(), [this, hdl = c->hdl, ok]() {
+    server_->Send(hdl, ok ? "Restored!" : "Failed to restore!");
+  });
+}
+
+bool OnlineWebsocketDecoder::TryAcquire(std::shared_ptr<Connection> c) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_.insert(c->hdl).second;
+}
+
+void OnlineWebsocketDecoder::Release(std::shared_ptr<Connection> c) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  active_.erase(c->hdl);
+}
+
 void OnlineWebsocketDecoder::Warmup() const {
   recognizer_->WarmpUpRecognizer(config_.recognizer_config.model_config.warm_up,
                                  config_.max_batch_size);
@@ -112,8 +237,16 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
     SHERPA_ONNX_LOG(FATAL) << "The decoder loop is aborted!";
   }
 
+  SHERPA_ONNX_TRACE_SCOPE("OnlineWebsocketDecoder::ProcessConnections");
+
+  auto now = std::chrono::steady_clock::now();
+  auto idle_duration = std::chrono::duration<float>(config_.idle_seconds);
+
   std::lock_guard<std::mutex> lock(mutex_);
   std::vector<connection_hdl> to_remove;
+  std::vector<std::shared_ptr<Connection>> to_compact;
+  int32_t num_idle_streams = 0;
+  int64_t idle_state_bytes = 0;
   for (auto &p : connections_) {
     auto hdl = p.first;
     auto c = p.second;
@@ -132,6 +265,15 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
 
     if (!recognizer_->IsReady(c->s.get()) && !c->eof) {
       // this stream has not enough frames to decode, so skip it
+      if (c->s->IsCompacted()) {
+        num_idle_streams += 1;
+        idle_state_bytes += c->s->StatesBytes();
+      } else if (config_.idle_seconds > 0 &&
+                 now - c->last_active > idle_duration) {
+        // In `CompactStates()`, it will remove hdl from `active_`
+        to_compact.push_back(c);
+        active_.insert(c->hdl);
+      }
       continue;
     }
 
@@ -160,10 +302,28 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
     connections_.erase(hdl);
   }
 
+  num_streams_->Set(connections_.size());
+  queue_depth_->Set(ready_connections_.size());
+
+  if (config_.idle_seconds > 0) {
+    num_idle_streams_->Set(num_idle_streams);
+    idle_state_bytes_->Set(idle_state_bytes);
+    bytes_per_idle_stream_->Set(
+        num_idle_streams ? static_cast<double>(idle_state_bytes) /
+                               num_idle_streams
+                         : 0);
+  }
+  SHERPA_ONNX_TRACE_COUNTER("ready_connections", ready_connections_.size());
+
   if (!ready_connections_.empty()) {
     asio::post(server_->GetWorkContext(), [this]() { Decode(); });
   }
 
+  if (!to_compact.empty()) {
+    asio::post(server_->GetWorkContext(),
+               [this, to_compact]() { CompactStates(to_compact); });
+  }
+
   // Schedule another call
   timer_.expires_after(std::chrono::milliseconds(config_.loop_interval_ms));
 
@@ -172,6 +332,8 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
 }
 
 void OnlineWebsocketDecoder::Decode() {
+  SHERPA_ONNX_TRACE_SCOPE("OnlineWebsocketDecoder::Decode");
+
   std::unique_lock<std::mutex> lock(mutex_);
   if (ready_connections_.empty()) {
     // There are no connections that are ready for decoding,
@@ -190,6 +352,9 @@ void OnlineWebsocketDecoder::Decode() {
     s_vec.push_back(c->s.get());
   }
 
+  queue_depth_->Set(ready_connections_.size());
+  SHERPA_ONNX_TRACE_COUNTER("ready_connections", ready_connections_.size());
+
   if (!ready_connections_.empty()) {
     // there are too many ready connections but this thread can only handle
     // max_batch_size connections at a time, so we schedule another call
@@ -201,8 +366,13 @@ void OnlineWebsocketDecoder::Decode() {
   recognizer_->DecodeStreams(s_vec.data(), s_vec.size());
   lock.lock();
 
+  auto now = std::chrono::steady_clock::now();
   for (auto c : c_vec) {
-    auto result = recognizer_->GetResult(c->s.get());
+    c->last_active = now;
+
+    auto result = config_.delta_results
+                      ? recognizer_->GetDeltaResult(c->s.get())
+                      : recognizer_->GetResult(c->s.get());
     if (recognizer_->IsEndpoint(c->s.get())) {
       result.is_final = true;
       recognizer_->Reset(c->s.get());
@@ -212,14 +382,38 @@ void OnlineWebsocketDecoder::Decode() {
       result.is_final = true;
     }
 
+    std::string str;
+    if (config_.delta_results) {
+      str = result.AsDeltaJsonString(c->last_result);
+      c->last_result = std::move(result);
+    } else {
+      str = result.AsJsonString();
+    }
+
     asio::post(server_->GetConnectionContext(),
-               [this, hdl = c->hdl, str = result.AsJsonString()]() {
+               [this, hdl = c->hdl, str = std::move(str)]() {
                  server_->Send(hdl, str);
                });
     active_.erase(c->hdl);
   }
 }
 
+void OnlineWebsocketDecoder::CompactStates(
+    const std::vector<std::shared_ptr<Connection>> &c_vec) {
+  SHERPA_ONNX_TRACE_SCOPE_N("OnlineWebsocketDecoder::CompactStates",
+                            c_vec.size());
+
+  // The streams are in active_, so no other threads are using their states
+  for (auto &c : c_vec) {
+    c->s->CompactStates(config_.idle_fp16, config_.idle_spill_dir);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &c : c_vec) {
+    active_.erase(c->hdl);
+  }
+}
+
 OnlineWebsocketServer::OnlineWebsocketServer(
     asio::io_context &io_conn, asio::io_context &io_work,
     const OnlineWebsocketServerConfig &config)
@@ -231,8 +425,21 @@ OnlineWebsocketServer::OnlineWebsocketServer(
       decoder_(this) {
   SetupLog();
 
+  num_connections_ = MetricsRegistry::Global().GetGauge(
+      "sherpa_onnx_online_server_connections",
+      "Number of active websocket connections");
+
+  if (config_.enable_metrics) {
+    MetricsRegistry::SetEnabled(true);
+  }
+
   server_.init_asio(&io_conn_);
 
+  server_.set_http_handler([this](connection_hdl hdl) { OnHttp(hdl); });
+
+  server_.set_validate_handler(
+      [this](connection_hdl hdl) { return OnValidate(hdl); });
+
   server_.set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
 
   server_.set_close_handler([this](connection_hdl hdl) { OnClose(hdl); });
@@ -247,25 +454,28 @@ void OnlineWebsocketServer::Run(uint16_t port) {
   server_.set_reuse_addr(true);
   server_.listen(asio::ip::tcp::v4(), port);
   server_.start_accept();
-  auto recognizer_config = config_.decoder_config.recognizer_config;
-  int32_t warm_up = recognizer_config.model_config.warm_up;
-  const std::string &model_type = recognizer_config.model_config.model_type;
-  if (0 < warm_up && warm_up < 100) {
-    if (model_type == "zipformer2") {
+
+  // The warm-up runs in a work thread so that GET /ready is answered while
+  // it is running
+  asio::post(io_work_, [this]() {
+    int32_t warm_up =
+        config_.decoder_config.recognizer_config.model_config.warm_up;
+    if (warm_up > 0) {
+      auto start = std::chrono::steady_clock::now();
       decoder_.Warmup();
-      SHERPA_ONNX_LOGE("Warm up completed : %d times.", warm_up);
+      float elapsed_seconds =
+          std::chrono::duration<float>(std::chrono::steady_clock::now() -
+                                       start)
+              .count();
+      SHERPA_ONNX_LOGE("Warm up completed : %d times in %.3f s.", warm_up,
+                       elapsed_seconds);
     } else {
-      SHERPA_ONNX_LOGE("Only Zipformer2 has warmup support for now.");
-      SHERPA_ONNX_LOGE("Given: %s", model_type.c_str());
-      exit(0);
+      SHERPA_ONNX_LOGE("Starting without warmup!");
     }
-  } else if (warm_up == 0) {
-    SHERPA_ONNX_LOGE("Starting without warmup!");
-  } else {
-    SHERPA_ONNX_LOGE("Invalid Warm up Value!. Expected 0 < warm_up < 100");
-    exit(0);
-  }
-  decoder_.Run();
+
+    ready_ = true;
+    decoder_.Run();
+  });
 }
 
 void OnlineWebsocketServer::SetupLog() {
@@ -290,9 +500,23 @@ void OnlineWebsocketServer::Send(connection_hdl hdl, const std::string &text) {
   }
 }
 
+void OnlineWebsocketServer::SendBinary(connection_hdl hdl,
+                                       const std::string &data) {
+  websocketpp::lib::error_code ec;
+  if (!Contains(hdl)) {
+    return;
+  }
+
+  server_.send(hdl, data, websocketpp::frame::opcode::binary, ec);
+  if (ec) {
+    server_.get_alog().write(websocketpp::log::alevel::app, ec.message());
+  }
+}
+
 void OnlineWebsocketServer::OnOpen(connection_hdl hdl) {
   std::lock_guard<std::mutex> lock(mutex_);
   connections_.insert(hdl);
+  num_connections_->Set(connections_.size());
 
   std::ostringstream os;
   os << "New connection: "
@@ -304,11 +528,47 @@ void OnlineWebsocketServer::OnOpen(connection_hdl hdl) {
 void OnlineWebsocketServer::OnClose(connection_hdl hdl) {
   std::lock_guard<std::mutex> lock(mutex_);
   connections_.erase(hdl);
+  num_connections_->Set(connections_.size());
 
   SHERPA_ONNX_LOG(INFO) << "Number of active connections: "
                         << connections_.size() << "\n";
 }
 
+bool OnlineWebsocketServer::OnValidate(connection_hdl hdl) {
+  if (ready_) {
+    return true;
+  }
+
+  auto con = server_.get_con_from_hdl(hdl);
+  con->set_status(websocketpp::http::status_code::service_unavailable);
+  return false;
+}
+
+void OnlineWebsocketServer::OnHttp(connection_hdl hdl) {
+  auto con = server_.get_con_from_hdl(hdl);
+
+  if (con->get_resource() == "/ready") {
+    if (ready_) {
+      con->set_status(websocketpp::http::status_code::ok);
+      con->set_body("Ready\n");
+    } else {
+      con->set_status(websocketpp::http::status_code::service_unavailable);
+      con->set_body("Warming up\n");
+    }
+    return;
+  }
+
+  if (!config_.enable_metrics || con->get_resource() != "/metrics") {
+    con->set_status(websocketpp::http::status_code::not_found);
+    con->set_body("Not found. Please use a websocket client\n");
+    return;
+  }
+
+  con->set_status(websocketpp::http::status_code::ok);
+  con->append_header("Content-Type", "text/plain; version=0.0.4");
+  con->set_body(MetricsRegistry::Global().ToText());
+}
+
 bool OnlineWebsocketServer::Contains(connection_hdl hdl) const {
   std::lock_guard<std::mutex> lock(mutex_);
   return connections_.count(hdl);
@@ -324,12 +584,63 @@ void OnlineWebsocketServer::OnMessage(connection_hdl hdl,
     case websocketpp::frame::opcode::text:
       if (payload == "Done") {
         asio::post(io_work_, [this, c]() { decoder_.InputFinished(c); });
+      } else if (payload == "SNAPSHOT") {
+        asio::post(io_work_, [this, c]() { decoder_.Snapshot(c); });
+      } else if (payload == "RESTORE") {
+        c->expect_snapshot = true;
+      } else {
+        AudioSampleFormat format;
+        int32_t sample_rate = 0;
+        if (ParseAudioFormatMessage(payload, &format, &sample_rate)) {
+          std::lock_guard<std::mutex> lock(c->mutex);
+          c->format = format;
+          c->sample_rate = sample_rate;
+          c->num_partial_bytes = 0;
+        } else {
+          SHERPA_ONNX_LOG(WARNING) << "Ignore invalid payload: " << payload;
+        }
       }
       break;
     case websocketpp::frame::opcode::binary: {
-      auto p = reinterpret_cast<const float *>(payload.data());
-      int32_t num_samples = payload.size() / sizeof(float);
-      std::vector<float> samples(p, p + num_samples);
+      if (c->expect_snapshot) {
+        c->expect_snapshot = false;
+        // Do not parse snapshots from clients unless they are enabled
+        if (!config_.decoder_config.recognizer_config.feat_config
+                 .enable_snapshots) {
+          SHERPA_ONNX_LOG(WARNING) << "Snapshots are disabled. Ignore RESTORE";
+          Send(hdl, "Failed to restore!");
+          break;
+        }
+
+        asio::post(io_work_, [this, c, snapshot = payload]() mutable {
+          decoder_.Restore(c, std::move(snapshot));
+        });
+        break;
+      }
+
+      auto p = reinterpret_cast<const uint8_t *>(payload.data());
+      int32_t n = static_cast<int32_t>(payload.size());
+      int32_t bytes_per_sample = BytesPerSample(c->format);
+
+      // Prepend the incomplete sample from the previous message
+      std::vector<uint8_t> buf;
+      if (c->num_partial_bytes > 0) {
+        buf.reserve(c->num_partial_bytes + n);
+        buf.insert(buf.end(), c->partial_sample,
+                   c->partial_sample + c->num_partial_bytes);
+        buf.insert(buf.end(), p, p + n);
+        p = buf.data();
+        n = static_cast<int32_t>(buf.size());
+      }
+
+      int32_t num_samples = n / bytes_per_sample;
+      c->num_partial_bytes = n - num_samples * bytes_per_sample;
+      std::copy(p + num_samples * bytes_per_sample, p + n, c->partial_sample);
+
+      // Convert directly into the buffer that is passed to the
+      // feature extractor
+      std::vector<float> samples(num_samples);
+      DecodeAudioSamples(c->format, p, num_samples, samples.data());
 
       {
         std::lock_guard<std::mutex> lock(c->mutex);
@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <atomic>
 #include <deque>
 #include <fstream>
 #include <map>
@@ -17,6 +18,8 @@
 #include <vector>
 
 #include "asio.hpp"
+#include "sherpa-onnx/csrc/audio-sample-format.h"
+#include "sherpa-onnx/csrc/metrics.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/parse-options.h"
@@ -36,7 +39,8 @@ struct Connection {
   // set it to true when InputFinished() is called
   bool eof = false;
 
-  // The last time we received a message from the client
+  // The last time the stream was decoded. It is used to find idle streams
+  // whose states can be compacted.
   // TODO(fangjun): Use it to disconnect from a client if it is inactive
   // for a specified time.
   std::chrono::steady_clock::time_point last_active;
@@ -49,6 +53,26 @@ struct Connection {
   // and invoke work threads to compute features
   std::deque<std::vector<float>> samples;
 
+  // Format and sample rate of the samples sent by the client.
+  // They can be changed by an AUDIO_FORMAT text message before the
+  // client sends any samples. sample_rate is 0 if the client did not
+  // specify it, in which case we use the sample rate of the recognizer.
+  AudioSampleFormat format = AudioSampleFormat::kFloat32;
+  int32_t sample_rate = 0;
+
+  // A message may end in the middle of a sample. We save the bytes
+  // of the incomplete sample here. Accessed only by the I/O threads.
+  uint8_t partial_sample[sizeof(float)];
+  int32_t num_partial_bytes = 0;
+
+  // Set by a RESTORE text message. The next binary message is a snapshot
+  // of a stream instead of audio samples. Accessed only by the I/O threads.
+  bool expect_snapshot = false;
+
+  // The last result sent to the client. Used only with --delta-results for
+  // models that do not build results incrementally
+  OnlineRecognizerResult last_result;
+
   Connection() = default;
   Connection(connection_hdl hdl, std::shared_ptr<OnlineStream> s)
       : hdl(hdl), s(s), last_active(std::chrono::steady_clock::now()) {}
@@ -64,6 +88,23 @@ struct OnlineWebsocketDecoderConfig {
 
   float end_tail_padding = 0.8;
 
+  // If positive, the model states of a stream that has not been decoded
+  // for this number of seconds are compacted to save memory.
+  // See OnlineStream::CompactStates()
+  float idle_seconds = 0;
+
+  // Used only when idle_seconds > 0. True to store the states of idle
+  // streams in half precision.
+  bool idle_fp16 = true;
+
+  // Used only when idle_seconds > 0. If not empty, the states of idle
+  // streams are spilled to memory-mapped files in this directory.
+  std::string idle_spill_dir;
+
+  // True to send only what has changed since the previous result of a
+  // stream. See OnlineRecognizerResult::AsDeltaJsonString()
+  bool delta_results = false;
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -85,6 +126,14 @@ class OnlineWebsocketDecoder {
   // signal that there will be no more audio samples for a stream
   void InputFinished(std::shared_ptr<Connection> c);
 
+  // Send a snapshot of the stream to the client in a binary message.
+  // See OnlineStream::Serialize()
+  void Snapshot(std::shared_ptr<Connection> c);
+
+  // Replace the stream of a connection with the one restored from the
+  // given snapshot
+  void Restore(std::shared_ptr<Connection> c, std::string snapshot);
+
   void Warmup() const;
 
   void Run();
@@ -96,6 +145,15 @@ class OnlineWebsocketDecoder {
    */
   void Decode();
 
+  // Compact the states of idle streams. It is called by one of the worker
+  // threads.
+  void CompactStates(const std::vector<std::shared_ptr<Connection>> &c_vec);
+
+  // Mark the stream of c as active so that no other threads use it.
+  // Return false if it is being decoded.
+  bool TryAcquire(std::shared_ptr<Connection> c);
+  void Release(std::shared_ptr<Connection> c);
+
  private:
   OnlineWebsocketServer *server_;  // not owned
   std::unique_ptr<OnlineRecognizer> recognizer_;
@@ -116,6 +174,13 @@ class OnlineWebsocketDecoder {
   // If we are decoding a stream, we put it in the active_ set so that
   // only one thread can decode a stream at a time.
   std::set<connection_hdl, std::owner_less<connection_hdl>> active_;
+
+  Gauge *num_streams_;  // size of connections_
+  Gauge *queue_depth_;  // size of ready_connections_
+
+  Gauge *num_idle_streams_;  // streams whose states are compacted
+  Gauge *idle_state_bytes_;  // memory used by the states of idle streams
+  Gauge *bytes_per_idle_stream_;
 };
 
 struct OnlineWebsocketServerConfig {
@@ -123,6 +188,10 @@ struct OnlineWebsocketServerConfig {
 
   std::string log_file = "./log.txt";
 
+  // If true, metrics are exported in the Prometheus text format
+  // at http://<server-ip>:<port>/metrics
+  bool enable_metrics = false;
+
   void Register(sherpa_onnx::ParseOptions *po);
   void Validate() const;
 };
@@ -142,11 +211,20 @@ class OnlineWebsocketServer {
 
   void Send(connection_hdl hdl, const std::string &text);
 
+  void SendBinary(connection_hdl hdl, const std::string &data);
+
   bool Contains(connection_hdl hdl) const;
 
+  // True after the warm-up. Before that, websocket connections are
+  // refused and GET /ready returns 503.
+  bool IsReady() const { return ready_; }
+
  private:
   void SetupLog();
 
+  // It is invoked before a websocket handshake is accepted
+  bool OnValidate(connection_hdl hdl);
+
   // When a websocket client is connected, it will invoke this method
   // (Not for HTTP)
   void OnOpen(connection_hdl hdl);
@@ -154,6 +232,25 @@ class OnlineWebsocketServer {
   // When a websocket client is disconnected, it will invoke this method
   void OnClose(connection_hdl hdl);
 
+  // For plain HTTP requests. It serves GET /metrics and GET /ready
+  void OnHttp(connection_hdl hdl);
+
+  // The client sends audio samples in binary messages and a text message
+  // "Done" after the last sample. Samples are float32 by default. To use a
+  // more compact format, the client sends a text message
+  //
+  //   AUDIO_FORMAT <format> <sample_rate>
+  //
+  // before any samples, where format is one of float32, int16, mulaw, alaw.
+  // See also audio-sample-format.h
+  //
+  // With --enable-snapshots, a text message SNAPSHOT asks the server to
+  // reply with a snapshot of the decoding state in a binary message. To
+  // resume from a snapshot, e.g., after reconnecting to another server,
+  // the client sends a text message RESTORE followed by the snapshot in a
+  // binary message. The server replies with "Restored!" or "Failed to
+  // restore!" and the client should wait for it before sending more
+  // samples.
   void OnMessage(connection_hdl hdl, server::message_ptr msg);
 
   // Close a websocket connection with given code and reason
@@ -174,6 +271,10 @@ class OnlineWebsocketServer {
   mutable std::mutex mutex_;
 
   std::set<connection_hdl, std::owner_less<connection_hdl>> connections_;
+
+  Gauge *num_connections_;
+
+  std::atomic<bool> ready_{false};
 };
 
 }  // namespace sherpa_onnx
@@ -2,10 +2,16 @@
 //
 // Copyright (c)  2022-2023  Xiaomi Corporation
 
+#include <csignal>
+#include <string>
+
 #include "asio.hpp"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-recognizer-tuner.h"
 #include "sherpa-onnx/csrc/online-websocket-server-impl.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/shared-runtime.h"
+#include "sherpa-onnx/csrc/trace.h"
 
 static constexpr const char *kUsageMessage = R"(
 Automatic speech recognition with sherpa-onnx using websocket.
@@ -25,6 +31,34 @@ Usage:
   --max-batch-size=5 \
   --loop-interval-ms=10
 
+Use --enable-metrics=1 to export per-stage latencies (p50/p99), batch
+sizes, queue depths and the real-time factor in the Prometheus text
+format:
+
+  curl http://127.0.0.1:6006/metrics
+
+Use --warm-up=2 to decode synthetic audio with batches of 1, 2, 4, ...,
+--max-batch-size streams before serving requests. Websocket
+connections are refused with 503 until the server is ready. Load
+balancers can poll:
+
+  curl http://127.0.0.1:6006/ready
+
+Use --trace-file=./trace.json to record a trace that can be viewed with
+https://ui.perfetto.dev. The trace is completed when the server receives
+SIGINT (Ctrl+C) or SIGTERM.
+
+Use --use-shared-runtime=true to run the model with one intra-op thread
+pool of onnxruntime for the whole process instead of its own pools. See
+--ort-intra-op-num-threads and --ort-cpu-affinity.
+
+Use --tuning-profile=./tuning-profile.txt to take the number of threads,
+the graph optimization level and --max-batch-size from a profile created
+by ./bin/sherpa-onnx-online-tuner for the given model on this CPU. With
+--auto-tune=1, the server tunes itself and saves the profile if the file
+has no entry for them yet. It overrides --num-threads and
+--max-batch-size.
+
 Please refer to
 https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
 for a list of pre-trained models to download.
@@ -53,6 +87,27 @@ int32_t main(int32_t argc, char *argv[]) {
 
   po.Register("port", &port, "The port on which the server will listen.");
 
+  std::string trace_file;
+  po.Register("trace-file", &trace_file,
+              "If not empty, write a Chrome trace of the decoding to this "
+              "file");
+
+  std::string tuning_profile;
+  po.Register("tuning-profile", &tuning_profile,
+              "If not empty, use the tuned parameters for the model on this "
+              "CPU from this file. See also --auto-tune");
+
+  bool auto_tune = false;
+  po.Register("auto-tune", &auto_tune,
+              "If true and --tuning-profile has no entry for the model on "
+              "this CPU, tune at startup and save the result to it");
+
+  sherpa_onnx::OnlineRecognizerTunerConfig tuner_config;
+  tuner_config.Register(&po);
+
+  sherpa_onnx::SharedRuntimeConfig shared_runtime_config;
+  shared_runtime_config.Register(&po);
+
   config.Register(&po);
 
   if (argc == 1) {
@@ -70,9 +125,49 @@ int32_t main(int32_t argc, char *argv[]) {
 
   config.Validate();
 
+  // It has to be created before any model
+  if (config.decoder_config.recognizer_config.model_config.use_shared_runtime &&
+      !sherpa_onnx::InitSharedRuntime(shared_runtime_config)) {
+    exit(EXIT_FAILURE);
+  }
+
+  if (auto_tune && tuning_profile.empty()) {
+    SHERPA_ONNX_LOGE("Please provide --tuning-profile for --auto-tune");
+    exit(EXIT_FAILURE);
+  }
+
+  if (!tuning_profile.empty()) {
+    if (!tuner_config.Validate()) {
+      exit(EXIT_FAILURE);
+    }
+
+    sherpa_onnx::TuningProfile profile;
+    if (sherpa_onnx::LoadOrTuneOnlineRecognizer(
+            tuning_profile, auto_tune, tuner_config,
+            &config.decoder_config.recognizer_config, &profile)) {
+      config.decoder_config.max_batch_size = profile.max_batch_size;
+    } else {
+      SHERPA_ONNX_LOGE(
+          "No profile for the model on this CPU in '%s'. Use the given "
+          "options",
+          tuning_profile.c_str());
+    }
+  }
+
   asio::io_context io_conn;  // for network connections
   asio::io_context io_work;  // for neural network and decoding
 
+  asio::signal_set signals(io_conn);
+  if (!trace_file.empty() &&
+      sherpa_onnx::Tracer::Global().Start(trace_file)) {
+    signals.add(SIGINT);
+    signals.add(SIGTERM);
+    signals.async_wait([](const asio::error_code & /*ec*/, int32_t /*sig*/) {
+      sherpa_onnx::Tracer::Global().Stop();
+      exit(EXIT_SUCCESS);
+    });
+  }
+
   sherpa_onnx::OnlineWebsocketServer server(io_conn, io_work, config);
   server.Run(port);
 
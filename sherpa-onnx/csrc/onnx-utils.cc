@@ -323,6 +323,28 @@ Ort::Value Repeat(OrtAllocator *allocator, Ort::Value *cur_encoder_out,
   return ans;
 }
 
+void ScatterRows(const Ort::Value *src, const std::vector<int32_t> &rows,
+                 Ort::Value *dst) {
+  std::vector<int64_t> src_shape = src->GetTensorTypeAndShapeInfo().GetShape();
+  std::vector<int64_t> dst_shape = dst->GetTensorTypeAndShapeInfo().GetShape();
+
+  if (src_shape.size() != 2 || dst_shape.size() != 2 ||
+      src_shape[0] != static_cast<int64_t>(rows.size()) ||
+      src_shape[1] != dst_shape[1]) {
+    SHERPA_ONNX_LOGE("ScatterRows: shape mismatch");
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  int64_t num_cols = src_shape[1];
+  const float *p_src = src->GetTensorData<float>();
+  float *p_dst = dst->GetTensorMutableData<float>();
+
+  for (auto r : rows) {
+    std::copy(p_src, p_src + num_cols, p_dst + r * num_cols);
+    p_src += num_cols;
+  }
+}
+
 CopyableOrtValue::CopyableOrtValue(const CopyableOrtValue &other) {
   *this = other;
 }
@@ -96,6 +96,16 @@ void Fill(Ort::Value *tensor, T value) {
 Ort::Value Repeat(OrtAllocator *allocator, Ort::Value *cur_encoder_out,
                   const std::vector<int32_t> &hyps_num_split);
 
+/** Copy row i of src to row rows[i] of dst.
+ *
+ * @param src A 2-D float tensor of shape (rows.size(), C)
+ * @param rows Row indexes into dst
+ * @param dst A 2-D float tensor of shape (N, C). Rows not in `rows`
+ *            are not changed.
+ */
+void ScatterRows(const Ort::Value *src, const std::vector<int32_t> &rows,
+                 Ort::Value *dst);
+
 struct CopyableOrtValue {
   Ort::Value value{nullptr};
 
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/session.h"
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -12,6 +13,7 @@
 #include <sstream>
 
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/model-cache.h"
 #include "sherpa-onnx/csrc/provider.h"
 #include "sherpa-onnx/csrc/offline-tts-model-config.h"
 #if defined(__APPLE__)
@@ -28,6 +30,13 @@
 
 namespace sherpa_onnx {
 
+// Entries that GetSessionOptionsImpl() adds to the config of a session to
+// tell CreateSession() how the optimized graph can be cached.
+// onnxruntime ignores keys it does not know.
+static constexpr const char *kCacheableKey = "sherpa_onnx.cacheable";
+static constexpr const char *kGraphOptimizationLevelKey =
+    "sherpa_onnx.graph_optimization_level";
+
 static void OrtStatusFailure(OrtStatus *status, const char *s) {
   const auto &api = Ort::GetApi();
   const char *msg = api.GetErrorMessage(status);
@@ -38,8 +47,8 @@ static void OrtStatusFailure(OrtStatus *status, const char *s) {
   api.ReleaseStatus(status);
 }
 
-// Explicit specialization for OfflineTtsModelConfig
-Ort::SessionOptions GetSessionOptions(const OfflineTtsModelConfig &config) {
+static Ort::SessionOptions GetTtsSessionOptions(
+    const OfflineTtsModelConfig &config) {
   SHERPA_ONNX_LOGE("GetSessionOptions for OfflineTtsModelConfig: %s", config.ToString().c_str());
   
   // If provider is "qnn" and we have QNN configuration, use provider_config
@@ -59,6 +68,15 @@ Ort::SessionOptions GetSessionOptions(const OfflineTtsModelConfig &config) {
   return GetSessionOptionsImpl(config.num_threads, config.provider);
 }
 
+// Explicit specialization for OfflineTtsModelConfig
+Ort::SessionOptions GetSessionOptions(const OfflineTtsModelConfig &config) {
+  Ort::SessionOptions sess_opts = GetTtsSessionOptions(config);
+  if (config.use_shared_runtime) {
+    UseSharedRuntime(&sess_opts);
+  }
+  return sess_opts;
+}
+
 Ort::SessionOptions GetSessionOptionsImpl(
     int32_t num_threads, const std::string &provider_str,
     const ProviderConfig *provider_config /*= nullptr*/) {
@@ -82,7 +100,10 @@ Ort::SessionOptions GetSessionOptionsImpl(
 
   switch (p) {
     case Provider::kCPU:
-      break;  // nothing to do for the CPU provider
+      // Graphs optimized for other providers contain nodes assigned to
+      // them, so only models that run on CPU are cached
+      sess_opts.AddConfigEntry(kCacheableKey, "1");
+      break;
     case Provider::kXnnpack: {
 #if ORT_API_VERSION >= 12
       if (std::find(available_providers.begin(), available_providers.end(),
@@ -357,10 +378,34 @@ Ort::SessionOptions GetSessionOptionsImpl(
   return sess_opts;
 }
 
+void SetGraphOptimizationLevel(const std::string &level,
+                               Ort::SessionOptions *sess_opts) {
+  if (level.empty()) {
+    return;
+  }
+
+  GraphOptimizationLevel l = ORT_ENABLE_ALL;
+  if (level == "disable") {
+    l = ORT_DISABLE_ALL;
+  } else if (level == "basic") {
+    l = ORT_ENABLE_BASIC;
+  } else if (level == "extended") {
+    l = ORT_ENABLE_EXTENDED;
+  }
+
+  sess_opts->SetGraphOptimizationLevel(l);
+  sess_opts->AddConfigEntry(kGraphOptimizationLevelKey, level.c_str());
+}
+
 Ort::SessionOptions GetSessionOptions(const OnlineModelConfig &config) {
-  return GetSessionOptionsImpl(config.num_threads,
-                               config.provider_config.provider,
-                               &config.provider_config);
+  Ort::SessionOptions sess_opts = GetSessionOptionsImpl(
+      config.num_threads, config.provider_config.provider,
+      &config.provider_config);
+  SetGraphOptimizationLevel(config.graph_optimization_level, &sess_opts);
+  if (config.use_shared_runtime) {
+    UseSharedRuntime(&sess_opts);
+  }
+  return sess_opts;
 }
 
 Ort::SessionOptions GetSessionOptions(const OnlineModelConfig &config,
@@ -369,22 +414,37 @@ Ort::SessionOptions GetSessionOptions(const OnlineModelConfig &config,
     Transducer models : Only encoder will run with tensorrt,
                         decoder and joiner will run with cuda
   */
-  if (config.provider_config.provider == "trt" &&
+  std::string provider = config.provider_config.provider;
+  if (provider == "trt" &&
       (model_type == "decoder" || model_type == "joiner")) {
-    return GetSessionOptionsImpl(config.num_threads, "cuda",
-                                 &config.provider_config);
+    provider = "cuda";
+  }
+
+  Ort::SessionOptions sess_opts = GetSessionOptionsImpl(
+      config.num_threads, provider, &config.provider_config);
+  SetGraphOptimizationLevel(config.graph_optimization_level, &sess_opts);
+  if (config.use_shared_runtime) {
+    UseSharedRuntime(&sess_opts);
   }
-  return GetSessionOptionsImpl(config.num_threads,
-                               config.provider_config.provider,
-                               &config.provider_config);
+  return sess_opts;
 }
 
 Ort::SessionOptions GetSessionOptions(const OfflineLMConfig &config) {
-  return GetSessionOptionsImpl(config.lm_num_threads, config.lm_provider);
+  Ort::SessionOptions sess_opts =
+      GetSessionOptionsImpl(config.lm_num_threads, config.lm_provider);
+  if (config.use_shared_runtime) {
+    UseSharedRuntime(&sess_opts);
+  }
+  return sess_opts;
 }
 
 Ort::SessionOptions GetSessionOptions(const OnlineLMConfig &config) {
-  return GetSessionOptionsImpl(config.lm_num_threads, config.lm_provider);
+  Ort::SessionOptions sess_opts =
+      GetSessionOptionsImpl(config.lm_num_threads, config.lm_provider);
+  if (config.use_shared_runtime) {
+    UseSharedRuntime(&sess_opts);
+  }
+  return sess_opts;
 }
 
 Ort::SessionOptions GetSessionOptions(int32_t num_threads,
@@ -392,4 +452,25 @@ Ort::SessionOptions GetSessionOptions(int32_t num_threads,
   return GetSessionOptionsImpl(num_threads, provider_str);
 }
 
+std::unique_ptr<Ort::Session> CreateSession(
+    const Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts) {
+  std::string dir = GetModelCacheDir();
+
+#if ORT_API_VERSION >= 14
+  if (!dir.empty() && sess_opts.HasConfigEntry(kCacheableKey)) {
+    std::string level;
+    if (sess_opts.HasConfigEntry(kGraphOptimizationLevelKey)) {
+      level = sess_opts.GetConfigEntry(kGraphOptimizationLevelKey);
+    }
+
+    return CreateCachedSession(env, model_data, model_data_length, sess_opts,
+                               dir, level);
+  }
+#endif
+
+  return std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                        sess_opts);
+}
+
 }  // namespace sherpa_onnx
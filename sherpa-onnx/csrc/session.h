@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_SESSION_H_
 #define SHERPA_ONNX_CSRC_SESSION_H_
 
+#include <memory>
 #include <string>
 #include <type_traits>
 
@@ -12,6 +13,7 @@
 #include "sherpa-onnx/csrc/offline-lm-config.h"
 #include "sherpa-onnx/csrc/online-lm-config.h"
 #include "sherpa-onnx/csrc/online-model-config.h"
+#include "sherpa-onnx/csrc/shared-runtime.h"
 
 // Forward declaration
 namespace sherpa_onnx {
@@ -35,9 +37,25 @@ Ort::SessionOptions GetSessionOptions(const OnlineModelConfig &config,
 Ort::SessionOptions GetSessionOptions(int32_t num_threads,
                                       const std::string &provider_str);
 
+// level is empty to keep the default of onnxruntime, or one of disable,
+// basic, extended, all
+void SetGraphOptimizationLevel(const std::string &level,
+                               Ort::SessionOptions *sess_opts);
+
 // Explicit specialization for OfflineTtsModelConfig
 Ort::SessionOptions GetSessionOptions(const OfflineTtsModelConfig &config);
 
+/** Create a session for a model in memory.
+ *
+ * If the model cache is enabled, see model-cache.h, and sess_opts is from
+ * GetSessionOptions() with the cpu provider, the optimized graph is loaded
+ * from or saved to the cache. Otherwise, it is the same as constructing an
+ * Ort::Session directly.
+ */
+std::unique_ptr<Ort::Session> CreateSession(
+    const Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts);
+
 // SFINAE helper to detect if ProviderConfig and IsEmpty() exist
 template <typename T>
 class HasProviderConfig {
@@ -52,15 +70,45 @@ class HasProviderConfig {
     static constexpr bool value = type::value;
 };
 
+// SFINAE helper to detect if a config has use_shared_runtime
+template <typename T>
+class HasUseSharedRuntime {
+ private:
+  template <typename C>
+  static auto test(int)
+      -> decltype(std::declval<C>().use_shared_runtime, std::true_type());
+  template <typename C>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+template <typename T>
+typename std::enable_if<HasUseSharedRuntime<T>::value>::type
+MaybeUseSharedRuntime(const T &config, Ort::SessionOptions *sess_opts) {
+  if (config.use_shared_runtime) {
+    UseSharedRuntime(sess_opts);
+  }
+}
+
+template <typename T>
+typename std::enable_if<!HasUseSharedRuntime<T>::value>::type
+MaybeUseSharedRuntime(const T & /*config*/,
+                      Ort::SessionOptions * /*sess_opts*/) {}
+
 // Template specialization for configs with provider_config field and IsEmpty method
 template <typename T>
 typename std::enable_if<HasProviderConfig<T>::value, Ort::SessionOptions>::type
 GetSessionOptions(const T &config) {
   SHERPA_ONNX_LOGE("GetSessionOptions (with provider config): %s", config.ToString().c_str());
-  if (config.provider_config.IsEmpty()) {
-    return GetSessionOptionsImpl(config.num_threads, config.provider);
-  }
-  return GetSessionOptionsImpl(config.num_threads, config.provider, &config.provider_config);
+  Ort::SessionOptions sess_opts =
+      config.provider_config.IsEmpty()
+          ? GetSessionOptionsImpl(config.num_threads, config.provider)
+          : GetSessionOptionsImpl(config.num_threads, config.provider,
+                                  &config.provider_config);
+  MaybeUseSharedRuntime(config, &sess_opts);
+  return sess_opts;
 }
 
 // Template specialization for configs without provider_config field
@@ -68,7 +116,10 @@ template <typename T>
 typename std::enable_if<!HasProviderConfig<T>::value, Ort::SessionOptions>::type
 GetSessionOptions(const T &config) {
   SHERPA_ONNX_LOGE("GetSessionOptions (without provider config): %s", config.ToString().c_str());
-  return GetSessionOptionsImpl(config.num_threads, config.provider);
+  Ort::SessionOptions sess_opts =
+      GetSessionOptionsImpl(config.num_threads, config.provider);
+  MaybeUseSharedRuntime(config, &sess_opts);
+  return sess_opts;
 }
 
 }  // namespace sherpa_onnx
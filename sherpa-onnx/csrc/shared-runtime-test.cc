@@ -0,0 +1,38 @@
+// sherpa-onnx/csrc/shared-runtime-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/shared-runtime.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(SharedRuntime, ParseCpuList) {
+  std::vector<int32_t> cpus;
+  EXPECT_TRUE(ParseCpuList("3", &cpus));
+  EXPECT_EQ(cpus, (std::vector<int32_t>{3}));
+
+  EXPECT_TRUE(ParseCpuList("0-3,8,10-11", &cpus));
+  EXPECT_EQ(cpus, (std::vector<int32_t>{0, 1, 2, 3, 8, 10, 11}));
+
+  EXPECT_FALSE(ParseCpuList("", &cpus));
+  EXPECT_FALSE(ParseCpuList("1,,2", &cpus));
+  EXPECT_FALSE(ParseCpuList("-1", &cpus));
+  EXPECT_FALSE(ParseCpuList("3-1", &cpus));
+  EXPECT_FALSE(ParseCpuList("1-2-3", &cpus));
+  EXPECT_FALSE(ParseCpuList("a", &cpus));
+}
+
+TEST(SharedRuntime, ToOrtThreadAffinity) {
+  // The calling thread is not pinned
+  EXPECT_EQ(ToOrtThreadAffinity({0, 1, 2, 3}, 1), "");
+  EXPECT_EQ(ToOrtThreadAffinity({0, 1, 2, 3}, 4), "2;3;4");
+
+  // CPUs are reused if there are more threads than CPUs
+  EXPECT_EQ(ToOrtThreadAffinity({4, 6}, 4), "7;5;7");
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,233 @@
+// sherpa-onnx/csrc/shared-runtime.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/shared-runtime.h"
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+struct SharedRuntime {
+  std::mutex mutex;
+  std::unique_ptr<Ort::Env> env;
+  SharedRuntimeConfig config;
+};
+
+SharedRuntime &GetSharedRuntime() {
+  // Never destroyed so that it outlives the sessions in static objects
+  static SharedRuntime *runtime = new SharedRuntime;
+  return *runtime;
+}
+
+}  // namespace
+
+void SharedRuntimeConfig::Register(ParseOptions *po) {
+  po->Register("ort-intra-op-num-threads", &intra_op_num_threads,
+               "Number of threads of the intra-op pool shared by models "
+               "with --use-shared-runtime. 0 means the number of CPUs of "
+               "--ort-cpu-affinity, or the default of onnxruntime");
+
+  po->Register("ort-inter-op-num-threads", &inter_op_num_threads,
+               "Number of threads of the inter-op pool shared by models "
+               "with --use-shared-runtime");
+
+  po->Register("ort-cpu-affinity", &cpu_affinity,
+               "If not empty, pin the threads of the shared intra-op pool "
+               "to these CPUs, e.g., 0-3,8. CPUs are numbered from 0");
+
+  po->Register("ort-allow-spinning", &allow_spinning,
+               "false to let idle threads of the shared pools sleep instead "
+               "of spinning");
+
+  po->Register("ort-shared-arena", &use_shared_arena,
+               "true to share one CPU arena allocator among the models with "
+               "--use-shared-runtime");
+}
+
+bool SharedRuntimeConfig::Validate() const {
+  if (intra_op_num_threads < 0) {
+    SHERPA_ONNX_LOGE("--ort-intra-op-num-threads should be >= 0. Given: %d",
+                     intra_op_num_threads);
+    return false;
+  }
+
+  if (inter_op_num_threads < 1) {
+    SHERPA_ONNX_LOGE("--ort-inter-op-num-threads should be > 0. Given: %d",
+                     inter_op_num_threads);
+    return false;
+  }
+
+  std::vector<int32_t> cpus;
+  if (!cpu_affinity.empty() && !ParseCpuList(cpu_affinity, &cpus)) {
+    SHERPA_ONNX_LOGE("Invalid --ort-cpu-affinity: '%s'",
+                     cpu_affinity.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+std::string SharedRuntimeConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "SharedRuntimeConfig(";
+  os << "intra_op_num_threads=" << intra_op_num_threads << ", ";
+  os << "inter_op_num_threads=" << inter_op_num_threads << ", ";
+  os << "cpu_affinity=\"" << cpu_affinity << "\", ";
+  os << "allow_spinning=" << (allow_spinning ? "True" : "False") << ", ";
+  os << "use_shared_arena=" << (use_shared_arena ? "True" : "False") << ")";
+
+  return os.str();
+}
+
+bool InitSharedRuntime(const SharedRuntimeConfig &config) {
+  if (!config.Validate()) {
+    return false;
+  }
+
+  auto &runtime = GetSharedRuntime();
+  std::lock_guard<std::mutex> lock(runtime.mutex);
+  if (runtime.env) {
+    SHERPA_ONNX_LOGE("The shared runtime is already initialized");
+    return false;
+  }
+
+  std::vector<int32_t> cpus;
+  if (!config.cpu_affinity.empty()) {
+    ParseCpuList(config.cpu_affinity, &cpus);
+  }
+
+  int32_t intra_op_num_threads = config.intra_op_num_threads;
+  if (intra_op_num_threads == 0) {
+    intra_op_num_threads = static_cast<int32_t>(cpus.size());
+  }
+
+  try {
+    Ort::ThreadingOptions tp;
+    tp.SetGlobalIntraOpNumThreads(intra_op_num_threads);
+    tp.SetGlobalInterOpNumThreads(config.inter_op_num_threads);
+    tp.SetGlobalSpinControl(config.allow_spinning);
+
+    if (!cpus.empty() && intra_op_num_threads > 1) {
+#if ORT_API_VERSION >= 14
+      std::string affinity = ToOrtThreadAffinity(cpus, intra_op_num_threads);
+      Ort::ThrowOnError(Ort::GetApi().SetGlobalIntraOpThreadAffinity(
+          tp, affinity.c_str()));
+#else
+      SHERPA_ONNX_LOGE(
+          "onnxruntime %d does not support thread affinity. Ignore "
+          "--ort-cpu-affinity",
+          static_cast<int32_t>(ORT_API_VERSION));
+#endif
+    }
+
+    auto env = std::make_unique<Ort::Env>(tp, ORT_LOGGING_LEVEL_ERROR,
+                                          "sherpa-onnx");
+
+    if (config.use_shared_arena) {
+      auto memory_info =
+          Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+      // -1 and 0 select the defaults of onnxruntime
+      Ort::ArenaCfg arena_cfg(0, -1, -1, -1);
+      env->CreateAndRegisterAllocator(memory_info, arena_cfg);
+    }
+
+    runtime.env = std::move(env);
+  } catch (const Ort::Exception &e) {
+    SHERPA_ONNX_LOGE("Failed to initialize the shared runtime: %s", e.what());
+    return false;
+  }
+
+  runtime.config = config;
+
+  return true;
+}
+
+bool IsSharedRuntimeInitialized() {
+  auto &runtime = GetSharedRuntime();
+  std::lock_guard<std::mutex> lock(runtime.mutex);
+  return runtime.env != nullptr;
+}
+
+void UseSharedRuntime(Ort::SessionOptions *sess_opts) {
+  auto &runtime = GetSharedRuntime();
+  std::lock_guard<std::mutex> lock(runtime.mutex);
+  if (!runtime.env) {
+    SHERPA_ONNX_LOGE(
+        "InitSharedRuntime() is not called before creating the model. Use "
+        "its own thread pools");
+    return;
+  }
+
+  sess_opts->DisablePerSessionThreads();
+
+  if (runtime.config.use_shared_arena) {
+    sess_opts->AddConfigEntry("session.use_env_allocators", "1");
+  }
+}
+
+bool ParseCpuList(const std::string &s, std::vector<int32_t> *cpus) {
+  cpus->clear();
+
+  std::vector<std::string> ranges;
+  SplitStringToVector(s, ",", false, &ranges);
+  if (ranges.empty()) {
+    return false;
+  }
+
+  for (const auto &r : ranges) {
+    std::vector<std::string> ends;
+    SplitStringToVector(r, "-", false, &ends);
+
+    int32_t first = 0;
+    int32_t last = 0;
+    if (ends.size() == 1) {
+      if (!ConvertStringToInteger(ends[0], &first)) {
+        return false;
+      }
+      last = first;
+    } else if (ends.size() == 2) {
+      if (!ConvertStringToInteger(ends[0], &first) ||
+          !ConvertStringToInteger(ends[1], &last)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+
+    if (first < 0 || last < first) {
+      return false;
+    }
+
+    for (int32_t i = first; i <= last; ++i) {
+      cpus->push_back(i);
+    }
+  }
+
+  return true;
+}
+
+std::string ToOrtThreadAffinity(const std::vector<int32_t> &cpus,
+                                int32_t num_threads) {
+  std::ostringstream os;
+  for (int32_t i = 1; i < num_threads; ++i) {
+    if (i > 1) {
+      os << ';';
+    }
+    os << cpus[i % cpus.size()] + 1;
+  }
+  return os.str();
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,91 @@
+// sherpa-onnx/csrc/shared-runtime.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_SHARED_RUNTIME_H_
+#define SHERPA_ONNX_CSRC_SHARED_RUNTIME_H_
+
+#include <string>
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/parse-options.h"
+
+namespace sherpa_onnx {
+
+/** Options of the process-wide onnxruntime environment.
+ *
+ * By default, each session of onnxruntime has its own thread pools. A
+ * server that loads models of ASR, VAD, punctuation and speaker
+ * identification has one pool per model competing for the same cores.
+ *
+ * The shared runtime has one intra-op and one inter-op thread pool for all
+ * sessions of models whose config sets use_shared_runtime to true.
+ */
+struct SharedRuntimeConfig {
+  // Number of threads of the global intra-op pool, including the thread
+  // that calls Run(). 0 means the number of CPUs in cpu_affinity if it is
+  // not empty, or the default of onnxruntime otherwise
+  int32_t intra_op_num_threads = 0;
+
+  // Number of threads of the global inter-op pool
+  int32_t inter_op_num_threads = 1;
+
+  // If not empty, CPUs to pin the threads of the intra-op pool to, e.g.,
+  // 0-3,8. CPUs are numbered from 0.
+  std::string cpu_affinity;
+
+  // false to let idle threads sleep instead of spinning. It reduces CPU
+  // usage at the cost of some latency
+  bool allow_spinning = true;
+
+  // true to register an arena allocator for CPU memory with the
+  // environment and share it among the sessions
+  bool use_shared_arena = false;
+
+  void Register(ParseOptions *po);
+  bool Validate() const;
+
+  std::string ToString() const;
+};
+
+/** Create the shared onnxruntime environment.
+ *
+ * onnxruntime has only one environment in a process. All Ort::Env objects
+ * refer to the one created first, so this has to be called before any
+ * model is created. Otherwise, the environment has no global thread pools
+ * and sessions that use them fail to load.
+ *
+ * @return Return false if it is already initialized or on error.
+ */
+bool InitSharedRuntime(const SharedRuntimeConfig &config);
+
+bool IsSharedRuntimeInitialized();
+
+/** Make sessions created with sess_opts use the thread pools and, if
+ * enabled, the arena allocator of the shared runtime.
+ *
+ * If InitSharedRuntime() has not been called, sess_opts is not changed and
+ * the session uses its own thread pools.
+ */
+void UseSharedRuntime(Ort::SessionOptions *sess_opts);
+
+/** Parse a list of CPUs such as "0-3,8,10-11".
+ *
+ * @return Return false if s is not a valid list.
+ */
+bool ParseCpuList(const std::string &s, std::vector<int32_t> *cpus);
+
+/** Convert a list of CPUs numbered from 0 to the affinity string of
+ * onnxruntime for a pool of num_threads threads.
+ *
+ * onnxruntime does not pin the calling thread, so it has num_threads - 1
+ * entries separated by ';', with processors numbered from 1. Thread i is
+ * pinned to cpus[i % cpus.size()].
+ */
+std::string ToOrtThreadAffinity(const std::vector<int32_t> &cpus,
+                                int32_t num_threads);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_SHARED_RUNTIME_H_
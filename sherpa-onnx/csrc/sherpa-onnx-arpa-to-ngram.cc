@@ -0,0 +1,59 @@
+// sherpa-onnx/csrc/sherpa-onnx-arpa-to-ngram.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#include <stdio.h>
+
+#include <chrono>  // NOLINT
+#include <string>
+
+#include "sherpa-onnx/csrc/ngram-lm.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Convert an ARPA n-gram LM over token IDs to the binary format of sherpa-onnx.
+
+The words of the ARPA file must be token IDs from tokens.txt, plus <s>,
+</s> and <unk>, e.g., the token-level n-gram LMs of icefall.
+
+The binary format is memory-mapped when loaded, so it loads much faster
+than the ARPA file and uses less memory. Both can be passed to --lm of
+./bin/sherpa-onnx and ./bin/sherpa-onnx-offline with
+--decoding-method=modified_beam_search.
+
+Usage:
+
+./bin/sherpa-onnx-arpa-to-ngram ./2gram.arpa ./2gram.ngram
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  po.Read(argc, argv);
+  if (po.NumArgs() != 2) {
+    fprintf(stderr,
+            "Error: Please provide the input ARPA file and the output "
+            "file.\n\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  std::string arpa = po.GetArg(1);
+  std::string output = po.GetArg(2);
+
+  const auto begin = std::chrono::steady_clock::now();
+
+  sherpa_onnx::NGramLM lm(arpa);
+  lm.Save(output);
+
+  const auto end = std::chrono::steady_clock::now();
+
+  float elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  fprintf(stderr, "Order: %d\n", lm.Order());
+  fprintf(stderr, "Elapsed seconds: %.3f s\n", elapsed_seconds);
+  fprintf(stderr, "Saved to %s\n", output.c_str());
+
+  return 0;
+}
@@ -0,0 +1,1475 @@
+// sherpa-onnx/csrc/sherpa-onnx-bench.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#if defined(_WIN32)
+// clang-format off
+#include <windows.h>
+#include <psapi.h>
+// clang-format on
+#else
+#include <sys/resource.h>
+#endif
+
+#include "sherpa-onnx/csrc/keyword-spotter.h"
+#include "sherpa-onnx/csrc/metrics.h"
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/resample.h"
+#include "sherpa-onnx/csrc/shared-runtime.h"
+#include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+#if SHERPA_ONNX_ENABLE_TTS
+#include "sherpa-onnx/csrc/offline-tts.h"
+#endif
+
+#if SHERPA_ONNX_ENABLE_SPEAKER_DIARIZATION
+#include "sherpa-onnx/csrc/offline-speaker-diarization.h"
+#endif
+
+// Count the allocations made through operator new in this process.
+// Memory allocated by onnxruntime's own arena is not included.
+static std::atomic<int64_t> g_num_allocations{0};
+static std::atomic<int64_t> g_allocated_bytes{0};
+
+void *operator new(std::size_t n) {
+  g_num_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+  if (void *p = malloc(n ? n : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { free(p); }
+
+namespace sherpa_onnx {
+
+namespace {
+
+const char *kUsageMessage = R"usage(
+Benchmark sherpa-onnx on CPU.
+
+It runs one task with generated or given audio and prints a JSON report
+with the real-time factor, throughput, latency percentiles, peak RSS and
+the number of heap allocations. It does not need a network connection.
+
+Usage:
+
+  ./bin/sherpa-onnx-bench \
+    --task=online-asr \
+    --num-streams=8 \
+    --batch-size=4 \
+    --num-workers=2 \
+    --chunk-ms=100 \
+    --duration=10 \
+    --tokens=/path/to/tokens.txt \
+    --encoder=/path/to/encoder.onnx \
+    --decoder=/path/to/decoder.onnx \
+    --joiner=/path/to/joiner.onnx \
+    --num-threads=1 \
+    [/path/to/foo.wav bar.wav ...]
+
+--task is one of
+
+  online-asr         Streaming ASR. Options of ./bin/sherpa-onnx
+  offline-asr        Non-streaming ASR. Options of ./bin/sherpa-onnx-offline
+  kws                Keyword spotting. Options of
+                     ./bin/sherpa-onnx-keyword-spotter
+  vad                Voice activity detection. Options of
+                     ./bin/sherpa-onnx-vad-microphone
+  tts                Text-to-speech. Options of ./bin/sherpa-onnx-offline-tts
+  speaker-embedding  Speaker embedding extraction. Options of
+                     ./bin/sherpa-onnx-speaker-identification
+  diarization        Speaker diarization. Options of
+                     ./bin/sherpa-onnx-offline-speaker-diarization
+
+If no wave files are given, --num-streams clips of --duration seconds of
+synthetic speech-like audio are generated. Otherwise, stream i uses
+wave file i % (number of wave files).
+
+Streaming tasks (online-asr, kws, vad) feed the audio in chunks of
+--chunk-ms as fast as possible and report the latency of each chunk, i.e.,
+the time from feeding a chunk to having decoded all of its frames. The
+other tasks report the latency of each utterance or request.
+
+Streams are split into batches of --batch-size, which are processed by
+--num-workers threads. --num-threads is the number of threads of
+onnxruntime for each model.
+
+For kws, --kws-stream-keywords creates every stream with custom keywords
+on top of the default ones, which is how per-device keywords are served.
+
+To measure the cost of LM shallow fusion in streaming ASR, compare runs
+with and without --lm at several batch sizes, e.g.,
+
+  for b in 1 8 32; do
+    for lm in "" /path/to/rnn-lm.onnx; do
+      ./bin/sherpa-onnx-bench --task=online-asr --num-streams=32 \
+        --batch-size=$b --decoding-method=modified_beam_search \
+        --lm="$lm" --lm-shallow-fusion=true --output="b$b${lm:+-lm}.json" \
+        ... # model options
+    done
+  done
+
+The LM of all hyps of all streams in a batch runs once per frame, so the
+relative cost of the LM goes down as the batch size goes up.
+
+For online-asr and offline-asr, the report also counts the calls of the
+decoder model of transducers and the number of rows (hypotheses) they
+process. With greedy search, only streams that have emitted a token in a
+frame are run through the decoder again, so rows per call is much less
+than --batch-size at large batch sizes, e.g.,
+
+  for b in 1 8 32 64; do
+    ./bin/sherpa-onnx-bench --task=online-asr --num-streams=64 \
+      --batch-size=$b --output="b$b.json" ... # model options
+  done
+
+For online-asr and offline-asr, --transcripts gives the reference text of
+each wave file, one line per file, and the report includes the word error
+rate (or the character error rate with --cer). Use it to compare decoding
+methods and LMs, e.g., --lm with an RNN LM versus an n-gram LM.
+
+For online-asr, --snapshot=true serializes every stream after each chunk,
+restores it into a new stream and reports the size of the snapshots and
+the time to take and restore them. The chunk latencies include this time.
+It requires --enable-snapshots=true. Run it once per model family to
+compare them, e.g.,
+
+  ./bin/sherpa-onnx-bench --task=online-asr --snapshot=true \
+    --enable-snapshots=true --output=zipformer.json ... # model options
+
+To measure the tail latency of a task while other models in the same
+process are busy, as in a server that runs ASR, VAD and speaker
+identification, give the other tasks with --background-tasks. Options of
+a background task are prefixed with its name. Each background task
+processes 2-second clips one at a time in a loop until the timed runs of
+--task finish. Only the latencies of --task are reported.
+
+--shared-runtime=true creates the process-wide onnxruntime environment
+with global thread pools. Models use it if their config sets
+use-shared-runtime. Compare the p99 and max latencies with and without
+it, e.g.,
+
+  ./bin/sherpa-onnx-bench --task=online-asr --num-streams=8 \
+    --background-tasks=vad,speaker-embedding \
+    --vad.silero-vad-model=./silero_vad.onnx \
+    --speaker-embedding.model=./3dspeaker.onnx \
+    --shared-runtime=true --ort-intra-op-num-threads=4 \
+    --use-shared-runtime=true \
+    --vad.vad-use-shared-runtime=true \
+    --speaker-embedding.use-shared-runtime=true \
+    ... # model options of online-asr
+)usage";
+
+struct BenchOptions {
+  std::string task;
+  int32_t num_streams = 1;
+  int32_t batch_size = 1;
+  int32_t num_workers = 1;
+  int32_t chunk_ms = 100;
+  float duration = 10;
+  int32_t sample_rate = 16000;
+  int32_t warmup = 1;
+  int32_t num_repeats = 1;
+  std::string text =
+      "Today as always, men fall into two groups: slaves and free men.";
+  int32_t sid = 0;
+  float speed = 1.0;
+  std::string kws_stream_keywords;
+  std::string transcripts;
+  bool cer = false;
+  bool snapshot = false;
+  std::string background_tasks;
+  bool shared_runtime = false;
+  std::string output;
+
+  void Register(ParseOptions *po) {
+    po->Register("task", &task,
+                 "online-asr, offline-asr, kws, vad, tts, speaker-embedding "
+                 "or diarization");
+    po->Register("num-streams", &num_streams,
+                 "Number of streams, utterances or requests processed "
+                 "concurrently");
+    po->Register("batch-size", &batch_size,
+                 "Number of streams decoded together in one call. Used only "
+                 "by online-asr, offline-asr and kws");
+    po->Register("num-workers", &num_workers,
+                 "Number of threads processing the batches");
+    po->Register("chunk-ms", &chunk_ms,
+                 "Chunk size in milliseconds for online-asr, kws and vad");
+    po->Register("duration", &duration,
+                 "Duration in seconds of each generated clip. Used only if "
+                 "no wave files are given");
+    po->Register("bench-sample-rate", &sample_rate,
+                 "Sample rate of the generated audio");
+    po->Register("warmup", &warmup,
+                 "Number of untimed runs with a single stream before "
+                 "benchmarking");
+    po->Register("num-repeats", &num_repeats,
+                 "Number of timed runs. Results of all runs are aggregated");
+    po->Register("text", &text, "Text to synthesize for the tts task");
+    po->Register("sid", &sid, "Speaker ID for the tts task");
+    po->Register("speed", &speed, "Speech speed for the tts task");
+    po->Register("kws-stream-keywords", &kws_stream_keywords,
+                 "If not empty, each stream of the kws task is created with "
+                 "these custom keywords in addition to the default ones. "
+                 "Same format as --keywords-file, with lines separated by /");
+    po->Register("transcripts", &transcripts,
+                 "If not empty, a file with the reference text of each wave "
+                 "file, one line per file. The error rate of online-asr and "
+                 "offline-asr is reported");
+    po->Register("cer", &cer,
+                 "True to report the character error rate instead of the "
+                 "word error rate. Used only with --transcripts");
+    po->Register("snapshot", &snapshot,
+                 "True to snapshot and restore every stream of online-asr "
+                 "after each chunk and report the size and time of it");
+    po->Register("background-tasks", &background_tasks,
+                 "Comma separated tasks to keep busy in the background "
+                 "while --task is benchmarked, e.g., vad,speaker-embedding. "
+                 "Their options are prefixed with the task name, e.g., "
+                 "--vad.silero-vad-model");
+    po->Register("shared-runtime", &shared_runtime,
+                 "True to create the shared onnxruntime environment before "
+                 "loading the models. Models use it only with "
+                 "use-shared-runtime in their config");
+    po->Register("output", &output,
+                 "If not empty, also write the JSON report to this file");
+  }
+
+  bool Validate() const {
+    if (num_streams < 1 || batch_size < 1 || num_workers < 1) {
+      fprintf(stderr,
+              "--num-streams, --batch-size and --num-workers must be "
+              "positive\n");
+      return false;
+    }
+
+    if (chunk_ms < 1) {
+      fprintf(stderr, "--chunk-ms must be positive. Given: %d\n", chunk_ms);
+      return false;
+    }
+
+    if (duration <= 0 || sample_rate <= 0) {
+      fprintf(stderr, "--duration and --bench-sample-rate must be positive\n");
+      return false;
+    }
+
+    if (num_repeats < 1 || warmup < 0) {
+      fprintf(stderr, "Invalid --num-repeats=%d or --warmup=%d\n", num_repeats,
+              warmup);
+      return false;
+    }
+
+    return true;
+  }
+};
+
+struct Audio {
+  std::vector<float> samples;
+  int32_t sample_rate = 16000;
+
+  float Duration() const {
+    return samples.size() / static_cast<float>(sample_rate);
+  }
+};
+
+// Generate speech-like audio: voiced segments with a few harmonics of a
+// slowly varying pitch, separated by low-level noise. It is deterministic
+// for a given seed.
+Audio GenerateAudio(float duration, int32_t sample_rate, int32_t seed) {
+  Audio ans;
+  ans.sample_rate = sample_rate;
+  ans.samples.resize(static_cast<int32_t>(duration * sample_rate));
+
+  std::mt19937 gen(seed);
+  std::normal_distribution<float> noise(0, 1);
+  std::uniform_real_distribution<float> uniform(0, 1);
+
+  const float kPi = 3.14159265358979f;
+  int32_t n = static_cast<int32_t>(ans.samples.size());
+  int32_t i = 0;
+  while (i < n) {
+    int32_t voiced = static_cast<int32_t>((0.8 + 1.2 * uniform(gen)) *
+                                          sample_rate);
+    int32_t silence = static_cast<int32_t>((0.2 + 0.4 * uniform(gen)) *
+                                           sample_rate);
+    float f0 = 100 + 120 * uniform(gen);
+    float amplitude = 0.1 + 0.2 * uniform(gen);
+    float phase = 0;
+
+    for (int32_t k = 0; k < voiced && i < n; ++k, ++i) {
+      float t = static_cast<float>(k) / voiced;
+      float f = f0 * (1 + 0.1f * std::sin(2 * kPi * 3 * t));
+      phase += 2 * kPi * f / sample_rate;
+
+      float s = 0;
+      for (int32_t h = 1; h <= 4; ++h) {
+        s += std::sin(h * phase) / h;
+      }
+
+      // Rise and fall of the energy inside a segment
+      float envelope = std::sin(kPi * t);
+      ans.samples[i] = amplitude * envelope * (0.6f * s + 0.1f * noise(gen));
+    }
+
+    for (int32_t k = 0; k < silence && i < n; ++k, ++i) {
+      ans.samples[i] = 0.003f * noise(gen);
+    }
+  }
+
+  return ans;
+}
+
+Audio Resample(const Audio &audio, int32_t sample_rate) {
+  if (audio.sample_rate == sample_rate) {
+    return audio;
+  }
+
+  float min_freq = std::min(audio.sample_rate, sample_rate);
+  float lowpass_cutoff = 0.99 * 0.5 * min_freq;
+  int32_t lowpass_filter_width = 6;
+  LinearResample resampler(audio.sample_rate, sample_rate, lowpass_cutoff,
+                           lowpass_filter_width);
+
+  Audio ans;
+  ans.sample_rate = sample_rate;
+  resampler.Resample(audio.samples.data(), audio.samples.size(), true,
+                     &ans.samples);
+  return ans;
+}
+
+// A fixed set of threads. Run() calls f(0), ..., f(n-1) on them
+// and waits until all calls return.
+class WorkerPool {
+ public:
+  explicit WorkerPool(int32_t num_workers) {
+    for (int32_t i = 0; i != num_workers; ++i) {
+      threads_.emplace_back([this]() { Loop(); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto &t : threads_) {
+      t.join();
+    }
+  }
+
+  void Run(int32_t n, const std::function<void(int32_t)> &f) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    f_ = &f;
+    n_ = n;
+    next_ = 0;
+    pending_ = static_cast<int32_t>(threads_.size());
+    ++generation_;
+    cv_.notify_all();
+
+    done_cv_.wait(lock, [this]() { return pending_ == 0; });
+    f_ = nullptr;
+  }
+
+ private:
+  void Loop() {
+    int64_t generation = 0;
+    while (true) {
+      const std::function<void(int32_t)> *f = nullptr;
+      int32_t n = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock,
+                 [&]() { return stop_ || generation_ != generation; });
+        if (stop_) {
+          return;
+        }
+        generation = generation_;
+        f = f_;
+        n = n_;
+      }
+
+      while (true) {
+        int32_t i = next_.fetch_add(1);
+        if (i >= n) {
+          break;
+        }
+        (*f)(i);
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_ == 0) {
+        done_cv_.notify_all();
+      }
+    }
+  }
+
+ private:
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(int32_t)> *f_ = nullptr;
+  int32_t n_ = 0;
+  std::atomic<int32_t> next_{0};
+  int32_t pending_ = 0;
+  int64_t generation_ = 0;
+  bool stop_ = false;
+};
+
+struct Report {
+  int32_t num_threads = 1;
+
+  // Unit of the latencies: chunk, utterance or request
+  std::string latency_unit;
+
+  // Number of streams, utterances or requests processed
+  int64_t num_items = 0;
+
+  // Duration of the input audio, or of the generated audio for tts
+  double audio_seconds = 0;
+
+  double elapsed_seconds = 0;
+
+  // In seconds
+  std::vector<double> latencies;
+
+  std::mutex mutex;
+
+  void AddLatencies(const std::vector<double> &v) {
+    std::lock_guard<std::mutex> lock(mutex);
+    latencies.insert(latencies.end(), v.begin(), v.end());
+  }
+
+  void AddAudioSeconds(double s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    audio_seconds += s;
+  }
+
+  // Recognized text of stream i. Set only with --transcripts
+  std::map<int32_t, std::string> texts;
+
+  void SetText(int32_t i, std::string text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    texts[i] = std::move(text);
+  }
+
+  // Calls of the decoder model and rows processed by them. Set only for
+  // online-asr and offline-asr.
+  int64_t decoder_calls = -1;
+  double decoder_rows = 0;
+
+  // Size in bytes and time in seconds of stream snapshots. Set only with
+  // --snapshot
+  std::vector<double> snapshot_bytes;
+  std::vector<double> serialize_seconds;
+  std::vector<double> deserialize_seconds;
+
+  void AddSnapshot(double bytes, double serialize, double deserialize) {
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshot_bytes.push_back(bytes);
+    serialize_seconds.push_back(serialize);
+    deserialize_seconds.push_back(deserialize);
+  }
+
+  // Runs of each background task during the timed runs. Set only with
+  // --background-tasks
+  std::map<std::string, int64_t> background_runs;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Split [0, n) into groups of at most batch_size consecutive integers
+std::vector<std::vector<int32_t>> SplitToBatches(int32_t n,
+                                                 int32_t batch_size) {
+  std::vector<std::vector<int32_t>> ans;
+  for (int32_t i = 0; i < n; i += batch_size) {
+    ans.emplace_back();
+    for (int32_t k = i; k < std::min(n, i + batch_size); ++k) {
+      ans.back().push_back(k);
+    }
+  }
+  return ans;
+}
+
+// For OnlineRecognizer and KeywordSpotter.
+// on_chunk_decoded(i, s) is called after all ready frames of stream i are
+// decoded.
+template <typename Recognizer>
+void RunStreaming(
+    const Recognizer &recognizer, const std::vector<Audio> &audio,
+    int32_t num_streams, const BenchOptions &opts, WorkerPool *pool,
+    const std::function<std::unique_ptr<OnlineStream>()> &create_stream,
+    const std::function<void(int32_t, OnlineStream *)> &on_chunk_decoded,
+    Report *report) {
+  std::vector<std::unique_ptr<OnlineStream>> streams;
+  std::vector<int32_t> offset(num_streams, 0);
+  std::vector<bool> done(num_streams, false);
+  for (int32_t i = 0; i != num_streams; ++i) {
+    streams.push_back(create_stream());
+    report->audio_seconds += audio[i % audio.size()].Duration();
+  }
+
+  auto batches = SplitToBatches(num_streams, opts.batch_size);
+
+  auto start = Clock::now();
+  int32_t num_done = 0;
+  while (num_done < num_streams) {
+    auto chunk_start = Clock::now();
+    pool->Run(batches.size(), [&](int32_t b) {
+      std::vector<OnlineStream *> ready;
+      int32_t num_fed = 0;
+      for (int32_t i : batches[b]) {
+        if (done[i]) {
+          continue;
+        }
+
+        const Audio &a = audio[i % audio.size()];
+        int32_t chunk_size = opts.chunk_ms * a.sample_rate / 1000;
+        int32_t n = std::min<int32_t>(chunk_size, a.samples.size() - offset[i]);
+        OnlineStream *s = streams[i].get();
+        s->AcceptWaveform(a.sample_rate, a.samples.data() + offset[i], n);
+        offset[i] += n;
+        ++num_fed;
+
+        if (offset[i] == static_cast<int32_t>(a.samples.size())) {
+          std::vector<float> tail_paddings(
+              static_cast<int32_t>(0.3 * a.sample_rate));
+          s->AcceptWaveform(a.sample_rate, tail_paddings.data(),
+                            tail_paddings.size());
+          s->InputFinished();
+        }
+      }
+
+      while (true) {
+        ready.clear();
+        for (int32_t i : batches[b]) {
+          if (!done[i] && recognizer.IsReady(streams[i].get())) {
+            ready.push_back(streams[i].get());
+          }
+        }
+
+        if (ready.empty()) {
+          break;
+        }
+
+        recognizer.DecodeStreams(ready.data(), ready.size());
+      }
+
+      for (int32_t i : batches[b]) {
+        if (!done[i]) {
+          on_chunk_decoded(i, streams[i].get());
+        }
+      }
+
+      report->AddLatencies(
+          std::vector<double>(num_fed, SecondsSince(chunk_start)));
+    });
+
+    for (int32_t i = 0; i != num_streams; ++i) {
+      int32_t n = static_cast<int32_t>(audio[i % audio.size()].samples.size());
+      if (!done[i] && offset[i] == n) {
+        done[i] = true;
+        ++num_done;
+      }
+    }
+  }
+
+  report->elapsed_seconds += SecondsSince(start);
+  report->num_items += num_streams;
+}
+
+class Task {
+ public:
+  virtual ~Task() = default;
+
+  // Process num_streams streams, where stream i uses audio[i % audio.size()]
+  virtual void Run(const std::vector<Audio> &audio, int32_t num_streams,
+                   const BenchOptions &opts, WorkerPool *pool,
+                   Report *report) = 0;
+
+  virtual int32_t NumThreads() const = 0;
+};
+
+class OnlineAsrTask : public Task {
+ public:
+  explicit OnlineAsrTask(const OnlineRecognizerConfig &config)
+      : config_(config), recognizer_(config) {}
+
+  void Run(const std::vector<Audio> &audio, int32_t num_streams,
+           const BenchOptions &opts, WorkerPool *pool,
+           Report *report) override {
+    if (opts.snapshot && !config_.feat_config.enable_snapshots) {
+      fprintf(stderr, "Please use --enable-snapshots=true with --snapshot\n");
+      exit(-1);
+    }
+
+    report->latency_unit = "chunk";
+    RunStreaming(
+        recognizer_, audio, num_streams, opts, pool,
+        [this]() { return recognizer_.CreateStream(); },
+        [this, &audio, &opts, report](int32_t i, OnlineStream *s) {
+          if (opts.snapshot) {
+            Snapshot(s, report);
+          }
+
+          auto r = recognizer_.GetResult(s);
+          if (!opts.transcripts.empty() &&
+              i < static_cast<int32_t>(audio.size())) {
+            report->SetText(i, std::move(r.text));
+          }
+        },
+        report);
+  }
+
+  int32_t NumThreads() const override {
+    return config_.model_config.num_threads;
+  }
+
+ private:
+  void Snapshot(const OnlineStream *s, Report *report) const {
+    auto start = Clock::now();
+    std::string data = s->Serialize();
+    double serialize = SecondsSince(start);
+
+    start = Clock::now();
+    auto restored = recognizer_.CreateStream();
+    if (!restored->Deserialize(data)) {
+      fprintf(stderr, "Failed to restore a snapshot of %d bytes\n",
+              static_cast<int32_t>(data.size()));
+      exit(-1);
+    }
+    double deserialize = SecondsSince(start);
+
+    report->AddSnapshot(data.size(), serialize, deserialize);
+  }
+
+ private:
+  OnlineRecognizerConfig config_;
+  OnlineRecognizer recognizer_;
+};
+
+class KwsTask : public Task {
+ public:
+  explicit KwsTask(const KeywordSpotterConfig &config)
+      : config_(config), spotter_(config) {}
+
+  void Run(const std::vector<Audio> &audio, int32_t num_streams,
+           const BenchOptions &opts, WorkerPool *pool,
+           Report *report) override {
+    report->latency_unit = "chunk";
+    RunStreaming(
+        spotter_, audio, num_streams, opts, pool,
+        [this, &opts]() {
+          return opts.kws_stream_keywords.empty()
+                     ? spotter_.CreateStream()
+                     : spotter_.CreateStream(opts.kws_stream_keywords);
+        },
+        [this](int32_t /*i*/, OnlineStream *s) {
+          if (!spotter_.GetResult(s).keyword.empty()) {
+            spotter_.Reset(s);
+          }
+        },
+        report);
+  }
+
+  int32_t NumThreads() const override {
+    return config_.model_config.num_threads;
+  }
+
+ private:
+  KeywordSpotterConfig config_;
+  KeywordSpotter spotter_;
+};
+
+class OfflineAsrTask : public Task {
+ public:
+  explicit OfflineAsrTask(const OfflineRecognizerConfig &config)
+      : config_(config), recognizer_(config) {}
+
+  void Run(const std::vector<Audio> &audio, int32_t num_streams,
+           const BenchOptions &opts, WorkerPool *pool,
+           Report *report) override {
+    report->latency_unit = "utterance";
+    for (int32_t i = 0; i != num_streams; ++i) {
+      report->audio_seconds += audio[i % audio.size()].Duration();
+    }
+
+    auto batches = SplitToBatches(num_streams, opts.batch_size);
+
+    auto start = Clock::now();
+    pool->Run(batches.size(), [&](int32_t b) {
+      auto batch_start = Clock::now();
+
+      std::vector<std::unique_ptr<OfflineStream>> streams;
+      std::vector<OfflineStream *> ss;
+      for (int32_t i : batches[b]) {
+        const Audio &a = audio[i % audio.size()];
+        streams.push_back(recognizer_.CreateStream());
+        streams.back()->AcceptWaveform(a.sample_rate, a.samples.data(),
+                                       a.samples.size());
+        ss.push_back(streams.back().get());
+      }
+
+      recognizer_.DecodeStreams(ss.data(), ss.size());
+
+      for (int32_t k = 0; k != static_cast<int32_t>(ss.size()); ++k) {
+        auto r = ss[k]->GetResult();
+        int32_t i = batches[b][k];
+        if (!opts.transcripts.empty() &&
+            i < static_cast<int32_t>(audio.size())) {
+          report->SetText(i, std::move(r.text));
+        }
+      }
+
+      report->AddLatencies(
+          std::vector<double>(ss.size(), SecondsSince(batch_start)));
+    });
+
+    report->elapsed_seconds += SecondsSince(start);
+    report->num_items += num_streams;
+  }
+
+  int32_t NumThreads() const override {
+    return config_.model_config.num_threads;
+  }
+
+ private:
+  OfflineRecognizerConfig config_;
+  OfflineRecognizer recognizer_;
+};
+
+class VadTask : public Task {
+ public:
+  explicit VadTask(const VadModelConfig &config) : config_(config) {}
+
+  void Run(const std::vector<Audio> &audio, int32_t num_streams,
+           const BenchOptions &opts, WorkerPool *pool,
+           Report *report) override {
+    report->latency_unit = "chunk";
+
+    // A detector is stateful, so each stream has its own
+    std::vector<std::unique_ptr<VoiceActivityDetector>> detectors;
+    std::vector<Audio> resampled;
+    for (const auto &a : audio) {
+      resampled.push_back(Resample(a, config_.sample_rate));
+    }
+
+    for (int32_t i = 0; i != num_streams; ++i) {
+      detectors.push_back(std::make_unique<VoiceActivityDetector>(config_));
+      report->audio_seconds += resampled[i % resampled.size()].Duration();
+    }
+
+    int32_t chunk_size = opts.chunk_ms * config_.sample_rate / 1000;
+
+    auto start = Clock::now();
+    pool->Run(num_streams, [&](int32_t i) {
+      const Audio &a = resampled[i % resampled.size()];
+      VoiceActivityDetector *vad = detectors[i].get();
+
+      std::vector<double> latencies;
+      int32_t n = static_cast<int32_t>(a.samples.size());
+      for (int32_t k = 0; k < n; k += chunk_size) {
+        auto chunk_start = Clock::now();
+        vad->AcceptWaveform(a.samples.data() + k, std::min(chunk_size, n - k));
+        while (!vad->Empty()) {
+          vad->Pop();
+        }
+        latencies.push_back(SecondsSince(chunk_start));
+      }
+
+      vad->Flush();
+      while (!vad->Empty()) {
+        vad->Pop();
+      }
+
+      report->AddLatencies(latencies);
+    });
+
+    report->elapsed_seconds += SecondsSince(start);
+    report->num_items += num_streams;
+  }
+
+  int32_t NumThreads() const override { return config_.num_threads; }
+
+ private:
+  VadModelConfig config_;
+};
+
+class SpeakerEmbeddingTask : public Task {
+ public:
+  explicit SpeakerEmbeddingTask(const SpeakerEmbeddingExtractorConfig &config)
+      : config_(config), extractor_(config) {}
+
+  void Run(const std::vector<Audio> &audio, int32_t num_streams,
+           const BenchOptions &opts, WorkerPool *pool,
+           Report *report) override {
+    report->latency_unit = "utterance";
+    for (int32_t i = 0; i != num_streams; ++i) {
+      report->audio_seconds += audio[i % audio.size()].Duration();
+    }
+
+    auto start = Clock::now();
+    pool->Run(num_streams, [&](int32_t i) {
+      const Audio &a = audio[i % audio.size()];
+
+      auto utterance_start = Clock::now();
+      auto s = extractor_.CreateStream();
+      s->AcceptWaveform(a.sample_rate, a.samples.data(), a.samples.size());
+      s->InputFinished();
+      if (extractor_.IsReady(s.get())) {
+        extractor_.Compute(s.get());
+      }
+
+      report->AddLatencies({SecondsSince(utterance_start)});
+    });
+
+    report->elapsed_seconds += SecondsSince(start);
+    report->num_items += num_streams;
+  }
+
+  int32_t NumThreads() const override { return config_.num_threads; }
+
+ private:
+  SpeakerEmbeddingExtractorConfig config_;
+  SpeakerEmbeddingExtractor extractor_;
+};
+
+#if SHERPA_ONNX_ENABLE_TTS
+class TtsTask : public Task {
+ public:
+  explicit TtsTask(const OfflineTtsConfig &config)
+      : config_(config), tts_(config) {}
+
+  void Run(const std::vector<Audio> & /*audio*/, int32_t num_streams,
+           const BenchOptions &opts, WorkerPool *pool,
+           Report *report) override {
+    report->latency_unit = "request";
+
+    auto start = Clock::now();
+    pool->Run(num_streams, [&](int32_t /*i*/) {
+      auto request_start = Clock::now();
+      auto generated = tts_.Generate(opts.text, opts.sid, opts.speed);
+      report->AddLatencies({SecondsSince(request_start)});
+
+      if (generated.sample_rate > 0) {
+        report->AddAudioSeconds(generated.samples.size() /
+                                static_cast<double>(generated.sample_rate));
+      }
+    });
+
+    report->elapsed_seconds += SecondsSince(start);
+    report->num_items += num_streams;
+  }
+
+  int32_t NumThreads() const override { return config_.model.num_threads; }
+
+ private:
+  OfflineTtsConfig config_;
+  OfflineTts tts_;
+};
+#endif
+
+#if SHERPA_ONNX_ENABLE_SPEAKER_DIARIZATION
+class DiarizationTask : public Task {
+ public:
+  explicit DiarizationTask(const OfflineSpeakerDiarizationConfig &config)
+      : config_(config), sd_(config) {}
+
+  void Run(const std::vector<Audio> &audio, int32_t num_streams,
+           const BenchOptions &opts, WorkerPool *pool,
+           Report *report) override {
+    report->latency_unit = "utterance";
+
+    std::vector<Audio> resampled;
+    for (const auto &a : audio) {
+      resampled.push_back(Resample(a, sd_.SampleRate()));
+    }
+
+    for (int32_t i = 0; i != num_streams; ++i) {
+      report->audio_seconds += resampled[i % resampled.size()].Duration();
+    }
+
+    auto start = Clock::now();
+    pool->Run(num_streams, [&](int32_t i) {
+      const Audio &a = resampled[i % resampled.size()];
+
+      auto utterance_start = Clock::now();
+      sd_.Process(a.samples.data(), a.samples.size());
+      report->AddLatencies({SecondsSince(utterance_start)});
+    });
+
+    report->elapsed_seconds += SecondsSince(start);
+    report->num_items += num_streams;
+  }
+
+  int32_t NumThreads() const override {
+    return config_.segmentation.num_threads;
+  }
+
+ private:
+  OfflineSpeakerDiarizationConfig config_;
+  OfflineSpeakerDiarization sd_;
+};
+#endif
+
+// It keeps the config of a task from registering its options until the
+// command line is parsed
+class TaskFactory {
+ public:
+  virtual ~TaskFactory() = default;
+
+  // Return nullptr on error
+  virtual std::unique_ptr<Task> Create() = 0;
+};
+
+template <typename Config, typename T>
+class TaskFactoryImpl : public TaskFactory {
+ public:
+  explicit TaskFactoryImpl(ParseOptions *po) { config_.Register(po); }
+
+  std::unique_ptr<Task> Create() override {
+    fprintf(stderr, "%s\n", config_.ToString().c_str());
+
+    if (!config_.Validate()) {
+      fprintf(stderr, "Errors in config!\n");
+      return nullptr;
+    }
+
+    return std::make_unique<T>(config_);
+  }
+
+ private:
+  Config config_;
+};
+
+// Register the options of the given task. Return nullptr if it is not
+// supported.
+std::unique_ptr<TaskFactory> RegisterTask(const std::string &task,
+                                          ParseOptions *po) {
+  if (task == "online-asr") {
+    return std::make_unique<
+        TaskFactoryImpl<OnlineRecognizerConfig, OnlineAsrTask>>(po);
+  } else if (task == "offline-asr") {
+    return std::make_unique<
+        TaskFactoryImpl<OfflineRecognizerConfig, OfflineAsrTask>>(po);
+  } else if (task == "kws") {
+    return std::make_unique<TaskFactoryImpl<KeywordSpotterConfig, KwsTask>>(
+        po);
+  } else if (task == "vad") {
+    return std::make_unique<TaskFactoryImpl<VadModelConfig, VadTask>>(po);
+  } else if (task == "speaker-embedding") {
+    return std::make_unique<TaskFactoryImpl<SpeakerEmbeddingExtractorConfig,
+                                            SpeakerEmbeddingTask>>(po);
+#if SHERPA_ONNX_ENABLE_TTS
+  } else if (task == "tts") {
+    return std::make_unique<TaskFactoryImpl<OfflineTtsConfig, TtsTask>>(po);
+#endif
+#if SHERPA_ONNX_ENABLE_SPEAKER_DIARIZATION
+  } else if (task == "diarization") {
+    return std::make_unique<
+        TaskFactoryImpl<OfflineSpeakerDiarizationConfig, DiarizationTask>>(po);
+#endif
+  }
+
+  return nullptr;
+}
+
+// Keep the given tasks busy in background threads, one clip at a time,
+// until the object is destroyed
+class BackgroundTasks {
+ public:
+  BackgroundTasks(std::vector<std::unique_ptr<Task>> *tasks,
+                  const std::vector<std::string> &names,
+                  const BenchOptions &opts)
+      : names_(names), runs_(tasks->size()) {
+    for (int32_t k = 0; k != static_cast<int32_t>(tasks->size()); ++k) {
+      Task *t = (*tasks)[k].get();
+      threads_.emplace_back([this, t, k, &opts]() {
+        std::vector<Audio> audio = {
+            GenerateAudio(2, opts.sample_rate, 1000 + k)};
+        WorkerPool pool(1);
+        while (!stop_) {
+          Report r;
+          t->Run(audio, 1, opts, &pool, &r);
+          ++runs_[k];
+        }
+      });
+    }
+  }
+
+  ~BackgroundTasks() {
+    stop_ = true;
+    for (auto &t : threads_) {
+      t.join();
+    }
+  }
+
+  // Number of runs of each task so far
+  std::map<std::string, int64_t> Runs() const {
+    std::map<std::string, int64_t> ans;
+    for (int32_t k = 0; k != static_cast<int32_t>(names_.size()); ++k) {
+      ans[names_[k]] += runs_[k].load();
+    }
+    return ans;
+  }
+
+ private:
+  std::vector<std::string> names_;
+  std::vector<std::atomic<int64_t>> runs_;
+  std::atomic<bool> stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+// Peak resident set size in MB
+double PeakRssMb() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+    return pmc.PeakWorkingSetSize / (1024.0 * 1024.0);
+  }
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+#if defined(__APPLE__)
+  return usage.ru_maxrss / (1024.0 * 1024.0);  // in bytes
+#else
+  return usage.ru_maxrss / 1024.0;  // in KB
+#endif
+#endif
+}
+
+// Nearest-rank percentile. v must be sorted
+double Percentile(const std::vector<double> &v, double q) {
+  if (v.empty()) {
+    return 0;
+  }
+
+  int32_t k = static_cast<int32_t>(std::ceil(q * v.size())) - 1;
+  k = std::max(0, std::min(k, static_cast<int32_t>(v.size()) - 1));
+  return v[k];
+}
+
+// Split text into lower-cased words, or into characters if cer is true
+std::vector<std::string> SplitForErrorRate(const std::string &text,
+                                           bool cer) {
+  std::string s = ToLowerCase(text);
+
+  std::vector<std::string> ans;
+  if (cer) {
+    for (auto &c : SplitUtf8(s)) {
+      if (c != " ") {
+        ans.push_back(std::move(c));
+      }
+    }
+  } else {
+    SplitStringToVector(s, " \t", true, &ans);
+  }
+  return ans;
+}
+
+// Levenshtein distance between two sequences
+int32_t EditDistance(const std::vector<std::string> &a,
+                     const std::vector<std::string> &b) {
+  std::vector<int32_t> prev(b.size() + 1);
+  std::vector<int32_t> cur(b.size() + 1);
+  for (int32_t j = 0; j <= static_cast<int32_t>(b.size()); ++j) {
+    prev[j] = j;
+  }
+
+  for (int32_t i = 1; i <= static_cast<int32_t>(a.size()); ++i) {
+    cur[0] = i;
+    for (int32_t j = 1; j <= static_cast<int32_t>(b.size()); ++j) {
+      int32_t sub = prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+      cur[j] = std::min({sub, prev[j] + 1, cur[j - 1] + 1});
+    }
+    std::swap(prev, cur);
+  }
+
+  return prev[b.size()];
+}
+
+struct ErrorRate {
+  int64_t num_errors = 0;
+  int64_t num_ref = 0;
+};
+
+ErrorRate ComputeErrorRate(const std::vector<std::string> &references,
+                           const std::map<int32_t, std::string> &texts,
+                           bool cer) {
+  ErrorRate ans;
+  for (int32_t i = 0; i != static_cast<int32_t>(references.size()); ++i) {
+    auto ref = SplitForErrorRate(references[i], cer);
+
+    std::vector<std::string> hyp;
+    auto it = texts.find(i);
+    if (it != texts.end()) {
+      hyp = SplitForErrorRate(it->second, cer);
+    }
+
+    ans.num_errors += EditDistance(ref, hyp);
+    ans.num_ref += ref.size();
+  }
+  return ans;
+}
+
+std::string ToJson(const BenchOptions &opts, Report *report,
+                   int64_t num_allocations, int64_t allocated_bytes,
+                   const ErrorRate *error_rate) {
+  std::vector<double> &v = report->latencies;
+  std::sort(v.begin(), v.end());
+
+  double sum = 0;
+  for (auto d : v) {
+    sum += d;
+  }
+
+  double elapsed = report->elapsed_seconds;
+  double audio_seconds = report->audio_seconds;
+
+  std::ostringstream os;
+  os << std::setprecision(6) << std::fixed;
+  os << "{\n";
+  os << "  \"task\": \"" << opts.task << "\",\n";
+  os << "  \"num_streams\": " << opts.num_streams << ",\n";
+  os << "  \"batch_size\": " << opts.batch_size << ",\n";
+  os << "  \"num_workers\": " << opts.num_workers << ",\n";
+  os << "  \"num_threads\": " << report->num_threads << ",\n";
+  os << "  \"chunk_ms\": " << opts.chunk_ms << ",\n";
+  os << "  \"num_repeats\": " << opts.num_repeats << ",\n";
+  os << "  \"num_items\": " << report->num_items << ",\n";
+  os << "  \"audio_seconds\": " << audio_seconds << ",\n";
+  os << "  \"elapsed_seconds\": " << elapsed << ",\n";
+  os << "  \"rtf\": " << (audio_seconds > 0 ? elapsed / audio_seconds : 0)
+     << ",\n";
+  os << "  \"throughput_audio_seconds_per_second\": "
+     << (elapsed > 0 ? audio_seconds / elapsed : 0) << ",\n";
+  os << "  \"throughput_items_per_second\": "
+     << (elapsed > 0 ? report->num_items / elapsed : 0) << ",\n";
+  os << "  \"latency_ms\": {\n";
+  os << "    \"unit\": \"" << report->latency_unit << "\",\n";
+  os << "    \"count\": " << v.size() << ",\n";
+  os << "    \"mean\": " << (v.empty() ? 0 : 1000 * sum / v.size()) << ",\n";
+  os << "    \"p50\": " << 1000 * Percentile(v, 0.5) << ",\n";
+  os << "    \"p90\": " << 1000 * Percentile(v, 0.9) << ",\n";
+  os << "    \"p99\": " << 1000 * Percentile(v, 0.99) << ",\n";
+  os << "    \"max\": " << (v.empty() ? 0 : 1000 * v.back()) << "\n";
+  os << "  },\n";
+  os << "  \"peak_rss_mb\": " << PeakRssMb() << ",\n";
+  os << "  \"num_allocations\": " << num_allocations << ",\n";
+  os << "  \"allocated_mb\": " << allocated_bytes / (1024.0 * 1024.0);
+  if (report->decoder_calls >= 0) {
+    int64_t calls = report->decoder_calls;
+    double rows = report->decoder_rows;
+    os << ",\n";
+    os << "  \"decoder\": {\n";
+    os << "    \"calls\": " << calls << ",\n";
+    os << "    \"rows\": " << static_cast<int64_t>(rows) << ",\n";
+    os << "    \"rows_per_call\": " << (calls > 0 ? rows / calls : 0) << ",\n";
+    os << "    \"calls_per_second\": " << (elapsed > 0 ? calls / elapsed : 0)
+       << ",\n";
+    os << "    \"rows_per_second\": " << (elapsed > 0 ? rows / elapsed : 0)
+       << "\n";
+    os << "  }";
+  }
+  if (!report->snapshot_bytes.empty()) {
+    std::vector<double> &b = report->snapshot_bytes;
+    std::vector<double> &ser = report->serialize_seconds;
+    std::vector<double> &des = report->deserialize_seconds;
+    std::sort(b.begin(), b.end());
+    std::sort(ser.begin(), ser.end());
+    std::sort(des.begin(), des.end());
+
+    double total_bytes = 0;
+    for (auto d : b) {
+      total_bytes += d;
+    }
+
+    os << ",\n";
+    os << "  \"snapshot\": {\n";
+    os << "    \"count\": " << b.size() << ",\n";
+    os << "    \"mean_bytes\": " << total_bytes / b.size() << ",\n";
+    os << "    \"max_bytes\": " << static_cast<int64_t>(b.back()) << ",\n";
+    os << "    \"serialize_ms_p50\": " << 1000 * Percentile(ser, 0.5) << ",\n";
+    os << "    \"serialize_ms_p99\": " << 1000 * Percentile(ser, 0.99)
+       << ",\n";
+    os << "    \"deserialize_ms_p50\": " << 1000 * Percentile(des, 0.5)
+       << ",\n";
+    os << "    \"deserialize_ms_p99\": " << 1000 * Percentile(des, 0.99)
+       << "\n";
+    os << "  }";
+  }
+  if (!report->background_runs.empty()) {
+    os << ",\n";
+    os << "  \"shared_runtime\": " << (opts.shared_runtime ? "true" : "false")
+       << ",\n";
+    os << "  \"background_runs\": {\n";
+    int32_t k = 0;
+    for (const auto &p : report->background_runs) {
+      os << "    \"" << p.first << "\": " << p.second
+         << (++k < static_cast<int32_t>(report->background_runs.size())
+                 ? ",\n"
+                 : "\n");
+    }
+    os << "  }";
+  }
+  if (error_rate) {
+    os << ",\n";
+    os << "  \"error_rate\": {\n";
+    os << "    \"unit\": \"" << (opts.cer ? "char" : "word") << "\",\n";
+    os << "    \"errors\": " << error_rate->num_errors << ",\n";
+    os << "    \"ref_length\": " << error_rate->num_ref << ",\n";
+    os << "    \"rate\": "
+       << (error_rate->num_ref > 0
+               ? static_cast<double>(error_rate->num_errors) /
+                     error_rate->num_ref
+               : 0)
+       << "\n";
+    os << "  }";
+  }
+  os << "\n}\n";
+
+  return os.str();
+}
+
+// ParseOptions rejects unknown options, so we have to know the tasks
+// before registering the options of their configs. prefix is, e.g., --task=
+std::string GetOption(int32_t argc, char *argv[], const char *prefix) {
+  for (int32_t i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], prefix, strlen(prefix)) == 0) {
+      return argv[i] + strlen(prefix);
+    }
+  }
+  return {};
+}
+
+int32_t RunBench(int32_t argc, char *argv[]) {
+  ParseOptions po(kUsageMessage);
+  BenchOptions opts;
+  opts.Register(&po);
+
+  SharedRuntimeConfig shared_runtime_config;
+  shared_runtime_config.Register(&po);
+
+  std::string task = GetOption(argc, argv, "--task=");
+
+  auto factory = RegisterTask(task, &po);
+  if (!factory) {
+    po.Read(argc, argv);
+    fprintf(stderr, "Unsupported --task='%s'\n\n", task.c_str());
+    po.PrintUsage();
+    return -1;
+  }
+
+  std::vector<std::string> background_names;
+  SplitStringToVector(GetOption(argc, argv, "--background-tasks="), ",", true,
+                      &background_names);
+
+  std::vector<std::unique_ptr<TaskFactory>> background_factories;
+  for (const auto &name : background_names) {
+    ParseOptions prefixed_po(name, &po);
+    background_factories.push_back(RegisterTask(name, &prefixed_po));
+    if (!background_factories.back()) {
+      fprintf(stderr, "Unsupported background task '%s'\n", name.c_str());
+      return -1;
+    }
+  }
+
+  po.Read(argc, argv);
+
+  if (!opts.Validate()) {
+    return -1;
+  }
+
+  // It has to be created before any model
+  if (opts.shared_runtime && !InitSharedRuntime(shared_runtime_config)) {
+    return -1;
+  }
+
+  std::unique_ptr<Task> t = factory->Create();
+  if (!t) {
+    return -1;
+  }
+
+  std::vector<std::unique_ptr<Task>> background;
+  for (auto &f : background_factories) {
+    background.push_back(f->Create());
+    if (!background.back()) {
+      return -1;
+    }
+  }
+
+  std::vector<Audio> audio;
+  for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+    Audio a;
+    bool is_ok = false;
+    a.samples = ReadWave(po.GetArg(i), &a.sample_rate, &is_ok);
+    if (!is_ok) {
+      fprintf(stderr, "Failed to read '%s'\n", po.GetArg(i).c_str());
+      return -1;
+    }
+    audio.push_back(std::move(a));
+  }
+
+  std::vector<std::string> references;
+  if (!opts.transcripts.empty()) {
+    if (task != "online-asr" && task != "offline-asr") {
+      fprintf(stderr, "--transcripts is for online-asr and offline-asr only\n");
+      return -1;
+    }
+
+    std::ifstream is(opts.transcripts);
+    if (!is) {
+      fprintf(stderr, "Failed to open '%s'\n", opts.transcripts.c_str());
+      return -1;
+    }
+
+    std::string line;
+    while (std::getline(is, line)) {
+      references.push_back(line);
+    }
+
+    if (references.size() != audio.size()) {
+      fprintf(stderr,
+              "--transcripts has %d lines, but %d wave files are given\n",
+              static_cast<int32_t>(references.size()),
+              static_cast<int32_t>(audio.size()));
+      return -1;
+    }
+  }
+
+  if (audio.empty()) {
+    for (int32_t i = 0; i != opts.num_streams; ++i) {
+      audio.push_back(GenerateAudio(opts.duration, opts.sample_rate, i));
+    }
+  }
+
+  WorkerPool pool(opts.num_workers);
+
+  for (int32_t i = 0; i != opts.warmup; ++i) {
+    Report r;
+    t->Run(audio, 1, opts, &pool, &r);
+  }
+
+  // Warm up the background tasks, too
+  for (auto &b : background) {
+    Report r;
+    std::vector<Audio> a = {GenerateAudio(2, opts.sample_rate, 0)};
+    b->Run(a, 1, opts, &pool, &r);
+  }
+
+  // Metrics of the decoder model of transducers. A background task of the
+  // same kind would add to them
+  std::string decoder_prefix;
+  if ((task == "online-asr" || task == "offline-asr") &&
+      std::find(background_names.begin(), background_names.end(), task) ==
+          background_names.end()) {
+    decoder_prefix = task == "online-asr" ? "sherpa_onnx_online_decoder"
+                                          : "sherpa_onnx_offline_decoder";
+    MetricsRegistry::SetEnabled(true);
+    MetricsRegistry::Global().Reset();
+  }
+
+  Report report;
+  report.num_threads = t->NumThreads();
+
+  int64_t num_allocations = g_num_allocations.load();
+  int64_t allocated_bytes = g_allocated_bytes.load();
+
+  {
+    std::unique_ptr<BackgroundTasks> busy;
+    if (!background.empty()) {
+      busy = std::make_unique<BackgroundTasks>(&background, background_names,
+                                               opts);
+    }
+
+    for (int32_t i = 0; i != opts.num_repeats; ++i) {
+      t->Run(audio, opts.num_streams, opts, &pool, &report);
+    }
+
+    if (busy) {
+      report.background_runs = busy->Runs();
+    }
+  }
+
+  num_allocations = g_num_allocations.load() - num_allocations;
+  allocated_bytes = g_allocated_bytes.load() - allocated_bytes;
+
+  if (!decoder_prefix.empty()) {
+    auto &registry = MetricsRegistry::Global();
+    report.decoder_calls =
+        registry.GetHistogram(decoder_prefix + "_seconds", "")->Count();
+    report.decoder_rows =
+        registry.GetCounter(decoder_prefix + "_rows_total", "")->Value();
+  }
+
+  ErrorRate error_rate;
+  if (!references.empty()) {
+    error_rate = ComputeErrorRate(references, report.texts, opts.cer);
+  }
+
+  std::string json =
+      ToJson(opts, &report, num_allocations, allocated_bytes,
+             references.empty() ? nullptr : &error_rate);
+  fprintf(stdout, "%s", json.c_str());
+
+  if (!opts.output.empty()) {
+    std::ofstream os(opts.output);
+    if (!os) {
+      fprintf(stderr, "Failed to open '%s'\n", opts.output.c_str());
+      return -1;
+    }
+    os << json;
+  }
+
+  return 0;
+}
+
+}  // namespace
+
+}  // namespace sherpa_onnx
+
+int32_t main(int32_t argc, char *argv[]) {
+  return sherpa_onnx::RunBench(argc, argv);
+}
@@ -0,0 +1,159 @@
+// sherpa-onnx/csrc/sherpa-onnx-model-cache.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#include <stdio.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/model-cache.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/session.h"
+
+// Seconds to create a session for the model with the cache in dir.
+// An empty dir disables the cache.
+static double TimeCreateSession(const Ort::Env &env,
+                                const std::vector<char> &model,
+                                const Ort::SessionOptions &sess_opts,
+                                const std::string &dir) {
+  sherpa_onnx::SetModelCacheDir(dir);
+
+  auto start = std::chrono::steady_clock::now();
+  auto sess =
+      sherpa_onnx::CreateSession(env, model.data(), model.size(), sess_opts);
+
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Remove the entries and temporary files of the cache in dir. Other files
+// in dir are kept.
+static int32_t ClearModelCache(const std::string &dir) {
+  int32_t n = 0;
+  for (const auto &name : sherpa_onnx::ListFiles(dir)) {
+    if (sherpa_onnx::IsModelCacheFilename(name) &&
+        std::remove((dir + "/" + name).c_str()) == 0) {
+      ++n;
+    }
+  }
+
+  return n;
+}
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Pre-warm the cache of optimized models, e.g., when building a container
+image, so that the first start of a server does not spend time on graph
+optimizations.
+
+The cache is used when the environment variable SHERPA_ONNX_MODEL_CACHE_DIR
+is set to the same directory. Only models that run on CPU are cached. Pass
+the --graph-optimization-level that the models are loaded with, since it is
+part of the cache key. Entries of a model become stale when the model, the
+version of onnxruntime or the optimization level changes. Use --clear to
+remove them.
+
+For each model, it prints the time to create a session without the cache,
+when the entry is created and when it is loaded from the cache.
+
+Usage:
+
+./bin/sherpa-onnx-model-cache \
+  --cache-dir=/var/cache/sherpa-onnx \
+  --graph-optimization-level=extended \
+  /path/to/encoder.onnx \
+  /path/to/decoder.onnx \
+  /path/to/joiner.onnx
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+
+  std::string cache_dir;
+  std::string graph_optimization_level;
+  int32_t num_threads = 1;
+  bool clear = false;
+
+  po.Register("cache-dir", &cache_dir,
+              "Directory of the cache. It must exist. If empty, use "
+              "the environment variable SHERPA_ONNX_MODEL_CACHE_DIR");
+
+  po.Register("graph-optimization-level", &graph_optimization_level,
+              "Graph optimization level of onnxruntime: disable, basic, "
+              "extended or all. Leave it empty to use the default of "
+              "onnxruntime");
+
+  po.Register("num-threads", &num_threads,
+              "Number of threads to run the neural network");
+
+  po.Register("clear", &clear,
+              "true to remove all entries of the cache before pre-warming. "
+              "Other files in the directory are kept");
+
+  po.Read(argc, argv);
+
+  if (cache_dir.empty()) {
+    cache_dir = sherpa_onnx::GetModelCacheDir();
+  }
+
+  if (cache_dir.empty()) {
+    fprintf(stderr, "Please provide --cache-dir\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (clear) {
+    int32_t n = ClearModelCache(cache_dir);
+    fprintf(stderr, "Removed %d files from %s\n", n, cache_dir.c_str());
+  }
+
+  if (po.NumArgs() == 0 && !clear) {
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
+
+  Ort::SessionOptions sess_opts =
+      sherpa_onnx::GetSessionOptions(num_threads, "cpu");
+  sherpa_onnx::SetGraphOptimizationLevel(graph_optimization_level,
+                                         &sess_opts);
+
+  for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+    std::string filename = po.GetArg(i);
+    if (!sherpa_onnx::FileExists(filename)) {
+      fprintf(stderr, "%s does not exist\n", filename.c_str());
+      return -1;
+    }
+
+    std::vector<char> model = sherpa_onnx::ReadFile(filename);
+
+    std::string cache_file = sherpa_onnx::ModelCacheFilename(
+        cache_dir, sherpa_onnx::ModelCacheKey(model.data(), model.size(),
+                                              graph_optimization_level));
+
+    // Measure the creation of the entry even if it exists
+    std::remove(cache_file.c_str());
+
+    double no_cache = TimeCreateSession(env, model, sess_opts, "");
+    double miss = TimeCreateSession(env, model, sess_opts, cache_dir);
+
+    if (!sherpa_onnx::FileExists(cache_file)) {
+      fprintf(stderr, "Failed to cache %s\n", filename.c_str());
+      return -1;
+    }
+
+    double hit = TimeCreateSession(env, model, sess_opts, cache_dir);
+
+    fprintf(stderr, "%s -> %s\n", filename.c_str(), cache_file.c_str());
+    fprintf(stderr,
+            "  without cache: %.3f s, creating the entry: %.3f s, from "
+            "cache: %.3f s\n",
+            no_cache, miss, hit);
+  }
+
+  return 0;
+}
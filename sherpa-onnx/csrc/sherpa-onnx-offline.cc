@@ -10,6 +10,7 @@
 
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/trace.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 
 int main(int32_t argc, char *argv[]) {
@@ -107,6 +108,11 @@ for a list of pre-trained models to download.
   sherpa_onnx::OfflineRecognizerConfig config;
   config.Register(&po);
 
+  std::string trace_file;
+  po.Register("trace-file", &trace_file,
+              "If not empty, write a Chrome trace of the decoding to this "
+              "file. You can view it with https://ui.perfetto.dev");
+
   po.Read(argc, argv);
   if (po.NumArgs() < 1) {
     fprintf(stderr, "Error: Please provide at least 1 wave file.\n\n");
@@ -124,6 +130,10 @@ for a list of pre-trained models to download.
   fprintf(stderr, "Creating recognizer ...\n");
   sherpa_onnx::OfflineRecognizer recognizer(config);
 
+  if (!trace_file.empty()) {
+    sherpa_onnx::Tracer::Global().Start(trace_file);
+  }
+
   fprintf(stderr, "Started\n");
   const auto begin = std::chrono::steady_clock::now();
 
@@ -175,5 +185,7 @@ for a list of pre-trained models to download.
   fprintf(stderr, "Real time factor (RTF): %.3f / %.3f = %.3f\n",
           elapsed_seconds, duration, rtf);
 
+  sherpa_onnx::Tracer::Global().Stop();
+
   return 0;
 }
@@ -0,0 +1,84 @@
+// sherpa-onnx/csrc/sherpa-onnx-online-tuner.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#include <stdio.h>
+
+#include <string>
+
+#include "sherpa-onnx/csrc/online-recognizer-tuner.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Find the number of threads, the graph optimization level and the batch size
+that work best for a streaming model on this machine.
+
+It decodes synthetic audio with each candidate and saves the best one to
+the profile file, keyed by the hash of the model files and the CPU model.
+An existing entry for the same key is replaced. Pass the profile file to
+./bin/sherpa-onnx-online-websocket-server --tuning-profile to use it.
+
+Usage:
+
+./bin/sherpa-onnx-online-tuner \
+  --tokens=/path/to/tokens.txt \
+  --encoder=/path/to/encoder.onnx \
+  --decoder=/path/to/decoder.onnx \
+  --joiner=/path/to/joiner.onnx \
+  --tune-max-num-threads=8 \
+  --tune-max-batch-size=16 \
+  --tuning-profile=./tuning-profile.txt
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  sherpa_onnx::OnlineRecognizerConfig config;
+  sherpa_onnx::OnlineRecognizerTunerConfig tuner_config;
+
+  std::string profile_file = "./tuning-profile.txt";
+  po.Register("tuning-profile", &profile_file,
+              "The tuned profile is saved to this file");
+
+  config.Register(&po);
+  tuner_config.Register(&po);
+
+  if (argc == 1) {
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  po.Read(argc, argv);
+  if (po.NumArgs() != 0) {
+    fprintf(stderr, "Unrecognized positional arguments!\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(stderr, "%s\n", config.ToString().c_str());
+  fprintf(stderr, "%s\n", tuner_config.ToString().c_str());
+
+  if (!config.Validate() || !tuner_config.Validate()) {
+    fprintf(stderr, "Errors in config!\n");
+    return -1;
+  }
+
+  std::string model_hash =
+      sherpa_onnx::HashFiles(sherpa_onnx::ModelFiles(config.model_config));
+  std::string cpu_model = sherpa_onnx::CpuModelName();
+
+  sherpa_onnx::TuningProfile profile =
+      sherpa_onnx::TuneOnlineRecognizer(config, tuner_config);
+
+  fprintf(stderr, "Model hash: %s\n", model_hash.c_str());
+  fprintf(stderr, "CPU: %s\n", cpu_model.c_str());
+  fprintf(stderr, "%s\n", profile.ToString().c_str());
+
+  if (!sherpa_onnx::SaveTuningProfile(profile_file, model_hash, cpu_model,
+                                      profile)) {
+    return -1;
+  }
+
+  fprintf(stderr, "Saved to %s\n", profile_file.c_str());
+
+  return 0;
+}
@@ -194,8 +194,8 @@ for a list of pre-trained models to download.
     }
 
     while (!vad->Empty()) {
-      const auto &segment = vad->Front();
-      float duration = segment.samples.size() / 16000.;
+      const auto &segment = vad->FrontView();
+      float duration = segment.samples.Size() / 16000.;
       float start_time = segment.start / 16000.;
       float end_time = start_time + duration;
       if (duration < 0.1) {
@@ -204,7 +204,7 @@ for a list of pre-trained models to download.
       }
 
       auto s = recognizer.CreateStream();
-      s->AcceptWaveform(16000, segment.samples.data(), segment.samples.size());
+      s->AcceptWaveform(16000, segment.samples);
       recognizer.DecodeStream(s.get());
       const auto &result = s->GetResult();
       if (!result.text.empty()) {
@@ -14,6 +14,7 @@
 #include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/parse-options.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
+#include "sherpa-onnx/csrc/trace.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 
 typedef struct {
@@ -80,6 +81,11 @@ for a list of pre-trained models to download.
 
   config.Register(&po);
 
+  std::string trace_file;
+  po.Register("trace-file", &trace_file,
+              "If not empty, write a Chrome trace of the decoding to this "
+              "file. You can view it with https://ui.perfetto.dev");
+
   po.Read(argc, argv);
   if (po.NumArgs() < 1) {
     po.PrintUsage();
@@ -96,6 +102,10 @@ for a list of pre-trained models to download.
 
   sherpa_onnx::OnlineRecognizer recognizer(config);
 
+  if (!trace_file.empty()) {
+    sherpa_onnx::Tracer::Global().Start(trace_file);
+  }
+
   std::vector<Stream> ss;
 
   const auto begin = std::chrono::steady_clock::now();
@@ -171,5 +181,7 @@ for a list of pre-trained models to download.
 
   std::cerr << os.str();
 
+  sherpa_onnx::Tracer::Global().Stop();
+
   return 0;
 }
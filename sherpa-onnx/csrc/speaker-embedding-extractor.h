@@ -20,6 +20,10 @@ struct SpeakerEmbeddingExtractorConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   SpeakerEmbeddingExtractorConfig() = default;
   SpeakerEmbeddingExtractorConfig(const std::string &model, int32_t num_threads,
                                   bool debug, const std::string &provider)
@@ -13,6 +13,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/spoken-language-identification-whisper-impl.h"
 
 namespace sherpa_onnx {
@@ -31,8 +32,7 @@ static ModelType GetModelType(char *model_data, size_t model_data_length,
   Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
   Ort::SessionOptions sess_opts;
 
-  auto sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
-                                             sess_opts);
+  auto sess = CreateSession(env, model_data, model_data_length, sess_opts);
 
   Ort::ModelMetadata meta_data = sess->GetModelMetadata();
   if (debug) {
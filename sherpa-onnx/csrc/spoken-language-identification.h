@@ -53,6 +53,10 @@ struct SpokenLanguageIdentificationConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   SpokenLanguageIdentificationConfig() = default;
 
   SpokenLanguageIdentificationConfig(
@@ -0,0 +1,51 @@
+// sherpa-onnx/csrc/thread-pool-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/thread-pool.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(ThreadPool, ParallelFor) {
+  for (int32_t num_threads : {0, 1, 4}) {
+    ThreadPool pool(num_threads);
+    EXPECT_EQ(pool.NumThreads(), num_threads);
+
+    for (int32_t n : {0, 1, 3, 100}) {
+      std::vector<int32_t> v(n, 0);
+      pool.ParallelFor(n, [&v](int32_t i) { v[i] += i + 1; });
+
+      for (int32_t i = 0; i != n; ++i) {
+        EXPECT_EQ(v[i], i + 1);
+      }
+    }
+  }
+}
+
+TEST(ThreadPool, ConcurrentCallers) {
+  ThreadPool pool(3);
+  std::atomic<int32_t> sum{0};
+
+  std::vector<std::thread> callers;
+  for (int32_t k = 0; k != 4; ++k) {
+    callers.emplace_back([&pool, &sum] {
+      for (int32_t r = 0; r != 50; ++r) {
+        pool.ParallelFor(10, [&sum](int32_t i) { sum += i; });
+      }
+    });
+  }
+
+  for (auto &t : callers) {
+    t.join();
+  }
+
+  EXPECT_EQ(sum.load(), 4 * 50 * 45);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,121 @@
+// sherpa-onnx/csrc/thread-pool.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/thread-pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace sherpa_onnx {
+
+namespace {
+
+// State of one ParallelFor() call. Workers hold a reference to it since
+// they may pick up their task after the caller has done all the work.
+struct ParallelForState {
+  ParallelForState(int32_t n, const std::function<void(int32_t)> &f)
+      : n(n), f(f) {}
+
+  // Run items until none is left
+  void Run() {
+    int32_t i;
+    while ((i = next.fetch_add(1)) < n) {
+      f(i);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (++num_done == n) {
+        cond.notify_one();
+      }
+    }
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return num_done == n; });
+  }
+
+  const int32_t n;
+  const std::function<void(int32_t)> &f;
+  std::atomic<int32_t> next{0};
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  int32_t num_done = 0;
+};
+
+}  // namespace
+
+ThreadPool::ThreadPool(int32_t num_threads) {
+  threads_.reserve(std::max(num_threads, 0));
+  for (int32_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this] { Loop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+
+  for (auto &t : threads_) {
+    t.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int32_t n,
+                             const std::function<void(int32_t)> &f) {
+  if (n <= 0) {
+    return;
+  }
+
+  int32_t num_helpers = std::min(n - 1, NumThreads());
+  if (num_helpers == 0) {
+    for (int32_t i = 0; i != n; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  // f outlives all calls to it: Wait() returns only after the last one
+  auto state = std::make_shared<ParallelForState>(n, f);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int32_t i = 0; i != num_helpers; ++i) {
+      tasks_.emplace_back([state] { state->Run(); });
+    }
+  }
+
+  if (num_helpers == 1) {
+    cond_.notify_one();
+  } else {
+    cond_.notify_all();
+  }
+
+  state->Run();
+  state->Wait();
+}
+
+void ThreadPool::Loop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;  // stop_ is true
+      }
+
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    task();
+  }
+}
+
+}  // namespace sherpa_onnx
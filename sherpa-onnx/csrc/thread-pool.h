@@ -0,0 +1,55 @@
+// sherpa-onnx/csrc/thread-pool.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_THREAD_POOL_H_
+#define SHERPA_ONNX_CSRC_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace sherpa_onnx {
+
+// A fixed set of worker threads that run tasks from a FIFO queue.
+class ThreadPool {
+ public:
+  // num_threads is the number of worker threads. If it is 0, all tasks
+  // passed to ParallelFor() run on the calling thread.
+  explicit ThreadPool(int32_t num_threads);
+
+  // Wait for queued tasks to finish and join the workers
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int32_t NumThreads() const { return static_cast<int32_t>(threads_.size()); }
+
+  /** Call f(0), f(1), ..., f(n-1) in an unspecified order and return after
+   * all of them have returned.
+   *
+   * The calls are shared between the workers and the calling thread.
+   * It is safe to call it from several threads at the same time.
+   */
+  void ParallelFor(int32_t n, const std::function<void(int32_t)> &f);
+
+ private:
+  void Loop();
+
+ private:
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_ = false;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_THREAD_POOL_H_
@@ -0,0 +1,78 @@
+// sherpa-onnx/csrc/trace-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/trace.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+static std::string ReadFile(const std::string &filename) {
+  std::ifstream is(filename);
+  std::ostringstream os;
+  os << is.rdbuf();
+  return os.str();
+}
+
+static int32_t Count(const std::string &s, const std::string &pattern) {
+  int32_t n = 0;
+  for (auto pos = s.find(pattern); pos != std::string::npos;
+       pos = s.find(pattern, pos + 1)) {
+    ++n;
+  }
+  return n;
+}
+
+TEST(Tracer, Disabled) {
+  ASSERT_FALSE(Tracer::Global().Enabled());
+  { SHERPA_ONNX_TRACE_SCOPE("not-recorded"); }
+}
+
+#if SHERPA_ONNX_ENABLE_TRACE
+TEST(Tracer, WriteSpans) {
+  std::string filename = "./trace-test.json";
+  ASSERT_TRUE(Tracer::Global().Start(filename));
+
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i != 3; ++i) {
+    threads.emplace_back([]() {
+      for (int32_t k = 0; k != 5000; ++k) {
+        SHERPA_ONNX_TRACE_SCOPE_N("span", k);
+      }
+    });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  SHERPA_ONNX_TRACE_COUNTER("queue", 3);
+
+  Tracer::Global().Stop();
+  EXPECT_FALSE(Tracer::Global().Enabled());
+
+  std::string text = ReadFile(filename);
+  ASSERT_GE(text.size(), 4);
+  EXPECT_EQ(text.substr(0, 2), "[\n");
+  EXPECT_EQ(text.substr(text.size() - 3), "\n]\n");
+
+  EXPECT_EQ(Count(text, "\"name\":\"span\""), 15000);
+  EXPECT_EQ(Count(text, "\"ph\":\"C\""), 1);
+  EXPECT_EQ(Count(text, "\"args\":{\"n\":4999}"), 3);
+
+  // one event per line
+  EXPECT_EQ(Count(text, "\n"), 15001 + 2);
+
+  { SHERPA_ONNX_TRACE_SCOPE("after-stop"); }
+  EXPECT_EQ(ReadFile(filename), text);
+}
+#endif
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,161 @@
+// sherpa-onnx/csrc/trace.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/trace.h"
+
+#include <cinttypes>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// Number of events a thread buffers before appending them to the file
+static constexpr int32_t kMaxBufferedEvents = 4096;
+
+Tracer &Tracer::Global() {
+  // Never destroyed so that threads can still record events during exit
+  static Tracer *tracer = []() {
+    auto t = new Tracer;
+    std::atexit([]() { Tracer::Global().Stop(); });
+    return t;
+  }();
+  return *tracer;
+}
+
+Tracer::~Tracer() { Stop(); }
+
+bool Tracer::Start(const std::string &filename) {
+#if !SHERPA_ONNX_ENABLE_TRACE
+  SHERPA_ONNX_LOGE(
+      "sherpa-onnx is built with -DSHERPA_ONNX_ENABLE_TRACE=OFF. Ignore "
+      "the trace file %s",
+      filename.c_str());
+  return false;
+#else
+  Stop();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_ = fopen(filename.c_str(), "w");
+  if (!file_) {
+    SHERPA_ONNX_LOGE("Failed to open %s for writing", filename.c_str());
+    return false;
+  }
+
+  fprintf(file_, "[\n");
+  num_written_ = 0;
+
+  start_ = std::chrono::steady_clock::now();
+  enabled_.store(true, std::memory_order_relaxed);
+
+  return true;
+#endif
+}
+
+void Tracer::Stop() {
+  if (!enabled_.exchange(false)) {
+    return;
+  }
+
+  std::vector<ThreadBuffer *> buffers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &b : buffers_) {
+      buffers.push_back(b.get());
+    }
+  }
+
+  // Lock order: ThreadBuffer::mutex and then mutex_
+  for (auto b : buffers) {
+    std::lock_guard<std::mutex> lock(b->mutex);
+    Flush(b);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_) {
+    fprintf(file_, "\n]\n");
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+int64_t Tracer::Now() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start_)
+      .count();
+}
+
+void Tracer::AddSpan(const char *name, int64_t start_us, int64_t dur_us,
+                     int64_t n /*= -1*/) {
+  Add({name, start_us, dur_us, n});
+}
+
+void Tracer::AddCounter(const char *name, int64_t value) {
+  Add({name, Now(), -1, value});
+}
+
+Tracer::ThreadBuffer *Tracer::GetThreadBuffer() {
+  // Buffers are never freed, so the pointer stays valid even if the
+  // tracer is restarted
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(std::make_unique<ThreadBuffer>());
+    buffer = buffers_.back().get();
+    buffer->tid = static_cast<int32_t>(buffers_.size());
+    buffer->events.reserve(kMaxBufferedEvents);
+  }
+  return buffer;
+}
+
+void Tracer::Add(const Event &e) {
+  ThreadBuffer *b = GetThreadBuffer();
+
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->events.push_back(e);
+
+  if (static_cast<int32_t>(b->events.size()) >= kMaxBufferedEvents) {
+    Flush(b);
+  }
+}
+
+void Tracer::Flush(ThreadBuffer *b) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_) {
+    b->events.clear();
+    return;
+  }
+
+  for (const auto &e : b->events) {
+    if (num_written_ > 0) {
+      fprintf(file_, ",\n");
+    }
+
+    if (e.dur >= 0) {
+      fprintf(file_,
+              "{\"name\":\"%s\",\"cat\":\"sherpa-onnx\",\"ph\":\"X\","
+              "\"ts\":%" PRId64 ",\"dur\":%" PRId64 ",\"pid\":0,\"tid\":%d",
+              e.name, e.ts, e.dur, b->tid);
+      if (e.value >= 0) {
+        fprintf(file_, ",\"args\":{\"n\":%" PRId64 "}", e.value);
+      }
+      fprintf(file_, "}");
+    } else {
+      fprintf(file_,
+              "{\"name\":\"%s\",\"cat\":\"sherpa-onnx\",\"ph\":\"C\","
+              "\"ts\":%" PRId64 ",\"pid\":0,\"tid\":%d,"
+              "\"args\":{\"value\":%" PRId64 "}}",
+              e.name, e.ts, b->tid, e.value);
+    }
+
+    ++num_written_;
+  }
+
+  fflush(file_);
+  b->events.clear();
+}
+
+}  // namespace sherpa_onnx
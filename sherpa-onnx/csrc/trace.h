@@ -0,0 +1,157 @@
+// sherpa-onnx/csrc/trace.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_TRACE_H_
+#define SHERPA_ONNX_CSRC_TRACE_H_
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#ifndef SHERPA_ONNX_ENABLE_TRACE
+#define SHERPA_ONNX_ENABLE_TRACE 1
+#endif
+
+namespace sherpa_onnx {
+
+/** A profiler that records trace events in the Chrome trace-event format.
+ *
+ * The output file can be opened with https://ui.perfetto.dev or
+ * chrome://tracing. Each thread records its events into its own buffer,
+ * so recording a span does not contend on a lock shared with other
+ * threads. A buffer is appended to the file when it is full or when
+ * Stop() is called.
+ *
+ * The file uses the JSON array format, for which the closing bracket
+ * is optional, so a trace is still readable if the process is killed.
+ */
+class Tracer {
+ public:
+  // The process-wide tracer used by SHERPA_ONNX_TRACE_SCOPE
+  static Tracer &Global();
+
+  ~Tracer();
+
+  // Start recording into the given file. Return false if the file cannot
+  // be opened. If it is already recording, the previous file is closed.
+  // Events are also flushed at exit.
+  bool Start(const std::string &filename);
+
+  // Write all buffered events and close the file
+  void Stop();
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Microseconds since Start()
+  int64_t Now() const;
+
+  /** Record a complete event ("ph": "X").
+   *
+   * @param name  It must outlive the tracer, e.g., a string literal.
+   * @param start_us  Start time returned by Now().
+   * @param dur_us  Duration in microseconds.
+   * @param n  If not negative, it is saved in "args" as {"n": n}, e.g.,
+   *           the batch size.
+   */
+  void AddSpan(const char *name, int64_t start_us, int64_t dur_us,
+               int64_t n = -1);
+
+  // Record a counter event ("ph": "C"), e.g., the length of a queue.
+  // name must outlive the tracer.
+  void AddCounter(const char *name, int64_t value);
+
+ private:
+  struct Event {
+    const char *name;
+    int64_t ts;
+    int64_t dur;  // -1 for counter events
+    int64_t value;
+  };
+
+  struct ThreadBuffer {
+    int32_t tid;
+    std::mutex mutex;  // Locked by the owning thread and by Flush()
+    std::vector<Event> events;
+  };
+
+  ThreadBuffer *GetThreadBuffer();
+
+  void Add(const Event &e);
+
+  // The caller holds b->mutex
+  void Flush(ThreadBuffer *b);
+
+ private:
+  std::atomic<bool> enabled_{false};
+  std::chrono::steady_clock::time_point start_;
+
+  std::mutex mutex_;  // Protects file_ and buffers_
+  FILE *file_ = nullptr;
+  int64_t num_written_ = 0;  // number of events in file_
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// Record the time spent in a scope as a span of the current thread
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(const char *name, int64_t n = -1) {
+    Tracer &tracer = Tracer::Global();
+    if (tracer.Enabled()) {
+      name_ = name;
+      n_ = n;
+      start_ = tracer.Now();
+    }
+  }
+
+  ~ScopedTrace() {
+    if (name_) {
+      Tracer &tracer = Tracer::Global();
+      tracer.AddSpan(name_, start_, tracer.Now() - start_, n_);
+    }
+  }
+
+  ScopedTrace(const ScopedTrace &) = delete;
+  ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+ private:
+  const char *name_ = nullptr;
+  int64_t start_ = 0;
+  int64_t n_ = -1;
+};
+
+#define SHERPA_ONNX_TRACE_CONCAT_IMPL(a, b) a##b
+#define SHERPA_ONNX_TRACE_CONCAT(a, b) SHERPA_ONNX_TRACE_CONCAT_IMPL(a, b)
+
+#if SHERPA_ONNX_ENABLE_TRACE
+// Trace the rest of the enclosing scope. name must be a string literal.
+#define SHERPA_ONNX_TRACE_SCOPE(name)                                   \
+  ::sherpa_onnx::ScopedTrace SHERPA_ONNX_TRACE_CONCAT(sherpa_onnx_trace_, \
+                                                      __LINE__)(name)
+
+// Like SHERPA_ONNX_TRACE_SCOPE and it also records n, e.g., a batch size
+#define SHERPA_ONNX_TRACE_SCOPE_N(name, n)                              \
+  ::sherpa_onnx::ScopedTrace SHERPA_ONNX_TRACE_CONCAT(sherpa_onnx_trace_, \
+                                                      __LINE__)(name, n)
+
+#define SHERPA_ONNX_TRACE_COUNTER(name, value)                  \
+  do {                                                          \
+    auto &sherpa_onnx_tracer = ::sherpa_onnx::Tracer::Global(); \
+    if (sherpa_onnx_tracer.Enabled()) {                         \
+      sherpa_onnx_tracer.AddCounter(name, value);               \
+    }                                                           \
+  } while (0)
+#else
+#define SHERPA_ONNX_TRACE_SCOPE(name)
+#define SHERPA_ONNX_TRACE_SCOPE_N(name, n)
+#define SHERPA_ONNX_TRACE_COUNTER(name, value)
+#endif
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_TRACE_H_
@@ -0,0 +1,75 @@
+// sherpa-onnx/csrc/tuning-profile-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/tuning-profile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(TuningProfile, SaveAndLoad) {
+  std::string filename = "tuning-profile-test.txt";
+  std::remove(filename.c_str());
+
+  TuningProfile p;
+  EXPECT_FALSE(LoadTuningProfile(filename, "abc", "cpu x4", &p));
+
+  TuningProfile a;
+  a.num_threads = 4;
+  a.graph_optimization_level = "extended";
+  a.max_batch_size = 8;
+  EXPECT_TRUE(SaveTuningProfile(filename, "abc", "cpu x4", a));
+
+  TuningProfile b;
+  b.num_threads = 2;
+  b.max_batch_size = 16;
+  EXPECT_TRUE(SaveTuningProfile(filename, "abc", "other cpu x8", b));
+
+  EXPECT_TRUE(LoadTuningProfile(filename, "abc", "cpu x4", &p));
+  EXPECT_EQ(p.num_threads, 4);
+  EXPECT_EQ(p.graph_optimization_level, "extended");
+  EXPECT_EQ(p.max_batch_size, 8);
+
+  EXPECT_TRUE(LoadTuningProfile(filename, "abc", "other cpu x8", &p));
+  EXPECT_EQ(p.num_threads, 2);
+  EXPECT_EQ(p.graph_optimization_level, "");
+  EXPECT_EQ(p.max_batch_size, 16);
+
+  // Replace an existing profile
+  a.num_threads = 3;
+  EXPECT_TRUE(SaveTuningProfile(filename, "abc", "cpu x4", a));
+  EXPECT_TRUE(LoadTuningProfile(filename, "abc", "cpu x4", &p));
+  EXPECT_EQ(p.num_threads, 3);
+
+  EXPECT_FALSE(LoadTuningProfile(filename, "abd", "cpu x4", &p));
+
+  std::remove(filename.c_str());
+}
+
+TEST(TuningProfile, HashFiles) {
+  std::string filename = "tuning-profile-test.bin";
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os << "model";
+  }
+  std::string h1 = HashFiles({filename});
+  EXPECT_EQ(h1.size(), 16);
+  EXPECT_EQ(HashFiles({filename}), h1);
+
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os << "model2";
+  }
+  EXPECT_NE(HashFiles({filename}), h1);
+
+  std::remove(filename.c_str());
+
+  EXPECT_FALSE(CpuModelName().empty());
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,204 @@
+// sherpa-onnx/csrc/tuning-profile.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/tuning-profile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/mapped-file.h"
+#include "sherpa-onnx/csrc/text-utils.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t Fnv1a(const char *p, size_t n, uint64_t h) {
+  for (size_t i = 0; i != n; ++i) {
+    h ^= static_cast<uint8_t>(p[i]);
+    h *= kFnvPrime;
+  }
+  return h;
+}
+
+// Fields of a line are separated by tabs:
+//   model_hash cpu_model num_threads graph_optimization_level max_batch_size
+// An empty graph_optimization_level is saved as "default".
+std::string ToLine(const std::string &model_hash, const std::string &cpu_model,
+                   const TuningProfile &p) {
+  std::ostringstream os;
+  os << model_hash << '\t' << cpu_model << '\t' << p.num_threads << '\t'
+     << (p.graph_optimization_level.empty() ? "default"
+                                            : p.graph_optimization_level)
+     << '\t' << p.max_batch_size;
+  return os.str();
+}
+
+bool ParseLine(const std::string &line, std::string *model_hash,
+               std::string *cpu_model, TuningProfile *p) {
+  std::vector<std::string> fields;
+  SplitStringToVector(line, "\t", false, &fields);
+  if (fields.size() != 5) {
+    return false;
+  }
+
+  *model_hash = fields[0];
+  *cpu_model = fields[1];
+
+  if (!ConvertStringToInteger(fields[2], &p->num_threads) ||
+      !ConvertStringToInteger(fields[4], &p->max_batch_size)) {
+    return false;
+  }
+
+  p->graph_optimization_level = fields[3] == "default" ? "" : fields[3];
+
+  return true;
+}
+
+std::string ReadCpuModel() {
+#if defined(__APPLE__)
+  char buf[256] = {};
+  size_t size = sizeof(buf);
+  if (sysctlbyname("machdep.cpu.brand_string", buf, &size, nullptr, 0) == 0) {
+    return buf;
+  }
+#elif defined(__linux__)
+  std::ifstream is("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(is, line)) {
+    // x86 uses "model name". Some arm boards have "Hardware" only
+    for (const char *key : {"model name", "Hardware", "cpu model"}) {
+      if (line.compare(0, strlen(key), key) == 0) {
+        auto colon = line.find(':');
+        if (colon == std::string::npos) {
+          continue;
+        }
+
+        auto pos = line.find_first_not_of(" \t", colon + 1);
+        if (pos != std::string::npos) {
+          return line.substr(pos);
+        }
+      }
+    }
+  }
+#endif
+  return "unknown";
+}
+
+}  // namespace
+
+std::string TuningProfile::ToString() const {
+  std::ostringstream os;
+  os << "TuningProfile(";
+  os << "num_threads=" << num_threads << ", ";
+  os << "graph_optimization_level=\"" << graph_optimization_level << "\", ";
+  os << "max_batch_size=" << max_batch_size << ")";
+  return os.str();
+}
+
+std::string CpuModelName() {
+  std::string ans = ReadCpuModel();
+  std::replace(ans.begin(), ans.end(), '\t', ' ');
+
+  ans += " x" + std::to_string(std::thread::hardware_concurrency());
+  return ans;
+}
+
+std::string HashFiles(const std::vector<std::string> &filenames) {
+  uint64_t h = kFnvOffset;
+  for (const auto &f : filenames) {
+    h = Fnv1a(f.data(), f.size(), h);
+
+    auto file = MappedFile::Open(f);
+    if (file) {
+      h = Fnv1a(file->Data(), file->Size(), h);
+    }
+  }
+
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+  return buf;
+}
+
+bool LoadTuningProfile(const std::string &filename,
+                       const std::string &model_hash,
+                       const std::string &cpu_model, TuningProfile *profile) {
+  std::ifstream is(filename);
+  std::string line;
+  while (std::getline(is, line)) {
+    std::string h;
+    std::string c;
+    TuningProfile p;
+    if (ParseLine(line, &h, &c, &p) && h == model_hash && c == cpu_model) {
+      *profile = p;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool SaveTuningProfile(const std::string &filename,
+                       const std::string &model_hash,
+                       const std::string &cpu_model,
+                       const TuningProfile &profile) {
+  std::vector<std::string> lines;
+  {
+    std::ifstream is(filename);
+    std::string line;
+    while (std::getline(is, line)) {
+      std::string h;
+      std::string c;
+      TuningProfile p;
+      if (ParseLine(line, &h, &c, &p) &&
+          !(h == model_hash && c == cpu_model)) {
+        lines.push_back(line);
+      }
+    }
+  }
+  lines.push_back(ToLine(model_hash, cpu_model, profile));
+
+  // Write to a temporary file first so that a crash does not leave a
+  // truncated profile file
+  std::string tmp = filename + ".tmp";
+  {
+    std::ofstream os(tmp);
+    for (const auto &line : lines) {
+      os << line << "\n";
+    }
+
+    if (!os) {
+      SHERPA_ONNX_LOGE("Failed to write '%s'", tmp.c_str());
+      return false;
+    }
+  }
+
+#if defined(_WIN32)
+  std::remove(filename.c_str());
+#endif
+
+  if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+    SHERPA_ONNX_LOGE("Failed to rename '%s' to '%s'", tmp.c_str(),
+                     filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,64 @@
+// sherpa-onnx/csrc/tuning-profile.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_TUNING_PROFILE_H_
+#define SHERPA_ONNX_CSRC_TUNING_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Runtime parameters that work best for a model on a kind of CPU.
+ *
+ * They are found by benchmarking, see online-recognizer-tuner.h, and
+ * saved in a profile file so that the next start can reuse them.
+ */
+struct TuningProfile {
+  // Number of intra-op threads of onnxruntime
+  int32_t num_threads = 1;
+
+  // Empty to use the default of onnxruntime. Otherwise, one of disable,
+  // basic, extended, all
+  std::string graph_optimization_level;
+
+  // Max number of streams decoded together
+  int32_t max_batch_size = 1;
+
+  std::string ToString() const;
+};
+
+// A name of the CPU of this machine, e.g., the model name in /proc/cpuinfo,
+// followed by the number of hardware threads.
+std::string CpuModelName();
+
+/** Return a hash of the content of the given files, in hex.
+ *
+ * Files that cannot be opened are hashed by name only.
+ */
+std::string HashFiles(const std::vector<std::string> &filenames);
+
+/** Look up the profile for a (model hash, CPU model) pair in a profile
+ * file.
+ *
+ * @return Return true if it is found.
+ */
+bool LoadTuningProfile(const std::string &filename,
+                       const std::string &model_hash,
+                       const std::string &cpu_model, TuningProfile *profile);
+
+/** Add or replace the profile for a (model hash, CPU model) pair in a
+ * profile file. Profiles of other pairs are kept.
+ *
+ * @return Return true on success.
+ */
+bool SaveTuningProfile(const std::string &filename,
+                       const std::string &model_hash,
+                       const std::string &cpu_model,
+                       const TuningProfile &profile);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_TUNING_PROFILE_H_
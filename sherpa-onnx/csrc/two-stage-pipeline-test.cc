@@ -0,0 +1,95 @@
+// sherpa-onnx/csrc/two-stage-pipeline-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/two-stage-pipeline.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(TwoStagePipeline, Order) {
+  TwoStagePipeline pipeline;
+
+  std::vector<int32_t> first;
+  std::vector<int32_t> second;
+  std::vector<int32_t> value(10, 0);
+
+  std::vector<TwoStagePipeline::Job> jobs;
+  for (int32_t i = 0; i != 10; ++i) {
+    jobs.push_back({[&, i] {
+                      first.push_back(i);
+                      value[i] = i;
+                    },
+                    [&, i] {
+                      second.push_back(i);
+                      // the first stage of this job has finished
+                      value[i] *= 2;
+                    }});
+  }
+
+  pipeline.Run(std::move(jobs));
+
+  ASSERT_EQ(first.size(), 10);
+  ASSERT_EQ(second.size(), 10);
+  for (int32_t i = 0; i != 10; ++i) {
+    EXPECT_EQ(first[i], i);
+    EXPECT_EQ(second[i], i);
+    EXPECT_EQ(value[i], 2 * i);
+  }
+}
+
+TEST(TwoStagePipeline, Overlap) {
+  TwoStagePipeline pipeline;
+
+  // The first stage of job 1 runs while the second stage of job 0 waits
+  // for it
+  std::atomic<bool> first_of_job1_started{false};
+  std::atomic<bool> overlapped{false};
+
+  std::vector<TwoStagePipeline::Job> jobs;
+  jobs.push_back({[] {},
+                  [&] {
+                    for (int32_t i = 0; i != 1000; ++i) {
+                      if (first_of_job1_started) {
+                        overlapped = true;
+                        break;
+                      }
+                      std::this_thread::sleep_for(
+                          std::chrono::milliseconds(1));
+                    }
+                  }});
+  jobs.push_back({[&] { first_of_job1_started = true; }, [] {}});
+
+  pipeline.Run(std::move(jobs));
+  EXPECT_TRUE(overlapped);
+}
+
+TEST(TwoStagePipeline, ConcurrentCallers) {
+  TwoStagePipeline pipeline;
+  std::atomic<int32_t> sum{0};
+
+  std::vector<std::thread> callers;
+  for (int32_t k = 0; k != 4; ++k) {
+    callers.emplace_back([&pipeline, &sum] {
+      for (int32_t r = 0; r != 20; ++r) {
+        std::vector<TwoStagePipeline::Job> jobs(
+            3, {[&sum] { sum += 1; }, [&sum] { sum += 2; }});
+        pipeline.Run(std::move(jobs));
+      }
+    });
+  }
+
+  for (auto &t : callers) {
+    t.join();
+  }
+
+  EXPECT_EQ(sum.load(), 4 * 20 * 3 * 3);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,111 @@
+// sherpa-onnx/csrc/two-stage-pipeline.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/two-stage-pipeline.h"
+
+#include <utility>
+
+namespace sherpa_onnx {
+
+// Jobs of one call to Run(). Each job is a task.
+struct TwoStagePipeline::Task {
+  Job job;
+
+  // Shared by the tasks of a call to Run()
+  struct Group {
+    std::mutex mutex;
+    std::condition_variable cond;
+    int32_t num_pending = 0;
+  };
+  std::shared_ptr<Group> group;
+};
+
+TwoStagePipeline::TwoStagePipeline() {
+  first_.thread = std::thread([this] { Loop(&first_, true); });
+  second_.thread = std::thread([this] { Loop(&second_, false); });
+}
+
+TwoStagePipeline::~TwoStagePipeline() {
+  // The first stage stops before the second one, so all tasks that have
+  // passed the first stage are also finished by the second one.
+  for (Stage *stage : {&first_, &second_}) {
+    {
+      std::lock_guard<std::mutex> lock(stage->mutex);
+      stage->stop = true;
+    }
+    stage->cond.notify_all();
+    stage->thread.join();
+  }
+}
+
+void TwoStagePipeline::Run(std::vector<Job> jobs) {
+  if (jobs.empty()) {
+    return;
+  }
+
+  auto group = std::make_shared<Task::Group>();
+  group->num_pending = static_cast<int32_t>(jobs.size());
+
+  {
+    // Tasks of a call are queued together, so they are not interleaved
+    // with tasks of another call
+    std::lock_guard<std::mutex> lock(first_.mutex);
+    for (auto &job : jobs) {
+      auto task = std::make_shared<Task>();
+      task->job = std::move(job);
+      task->group = group;
+      first_.tasks.push_back(std::move(task));
+    }
+  }
+  first_.cond.notify_one();
+
+  std::unique_lock<std::mutex> lock(group->mutex);
+  group->cond.wait(lock, [&group] { return group->num_pending == 0; });
+}
+
+void TwoStagePipeline::Push(Stage *stage, std::shared_ptr<Task> task) {
+  {
+    std::lock_guard<std::mutex> lock(stage->mutex);
+    stage->tasks.push_back(std::move(task));
+  }
+  stage->cond.notify_one();
+}
+
+void TwoStagePipeline::Loop(Stage *stage, bool is_first) {
+  while (true) {
+    std::shared_ptr<Task> task;
+    {
+      std::unique_lock<std::mutex> lock(stage->mutex);
+      stage->cond.wait(
+          lock, [stage] { return stage->stop || !stage->tasks.empty(); });
+      if (stage->tasks.empty()) {
+        return;  // stage->stop is true
+      }
+
+      task = std::move(stage->tasks.front());
+      stage->tasks.pop_front();
+    }
+
+    if (is_first) {
+      if (task->job.first) {
+        task->job.first();
+      }
+      Push(&second_, std::move(task));
+      continue;
+    }
+
+    if (task->job.second) {
+      task->job.second();
+    }
+
+    auto &group = *task->group;
+    {
+      std::lock_guard<std::mutex> lock(group.mutex);
+      --group.num_pending;
+    }
+    group.cond.notify_all();
+  }
+}
+
+}  // namespace sherpa_onnx
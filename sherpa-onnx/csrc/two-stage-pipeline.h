@@ -0,0 +1,72 @@
+// sherpa-onnx/csrc/two-stage-pipeline.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_TWO_STAGE_PIPELINE_H_
+#define SHERPA_ONNX_CSRC_TWO_STAGE_PIPELINE_H_
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Run jobs that consist of two stages on two threads, one per stage.
+ *
+ * Jobs go through each stage in the order they are submitted, so the
+ * first stage of a job runs at the same time as the second stage of the
+ * previous job. For instance, the encoder of one batch can run while the
+ * search of the previous batch is running.
+ *
+ * The second stage of a job always starts after its first stage has
+ * returned.
+ */
+class TwoStagePipeline {
+ public:
+  struct Job {
+    std::function<void()> first;
+    std::function<void()> second;
+  };
+
+  TwoStagePipeline();
+
+  // Finish all submitted jobs and join the threads
+  ~TwoStagePipeline();
+
+  TwoStagePipeline(const TwoStagePipeline &) = delete;
+  TwoStagePipeline &operator=(const TwoStagePipeline &) = delete;
+
+  /** Run the given jobs and return after all of them have finished.
+   *
+   * It is safe to call it from several threads at the same time. Jobs
+   * from different calls are interleaved in the order they are submitted.
+   */
+  void Run(std::vector<Job> jobs);
+
+ private:
+  struct Task;
+
+  // A queue of tasks served by one thread
+  struct Stage {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::shared_ptr<Task>> tasks;
+    bool stop = false;
+    std::thread thread;
+  };
+
+  void Push(Stage *stage, std::shared_ptr<Task> task);
+  void Loop(Stage *stage, bool is_first);
+
+ private:
+  Stage first_;
+  Stage second_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_TWO_STAGE_PIPELINE_H_
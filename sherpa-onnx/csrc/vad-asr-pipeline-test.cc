@@ -0,0 +1,340 @@
+// sherpa-onnx/csrc/vad-asr-pipeline-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vad-asr-pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+// Non-zero samples are speech. A segment ends at the next zero sample or
+// at Flush()
+class StubDetector : public VadAsrPipelineBackend::Detector {
+ public:
+  void AcceptWaveform(const float *samples, int32_t n) override {
+    for (int32_t i = 0; i != n; ++i, ++num_samples_) {
+      if (samples[i] == 0) {
+        EndSegment();
+        continue;
+      }
+
+      if (current_.empty()) {
+        start_ = num_samples_;
+      }
+      current_.push_back(samples[i]);
+    }
+  }
+
+  bool Empty() const override { return segments_.empty(); }
+
+  const SpeechSegmentView &FrontView() const override {
+    return segments_.front();
+  }
+
+  void Pop() override { segments_.pop_front(); }
+
+  void Flush() override { EndSegment(); }
+
+  void Reset() override {
+    current_.clear();
+    num_samples_ = 0;
+  }
+
+ private:
+  void EndSegment() {
+    if (current_.empty()) {
+      return;
+    }
+
+    auto storage = std::make_shared<std::vector<float>>(std::move(current_));
+    current_.clear();
+
+    SpeechSegmentView segment;
+    segment.start = start_;
+    segment.samples.storage = storage;
+    segment.samples.data1 = storage->data();
+    segment.samples.size1 = static_cast<int32_t>(storage->size());
+    segments_.push_back(std::move(segment));
+  }
+
+ private:
+  std::vector<float> current_;
+  int32_t start_ = 0;
+  int32_t num_samples_ = 0;
+  std::deque<SpeechSegmentView> segments_;
+};
+
+// The text of a segment is its first sample. Segments are decoded by a
+// few threads after a random delay, so they finish out of order.
+class StubBackend : public VadAsrPipelineBackend {
+ public:
+  explicit StubBackend(int32_t num_threads) {
+    for (int32_t i = 0; i != num_threads; ++i) {
+      threads_.emplace_back([this, i]() { Worker(i); });
+    }
+  }
+
+  ~StubBackend() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto &t : threads_) {
+      t.join();
+    }
+  }
+
+  std::unique_ptr<Detector> CreateDetector() const override {
+    return std::make_unique<StubDetector>();
+  }
+
+  void Decode(const CircularBufferView &samples,
+              DecodeCallback done) override {
+    OfflineRecognitionResult r;
+    r.text = std::to_string(static_cast<int32_t>(samples.data1[0]));
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.emplace_back(std::move(r), std::move(done));
+    }
+    cv_.notify_one();
+  }
+
+  BatchingStats GetStats() const override { return {}; }
+
+ private:
+  void Worker(int32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int32_t> delay_us(0, 2000);
+
+    while (true) {
+      std::pair<OfflineRecognitionResult, DecodeCallback> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) {
+          return;
+        }
+
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+
+      std::this_thread::sleep_for(std::chrono::microseconds(delay_us(gen)));
+      job.second(std::move(job.first));
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::pair<OfflineRecognitionResult, DecodeCallback>> jobs_;
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
+
+// 100 samples per second and windows of 4 samples
+VadAsrPipelineConfig StubConfig(int32_t num_vad_threads,
+                                int32_t num_asr_threads) {
+  VadAsrPipelineConfig config;
+  config.vad.sample_rate = 100;
+  config.vad.silero_vad.window_size = 4;
+  config.num_vad_threads = num_vad_threads;
+  config.num_asr_threads = num_asr_threads;
+  config.min_segment_duration = 0.1;
+  return config;
+}
+
+void Append(int32_t n, float value, std::vector<float> *samples) {
+  samples->insert(samples->end(), n, value);
+}
+
+// Feed samples in chunks of a few samples
+void Feed(VadAsrPipeline *pipeline, int32_t channel,
+          const std::vector<float> &samples) {
+  int32_t n = static_cast<int32_t>(samples.size());
+  for (int32_t i = 0; i < n; i += 7) {
+    pipeline->AcceptWaveform(channel, samples.data() + i, std::min(7, n - i));
+  }
+}
+
+}  // namespace
+
+TEST(VadAsrPipeline, SegmentHandOff) {
+  std::vector<VadAsrPipelineResult> results;
+  VadAsrPipeline pipeline(
+      StubConfig(1, 2), 1,
+      [&results](const VadAsrPipelineResult &r) { results.push_back(r); },
+      std::make_unique<StubBackend>(2));
+
+  std::vector<float> samples;
+  Append(20, 0, &samples);
+  Append(30, 1, &samples);
+  Append(20, 0, &samples);
+  Append(50, 2, &samples);
+  Append(20, 0, &samples);
+  Append(5, 3, &samples);  // shorter than min_segment_duration
+  Append(20, 0, &samples);
+
+  Feed(&pipeline, 0, samples);
+  pipeline.InputFinished(0);
+  pipeline.WaitForCompletion();
+
+  ASSERT_EQ(results.size(), 2);
+
+  EXPECT_EQ(results[0].channel, 0);
+  EXPECT_EQ(results[0].segment_index, 0);
+  EXPECT_EQ(results[0].result.text, "1");
+  EXPECT_NEAR(results[0].start_time, 0.2, 1e-5);
+  EXPECT_NEAR(results[0].end_time, 0.5, 1e-5);
+
+  EXPECT_EQ(results[1].segment_index, 1);
+  EXPECT_EQ(results[1].result.text, "2");
+  EXPECT_NEAR(results[1].start_time, 0.7, 1e-5);
+  EXPECT_NEAR(results[1].end_time, 1.2, 1e-5);
+}
+
+TEST(VadAsrPipeline, InOrder) {
+  constexpr int32_t kNumChannels = 4;
+  constexpr int32_t kNumSegments = 50;
+
+  std::mutex mutex;
+  std::vector<std::vector<VadAsrPipelineResult>> results(kNumChannels);
+  std::vector<std::atomic<int32_t>> num_active(kNumChannels);
+  std::atomic<bool> concurrent{false};
+
+  VadAsrPipeline pipeline(
+      StubConfig(3, 8), kNumChannels,
+      [&](const VadAsrPipelineResult &r) {
+        if (num_active[r.channel]++ != 0) {
+          concurrent = true;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          results[r.channel].push_back(r);
+        }
+
+        --num_active[r.channel];
+      },
+      std::make_unique<StubBackend>(8));
+
+  std::vector<std::thread> producers;
+  for (int32_t c = 0; c != kNumChannels; ++c) {
+    producers.emplace_back([&pipeline, c]() {
+      for (int32_t i = 0; i != kNumSegments; ++i) {
+        std::vector<float> samples;
+        Append(10 + i % 7, i + 1, &samples);
+        Append(3, 0, &samples);
+        Feed(&pipeline, c, samples);
+      }
+      pipeline.InputFinished(c);
+    });
+  }
+
+  for (auto &t : producers) {
+    t.join();
+  }
+
+  pipeline.WaitForCompletion();
+
+  EXPECT_FALSE(concurrent);
+  for (int32_t c = 0; c != kNumChannels; ++c) {
+    ASSERT_EQ(results[c].size(), kNumSegments);
+    for (int32_t i = 0; i != kNumSegments; ++i) {
+      EXPECT_EQ(results[c][i].channel, c);
+      EXPECT_EQ(results[c][i].segment_index, i);
+      EXPECT_EQ(results[c][i].result.text, std::to_string(i + 1));
+    }
+  }
+}
+
+TEST(VadAsrPipeline, FlushPendingSegment) {
+  std::vector<VadAsrPipelineResult> results;
+  VadAsrPipeline pipeline(
+      StubConfig(1, 1), 1,
+      [&results](const VadAsrPipelineResult &r) { results.push_back(r); },
+      std::make_unique<StubBackend>(1));
+
+  // The input ends in the middle of speech
+  std::vector<float> samples;
+  Append(10, 0, &samples);
+  Append(30, 5, &samples);
+  Feed(&pipeline, 0, samples);
+
+  pipeline.WaitForCompletion();
+  EXPECT_TRUE(results.empty());
+
+  pipeline.InputFinished(0);
+  pipeline.WaitForCompletion();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].result.text, "5");
+  EXPECT_NEAR(results[0].end_time, 0.4, 1e-5);
+
+  // The channel starts a new input. Its timestamps start from 0 again and
+  // segments are still numbered per channel
+  samples.clear();
+  Append(20, 0, &samples);
+  Append(15, 6, &samples);
+  Feed(&pipeline, 0, samples);
+  pipeline.InputFinished(0);
+  pipeline.WaitForCompletion();
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[1].segment_index, 1);
+  EXPECT_EQ(results[1].result.text, "6");
+  EXPECT_NEAR(results[1].start_time, 0.2, 1e-5);
+}
+
+TEST(VadAsrPipeline, Shutdown) {
+  constexpr int32_t kNumChannels = 3;
+
+  std::mutex mutex;
+  std::vector<VadAsrPipelineResult> results;
+
+  {
+    VadAsrPipeline pipeline(
+        StubConfig(2, 2), kNumChannels,
+        [&](const VadAsrPipelineResult &r) {
+          std::lock_guard<std::mutex> lock(mutex);
+          results.push_back(r);
+        },
+        std::make_unique<StubBackend>(2));
+
+    for (int32_t c = 0; c != kNumChannels; ++c) {
+      std::vector<float> samples;
+      Append(20, c + 1, &samples);
+      Append(5, 0, &samples);
+      Append(20, c + 1, &samples);
+      Feed(&pipeline, c, samples);
+      pipeline.InputFinished(c);
+    }
+
+    // The destructor waits for the segments that are still being
+    // detected or decoded, including the last ones flushed by
+    // InputFinished()
+  }
+
+  EXPECT_EQ(results.size(), 2 * kNumChannels);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,438 @@
+// sherpa-onnx/csrc/vad-asr-pipeline.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vad-asr-pipeline.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/offline-recognizer-batch-queue.h"
+#include "sherpa-onnx/csrc/trace.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+class DefaultDetector : public VadAsrPipelineBackend::Detector {
+ public:
+  DefaultDetector(const VadModelConfig &config, float buffer_size_in_seconds)
+      : vad_(config, buffer_size_in_seconds) {}
+
+  void AcceptWaveform(const float *samples, int32_t n) override {
+    vad_.AcceptWaveform(samples, n);
+  }
+
+  bool Empty() const override { return vad_.Empty(); }
+
+  const SpeechSegmentView &FrontView() const override {
+    return vad_.FrontView();
+  }
+
+  void Pop() override { vad_.Pop(); }
+
+  void Flush() override { vad_.Flush(); }
+
+  void Reset() override { vad_.Reset(); }
+
+ private:
+  VoiceActivityDetector vad_;
+};
+
+class DefaultBackend : public VadAsrPipelineBackend {
+ public:
+  explicit DefaultBackend(const VadAsrPipelineConfig &config)
+      : config_(config),
+        recognizer_(config.asr),
+        queue_(&recognizer_, config.batching, config.num_asr_threads) {}
+
+  std::unique_ptr<Detector> CreateDetector() const override {
+    return std::make_unique<DefaultDetector>(
+        config_.vad, config_.vad_buffer_size_in_seconds);
+  }
+
+  void Decode(const CircularBufferView &samples,
+              DecodeCallback done) override {
+    auto s = recognizer_.CreateStream();
+    s->AcceptWaveform(config_.vad.sample_rate, samples);
+
+    queue_.Push(std::move(s), [done = std::move(done)](
+                                  std::unique_ptr<OfflineStream> stream) {
+      done(stream->GetResult());
+    });
+  }
+
+  BatchingStats GetStats() const override { return queue_.GetStats(); }
+
+ private:
+  VadAsrPipelineConfig config_;
+  OfflineRecognizer recognizer_;
+  OfflineRecognizerBatchQueue queue_;
+};
+
+}  // namespace
+
+void VadAsrPipelineConfig::Register(ParseOptions *po) {
+  vad.Register(po);
+  asr.Register(po);
+  batching.Register(po);
+
+  po->Register("num-vad-threads", &num_vad_threads,
+               "Number of threads running the voice activity detectors of "
+               "all channels");
+
+  po->Register("num-asr-threads", &num_asr_threads,
+               "Number of threads decoding batches of speech segments");
+
+  po->Register("min-segment-duration", &min_segment_duration,
+               "Speech segments shorter than this value in seconds are "
+               "discarded");
+
+  po->Register("vad-buffer-size-in-seconds", &vad_buffer_size_in_seconds,
+               "Size of the buffer of the voice activity detector of each "
+               "channel");
+}
+
+bool VadAsrPipelineConfig::Validate() const {
+  if (!vad.Validate() || !asr.Validate() || !batching.Validate()) {
+    return false;
+  }
+
+  if (num_vad_threads <= 0) {
+    SHERPA_ONNX_LOGE("Expect --num-vad-threads > 0. Given: %d",
+                     num_vad_threads);
+    return false;
+  }
+
+  if (num_asr_threads <= 0) {
+    SHERPA_ONNX_LOGE("Expect --num-asr-threads > 0. Given: %d",
+                     num_asr_threads);
+    return false;
+  }
+
+  if (vad_buffer_size_in_seconds <= 0) {
+    SHERPA_ONNX_LOGE("Expect --vad-buffer-size-in-seconds > 0. Given: %.3f",
+                     vad_buffer_size_in_seconds);
+    return false;
+  }
+
+  return true;
+}
+
+std::string VadAsrPipelineConfig::ToString() const {
+  std::ostringstream os;
+
+  os << "VadAsrPipelineConfig(";
+  os << "vad=" << vad.ToString() << ", ";
+  os << "asr=" << asr.ToString() << ", ";
+  os << "batching=" << batching.ToString() << ", ";
+  os << "num_vad_threads=" << num_vad_threads << ", ";
+  os << "num_asr_threads=" << num_asr_threads << ", ";
+  os << "min_segment_duration=" << min_segment_duration << ", ";
+  os << "vad_buffer_size_in_seconds=" << vad_buffer_size_in_seconds << ")";
+
+  return os.str();
+}
+
+class VadAsrPipeline::Impl {
+ public:
+  Impl(const VadAsrPipelineConfig &config, int32_t num_channels,
+       VadAsrPipelineCallback callback,
+       std::unique_ptr<VadAsrPipelineBackend> backend)
+      : config_(config),
+        callback_(std::move(callback)),
+        backend_(std::move(backend)) {
+    if (num_channels <= 0) {
+      SHERPA_ONNX_LOGE("Expect num_channels > 0. Given: %d", num_channels);
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    channels_.reserve(num_channels);
+    for (int32_t i = 0; i != num_channels; ++i) {
+      auto c = std::make_unique<Channel>();
+      c->id = i;
+      c->vad = backend_->CreateDetector();
+      channels_.push_back(std::move(c));
+    }
+
+    vad_threads_.reserve(config.num_vad_threads);
+    for (int32_t i = 0; i != config.num_vad_threads; ++i) {
+      vad_threads_.emplace_back([this]() { VadWorker(); });
+    }
+  }
+
+  ~Impl() {
+    WaitForCompletion();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto &t : vad_threads_) {
+      t.join();
+    }
+  }
+
+  void AcceptWaveform(int32_t channel, const float *samples, int32_t n) {
+    Channel *c = GetChannel(channel);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    c->pending.insert(c->pending.end(), samples, samples + n);
+    Schedule(c);
+  }
+
+  void InputFinished(int32_t channel) {
+    Channel *c = GetChannel(channel);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    c->finish_offsets.push_back(static_cast<int32_t>(c->pending.size()));
+    Schedule(c);
+  }
+
+  void WaitForCompletion() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() {
+      return num_scheduled_ == 0 && num_in_flight_ == 0;
+    });
+  }
+
+  int32_t NumChannels() const {
+    return static_cast<int32_t>(channels_.size());
+  }
+
+  BatchingStats GetStats() const { return backend_->GetStats(); }
+
+ private:
+  struct Channel {
+    int32_t id = 0;
+
+    // Only used by the VAD thread that has taken this channel
+    std::unique_ptr<VadAsrPipelineBackend::Detector> vad;
+    int32_t next_segment_index = 0;
+
+    // Protected by Impl::mutex_
+    std::vector<float> pending;  // samples not yet given to vad
+    // Positions in pending at which InputFinished() was called
+    std::deque<int32_t> finish_offsets;
+    bool scheduled = false;  // in ready_ or taken by a VAD thread
+
+    // Decoded segments waiting for the ones before them
+    std::mutex result_mutex;
+    int32_t next_to_deliver = 0;
+    std::map<int32_t, VadAsrPipelineResult> finished;
+  };
+
+  Channel *GetChannel(int32_t channel) const {
+    if (channel < 0 || channel >= NumChannels()) {
+      SHERPA_ONNX_LOGE("Invalid channel %d. Number of channels: %d", channel,
+                       NumChannels());
+      SHERPA_ONNX_EXIT(-1);
+    }
+    return channels_[channel].get();
+  }
+
+  // The caller holds mutex_
+  void Schedule(Channel *c) {
+    if (c->scheduled) {
+      return;
+    }
+
+    c->scheduled = true;
+    ++num_scheduled_;
+    ready_.push_back(c);
+    cv_.notify_one();
+  }
+
+  void VadWorker() {
+    std::vector<float> samples;
+
+    while (true) {
+      Channel *c = nullptr;
+      bool finished = false;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stop_ || !ready_.empty(); });
+        if (ready_.empty()) {
+          return;
+        }
+
+        c = ready_.front();
+        ready_.pop_front();
+
+        // Take the samples up to the first InputFinished() or all of them
+        int32_t n = static_cast<int32_t>(c->pending.size());
+        if (!c->finish_offsets.empty()) {
+          n = c->finish_offsets.front();
+          c->finish_offsets.pop_front();
+          for (auto &k : c->finish_offsets) {
+            k -= n;
+          }
+          finished = true;
+        }
+
+        samples.assign(c->pending.begin(), c->pending.begin() + n);
+        c->pending.erase(c->pending.begin(), c->pending.begin() + n);
+      }
+
+      RunVad(c, samples, finished);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!c->pending.empty() || !c->finish_offsets.empty()) {
+        ready_.push_back(c);
+        cv_.notify_one();
+      } else {
+        c->scheduled = false;
+        --num_scheduled_;
+        done_cv_.notify_all();
+      }
+    }
+  }
+
+  void RunVad(Channel *c, const std::vector<float> &samples, bool finished) {
+    SHERPA_ONNX_TRACE_SCOPE_N("VadAsrPipeline::RunVad", samples.size());
+
+    VadAsrPipelineBackend::Detector *vad = c->vad.get();
+    int32_t window_size = config_.vad.silero_vad.window_size;
+    int32_t n = static_cast<int32_t>(samples.size());
+
+    // Feed one window at a time. The detector decides whether a window
+    // is speech based on all windows of a call
+    for (int32_t i = 0; i < n; i += window_size) {
+      vad->AcceptWaveform(samples.data() + i, std::min(window_size, n - i));
+      SubmitSegments(c);
+    }
+
+    if (finished) {
+      vad->Flush();
+      SubmitSegments(c);
+      vad->Reset();
+    }
+  }
+
+  // Send segments detected by the VAD of channel c to the ASR queue
+  void SubmitSegments(Channel *c) {
+    VadAsrPipelineBackend::Detector *vad = c->vad.get();
+    float sample_rate = config_.vad.sample_rate;
+
+    while (!vad->Empty()) {
+      const SpeechSegmentView &segment = vad->FrontView();
+
+      float start_time = segment.start / sample_rate;
+      float duration = segment.samples.Size() / sample_rate;
+      if (duration < config_.min_segment_duration) {
+        vad->Pop();
+        continue;
+      }
+
+      VadAsrPipelineResult r;
+      r.channel = c->id;
+      r.segment_index = c->next_segment_index++;
+      r.start_time = start_time;
+      r.end_time = start_time + duration;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++num_in_flight_;
+      }
+
+      backend_->Decode(segment.samples,
+                       [this, c, r = std::move(r)](
+                           OfflineRecognitionResult result) mutable {
+                         r.result = std::move(result);
+                         Deliver(c, std::move(r));
+                       });
+      vad->Pop();
+    }
+  }
+
+  // Called from the ASR threads
+  void Deliver(Channel *c, VadAsrPipelineResult r) {
+    int32_t num_delivered = 0;
+    {
+      std::lock_guard<std::mutex> lock(c->result_mutex);
+      int32_t index = r.segment_index;
+      c->finished.emplace(index, std::move(r));
+
+      while (!c->finished.empty() &&
+             c->finished.begin()->first == c->next_to_deliver) {
+        if (callback_) {
+          callback_(c->finished.begin()->second);
+        }
+
+        c->finished.erase(c->finished.begin());
+        ++c->next_to_deliver;
+        ++num_delivered;
+      }
+    }
+
+    if (num_delivered) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      num_in_flight_ -= num_delivered;
+      done_cv_.notify_all();
+    }
+  }
+
+ private:
+  VadAsrPipelineConfig config_;
+  VadAsrPipelineCallback callback_;
+
+  // Declared before backend_ so that they are destroyed after the ASR
+  // threads have delivered all results
+  std::vector<std::unique_ptr<Channel>> channels_;
+  std::unique_ptr<VadAsrPipelineBackend> backend_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;       // for the VAD threads
+  std::condition_variable done_cv_;  // for WaitForCompletion()
+  std::deque<Channel *> ready_;      // channels with new input
+  int32_t num_scheduled_ = 0;        // channels in ready_ or being run
+  int32_t num_in_flight_ = 0;        // segments submitted but not delivered
+  bool stop_ = false;
+
+  std::vector<std::thread> vad_threads_;
+};
+
+VadAsrPipeline::VadAsrPipeline(const VadAsrPipelineConfig &config,
+                               int32_t num_channels,
+                               VadAsrPipelineCallback callback)
+    : VadAsrPipeline(config, num_channels, std::move(callback),
+                     std::make_unique<DefaultBackend>(config)) {}
+
+VadAsrPipeline::VadAsrPipeline(const VadAsrPipelineConfig &config,
+                               int32_t num_channels,
+                               VadAsrPipelineCallback callback,
+                               std::unique_ptr<VadAsrPipelineBackend> backend)
+    : impl_(std::make_unique<Impl>(config, num_channels, std::move(callback),
+                                   std::move(backend))) {}
+
+VadAsrPipeline::~VadAsrPipeline() = default;
+
+void VadAsrPipeline::AcceptWaveform(int32_t channel, const float *samples,
+                                    int32_t n) {
+  impl_->AcceptWaveform(channel, samples, n);
+}
+
+void VadAsrPipeline::InputFinished(int32_t channel) {
+  impl_->InputFinished(channel);
+}
+
+void VadAsrPipeline::WaitForCompletion() { impl_->WaitForCompletion(); }
+
+int32_t VadAsrPipeline::NumChannels() const { return impl_->NumChannels(); }
+
+BatchingStats VadAsrPipeline::GetStats() const { return impl_->GetStats(); }
+
+}  // namespace sherpa_onnx
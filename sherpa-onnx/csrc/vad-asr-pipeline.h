@@ -0,0 +1,181 @@
+// sherpa-onnx/csrc/vad-asr-pipeline.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_VAD_ASR_PIPELINE_H_
+#define SHERPA_ONNX_CSRC_VAD_ASR_PIPELINE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "sherpa-onnx/csrc/length-bucketed-batcher.h"
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/vad-model-config.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+struct VadAsrPipelineConfig {
+  VadModelConfig vad;
+  OfflineRecognizerConfig asr;
+
+  // How speech segments from all channels are batched for ASR
+  BatchingConfig batching;
+
+  // Number of threads running the voice activity detectors
+  int32_t num_vad_threads = 1;
+
+  // Number of threads calling OfflineRecognizer::DecodeStreams()
+  int32_t num_asr_threads = 2;
+
+  // Speech segments shorter than this value in seconds are discarded
+  float min_segment_duration = 0.1;
+
+  // Size of the buffer of each voice activity detector
+  float vad_buffer_size_in_seconds = 60;
+
+  VadAsrPipelineConfig() = default;
+
+  VadAsrPipelineConfig(const VadModelConfig &vad,
+                       const OfflineRecognizerConfig &asr,
+                       const BatchingConfig &batching, int32_t num_vad_threads,
+                       int32_t num_asr_threads, float min_segment_duration,
+                       float vad_buffer_size_in_seconds)
+      : vad(vad),
+        asr(asr),
+        batching(batching),
+        num_vad_threads(num_vad_threads),
+        num_asr_threads(num_asr_threads),
+        min_segment_duration(min_segment_duration),
+        vad_buffer_size_in_seconds(vad_buffer_size_in_seconds) {}
+
+  void Register(ParseOptions *po);
+  bool Validate() const;
+
+  std::string ToString() const;
+};
+
+struct VadAsrPipelineResult {
+  int32_t channel = 0;
+
+  // Index of the segment in its channel. For each channel, results are
+  // delivered in increasing order of it, starting from 0. It is not reset
+  // by InputFinished(), i.e., the segments of the next input of the
+  // channel continue the numbering.
+  int32_t segment_index = 0;
+
+  // In seconds, relative to the start of the input of the channel
+  float start_time = 0;
+  float end_time = 0;
+
+  OfflineRecognitionResult result;
+};
+
+using VadAsrPipelineCallback =
+    std::function<void(const VadAsrPipelineResult &result)>;
+
+/** The models used by VadAsrPipeline. By default, they are a
+ * VoiceActivityDetector per channel and an OfflineRecognizerBatchQueue
+ * created from VadAsrPipelineConfig. Tests replace them with stubs.
+ */
+class VadAsrPipelineBackend {
+ public:
+  // The same interface as VoiceActivityDetector
+  class Detector {
+   public:
+    virtual ~Detector() = default;
+
+    virtual void AcceptWaveform(const float *samples, int32_t n) = 0;
+    virtual bool Empty() const = 0;
+    virtual const SpeechSegmentView &FrontView() const = 0;
+    virtual void Pop() = 0;
+    virtual void Flush() = 0;
+    virtual void Reset() = 0;
+  };
+
+  using DecodeCallback = std::function<void(OfflineRecognitionResult)>;
+
+  virtual ~VadAsrPipelineBackend() = default;
+
+  // It is called once for each channel
+  virtual std::unique_ptr<Detector> CreateDetector() const = 0;
+
+  /** Decode a speech segment. It returns without waiting for the result.
+   *
+   * @param samples  Samples of the segment.
+   * @param done  It is called with the result from any thread.
+   */
+  virtual void Decode(const CircularBufferView &samples,
+                      DecodeCallback done) = 0;
+
+  virtual BatchingStats GetStats() const = 0;
+};
+
+/** Voice activity detection followed by non-streaming ASR for many
+ * audio channels, e.g., the calls of a call centre, with a single
+ * recognizer.
+ *
+ * Each channel has its own voice activity detector. Detectors of
+ * channels with new samples are run by a pool of threads. Speech
+ * segments from all channels are put into a single length-bucketed
+ * queue and decoded in batches by another pool of threads (see
+ * OfflineRecognizerBatchQueue).
+ *
+ * Results are delivered through the callback, which is called from the
+ * ASR threads. For a given channel, the callback is never called
+ * concurrently and results arrive in the order of the segments.
+ *
+ * All methods are thread-safe.
+ */
+class VadAsrPipeline {
+ public:
+  VadAsrPipeline(const VadAsrPipelineConfig &config, int32_t num_channels,
+                 VadAsrPipelineCallback callback);
+
+  // Use backend instead of the models in config.vad and config.asr
+  VadAsrPipeline(const VadAsrPipelineConfig &config, int32_t num_channels,
+                 VadAsrPipelineCallback callback,
+                 std::unique_ptr<VadAsrPipelineBackend> backend);
+
+  // It waits until all accepted samples are processed
+  ~VadAsrPipeline();
+
+  VadAsrPipeline(const VadAsrPipeline &) = delete;
+  VadAsrPipeline &operator=(const VadAsrPipeline &) = delete;
+
+  /** Append samples to a channel. It returns without waiting for
+   * them to be processed.
+   *
+   * @param channel  In the range [0, NumChannels()).
+   * @param samples  Normalized to [-1, 1]. The sample rate must be
+   *                 config.vad.sample_rate.
+   * @param n  Number of samples.
+   */
+  void AcceptWaveform(int32_t channel, const float *samples, int32_t n);
+
+  /** Signal the end of the input of a channel so that the last speech
+   * segment is decoded. The channel can be used for a new input
+   * afterwards, whose timestamps start from 0 again. Its segment indexes
+   * continue from the previous input.
+   */
+  void InputFinished(int32_t channel);
+
+  // Block until all samples accepted so far are processed and all
+  // resulting callbacks have returned
+  void WaitForCompletion();
+
+  int32_t NumChannels() const;
+
+  // Statistics of the ASR batches
+  BatchingStats GetStats() const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_VAD_ASR_PIPELINE_H_
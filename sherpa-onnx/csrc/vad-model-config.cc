@@ -22,6 +22,10 @@ void VadModelConfig::Register(ParseOptions *po) {
                "Specify a provider to run the VAD model. Supported values: "
                "cpu, cuda, coreml");
 
+  po->Register("vad-use-shared-runtime", &use_shared_runtime,
+               "true to run the model with the thread pools of the shared "
+               "onnxruntime environment. See --ort-intra-op-num-threads");
+
   po->Register("vad-debug", &debug,
                "true to display debug information when loading vad models");
 }
@@ -36,6 +40,8 @@ std::string VadModelConfig::ToString() const {
   os << "sample_rate=" << sample_rate << ", ";
   os << "num_threads=" << num_threads << ", ";
   os << "provider=\"" << provider << "\", ";
+  os << "use_shared_runtime=" << (use_shared_runtime ? "True" : "False")
+     << ", ";
   os << "debug=" << (debug ? "True" : "False") << ")";
 
   return os.str();
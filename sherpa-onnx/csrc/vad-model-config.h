@@ -18,6 +18,10 @@ struct VadModelConfig {
   int32_t num_threads = 1;
   std::string provider = "cpu";
 
+  // true to use the thread pools of the shared runtime. See
+  // shared-runtime.h
+  bool use_shared_runtime = false;
+
   // true to show debug information when loading models
   bool debug = false;
 
@@ -5,8 +5,10 @@
 #include "sherpa-onnx/csrc/voice-activity-detector.h"
 
 #include <algorithm>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <utility>
+#include <vector>
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -18,7 +20,9 @@
 #endif
 
 #include "sherpa-onnx/csrc/circular-buffer.h"
+#include "sherpa-onnx/csrc/trace.h"
 #include "sherpa-onnx/csrc/vad-model.h"
+#include "sherpa-onnx/csrc/warm-up.h"
 
 namespace sherpa_onnx {
 
@@ -89,11 +93,9 @@ class VoiceActivityDetector::Impl {
         // end of speech, save the speech segment
         int32_t end = buffer_.Tail() - model_->MinSilenceDurationSamples();
 
-        std::vector<float> s = buffer_.Get(start_, end - start_);
-        SpeechSegment segment;
-
+        SpeechSegmentView segment;
         segment.start = start_;
-        segment.samples = std::move(s);
+        segment.samples = buffer_.GetView(start_, end - start_);
 
         segments_.push(std::move(segment));
 
@@ -115,14 +117,33 @@ class VoiceActivityDetector::Impl {
 
   bool Empty() const { return segments_.empty(); }
 
-  void Pop() { segments_.pop(); }
+  void Pop() {
+    segments_.pop();
+    front_is_valid_ = false;
+  }
 
-  void Clear() { std::queue<SpeechSegment>().swap(segments_); }
+  void Clear() {
+    std::queue<SpeechSegmentView>().swap(segments_);
+    front_is_valid_ = false;
+  }
 
-  const SpeechSegment &Front() const { return segments_.front(); }
+  const SpeechSegment &Front() const {
+    // Front() is const, so several threads may call it at the same time
+    std::lock_guard<std::mutex> lock(front_mutex_);
+    if (!front_is_valid_) {
+      const auto &segment = segments_.front();
+      front_.start = segment.start;
+      front_.samples = segment.samples.ToVector();
+      front_is_valid_ = true;
+    }
+
+    return front_;
+  }
+
+  const SpeechSegmentView &FrontView() const { return segments_.front(); }
 
   void Reset() {
-    std::queue<SpeechSegment>().swap(segments_);
+    Clear();
 
     model_->Reset();
     buffer_.Reset();
@@ -140,12 +161,9 @@ class VoiceActivityDetector::Impl {
       return;
     }
 
-    std::vector<float> s = buffer_.Get(start_, end - start_);
-
-    SpeechSegment segment;
-
+    SpeechSegmentView segment;
     segment.start = start_;
-    segment.samples = std::move(s);
+    segment.samples = buffer_.GetView(start_, end - start_);
 
     segments_.push(std::move(segment));
 
@@ -167,7 +185,15 @@ class VoiceActivityDetector::Impl {
   }
 
  private:
-  std::queue<SpeechSegment> segments_;
+  // Segments refer to buffer_ without copying the samples
+  std::queue<SpeechSegmentView> segments_;
+
+  // A copy of the samples of the first segment, made by Front(). Pop()
+  // and Clear() modify segments_, so they can't run concurrently with
+  // Front() and don't need front_mutex_.
+  mutable std::mutex front_mutex_;
+  mutable SpeechSegment front_;
+  mutable bool front_is_valid_ = false;
 
   std::unique_ptr<VadModel> model_;
   VadModelConfig config_;
@@ -194,6 +220,7 @@ VoiceActivityDetector::VoiceActivityDetector(
 VoiceActivityDetector::~VoiceActivityDetector() = default;
 
 void VoiceActivityDetector::AcceptWaveform(const float *samples, int32_t n) {
+  SHERPA_ONNX_TRACE_SCOPE_N("VoiceActivityDetector::AcceptWaveform", n);
   impl_->AcceptWaveform(samples, n);
 }
 
@@ -207,6 +234,10 @@ const SpeechSegment &VoiceActivityDetector::Front() const {
   return impl_->Front();
 }
 
+const SpeechSegmentView &VoiceActivityDetector::FrontView() const {
+  return impl_->FrontView();
+}
+
 void VoiceActivityDetector::Reset() const { impl_->Reset(); }
 
 void VoiceActivityDetector::Flush() const { impl_->Flush(); }
@@ -219,6 +250,22 @@ const VadModelConfig &VoiceActivityDetector::GetConfig() const {
   return impl_->GetConfig();
 }
 
+void VoiceActivityDetector::WarmUp(int32_t num_runs) {
+  int32_t sample_rate = impl_->GetConfig().sample_rate;
+  std::vector<float> samples = GenerateWarmUpAudio(2, sample_rate);
+
+  // Feed 10 ms at a time like a microphone does
+  int32_t chunk = sample_rate / 100;
+  for (int32_t i = 0; i < num_runs; ++i) {
+    for (int32_t k = 0; k + chunk <= static_cast<int32_t>(samples.size());
+         k += chunk) {
+      impl_->AcceptWaveform(samples.data() + k, chunk);
+    }
+
+    impl_->Reset();
+  }
+}
+
 #if __ANDROID_API__ >= 9
 template VoiceActivityDetector::VoiceActivityDetector(
     AAssetManager *mgr, const VadModelConfig &config,
@@ -7,6 +7,7 @@
 #include <memory>
 #include <vector>
 
+#include "sherpa-onnx/csrc/circular-buffer.h"
 #include "sherpa-onnx/csrc/vad-model-config.h"
 
 namespace sherpa_onnx {
@@ -16,6 +17,13 @@ struct SpeechSegment {
   std::vector<float> samples;
 };
 
+// Like SpeechSegment, but the samples are not copied out of the buffer
+// of the voice activity detector. It stays valid after Pop().
+struct SpeechSegmentView {
+  int32_t start;  // in samples
+  CircularBufferView samples;
+};
+
 class VoiceActivityDetector {
  public:
   explicit VoiceActivityDetector(const VadModelConfig &config,
@@ -31,8 +39,15 @@ class VoiceActivityDetector {
   bool Empty() const;
   void Pop();
   void Clear();
+  // The samples are copied from the buffer of the detector on the first
+  // call. The returned reference is valid until Pop() or Clear(). It is
+  // safe to call it from several threads at the same time.
   const SpeechSegment &Front() const;
 
+  // Like Front() but without copying the samples. The returned view can be
+  // passed to OfflineStream::AcceptWaveform() directly.
+  const SpeechSegmentView &FrontView() const;
+
   bool IsSpeechDetected() const;
 
   void Reset() const;
@@ -43,6 +58,11 @@ class VoiceActivityDetector {
 
   const VadModelConfig &GetConfig() const;
 
+  // Run the model num_runs times over a few seconds of synthetic audio and
+  // reset the detector, so that the first real samples do not pay for
+  // memory allocation and kernel selection of onnxruntime
+  void WarmUp(int32_t num_runs);
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
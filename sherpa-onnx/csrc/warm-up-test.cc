@@ -0,0 +1,52 @@
+// sherpa-onnx/csrc/warm-up-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/warm-up.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(WarmUp, PowersOfTwoUpTo) {
+  EXPECT_EQ(PowersOfTwoUpTo(1), (std::vector<int32_t>{1}));
+  EXPECT_EQ(PowersOfTwoUpTo(2), (std::vector<int32_t>{1, 2}));
+  EXPECT_EQ(PowersOfTwoUpTo(8), (std::vector<int32_t>{1, 2, 4, 8}));
+  EXPECT_EQ(PowersOfTwoUpTo(5), (std::vector<int32_t>{1, 2, 4, 5}));
+}
+
+TEST(WarmUp, Durations) {
+  EXPECT_EQ(WarmUpDurations(1), (std::vector<float>{1}));
+  EXPECT_EQ(WarmUpDurations(8), (std::vector<float>{1, 2, 4, 8}));
+  EXPECT_EQ(WarmUpDurations(10), (std::vector<float>{1, 2, 4, 8, 10}));
+}
+
+TEST(WarmUp, Audio) {
+  std::vector<float> samples = GenerateWarmUpAudio(2, 16000);
+  ASSERT_EQ(samples.size(), 32000);
+
+  // Speech in the first 1.5 seconds and silence in the last 0.5 seconds
+  float speech = 0;
+  for (int32_t i = 0; i != 8000; ++i) {
+    speech += samples[i] * samples[i];
+  }
+
+  float silence = 0;
+  for (int32_t i = 24000; i != 32000; ++i) {
+    silence += samples[i] * samples[i];
+  }
+
+  EXPECT_GT(speech, 100 * silence);
+
+  for (float s : samples) {
+    EXPECT_LE(std::abs(s), 1);
+  }
+
+  // It is deterministic
+  EXPECT_EQ(samples, GenerateWarmUpAudio(2, 16000));
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,56 @@
+// sherpa-onnx/csrc/warm-up.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/warm-up.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace sherpa_onnx {
+
+std::vector<float> GenerateWarmUpAudio(float duration, int32_t sample_rate) {
+  std::vector<float> ans(static_cast<int32_t>(duration * sample_rate));
+
+  std::mt19937 gen(0);
+  std::normal_distribution<float> noise(0, 1);
+
+  const float kPi = 3.14159265358979f;
+  float phase = 0;
+  for (int32_t i = 0; i != static_cast<int32_t>(ans.size()); ++i) {
+    float t = static_cast<float>(i) / sample_rate;
+    float f0 = 120 + 40 * std::sin(2 * kPi * 0.5f * t);
+    phase += 2 * kPi * f0 / sample_rate;
+
+    float s = 0;
+    for (int32_t h = 1; h <= 4; ++h) {
+      s += std::sin(h * phase) / h;
+    }
+
+    float envelope = std::fmod(t, 2.0f) < 1.5f ? 0.2f : 0.0f;
+    ans[i] = envelope * s + 0.003f * noise(gen);
+  }
+
+  return ans;
+}
+
+std::vector<int32_t> PowersOfTwoUpTo(int32_t n) {
+  std::vector<int32_t> ans;
+  for (int32_t i = 1; i < n; i *= 2) {
+    ans.push_back(i);
+  }
+  ans.push_back(n);
+  return ans;
+}
+
+std::vector<float> WarmUpDurations(float max_duration) {
+  std::vector<float> ans;
+  for (float d = 1; d < max_duration; d *= 2) {
+    ans.push_back(d);
+  }
+  ans.push_back(max_duration);
+  return ans;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,88 @@
+// sherpa-onnx/csrc/warm-up.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_WARM_UP_H_
+#define SHERPA_ONNX_CSRC_WARM_UP_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/online-stream.h"
+
+namespace sherpa_onnx {
+
+// Voiced segments with a few harmonics and some noise so that the models
+// emit tokens and the decoders do representative work. It repeats 1.5
+// seconds of speech followed by 0.5 seconds of silence.
+std::vector<float> GenerateWarmUpAudio(float duration, int32_t sample_rate);
+
+// 1, 2, 4, ..., n. n is included even if it is not a power of 2.
+// n must be at least 1.
+std::vector<int32_t> PowersOfTwoUpTo(int32_t n);
+
+// Lengths in seconds of the utterances used to warm up non-streaming
+// models: 1, 2, 4, ..., max_duration. max_duration is included even if it
+// is not a power of 2. max_duration must be at least 1.
+std::vector<float> WarmUpDurations(float max_duration);
+
+/** Decode synthetic audio with 1, 2, 4, ..., max_batch_size streams at a
+ * time.
+ *
+ * onnxruntime allocates memory and selects kernels for a shape when it
+ * sees it for the first time, so the first requests after a start are
+ * much slower than the others. Running the shapes of the expected batch
+ * sizes at load time moves this cost out of the serving path.
+ *
+ * @param recognizer An OnlineRecognizerImpl or a KeywordSpotterImpl
+ * @param sample_rate Sample rate of the generated audio
+ * @param num_runs Number of runs of each batch size
+ * @param max_batch_size Largest number of streams decoded together. It
+ *                       must be at least 1.
+ */
+template <typename Recognizer>
+void WarmUpStreams(const Recognizer &recognizer, int32_t sample_rate,
+                   int32_t num_runs, int32_t max_batch_size) {
+  if (num_runs <= 0) {
+    return;
+  }
+
+  std::vector<float> samples = GenerateWarmUpAudio(2, sample_rate);
+  std::vector<float> tail_paddings(static_cast<int32_t>(0.3 * sample_rate));
+
+  for (int32_t batch_size : PowersOfTwoUpTo(max_batch_size)) {
+    for (int32_t i = 0; i < num_runs; ++i) {
+      std::vector<std::unique_ptr<OnlineStream>> streams;
+      for (int32_t k = 0; k != batch_size; ++k) {
+        auto s = recognizer.CreateStream();
+        s->AcceptWaveform(sample_rate, samples.data(), samples.size());
+        s->AcceptWaveform(sample_rate, tail_paddings.data(),
+                          tail_paddings.size());
+        s->InputFinished();
+        streams.push_back(std::move(s));
+      }
+
+      std::vector<OnlineStream *> ready;
+      while (true) {
+        ready.clear();
+        for (auto &s : streams) {
+          if (recognizer.IsReady(s.get())) {
+            ready.push_back(s.get());
+          }
+        }
+
+        if (ready.empty()) {
+          break;
+        }
+
+        recognizer.DecodeStreams(ready.data(), ready.size());
+      }
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_WARM_UP_H_
@@ -37,6 +37,7 @@ static void PybindOfflineSpeakerSegmentationModelConfig(py::module *m) {
       .def_readwrite("num_threads", &PyClass::num_threads)
       .def_readwrite("debug", &PyClass::debug)
       .def_readwrite("provider", &PyClass::provider)
+      .def_readwrite("use_shared_runtime", &PyClass::use_shared_runtime)
       .def("__str__", &PyClass::ToString)
       .def("validate", &PyClass::Validate);
 }
@@ -28,6 +28,7 @@ void PybindOfflineTtsKokoroModelConfig(py::module *m) {
       .def_readwrite("data_dir", &PyClass::data_dir)
       .def_readwrite("dict_dir", &PyClass::dict_dir)
       .def_readwrite("length_scale", &PyClass::length_scale)
+      .def_readwrite("lazy_voices", &PyClass::lazy_voices)
       .def("__str__", &PyClass::ToString)
       .def("validate", &PyClass::Validate);
 }
@@ -21,6 +21,7 @@ void PybindOnlineLMConfig(py::module *m) {
       .def_readwrite("model", &PyClass::model)
       .def_readwrite("scale", &PyClass::scale)
       .def_readwrite("lm_provider", &PyClass::lm_provider)
+      .def_readwrite("use_shared_runtime", &PyClass::use_shared_runtime)
       .def_readwrite("lm_num_threads", &PyClass::lm_num_threads)
       .def_readwrite("shallow_fusion", &PyClass::shallow_fusion)
       .def("__str__", &PyClass::ToString);
@@ -55,6 +55,9 @@ void PybindOnlineModelConfig(py::module *m) {
       .def_readwrite("provider_config", &PyClass::provider_config)
       .def_readwrite("tokens", &PyClass::tokens)
       .def_readwrite("num_threads", &PyClass::num_threads)
+      .def_readwrite("graph_optimization_level",
+                     &PyClass::graph_optimization_level)
+      .def_readwrite("use_shared_runtime", &PyClass::use_shared_runtime)
       .def_readwrite("warm_up", &PyClass::warm_up)
       .def_readwrite("debug", &PyClass::debug)
       .def_readwrite("model_type", &PyClass::model_type)
@@ -82,6 +82,9 @@ static void PybindOnlineRecognizerConfig(py::module *m) {
       .def_readwrite("temperature_scale", &PyClass::temperature_scale)
       .def_readwrite("rule_fsts", &PyClass::rule_fsts)
       .def_readwrite("rule_fars", &PyClass::rule_fars)
+      .def_readwrite("pipeline", &PyClass::pipeline)
+      .def_readwrite("pipeline_batch_size", &PyClass::pipeline_batch_size)
+      .def_readwrite("itn_tail_tokens", &PyClass::itn_tail_tokens)
       .def("__str__", &PyClass::ToString);
 }
 
@@ -4,6 +4,7 @@
 
 #include "sherpa-onnx/python/csrc/online-stream.h"
 
+#include <string>
 #include <vector>
 
 #include "sherpa-onnx/csrc/online-stream.h"
@@ -39,6 +40,12 @@ Return:
     `features = np.reshape(arr, (n, feature_dim))`
 )";
 
+constexpr const char *kSerializeUsage = R"(
+Return a snapshot of the decoding state of this stream as bytes. It can be
+restored with deserialize() into a new stream created by a recognizer with
+the same model, possibly in another process. Return empty bytes on error.
+)";
+
 void PybindOnlineStream(py::module *m) {
   using PyClass = OnlineStream;
   py::class_<PyClass>(*m, "OnlineStream")
@@ -54,7 +61,26 @@ void PybindOnlineStream(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("get_frames", &PyClass::GetFrames,
            py::arg("frame_index"), py::arg("n"), kGetFramesUsage,
-           py::call_guard<py::gil_scoped_release>());
+           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "serialize",
+          [](const PyClass &self) {
+            std::string data;
+            {
+              py::gil_scoped_release release;
+              data = self.Serialize();
+            }
+            return py::bytes(data);
+          },
+          kSerializeUsage)
+      .def(
+          "deserialize",
+          [](PyClass &self, const py::bytes &data) {
+            std::string s = data;
+            py::gil_scoped_release release;
+            return self.Deserialize(s);
+          },
+          py::arg("data"));
 }
 
 }  // namespace sherpa_onnx
@@ -0,0 +1,28 @@
+// sherpa-onnx/python/csrc/shared-runtime.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/python/csrc/shared-runtime.h"
+
+#include "sherpa-onnx/csrc/shared-runtime.h"
+
+namespace sherpa_onnx {
+
+void PybindSharedRuntime(py::module *m) {
+  using PyClass = SharedRuntimeConfig;
+  py::class_<PyClass>(*m, "SharedRuntimeConfig")
+      .def(py::init<>())
+      .def_readwrite("intra_op_num_threads", &PyClass::intra_op_num_threads)
+      .def_readwrite("inter_op_num_threads", &PyClass::inter_op_num_threads)
+      .def_readwrite("cpu_affinity", &PyClass::cpu_affinity)
+      .def_readwrite("allow_spinning", &PyClass::allow_spinning)
+      .def_readwrite("use_shared_arena", &PyClass::use_shared_arena)
+      .def("__str__", &PyClass::ToString)
+      .def("validate", &PyClass::Validate);
+
+  // Call it before creating any model
+  m->def("init_shared_runtime", &InitSharedRuntime, py::arg("config"));
+  m->def("is_shared_runtime_initialized", &IsSharedRuntimeInitialized);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,16 @@
+// sherpa-onnx/python/csrc/shared-runtime.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_PYTHON_CSRC_SHARED_RUNTIME_H_
+#define SHERPA_ONNX_PYTHON_CSRC_SHARED_RUNTIME_H_
+
+#include "sherpa-onnx/python/csrc/sherpa-onnx.h"
+
+namespace sherpa_onnx {
+
+void PybindSharedRuntime(py::module *m);
+
+}
+
+#endif  // SHERPA_ONNX_PYTHON_CSRC_SHARED_RUNTIME_H_
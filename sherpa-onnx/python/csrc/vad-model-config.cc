@@ -26,6 +26,7 @@ void PybindVadModelConfig(py::module *m) {
       .def_readwrite("sample_rate", &PyClass::sample_rate)
       .def_readwrite("num_threads", &PyClass::num_threads)
       .def_readwrite("provider", &PyClass::provider)
+      .def_readwrite("use_shared_runtime", &PyClass::use_shared_runtime)
       .def_readwrite("debug", &PyClass::debug)
       .def("__str__", &PyClass::ToString)
       .def("validate", &PyClass::Validate);
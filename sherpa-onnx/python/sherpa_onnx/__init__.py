@@ -34,6 +34,7 @@ from _sherpa_onnx import (
     OnlinePunctuationConfig,
     OnlinePunctuationModelConfig,
     OnlineStream,
+    SharedRuntimeConfig,
     SileroVadModelConfig,
     SpeakerEmbeddingExtractor,
     SpeakerEmbeddingExtractorConfig,
@@ -45,6 +46,8 @@ from _sherpa_onnx import (
     VadModel,
     VadModelConfig,
     VoiceActivityDetector,
+    init_shared_runtime,
+    is_shared_runtime_initialized,
     write_wave,
 )
 